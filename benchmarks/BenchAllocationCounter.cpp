@@ -0,0 +1,46 @@
+#include "BenchAllocationCounter.h"
+#include <cstdlib>
+#include <new>
+
+namespace PassBy {
+namespace Bench {
+
+std::atomic<size_t> AllocationCounters::liveBytes{0};
+std::atomic<size_t> AllocationCounters::allocations{0};
+
+} // namespace Bench
+} // namespace PassBy
+
+namespace {
+
+// Size header in front of each block so operator delete can account for it
+constexpr size_t kHeader = alignof(std::max_align_t);
+
+void* countedAllocate(size_t size) {
+    void* raw = std::malloc(size + kHeader);
+    if (!raw) {
+        throw std::bad_alloc();
+    }
+    *static_cast<size_t*>(raw) = size;
+    PassBy::Bench::AllocationCounters::liveBytes.fetch_add(size, std::memory_order_relaxed);
+    PassBy::Bench::AllocationCounters::allocations.fetch_add(1, std::memory_order_relaxed);
+    return static_cast<char*>(raw) + kHeader;
+}
+
+void countedFree(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+    void* raw = static_cast<char*>(ptr) - kHeader;
+    PassBy::Bench::AllocationCounters::liveBytes.fetch_sub(*static_cast<size_t*>(raw), std::memory_order_relaxed);
+    std::free(raw);
+}
+
+} // namespace
+
+void* operator new(size_t size) { return countedAllocate(size); }
+void* operator new[](size_t size) { return countedAllocate(size); }
+void operator delete(void* ptr) noexcept { countedFree(ptr); }
+void operator delete[](void* ptr) noexcept { countedFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { countedFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { countedFree(ptr); }
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace PassBy {
+namespace Bench {
+
+// Process-wide heap accounting, fed by the operator new/delete replacements in
+// BenchAllocationCounter.cpp
+struct AllocationCounters {
+    static std::atomic<size_t> liveBytes;
+    static std::atomic<size_t> allocations;
+};
+
+// Live heap bytes and allocation count since construction
+class AllocationScope {
+public:
+    AllocationScope()
+        : m_startBytes(AllocationCounters::liveBytes.load()),
+          m_startAllocations(AllocationCounters::allocations.load()) {}
+
+    size_t liveBytes() const {
+        return AllocationCounters::liveBytes.load() - m_startBytes;
+    }
+
+    size_t allocations() const {
+        return AllocationCounters::allocations.load() - m_startAllocations;
+    }
+
+private:
+    size_t m_startBytes;
+    size_t m_startAllocations;
+};
+
+} // namespace Bench
+} // namespace PassBy
@@ -0,0 +1,156 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <random>
+#include <string>
+#include <vector>
+#include "PassBy/PassBy.h"
+#include "../src/internal/PassByBridge.h"
+#include "BenchAllocationCounter.h"
+
+// Bridge-to-manager discovery path, each case at 1, 4 and 16 producer threads.
+
+namespace {
+
+constexpr size_t kIdentifierPool = 1 << 16;
+constexpr int kEventsPerIteration = 256;
+
+const std::vector<std::string>& identifierPool() {
+    static const std::vector<std::string> pool = [] {
+        std::mt19937_64 rng(2024);
+        std::vector<std::string> identifiers;
+        identifiers.reserve(kIdentifierPool);
+        for (size_t i = 0; i < kIdentifierPool; ++i) {
+            uint8_t bytes[PassBy::DeviceId::kSize];
+            for (auto& b : bytes) {
+                b = static_cast<uint8_t>(rng());
+            }
+            identifiers.push_back(PassBy::DeviceId::fromBytes(bytes).toString());
+        }
+        return identifiers;
+    }();
+    return pool;
+}
+
+// Fresh manager state for each benchmark run; thread 0 only
+void resetManager(PassBy::PassByManager& manager) {
+    manager.flushEvents();
+    manager.setDeviceDiscoveredCallback(nullptr);
+    manager.setDeviceBatchCallback(nullptr);
+    manager.clearDiscoveredDevices();
+}
+
+// Register `count` distinct devices, draining the queue as we go so nothing is dropped
+void populate(PassBy::PassByManager& manager, size_t count) {
+    const auto& pool = identifierPool();
+    for (size_t i = 0; i < count; ++i) {
+        PassBy::PassByBridge::onDeviceDiscovered(pool[i % pool.size()]);
+        if (i % 1024 == 1023) {
+            manager.flushEvents();
+        }
+    }
+    manager.flushEvents();
+}
+
+// PassByBridge::onDeviceDiscovered through dispatch, range(0) = 1 with a user callback.
+// Each iteration reports a burst of events and waits for the dispatch thread to drain it.
+void BM_BridgeDiscovery(benchmark::State& state) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    static std::atomic<uint64_t> callbackCount{0};
+    static uint64_t droppedAtStart = 0;
+    if (state.thread_index() == 0) {
+        resetManager(manager);
+        if (state.range(0) == 1) {
+            manager.setDeviceDiscoveredCallback([](const PassBy::DeviceInfo&) {
+                callbackCount.fetch_add(1, std::memory_order_relaxed);
+            });
+        }
+        droppedAtStart = manager.getDroppedEventCount();
+    }
+
+    const auto& pool = identifierPool();
+    size_t next = static_cast<size_t>(state.thread_index()) * 4096;
+    for (auto _ : state) {
+        for (int i = 0; i < kEventsPerIteration; ++i) {
+            PassBy::PassByBridge::onDeviceDiscovered(pool[next++ % pool.size()]);
+        }
+        manager.flushEvents();
+    }
+
+    state.SetItemsProcessed(state.iterations() * kEventsPerIteration);
+    if (state.thread_index() == 0) {
+        state.counters["dropped"] = static_cast<double>(manager.getDroppedEventCount() - droppedAtStart);
+        manager.setDeviceDiscoveredCallback(nullptr);
+    }
+}
+
+// Full copy of the registry as it grows, range(0) = tracked devices
+void BM_GetDiscoveredDevices(benchmark::State& state) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    if (state.thread_index() == 0) {
+        resetManager(manager);
+        populate(manager, static_cast<size_t>(state.range(0)));
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(manager.getDiscoveredDevices());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// UI-style polling for changes, range(0) = tracked devices; 16 devices change per poll
+void BM_GetDiscoveredSince(benchmark::State& state) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    if (state.thread_index() == 0) {
+        resetManager(manager);
+        populate(manager, static_cast<size_t>(state.range(0)));
+    }
+
+    const auto& pool = identifierPool();
+    uint64_t generation = manager.getDiscoveredSince(0).generation;
+    size_t next = static_cast<size_t>(state.thread_index()) * 16;
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (int i = 0; i < 16; ++i) {
+            PassBy::PassByBridge::onDeviceDiscovered(pool[next++ % static_cast<size_t>(state.range(0))]);
+        }
+        manager.flushEvents();
+        state.ResumeTiming();
+
+        auto delta = manager.getDiscoveredSince(generation);
+        generation = delta.generation;
+        benchmark::DoNotOptimize(delta);
+    }
+}
+
+void BM_GetInstance(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(&PassBy::PassByManager::getInstance());
+    }
+}
+
+// Heap bytes held per tracked device, range(0) = tracked devices.
+// Single-threaded: the memory held depends on the device count, not on the caller threads.
+void BM_TrackedDeviceMemory(benchmark::State& state) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    const size_t count = static_cast<size_t>(state.range(0));
+    size_t bytes = 0;
+
+    for (auto _ : state) {
+        resetManager(manager);
+        PassBy::Bench::AllocationScope scope;
+        populate(manager, count);
+        bytes = scope.liveBytes();
+    }
+
+    state.counters["bytes_per_device"] = static_cast<double>(bytes) / static_cast<double>(count);
+    state.counters["store_bytes_per_device"] =
+        static_cast<double>(manager.getEncounterMemoryUsage()) / static_cast<double>(count);
+}
+
+} // namespace
+
+BENCHMARK(BM_BridgeDiscovery)->Arg(0)->Arg(1)->Threads(1)->Threads(4)->Threads(16)->UseRealTime();
+BENCHMARK(BM_GetDiscoveredDevices)->RangeMultiplier(10)->Range(100, 10000)->Threads(1)->Threads(4)->Threads(16)->UseRealTime();
+BENCHMARK(BM_GetDiscoveredSince)->RangeMultiplier(10)->Range(100, 10000)->Threads(1)->Threads(4)->Threads(16)->UseRealTime();
+BENCHMARK(BM_GetInstance)->Threads(1)->Threads(4)->Threads(16)->UseRealTime();
+BENCHMARK(BM_TrackedDeviceMemory)->Arg(1000)->Arg(10000)->Arg(50000)->Iterations(1);
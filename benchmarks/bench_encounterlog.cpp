@@ -0,0 +1,49 @@
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <string>
+#include "../src/internal/EncounterLog.h"
+#include "../src/internal/EncounterStore.h"
+
+// Warm start: reopen and reload an encounter log, range(0) = devices in the log
+
+namespace {
+
+PassBy::DeviceId idFor(uint32_t n) {
+    uint8_t bytes[PassBy::DeviceId::kSize] = {};
+    for (int i = 0; i < 4; ++i) {
+        bytes[i] = static_cast<uint8_t>(n >> (8 * i));
+        bytes[15 - i] = static_cast<uint8_t>((n * 2654435761u) >> (8 * i));
+    }
+    return PassBy::DeviceId::fromBytes(bytes);
+}
+
+void BM_EncounterLogReload(benchmark::State& state) {
+    const std::string path = "passby_bench_encounters.log";
+    const uint32_t count = static_cast<uint32_t>(state.range(0));
+    std::remove(path.c_str());
+    {
+        PassBy::EncounterStore store;
+        PassBy::EncounterLog log;
+        if (!log.open(path)) {
+            state.SkipWithError("cannot create log");
+            return;
+        }
+        for (uint32_t n = 0; n < count; ++n) {
+            log.append(*store.record(idFor(n), n, ""), "");
+        }
+    }
+
+    for (auto _ : state) {
+        PassBy::EncounterLog log;
+        PassBy::EncounterStore store;
+        log.open(path);
+        log.load(store, count);
+        benchmark::DoNotOptimize(store.size());
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+    std::remove(path.c_str());
+}
+
+} // namespace
+
+BENCHMARK(BM_EncounterLogReload)->Arg(10000)->Arg(100000)->Arg(300000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,85 @@
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "PassBy/EncounterGraph.h"
+
+// Encounter graph construction from a random report stream, by thread count
+
+namespace {
+
+struct Report {
+    uint32_t observer;
+    uint32_t peer;
+    int64_t startMs;
+    int64_t endMs;
+};
+
+PassBy::DeviceId deviceFor(uint32_t n) {
+    uint8_t bytes[PassBy::DeviceId::kSize] = {0xB0};
+    std::memcpy(bytes + 12, &n, sizeof(n));
+    return PassBy::DeviceId::fromBytes(bytes);
+}
+
+std::vector<Report> makeReports(size_t count) {
+    std::mt19937_64 rng(count);
+    const uint32_t devices = static_cast<uint32_t>(count / 20 + 1);
+    std::vector<Report> reports(count);
+    for (auto& report : reports) {
+        report.observer = static_cast<uint32_t>(rng() % devices);
+        report.peer = static_cast<uint32_t>(rng() % devices);
+        report.startMs = static_cast<int64_t>(rng() % (7 * 24 * 3600 * 1000LL));
+        report.endMs = report.startMs + static_cast<int64_t>(rng() % 600000);
+    }
+    return reports;
+}
+
+void BM_GraphBuild(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    const size_t threads = static_cast<size_t>(state.range(1));
+    auto reports = makeReports(count);
+    size_t bytes = 0;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        PassBy::EncounterGraphBuilder builder(threads);
+        builder.reserve(count);
+        for (const auto& report : reports) {
+            builder.add(deviceFor(report.observer), deviceFor(report.peer), report.startMs, report.endMs);
+        }
+        state.ResumeTiming();
+
+        PassBy::EncounterGraph graph = builder.build();
+        bytes = graph.memoryUsage();
+        benchmark::DoNotOptimize(graph);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * count));
+    state.counters["bytes_per_report"] = static_cast<double>(bytes) / static_cast<double>(count);
+}
+
+void BM_GraphContactCount(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    auto reports = makeReports(count);
+    PassBy::EncounterGraphBuilder builder;
+    for (const auto& report : reports) {
+        builder.add(deviceFor(report.observer), deviceFor(report.peer), report.startMs, report.endMs);
+    }
+    PassBy::EncounterGraph graph = builder.build();
+    PassBy::TimeWindow window{0, 24 * 3600 * 1000LL};
+    size_t next = 0;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(graph.contactCount(deviceFor(reports[next].observer), window));
+        next = next + 1 == count ? 0 : next + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+BENCHMARK(BM_GraphBuild)
+    ->ArgsProduct({{100000, 1000000}, {1, 4}})
+    ->Unit(benchmark::kMillisecond)
+    ->Iterations(3)
+    ->UseRealTime();
+BENCHMARK(BM_GraphContactCount)->Arg(1000000);
@@ -0,0 +1,103 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "PassBy/DeviceId.h"
+#include "../src/internal/DeviceIdTable.h"
+#include "BenchAllocationCounter.h"
+
+// Registry containers: the old std::set<std::string> against DeviceIdSet.
+// Identifiers arrive as UUID strings in both cases, so the DeviceIdSet numbers include parsing.
+
+namespace {
+
+std::vector<std::string> makeIdentifiers(size_t count) {
+    std::mt19937_64 rng(count);
+    std::vector<std::string> identifiers;
+    identifiers.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        uint8_t bytes[PassBy::DeviceId::kSize];
+        for (auto& b : bytes) {
+            b = static_cast<uint8_t>(rng());
+        }
+        identifiers.push_back(PassBy::DeviceId::fromBytes(bytes).toString());
+    }
+    return identifiers;
+}
+
+void reportPerDevice(benchmark::State& state, size_t count, size_t bytes) {
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * count));
+    state.counters["bytes_per_device"] = static_cast<double>(bytes) / static_cast<double>(count);
+}
+
+void BM_StdSetInsert(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    auto identifiers = makeIdentifiers(count);
+    size_t bytes = 0;
+
+    for (auto _ : state) {
+        PassBy::Bench::AllocationScope scope;
+        std::set<std::string> set;
+        for (const auto& id : identifiers) {
+            set.insert(id);
+        }
+        bytes = scope.liveBytes();
+        benchmark::DoNotOptimize(set);
+    }
+    reportPerDevice(state, count, bytes);
+}
+
+void BM_DeviceIdSetInsert(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    auto identifiers = makeIdentifiers(count);
+    size_t bytes = 0;
+
+    for (auto _ : state) {
+        PassBy::Bench::AllocationScope scope;
+        PassBy::DeviceIdSet set;
+        for (const auto& id : identifiers) {
+            set.insert(PassBy::DeviceId::fromString(id));
+        }
+        bytes = scope.liveBytes();
+        benchmark::DoNotOptimize(set);
+    }
+    reportPerDevice(state, count, bytes);
+}
+
+// Re-reporting an already known device: the steady state in a crowd
+void BM_StdSetDuplicate(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    auto identifiers = makeIdentifiers(count);
+    std::set<std::string> set(identifiers.begin(), identifiers.end());
+    size_t next = 0;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(set.insert(identifiers[next]));
+        next = next + 1 == count ? 0 : next + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_DeviceIdSetDuplicate(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    auto identifiers = makeIdentifiers(count);
+    PassBy::DeviceIdSet set;
+    for (const auto& id : identifiers) {
+        set.insert(PassBy::DeviceId::fromString(id));
+    }
+    size_t next = 0;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(set.insert(PassBy::DeviceId::fromString(identifiers[next])));
+        next = next + 1 == count ? 0 : next + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+BENCHMARK(BM_StdSetInsert)->RangeMultiplier(10)->Range(1000, 100000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DeviceIdSetInsert)->RangeMultiplier(10)->Range(1000, 100000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_StdSetDuplicate)->RangeMultiplier(10)->Range(1000, 100000);
+BENCHMARK(BM_DeviceIdSetDuplicate)->RangeMultiplier(10)->Range(1000, 100000);
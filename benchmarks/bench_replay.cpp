@@ -0,0 +1,73 @@
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include "PassBy/PassBy.h"
+#include "../src/internal/EventTrace.h"
+#include "../src/internal/PlatformInterface.h"
+#include "../src/internal/TraceReplayer.h"
+
+// Replay of a recorded event trace as fast as possible into a fresh context.
+// Set PASSBY_REPLAY_TRACE to a trace captured with startEventTrace() to benchmark
+// field load; otherwise a synthetic crowd of 2000 peers x 25 sightings is recorded.
+
+namespace {
+
+std::string tracePath() {
+    if (const char* path = std::getenv("PASSBY_REPLAY_TRACE")) {
+        return path;
+    }
+    static const std::string synthetic = [] {
+        const std::string path = "passby_bench_replay.trace";
+        PassBy::PassByContext recorder(nullptr);
+        recorder.startEventTrace(path);
+        std::mt19937 rng(7);
+        for (int i = 0; i < 2000 * 25; ++i) {
+            uint8_t bytes[PassBy::DeviceId::kSize] = {0xBE};
+            uint32_t peer = rng() % 2000;
+            bytes[14] = static_cast<uint8_t>(peer >> 8);
+            bytes[15] = static_cast<uint8_t>(peer);
+            recorder.onDeviceDiscovered(PassBy::DeviceId::fromBytes(bytes));
+            if (i % 1024 == 1023) {
+                recorder.flushEvents();
+            }
+        }
+        recorder.stopEventTrace();
+        return path;
+    }();
+    return synthetic;
+}
+
+void BM_ReplayTrace(benchmark::State& state) {
+    PassBy::EventTraceReader reader;
+    if (!reader.open(tracePath())) {
+        state.SkipWithError("cannot read trace");
+        return;
+    }
+    PassBy::ReplayOptions options;
+    options.speed = 0;
+
+    uint64_t events = 0;
+    uint64_t dropped = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        reader.rewind();
+        auto context = std::make_unique<PassBy::PassByContext>(nullptr);
+        state.ResumeTiming();
+
+        events += PassBy::TraceReplayer::replay(reader, *context, options).events;
+        context->flushEvents();
+
+        state.PauseTiming();
+        dropped += context->getDroppedEventCount();
+        context.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(events));
+    state.counters["dropped"] = static_cast<double>(dropped);
+}
+
+} // namespace
+
+BENCHMARK(BM_ReplayTrace)->Unit(benchmark::kMillisecond)->UseRealTime();
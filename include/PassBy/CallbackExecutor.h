@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <PassBy/DeviceId.h>
+
+namespace PassBy {
+
+// What an executor does with a callback when its queue is full
+enum class BackpressurePolicy : uint8_t {
+    Block,              // The dispatch thread waits for room; platform events keep being
+                        // queued (and dropped once that queue is full) meanwhile
+    DropOldest,         // Discard the longest-waiting callback
+    DropNewest,         // Discard the new callback
+    CoalesceByDevice    // Replace the queued callback for the same device; otherwise DropOldest
+};
+
+struct ExecutorOptions {
+    size_t threads = 1;                 // 1: one dedicated thread, callbacks in order
+    size_t queueCapacity = 1024;        // Callbacks waiting to run
+    BackpressurePolicy backpressure = BackpressurePolicy::Block;
+};
+
+// Runs the manager's callbacks (see PassByManager::setCallbackExecutor). Implement it to
+// run them elsewhere, e.g. on an application queue.
+class CallbackExecutor {
+public:
+    virtual ~CallbackExecutor() = default;
+
+    // Run task now or later. key is the device a discovery callback reports
+    // (null for batch and advertising callbacks), for coalescing.
+    virtual void execute(const DeviceId& key, std::function<void()> task) = 0;
+
+    // Block until every task passed to execute() so far has run or been dropped
+    virtual void drain() {}
+
+    // The calling thread is one of the executor's, i.e. this is a callback
+    virtual bool isExecutorThread() const { return false; }
+
+    // Tasks discarded by backpressure
+    virtual uint64_t droppedCount() const { return 0; }
+
+    // Runs each task on the calling thread (the manager's dispatch thread)
+    static std::shared_ptr<CallbackExecutor> inlineExecutor();
+
+    // Worker threads fed from one bounded queue. With more than one thread, callbacks
+    // run concurrently and those for different devices may run out of order.
+    static std::shared_ptr<CallbackExecutor> threadPool(const ExecutorOptions& options = ExecutorOptions());
+};
+
+} // namespace PassBy
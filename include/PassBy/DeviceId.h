@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace PassBy {
+
+// Fixed 16-byte device identifier.
+// Canonical identifiers are UUIDs in NSUUID UUIDString form (uppercase 8-4-4-4-12);
+// anything else maps to a 128-bit hash of its text, and the caller keeps the text.
+class DeviceId {
+public:
+    static constexpr size_t kSize = 16;
+    static constexpr size_t kStringLength = 36;
+
+    DeviceId() : m_bytes{} {}
+
+    static DeviceId fromBytes(const uint8_t* bytes) {
+        DeviceId id;
+        std::memcpy(id.m_bytes, bytes, kSize);
+        return id;
+    }
+
+    // Parse a UUID string in either case. Returns false if the text is not a UUID.
+    static bool parse(std::string_view text, DeviceId& out);
+
+    // Canonical id if the text is an uppercase UUID, hashed id otherwise.
+    // `isCanonical` reports which one was produced (toString() round-trips only canonical ids).
+    static DeviceId fromString(std::string_view text, bool* isCanonical = nullptr);
+
+    // Uppercase 8-4-4-4-12 form
+    std::string toString() const;
+
+    // Write the kStringLength characters of toString() to `out` (no terminator)
+    void format(char* out) const;
+
+    const uint8_t* bytes() const { return m_bytes; }
+
+    bool isNull() const {
+        return word(0) == 0 && word(1) == 0;
+    }
+
+    // Well-mixed 64-bit hash of the identifier
+    uint64_t hash() const {
+        uint64_t h = word(0) * 0x9E3779B97F4A7C15ULL ^ word(1);
+        h ^= h >> 32;
+        h *= 0xD6E8FEB86659FD93ULL;
+        h ^= h >> 32;
+        return h;
+    }
+
+    bool operator==(const DeviceId& other) const {
+        return word(0) == other.word(0) && word(1) == other.word(1);
+    }
+
+    bool operator!=(const DeviceId& other) const {
+        return !(*this == other);
+    }
+
+    // Byte-wise ordering
+    bool operator<(const DeviceId& other) const {
+        return std::memcmp(m_bytes, other.m_bytes, kSize) < 0;
+    }
+
+private:
+    uint64_t word(size_t index) const {
+        uint64_t value;
+        std::memcpy(&value, m_bytes + index * 8, sizeof(value));
+        return value;
+    }
+
+    alignas(8) uint8_t m_bytes[kSize];
+};
+
+// Hasher for standard containers
+struct DeviceIdHash {
+    size_t operator()(const DeviceId& id) const {
+        return static_cast<size_t>(id.hash());
+    }
+};
+
+} // namespace PassBy
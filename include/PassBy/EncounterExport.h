@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include <PassBy/PassByTypes.h>
+
+namespace PassBy {
+
+// Receives export output in chunks; return false to abort the export
+using ExportSink = std::function<bool(const uint8_t* data, size_t size)>;
+
+// Compact binary encounter export (see PassByManager::exportEncounters()).
+//
+// A 32-byte header (magic "PBYENCEX", uint32 version, uint32 reserved, uint64 record
+// count, int64 base time in Unix ms; little-endian) followed by one record per encounter
+// in ascending id order: the 16 id bytes, varint firstSeen - base, zigzag varint
+// lastSeen - firstSeen, varint (hitCount << 1 | hasAlias), then for identifiers that are
+// not a canonical UUID a varint length and the text. Typically 20-25 bytes per encounter.
+class EncounterExportWriter {
+public:
+    static constexpr size_t kDefaultChunkSize = 16 * 1024;
+
+    // Output goes to sink in chunks of about chunkSize bytes
+    explicit EncounterExportWriter(ExportSink sink, size_t chunkSize = kDefaultChunkSize);
+
+    // Start an export of `count` encounters, none first seen before baseMs
+    bool begin(uint64_t count, int64_t baseMs);
+
+    // Encounters must be added in ascending id order
+    bool add(const EncounterView& encounter);
+
+    // Write out the last chunk; false if the sink failed or fewer than `count` were added
+    bool finish();
+
+    uint64_t bytesWritten() const { return m_bytesWritten; }
+
+private:
+    bool flush();
+
+    ExportSink m_sink;
+    std::vector<uint8_t> m_buffer;
+    size_t m_chunkSize;
+    uint64_t m_expected;
+    uint64_t m_added;
+    uint64_t m_bytesWritten;
+    int64_t m_baseMs;
+    DeviceId m_lastId;
+    bool m_failed;
+};
+
+// Incremental decoder for EncounterExportWriter output: feed() it chunks as they arrive,
+// split anywhere. Only an incomplete trailing record is buffered between calls.
+class EncounterExportDecoder {
+public:
+    static constexpr size_t kMaxAliasLength = 255;
+
+    EncounterExportDecoder();
+
+    // Decode data, calling onEncounter for each complete record (the view is valid during
+    // the call). Returns false once the input is malformed.
+    bool feed(const uint8_t* data, size_t size, const std::function<void(const EncounterView&)>& onEncounter);
+
+    // Every record announced by the header was decoded and nothing is left over
+    bool finished() const;
+
+    uint64_t expectedCount() const { return m_expected; }
+    uint64_t decodedCount() const { return m_decoded; }
+    bool failed() const { return m_failed; }
+
+private:
+    // Decode one header or record from data; returns bytes consumed (0: need more input)
+    size_t decodeHeader(const uint8_t* data, size_t size);
+    size_t decodeRecord(const uint8_t* data, size_t size, const std::function<void(const EncounterView&)>& onEncounter);
+
+    std::vector<uint8_t> m_buffer;
+    std::string m_uuid;
+    uint64_t m_expected;
+    uint64_t m_decoded;
+    int64_t m_baseMs;
+    bool m_haveHeader;
+    bool m_failed;
+};
+
+} // namespace PassBy
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <PassBy/PassByTypes.h>
+
+namespace PassBy {
+
+template <typename Value> class DeviceIdTable;
+
+// Half-open time range [fromMs, toMs) in Unix ms; the default covers all time
+struct TimeWindow {
+    int64_t fromMs = std::numeric_limits<int64_t>::min();
+    int64_t toMs = std::numeric_limits<int64_t>::max();
+};
+
+// One contact of a node within a window
+struct GraphContact {
+    DeviceId id;
+    uint32_t encounters = 0;    // Merged encounter intervals overlapping the window
+    int64_t overlapMs = 0;      // Time together within the window
+    uint64_t hits = 0;          // Sightings in those intervals
+};
+
+struct GraphNeighbour {
+    DeviceId id;
+    uint32_t hops = 0;
+};
+
+// Who-met-whom graph over encounters reported by many devices, in compressed sparse row
+// form: per node a sorted run of (neighbour, edge) entries, per edge a sorted run of
+// encounter intervals (overlapping reports from either side merged). Built by
+// EncounterGraphBuilder; immutable, so queries are safe from any number of threads.
+// About 16 bytes per merged interval, 24 per edge and 50 per node.
+class EncounterGraph {
+public:
+    EncounterGraph();
+    ~EncounterGraph();
+    EncounterGraph(EncounterGraph&&) noexcept;
+    EncounterGraph& operator=(EncounterGraph&&) noexcept;
+
+    size_t nodeCount() const { return m_nodes.size(); }
+    size_t edgeCount() const { return m_intervalOffsets.empty() ? 0 : m_intervalOffsets.size() - 1; }
+    size_t intervalCount() const { return m_intervals.size(); }
+
+    bool contains(const DeviceId& node) const;
+
+    // Contacts of node with an encounter overlapping window, by id
+    std::vector<GraphContact> contacts(const DeviceId& node, const TimeWindow& window = TimeWindow()) const;
+
+    // Number of those contacts, without building the list
+    size_t contactCount(const DeviceId& node, const TimeWindow& window = TimeWindow()) const;
+
+    // Nodes within `hops` edges of node over edges active in window, nearest first
+    // (node itself excluded)
+    std::vector<GraphNeighbour> neighbourhood(const DeviceId& node, size_t hops,
+                                              const TimeWindow& window = TimeWindow()) const;
+
+    size_t memoryUsage() const;
+
+private:
+    friend class EncounterGraphBuilder;
+
+    struct Adjacent {
+        uint32_t node;
+        uint32_t edge;
+    };
+
+    struct Interval {
+        int64_t startMs;
+        uint32_t durationMs;
+        uint32_t hits;
+    };
+
+    bool findNode(const DeviceId& node, uint32_t* index) const;
+
+    // First interval of edge that ends at or after fromMs; the edge is active in window
+    // if it exists and starts before toMs
+    const Interval* firstInWindow(uint32_t edge, const TimeWindow& window) const;
+    bool isActive(uint32_t edge, const TimeWindow& window) const;
+
+    std::vector<DeviceId> m_nodes;
+    std::unique_ptr<DeviceIdTable<uint32_t>> m_nodeIndex;
+    std::vector<uint64_t> m_adjacencyOffsets;       // nodeCount + 1
+    std::vector<Adjacent> m_adjacency;              // Two entries per edge, by neighbour
+    std::vector<uint64_t> m_intervalOffsets;        // edgeCount + 1
+    std::vector<Interval> m_intervals;
+};
+
+// Collects encounter reports and builds an EncounterGraph using every core: parallel
+// sorts, and prefix sums to lay out the arrays. About 24 bytes per report until build().
+class EncounterGraphBuilder {
+public:
+    explicit EncounterGraphBuilder(size_t threads = 0);    // 0: one per core
+    ~EncounterGraphBuilder();
+
+    EncounterGraphBuilder(const EncounterGraphBuilder&) = delete;
+    EncounterGraphBuilder& operator=(const EncounterGraphBuilder&) = delete;
+
+    // observer saw peer from firstSeenMs to lastSeenMs; reports of a device by itself are ignored
+    void add(const DeviceId& observer, const DeviceId& peer, int64_t firstSeenMs, int64_t lastSeenMs,
+             uint32_t hitCount = 1);
+
+    // An encounter from the observer's registry, export or log
+    void add(const DeviceId& observer, const EncounterView& encounter);
+
+    void reserve(size_t reports);
+    size_t reportCount() const { return m_reports.size(); }
+
+    // Build the graph from everything added and reset the builder
+    EncounterGraph build();
+
+private:
+    struct Report {
+        uint32_t low;       // Node indices, low < high
+        uint32_t high;
+        int64_t startMs;
+        uint32_t durationMs;
+        uint32_t hits;
+    };
+
+    uint32_t nodeFor(const DeviceId& id);
+
+    size_t m_threads;
+    std::vector<DeviceId> m_nodes;
+    std::unique_ptr<DeviceIdTable<uint32_t>> m_nodeIndex;
+    std::vector<Report> m_reports;
+};
+
+} // namespace PassBy
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <PassBy/DeviceId.h>
+
+namespace PassBy {
+
+template <typename Value> class DeviceIdTable;
+
+// Secret a device derives its rotating identifiers from; shared with its contacts
+using ContactSecret = std::array<uint8_t, 32>;
+
+// The identifier a device advertises during one interval instead of a fixed one:
+// HMAC-SHA256(secret, "PassBy ephemeral id" || interval as big-endian int64), first
+// 16 bytes, marked as a random (version 4) UUID. Without the secret, identifiers of
+// different intervals cannot be linked.
+class EphemeralId {
+public:
+    static DeviceId derive(const ContactSecret& secret, int64_t interval);
+
+    // Interval containing unixMs
+    static int64_t intervalAt(int64_t unixMs, std::chrono::milliseconds intervalLength);
+};
+
+struct EphemeralTableOptions {
+    std::chrono::milliseconds interval = std::chrono::minutes(15);
+    size_t pastIntervals = 4;       // Still accepted after rotating (clock skew, late reports)
+    size_t futureIntervals = 1;     // Accepted ahead of our clock
+    size_t threads = 0;             // Derivation threads; 0: one per core
+};
+
+// Contact an ephemeral identifier resolved to
+struct EphemeralMatch {
+    DeviceId contact;
+    int64_t interval = 0;
+};
+
+// Every identifier of every known contact over a window of intervals around now, in a
+// hash table, so a discovered ephemeral identifier resolves to its contact in O(1).
+// Derivation is spread over threads. advanceTo() rolls the window forward incrementally:
+// it derives only the intervals entering the window and drops those leaving it.
+// Not thread-safe: resolve() may run concurrently only with other const calls.
+class EphemeralIdTable {
+public:
+    explicit EphemeralIdTable(const EphemeralTableOptions& options = EphemeralTableOptions());
+    ~EphemeralIdTable();
+
+    EphemeralIdTable(const EphemeralIdTable&) = delete;
+    EphemeralIdTable& operator=(const EphemeralIdTable&) = delete;
+
+    // Add or replace contacts; their identifiers for the current window are derived at once
+    void addContacts(const std::vector<std::pair<DeviceId, ContactSecret>>& contacts);
+    void addContact(const DeviceId& contact, const ContactSecret& secret);
+
+    // Returns false if contact is unknown
+    bool removeContact(const DeviceId& contact);
+
+    // Move the window to the intervals around unixMs. The first call, or a jump past the
+    // whole window (or backwards), derives every interval; otherwise only the new ones.
+    void advanceTo(int64_t unixMs);
+
+    // Contact advertising ephemeral in the current window
+    bool resolve(const DeviceId& ephemeral, EphemeralMatch* match) const;
+
+    size_t contactCount() const;
+    size_t size() const;            // Identifiers in the table
+    int64_t firstInterval() const { return m_firstInterval; }
+    int64_t lastInterval() const { return m_firstInterval + static_cast<int64_t>(m_windowIds.size()) - 1; }
+    size_t memoryUsage() const;
+
+private:
+    struct Contact {
+        DeviceId id;
+        ContactSecret secret;
+        bool active = false;
+    };
+
+    struct Entry {
+        uint32_t contact = 0;
+        int64_t interval = 0;
+    };
+
+    // Derive and index `count` intervals from `first` for the contacts in slots
+    void derive(int64_t first, size_t count, const std::vector<uint32_t>& slots);
+    std::vector<uint32_t> activeSlots() const;
+    void dropFront();
+
+    EphemeralTableOptions m_options;
+    std::vector<Contact> m_contacts;            // Slots; inactive ones are reused
+    std::vector<uint32_t> m_freeSlots;
+    std::unique_ptr<DeviceIdTable<uint32_t>> m_contactSlots;
+    std::unique_ptr<DeviceIdTable<Entry>> m_identifiers;
+    std::deque<std::vector<DeviceId>> m_windowIds;   // Identifiers added per interval, oldest first
+    int64_t m_firstInterval;
+    bool m_hasWindow;
+};
+
+} // namespace PassBy
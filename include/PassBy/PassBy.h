@@ -2,22 +2,58 @@
 
 #include <string>
 #include <vector>
-#include <set>
 #include <memory>
 #include <mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <PassBy/PassByTypes.h>
+#include <PassBy/CallbackExecutor.h>
+#include <PassBy/EncounterExport.h>
 
 namespace PassBy {
 
 // Forward declarations
 class PlatformInterface;
+struct DiscoveryEvent;
+enum class DiscoveryEventType : uint8_t;
+template <typename T> class MPSCRingBuffer;
+class EncounterStore;
+class EncounterLog;
+class ConnectionScheduler;
+class ResolvedPeripheralCache;
+class DutyCycleController;
+class DiscoveryBatcher;
+class PipelineMetrics;
+class EventTraceWriter;
+class RecentlySeenFilter;
+class EncounterAggregator;
+struct TraceEvent;
+struct BatchSubscription;
+struct SessionState;
+struct RegistrySnapshot;
+struct Subscription;
+struct SubscriptionSet;
 
+// Safe to use from any thread. Queries read immutable snapshots published with atomic
+// pointer swaps, so they never block the dispatch thread that records discoveries.
+//
+// Each instance is an independent context: it owns its platform, registry and dispatch
+// thread, and its platform reports to it directly. getInstance() is the process-wide
+// default context, the one PassByBridge routes to.
 class PassByManager {
 public:
-    // Singleton access
+    // Default context, created on first use (lock-free once created)
     static PassByManager& getInstance();
     
-    // No public constructors
+    // New context with a platform from PlatformFactory
+    PassByManager();
+    
+    // New context on the given platform (e.g. a SimulatedPlatform)
+    explicit PassByManager(std::unique_ptr<PlatformInterface> platform);
+    
     ~PassByManager();
     
     // Start BLE scanning with optional service UUID filter
@@ -26,31 +62,156 @@ public:
     // Stop BLE scanning  
     bool stopScanning();
     
-    // Check if currently scanning
+    // Check if currently scanning (the startScanning() session, not subscriptions)
     bool isScanning() const;
     
+    // Receive discoveries matching filter, independently of startScanning() and of other
+    // subscriptions. While any subscription or the session exists the platform runs one
+    // scan over the union of their services, and discoveries are recorded and passed to
+    // the callbacks above only if one of them asked for it. The callback runs on the
+    // dispatch thread. Returns 0 if a service UUID does not parse or the scan cannot start.
+    SubscriptionId subscribe(const SubscriptionFilter& filter, DeviceDiscoveredCallback callback);
+    
+    // Returns false if id is not an active subscription
+    bool unsubscribe(SubscriptionId id);
+    
     // Set callback for device discovery
     void setDeviceDiscoveredCallback(DeviceDiscoveredCallback callback);
     
-    // Set callback for advertising started
+    // Set a callback that receives each discovery as a borrowed view.
+    // Unlike the DeviceDiscoveredCallback it does not allocate per event.
+    void setDeviceViewCallback(DeviceViewCallback callback);
+    
+    // Set callback receiving deduplicated batches of discovered devices.
+    // A batch is delivered when options.flushInterval has passed since its first sighting,
+    // after options.maxEvents sightings, or from stopScanning(). Independent of the
+    // per-device callback; pass nullptr to disable.
+    void setDeviceBatchCallback(DeviceBatchCallback callback, const BatchOptions& options = BatchOptions());
+    
+    // Set callback for advertising started. Called once per scan start: a duty cycle's
+    // restarts only report failures, and the first success after one.
     void setAdvertisingStartedCallback(AdvertisingStartedCallback callback);
     
-    // Get discovered devices
+    // Run the callbacks above through executor instead of on the dispatch thread, so a slow
+    // consumer stalls its executor queue rather than event dispatch. Each discovery is one
+    // task, keyed by device; batches are copied for the task. nullptr (the default) runs
+    // them inline on the dispatch thread without allocating.
+    void setCallbackExecutor(std::shared_ptr<CallbackExecutor> executor);
+    
+    // Set limits for the peripheral connections the core schedules on the platform
+    void setConnectionPolicy(const ConnectionPolicy& policy);
+    
+    // Cycle the radio on and off while scanning; applies from the next window
+    void setDutyCycle(const DutyCycleOptions& options);
+    
+    // Pass each device to the discovery callbacks (device, view, batch and subscriptions)
+    // only if it was not seen within the filter's horizon; repeats still update the
+    // encounter store. Replacing the options, or clearDiscoveredDevices(), empties the filter.
+    void setDuplicateFilter(const DuplicateFilterOptions& options);
+    
+    // Get discovered devices. Like getEncounters() and visitEncounters() this reads the
+    // registry snapshot, which trails discovery by at most 100 ms and is brought up to date
+    // by flushEvents(); reading never waits for the dispatch thread.
     std::vector<std::string> getDiscoveredDevices() const;
     
-    // Clear discovered devices
+    // Clear discovered devices, after the discoveries already queued
     void clearDiscoveredDevices();
     
+    // Get first/last seen times and hit counts of tracked devices
+    std::vector<EncounterInfo> getEncounters() const;
+    
+    // Encounters new or changed after `generation` (start with 0) and devices removed since.
+    // Cost grows with the number of changes, not with the number of tracked devices. Reads
+    // the store itself under the device lock, so it may wait for the dispatch thread.
+    EncounterDelta getDiscoveredSince(uint64_t generation) const;
+    
+    // Visit every tracked encounter in the registry snapshot without copying; the views
+    // are valid during the call only
+    void visitEncounters(const EncounterVisitor& visitor) const;
+    
+    // Set TTL and memory limits for tracked devices (applies immediately)
+    void setEncounterPolicy(const EncounterPolicy& policy);
+    
+    // Approximate heap bytes used by the encounter store (takes the device lock briefly)
+    size_t getEncounterMemoryUsage() const;
+    
+    // Keep visit counts, dwell time and smoothed RSSI per device, updated on each recorded
+    // sighting (repeats hidden by the duplicate filter included). Applies immediately;
+    // replacing the options, or clearDiscoveredDevices(), starts the statistics over.
+    void setAggregation(const AggregationOptions& options);
+    
+    // Up to k devices best first by ranking, from the sightings dispatched so far. Costs
+    // O(k) whatever the number of devices, under the device lock; empty while aggregation
+    // is disabled.
+    std::vector<EncounterStats> getTopEncounters(EncounterRanking ranking, size_t k) const;
+    
+    // Persist encounters to an append-only log at path, first loading the encounters it holds.
+    // Returns false if the file cannot be opened or is not an encounter log.
+    bool openEncounterLog(const std::string& path);
+    
+    // Write out pending changes and close the encounter log
+    void closeEncounterLog();
+    
+    // Stream the tracked encounters to sink in the EncounterExportWriter format, in chunks of
+    // about chunkSize bytes. Reads the store in id-ordered batches (1/16 of the encounters, at
+    // least 1024), holding the device lock only while collecting one, and never calls sink
+    // with it held. Writes the encounters live when the export began, even if they are
+    // removed meanwhile. Returns false if the sink aborted.
+    bool exportEncounters(const ExportSink& sink,
+                          size_t chunkSize = EncounterExportWriter::kDefaultChunkSize) const;
+    
     // Get current service UUID (empty if not scanning or no filter)
-    const std::string& getCurrentServiceUUID() const;
+    std::string getCurrentServiceUUID() const;
     
     // Get library version
     static std::string getVersion();
 
-    // Called by platform-specific code when device is discovered
-    void onDeviceDiscovered(const std::string& uuid);
+    // Block until every event queued before this call has been dispatched and its callbacks
+    // have run on the callback executor (no-op when called from a callback)
+    void flushEvents();
     
-    // Called by platform-specific code when advertising is started
+    // Number of events dropped because the event queue was full or the identifier too long
+    uint64_t getDroppedEventCount() const;
+    
+    // Number of callback tasks the callback executor discarded under backpressure
+    uint64_t getDroppedCallbackCount() const;
+    
+    // Pipeline counters and per-stage latencies. Reads atomics only, so it is cheap enough
+    // to poll; without PASSBY_ENABLE_METRICS only the queue figures are filled in.
+    MetricsSnapshot getMetricsSnapshot() const;
+    
+    // Called by platform-specific code with the duration of a stage only it can observe
+    // (Connect, ServiceDiscovery, CharacteristicRead). Lock-free; safe from any thread.
+    void recordStageLatency(PipelineStage stage, std::chrono::microseconds latency);
+
+    // Record every platform call this context receives, including those routed through
+    // PassByBridge, into a compact binary trace at path with the time of each call, for
+    // replay with TraceReplayer. Replaces a running recording; returns false if the file
+    // cannot be created.
+    bool startEventTrace(const std::string& path);
+    
+    // Stop recording and close the trace; returns the number of events recorded
+    uint64_t stopEventTrace();
+
+    // Called by platform-specific code when device is discovered.
+    // Queues the event for the dispatch thread; safe to call from any thread.
+    void onDeviceDiscovered(std::string_view uuid);
+    void onDeviceDiscovered(const DeviceId& id);
+    
+    // Same with the service the device advertised (if known) and its RSSI, for subscription filters
+    void onDeviceDiscovered(std::string_view uuid, const DeviceId& service, int rssi);
+    void onDeviceDiscovered(const DeviceId& id, int rssi);
+    void onDeviceDiscovered(const DeviceId& id, const DeviceId& service, int rssi);
+    
+    // Called by platform-specific code for peripherals whose connections the core schedules.
+    // Queue the event for the dispatch thread; safe to call from any thread.
+    void onPeripheralDiscovered(const DeviceId& peripheral, int rssi);
+    void onPeripheralAdvertisement(const DeviceId& peripheral, int rssi, const uint8_t* data, size_t length);
+    void onPeripheralIdentifierRead(const DeviceId& peripheral, std::string_view uuid);
+    void onPeripheralConnectionFailed(const DeviceId& peripheral);
+    
+    // Called by platform-specific code when advertising is started.
+    // Queues the event for the dispatch thread; safe to call from any thread.
     void onAdvertisingStarted(const std::string& peripheralUUID, bool success, const std::string& errorMessage = "");
 
 #ifdef PASSBY_TESTING_ENABLED
@@ -58,26 +219,140 @@ protected:  // テストビルド時のみprotected
 #else
 private:    // 通常ビルドではprivate
 #endif
-    // Private constructor for singleton
-    PassByManager();
-    
     // Copy and move operations deleted
     PassByManager(const PassByManager&) = delete;
     PassByManager& operator=(const PassByManager&) = delete;
     PassByManager(PassByManager&&) = delete;
     PassByManager& operator=(PassByManager&&) = delete;
     
-    // Singleton instance
+    // Dispatch thread
+    void dispatchLoop();
+    void dispatchEvent(DiscoveryEvent& event);
+    void applyControlEvents();
+    void handleDiscovery(DiscoveryEvent& event);
+    void queueDiscovery(DiscoveryEventType type, const DeviceId& peripheral, std::string_view uuid,
+                        const DeviceId* service, int rssi);
+    void queueIdentifier(const DeviceId& id, const DeviceId* service, int rssi);
+    void queuePeripheral(const DeviceId& peripheral, const DeviceId* service, int rssi);
+    bool updateScan(bool sessionScanning, const std::string& sessionService);
+    std::string scanFilter(bool sessionScanning, const std::string& sessionService) const;
+    void publishSubscriptions(bool sessionScanning, const std::string& sessionService);
+    void pushControlEvent(DiscoveryEventType type);
+    void pushDutyCycleStart(const std::string& serviceUUID);
+    void runConnectionScheduler(int64_t nowMs);
+    void applyConnectionPolicy(const ConnectionPolicy& policy);
+    void runDutyCycle(int64_t nowMs);
+    void cancelConnections();
+    void wakeDispatchThread() const;
+    void requestBatchFlush();
+    void deliverBatch();
+    std::shared_ptr<CallbackExecutor> callbackExecutor() const;
+    void drainCallbackExecutor();
+    void persistEncounters();
+    static int64_t steadyTimeMs();
+    void stopDispatchThread();
+    static int64_t currentTimeMs();
+    bool onDispatchThread() const;
+    void publishSession(bool scanning, const std::string& serviceUUID);
+    std::shared_ptr<const SessionState> session() const;
+    std::shared_ptr<const RegistrySnapshot> registrySnapshot() const;
+    bool registrySnapshotStale() const;
+    void publishRegistrySnapshot() const;
+    void registryChanged();
+    void clearDevices();
+    void traceEvent(const TraceEvent& event);
+    
+    // Default context; s_instance owns it, s_current is the lock-free read path
     static std::unique_ptr<PassByManager> s_instance;
+    static std::atomic<PassByManager*> s_current;
     static std::mutex s_mutex;
     
+    // Scanning session, published for readers; changes are serialized by m_sessionMutex
+    std::shared_ptr<const SessionState> m_session;
+    std::mutex m_sessionMutex;
+    
+    // Subscriptions and the platform scan over their union (guarded by m_sessionMutex)
+    std::vector<std::shared_ptr<const Subscription>> m_subscriptions;
+    SubscriptionId m_nextSubscriptionId;
+    bool m_platformScanning;
+    std::string m_platformFilter;
+    
     // Instance data
-    bool m_isScanning;
-    std::set<std::string> m_discoveredDevices;
-    DeviceDiscoveredCallback m_deviceCallback;
-    AdvertisingStartedCallback m_advertisingCallback;
+    std::unique_ptr<EncounterStore> m_encounters;
+    std::unique_ptr<EncounterLog> m_encounterLog;   // Guarded by m_devicesMutex
+    std::unique_ptr<EncounterAggregator> m_aggregator;   // Guarded by m_devicesMutex; nullptr: disabled
+    mutable std::mutex m_devicesMutex;
+    std::shared_ptr<DeviceDiscoveredCallback> m_deviceCallback;
+    std::shared_ptr<DeviceViewCallback> m_deviceViewCallback;
+    std::shared_ptr<AdvertisingStartedCallback> m_advertisingCallback;
+    std::shared_ptr<const BatchSubscription> m_batchSubscription;
+    std::shared_ptr<const ConnectionPolicy> m_connectionPolicy;
+    std::shared_ptr<const DutyCycleOptions> m_dutyCycleOptions;
+    std::shared_ptr<const DuplicateFilterOptions> m_duplicateFilterOptions;
+    std::shared_ptr<const std::string> m_scanFilter;           // For the duty cycle's restarts
+    std::shared_ptr<const SubscriptionSet> m_subscriptionSet;  // nullptr: no subscriptions
+    std::shared_ptr<CallbackExecutor> m_callbackExecutor;      // nullptr: inline
+    mutable std::mutex m_callbackMutex;
     std::unique_ptr<PlatformInterface> m_platform;
-    std::string m_currentServiceUUID;
+    
+    // Registry snapshot for readers, republished by the dispatch thread at most every
+    // kSnapshotIntervalMs (m_snapshotPublishedMs, steady clock) and by flushEvents().
+    // m_registryVersion counts changes to the encounter store (written under m_devicesMutex).
+    mutable std::shared_ptr<const RegistrySnapshot> m_registrySnapshot;
+    mutable std::shared_ptr<RegistrySnapshot> m_spareSnapshot;   // Guarded by m_devicesMutex
+    std::atomic<uint64_t> m_registryVersion;
+    int64_t m_snapshotPublishedMs;
+    
+    // Event queue between platform producers and the dispatch thread
+    std::unique_ptr<MPSCRingBuffer<DiscoveryEvent>> m_eventQueue;
+    std::atomic<uint64_t> m_droppedEvents;
+    
+    // Control events (session and settings changes) bypass the bounded queue, so pushing
+    // one never waits for the dispatch thread; each applies once the events queued
+    // before it have been consumed
+    struct ControlEvent {
+        DiscoveryEventType type;
+        uint64_t queuePosition;
+    };
+    std::mutex m_controlMutex;
+    std::deque<ControlEvent> m_controlEvents;   // Guarded by m_controlMutex
+    std::atomic<uint64_t> m_controlQueued;
+    std::atomic<uint64_t> m_controlApplied;
+    std::unique_ptr<PipelineMetrics> m_metrics;
+    
+    // Event trace being recorded; m_tracing spares producers the shared_ptr load otherwise
+    std::shared_ptr<EventTraceWriter> m_trace;
+    std::atomic<bool> m_tracing;
+    std::mutex m_traceMutex;
+    std::thread m_dispatchThread;
+    mutable std::mutex m_wakeMutex;
+    mutable std::condition_variable m_wakeCondition;
+    std::atomic<bool> m_dispatchSleeping;
+    bool m_dispatchRunning;
+    std::atomic<uint64_t> m_processedEvents;
+    mutable std::condition_variable m_flushCondition;
+    mutable std::atomic<int> m_flushWaiters;
+    
+    // Dispatch thread only
+    std::unique_ptr<DiscoveryBatcher> m_batcher;
+    std::shared_ptr<const BatchSubscription> m_activeBatch;
+    std::unique_ptr<ConnectionScheduler> m_scheduler;
+    std::unique_ptr<ResolvedPeripheralCache> m_resolvedCache;
+    std::shared_ptr<const ConnectionPolicy> m_activeConnectionPolicy;
+    std::vector<size_t> m_matchedSubscriptions;     // Scratch for handleDiscovery()
+    std::unique_ptr<RecentlySeenFilter> m_duplicateFilter;     // nullptr: disabled
+    std::shared_ptr<const DuplicateFilterOptions> m_activeDuplicateFilterOptions;
+    
+    // Duty cycling (dispatch thread; m_radioParked is read by stopScanning after a flush)
+    std::unique_ptr<DutyCycleController> m_dutyCycle;
+    std::shared_ptr<const DutyCycleOptions> m_activeDutyCycleOptions;
+    std::string m_dutyCycleServiceUUID;
+    bool m_scanSessionActive;
+    bool m_radioParked;
+    bool m_advertisingReported;     // Since the platform was last started by a scan
 };
 
+// A PassByManager created directly is an independent session
+using PassByContext = PassByManager;
+
 } // namespace PassBy
\ No newline at end of file
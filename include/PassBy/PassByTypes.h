@@ -1,16 +1,236 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <functional>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <PassBy/DeviceId.h>
 
 namespace PassBy {
 
 // Simple device information from BLE scan
 struct DeviceInfo {
     std::string uuid;
+    DeviceId id;    // Binary form of uuid (hashed if uuid is not a canonical UUID)
     
-    DeviceInfo(const std::string& deviceUuid) : uuid(deviceUuid) {}
+    DeviceInfo(const std::string& deviceUuid) : uuid(deviceUuid), id(DeviceId::fromString(deviceUuid)) {}
+    DeviceInfo(const std::string& deviceUuid, const DeviceId& deviceId) : uuid(deviceUuid), id(deviceId) {}
+};
+
+// Borrowed device information; uuid is only valid during the callback
+struct DeviceView {
+    static constexpr int kUnknownRssi = 127;
+
+    std::string_view uuid;
+    DeviceId id;
+    std::chrono::system_clock::time_point seenAt{};    // When the platform reported it
+    int rssi = kUnknownRssi;                            // dBm
+    bool hasService = false;
+    DeviceId service;                                   // Advertised service, if hasService
+};
+
+// Per-device encounter record
+struct EncounterInfo {
+    std::string uuid;
+    DeviceId id;
+    std::chrono::system_clock::time_point firstSeen;
+    std::chrono::system_clock::time_point lastSeen;
+    uint32_t hitCount;  // Sightings since firstSeen
+    
+    EncounterInfo() : hitCount(0) {}
+};
+
+// Changes since a generation, see PassByManager::getDiscoveredSince()
+struct EncounterDelta {
+    uint64_t generation = 0;                // Pass to the next getDiscoveredSince() call
+    bool reset = false;                     // History was unavailable: `changed` holds every encounter
+                                            // and anything held from earlier calls is stale
+    std::vector<EncounterInfo> changed;     // New or updated encounters, most recent first
+    std::vector<DeviceId> removed;          // No longer tracked (expired, evicted); may repeat
+};
+
+// Borrowed view of one encounter; only valid during the visitor call
+struct EncounterView {
+    std::string_view uuid;
+    DeviceId id;
+    std::chrono::system_clock::time_point firstSeen;
+    std::chrono::system_clock::time_point lastSeen;
+    uint32_t hitCount;
+};
+
+// Contiguous read-only view of encounters
+class EncounterSpan {
+public:
+    EncounterSpan() : m_data(nullptr), m_size(0) {}
+    EncounterSpan(const EncounterInfo* data, size_t size) : m_data(data), m_size(size) {}
+    
+    const EncounterInfo* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    const EncounterInfo& operator[](size_t index) const { return m_data[index]; }
+    const EncounterInfo* begin() const { return m_data; }
+    const EncounterInfo* end() const { return m_data + m_size; }
+    
+private:
+    const EncounterInfo* m_data;
+    size_t m_size;
+};
+
+// Flush triggers for the batch callback (whichever comes first)
+struct BatchOptions {
+    std::chrono::milliseconds flushInterval{100};
+    size_t maxEvents = 256;     // Sightings, including repeats of the same device
+};
+
+// Retention limits for discovered devices
+struct EncounterPolicy {
+    // Forget devices not seen for this long (0 = keep until cleared)
+    std::chrono::milliseconds timeToLive{0};
+    
+    // Upper bound for the encounter store; least recently used devices are evicted (0 = unlimited)
+    size_t maxMemoryBytes = 0;
+};
+
+// Limits for the connect/read chains the core schedules on the platform
+struct ConnectionPolicy {
+    size_t maxConcurrentConnections = 3;
+    
+    // A connect/read chain still running after this is cancelled and counts as a failure
+    std::chrono::milliseconds connectionTimeout{10000};
+    
+    // Retry delay after a failure, doubling per consecutive failure up to maxBackoff
+    std::chrono::milliseconds initialBackoff{1000};
+    std::chrono::milliseconds maxBackoff{60000};
+    
+    // Peripherals not heard from for this long are no longer candidates
+    std::chrono::milliseconds candidateLifetime{5000};
+    
+    // Upper bound for peripherals tracked at once; further advertisers are ignored
+    size_t maxTrackedPeripherals = 1024;
+    
+    // An identifier read from a peripheral is reported again on its advertisements,
+    // without connecting, for this long (0 disables the cache)
+    std::chrono::milliseconds resolvedLifetime{600000};
+    size_t maxResolvedPeripherals = 4096;
+};
+
+// Scan/advertise duty cycling while scanning. The radio is on for a window at the
+// start of every cycle; the cycle period moves between the two latency targets
+// depending on whether recent windows found new peers.
+struct DutyCycleOptions {
+    bool enabled = false;   // Off: the radio stays on for the whole session
+    
+    // Radio-on time per cycle; extended up to maxWindow while new peers keep appearing
+    std::chrono::milliseconds window{2000};
+    std::chrono::milliseconds maxWindow{10000};
+    
+    // Cycle period (worst-case discovery latency) while new peers are appearing,
+    // doubling per quiet window up to maxLatency
+    std::chrono::milliseconds targetLatency{5000};
+    std::chrono::milliseconds maxLatency{60000};
+};
+
+// Long-horizon duplicate suppression (see PassByManager::setDuplicateFilter). A fixed-size
+// probabilistic filter remembers devices for the last `slices` time slices, using about
+// 1.44 * log2(slices / falsePositiveRate) bits per device per slice however many devices
+// are seen (devicesPerSlice = 100000 at the defaults: 1.6 MB).
+struct DuplicateFilterOptions {
+    bool enabled = false;
+    std::chrono::milliseconds sliceDuration{std::chrono::hours(24)};
+    size_t slices = 7;                  // Devices are remembered for slices - 1 to slices durations
+    size_t devicesPerSlice = 100000;    // Distinct devices per slice the rate holds for
+    double falsePositiveRate = 0.001;   // Chance that a device not seen is taken for a repeat
+};
+
+// What a discovery subscription receives. Empty lists match everything; a device must
+// pass every criterion that is set.
+struct SubscriptionFilter {
+    static constexpr int kAnyRssi = -128;
+    
+    std::vector<std::string> serviceUUIDs;          // Advertised one of these services
+    std::vector<std::string> identifierPrefixes;    // Identifier (as reported) starts with one of these
+    int minRssi = kAnyRssi;                         // Heard at least this strong, dBm
+};
+
+using SubscriptionId = uint64_t;    // 0 is never a valid subscription
+
+// Timed stages of the discovery pipeline (see PassByManager::getMetricsSnapshot())
+enum class PipelineStage : uint8_t {
+    Advertisement,          // Peripheral advertisement reported until the core handled it
+    Connect,                // Connection requested until connected (platform reported)
+    ServiceDiscovery,       // Connected until the identifier characteristic was found (platform reported)
+    CharacteristicRead,     // Read requested until the value arrived (platform reported)
+    Delivery                // Discovery reported until the callbacks returned, or were handed
+                            // to the callback executor
+};
+
+constexpr size_t kPipelineStageCount = 5;
+
+// Latency distribution of one stage. Percentiles are bucket bounds, within 1/16 of the true value.
+struct LatencySummary {
+    uint64_t count = 0;
+    std::chrono::microseconds min{0};
+    std::chrono::microseconds mean{0};
+    std::chrono::microseconds p50{0};
+    std::chrono::microseconds p90{0};
+    std::chrono::microseconds p99{0};
+    std::chrono::microseconds max{0};
+};
+
+// Pipeline counters and latencies since the manager was created
+struct MetricsSnapshot {
+    bool enabled = false;                   // Built with PASSBY_ENABLE_METRICS; otherwise only
+                                            // droppedEvents, droppedCallbacks and queueDepth
+                                            // are filled in
+    std::array<LatencySummary, kPipelineStageCount> latency;    // Indexed by PipelineStage
+    
+    uint64_t advertisements = 0;            // Peripheral advertisements handled
+    uint64_t discoveries = 0;               // Discoveries recorded and passed to callbacks
+    uint64_t filteredDiscoveries = 0;       // Discoveries no subscription asked for
+    uint64_t duplicateDiscoveries = 0;      // Suppressed by the duplicate filter
+    uint64_t connectionsStarted = 0;
+    uint64_t connectionFailures = 0;        // Failed, or could not be started
+    uint64_t connectionTimeouts = 0;
+    uint64_t droppedEvents = 0;             // See getDroppedEventCount()
+    uint64_t droppedCallbacks = 0;          // See getDroppedCallbackCount()
+    size_t queueDepth = 0;                  // Events waiting for the dispatch thread
+    size_t maxQueueDepth = 0;               // Deepest the dispatch thread found the queue
+    
+    const LatencySummary& operator[](PipelineStage stage) const { return latency[static_cast<size_t>(stage)]; }
+};
+
+// Per-device statistics kept when aggregation is enabled (see PassByManager::setAggregation())
+struct AggregationOptions {
+    bool enabled = false;
+    std::chrono::milliseconds sessionGap = std::chrono::minutes(5);    // A longer silence ends a visit
+    double rssiSmoothing = 0.2;         // Weight of each new reading in the RSSI average
+    size_t maxDevices = 100000;         // The least recently seen device is dropped beyond this
+};
+
+// Orderings served by PassByManager::getTopEncounters()
+enum class EncounterRanking : uint8_t {
+    MostFrequent,   // Most visits, then most sightings
+    LongestDwell,   // Longest total time in range
+    MostRecent      // Seen most recently
+};
+
+constexpr size_t kEncounterRankingCount = 3;
+
+// Who we were near, for how long and how often
+struct EncounterStats {
+    std::string uuid;
+    DeviceId id;
+    std::chrono::system_clock::time_point firstSeen;
+    std::chrono::system_clock::time_point lastSeen;
+    uint64_t sightings = 0;
+    uint32_t visits = 0;                    // Runs of sightings no more than sessionGap apart
+    std::chrono::milliseconds dwell{0};     // Summed visit lengths, first to last sighting of each
+    bool hasRssi = false;
+    double rssi = 0;                        // Smoothed RSSI in dBm, if hasRssi
 };
 
 // Advertising information for callback
@@ -25,6 +245,11 @@ struct AdvertisingInfo {
 
 // Callback function types
 using DeviceDiscoveredCallback = std::function<void(const DeviceInfo&)>;
+using DeviceViewCallback = std::function<void(const DeviceView&)>;
 using AdvertisingStartedCallback = std::function<void(const AdvertisingInfo&)>;
+using EncounterVisitor = std::function<void(const EncounterView&)>;
+
+// Batch of distinct devices; the span is only valid during the call
+using DeviceBatchCallback = std::function<void(EncounterSpan)>;
 
 } // namespace PassBy
\ No newline at end of file
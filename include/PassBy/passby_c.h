@@ -0,0 +1,88 @@
+#ifndef PASSBY_C_H
+#define PASSBY_C_H
+
+/*
+ * Stable C ABI for hosts that cannot use the C++ API (Unity, JNI, Swift, ...).
+ *
+ * Discoveries are written by the context's dispatch thread into a single-producer /
+ * single-consumer ring of fixed-size passby_event records, which the host drains when it
+ * likes: many events per call, with no allocation or string marshalling per event.
+ * passby_peek_events() hands out the records in place (e.g. to wrap in a NativeArray or a
+ * direct ByteBuffer); passby_poll_events() copies them into a host buffer instead.
+ *
+ * Every function may be called from any thread, except that the consuming functions
+ * (poll, peek, release) must not run on two threads at once for the same context.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped whenever a record layout or function signature changes */
+#define PASSBY_C_ABI_VERSION 1
+
+typedef struct passby_context passby_context;
+
+typedef enum passby_event_type {
+    PASSBY_EVENT_DEVICE_DISCOVERED = 1,
+    PASSBY_EVENT_ADVERTISING_STARTED = 2
+} passby_event_type;
+
+/* passby_event.flags */
+#define PASSBY_EVENT_HAS_RSSI 0x01u
+#define PASSBY_EVENT_HAS_SERVICE 0x02u
+#define PASSBY_EVENT_SUCCESS 0x04u      /* ADVERTISING_STARTED: advertising is on */
+
+/* One event, 48 bytes, no pointers; laid out the same on every platform */
+typedef struct passby_event {
+    uint8_t device_id[16];      /* Binary UUID (a hash of it for non-UUID identifiers);
+                                   the peripheral UUID for ADVERTISING_STARTED */
+    uint8_t service[16];        /* Advertised service UUID, if PASSBY_EVENT_HAS_SERVICE */
+    int64_t timestamp_ms;       /* Unix time in ms when the platform reported it */
+    int16_t rssi;               /* dBm, if PASSBY_EVENT_HAS_RSSI */
+    uint8_t type;               /* passby_event_type */
+    uint8_t flags;
+    uint32_t sequence;          /* Counts every event produced, so a gap means drops */
+} passby_event;
+
+uint32_t passby_abi_version(void);
+const char* passby_version(void);
+
+/* New context on the platform's BLE stack; the ring holds at least ring_capacity events
+   (rounded up to a power of two). Returns NULL on failure. */
+passby_context* passby_create(uint32_t ring_capacity);
+
+/* Stops scanning; records handed out by passby_peek_events() become invalid */
+void passby_destroy(passby_context* context);
+
+/* service_uuid may be NULL or "" for no filter. Return 1 on success, 0 on failure. */
+int passby_start_scanning(passby_context* context, const char* service_uuid);
+int passby_stop_scanning(passby_context* context);
+int passby_is_scanning(const passby_context* context);
+
+/* Block until the events reported before this call are in the ring */
+void passby_flush(passby_context* context);
+
+/* Copy up to max_events of the oldest events into events; returns the number copied */
+uint32_t passby_poll_events(passby_context* context, passby_event* events, uint32_t max_events);
+
+/* Point *events at the oldest events, in place in the ring, and return how many are
+   contiguous there (0 if none). They stay valid until passby_release_events(). */
+uint32_t passby_peek_events(passby_context* context, const passby_event** events);
+
+/* Give back the first count events of the last peek (at most as many as it returned) */
+void passby_release_events(passby_context* context, uint32_t count);
+
+/* Events lost because the ring was full (the host fell behind) */
+uint64_t passby_dropped_events(const passby_context* context);
+
+/* Write the canonical text form of a 16-byte UUID, NUL-terminated, into out (37 bytes) */
+void passby_format_uuid(const uint8_t uuid[16], char out[37]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PASSBY_C_H */
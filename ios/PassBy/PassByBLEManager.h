@@ -1,15 +1,40 @@
 #import <Foundation/Foundation.h>
 #import <CoreBluetooth/CoreBluetooth.h>
 
+#ifdef __cplusplus
+namespace PassBy {
+class PassByManager;
+}
+#endif
+
 NS_ASSUME_NONNULL_BEGIN
 
 @interface PassByBLEManager : NSObject <CBCentralManagerDelegate, CBPeripheralManagerDelegate, CBPeripheralDelegate>
 
 @property (nonatomic, readonly) BOOL isActive;
 
-- (BOOL)startBLEWithServiceUUID:(nullable NSString*)serviceUUID;
+#ifdef __cplusplus
+// Context that receives discoveries; main queue only. Set by starting with a manager and
+// cleared by stopBLE, so no callback reaches a context that has gone away.
+@property (nonatomic, assign, readonly, nullable) PassBy::PassByManager *manager;
+#endif
+
+// Safe to call from any thread; off the main thread the change is applied on the main
+// queue asynchronously, in the order the calls were made.
+#ifdef __cplusplus
+- (BOOL)startBLEWithServiceUUID:(nullable NSString*)serviceUUID manager:(PassBy::PassByManager*)manager;
+#endif
 - (BOOL)stopBLE;
 
+// Stop reporting to the manager for good, before it is destroyed. Clears it on the main
+// queue and waits for that, so no queued request or callback reaches it afterwards.
+- (void)detachManager;
+
+// Connect/read chains requested by the core's connection scheduler. Safe to call from
+// any thread; the outcome is reported to the manager.
+- (void)connectPeripheralWithIdentifier:(NSUUID*)identifier;
+- (void)cancelPeripheralWithIdentifier:(NSUUID*)identifier;
+
 @end
 
 NS_ASSUME_NONNULL_END
\ No newline at end of file
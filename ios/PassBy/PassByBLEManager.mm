@@ -1,11 +1,28 @@
 #import "PassByBLEManager.h"
-#include "../../src/internal/PassByBridge.h"
+#include "PassBy/PassBy.h"
+#include "../../src/internal/AdvertisementCodec.h"
+#include <atomic>
+#include <chrono>
 
 // UUID for PassBy service and characteristics
 static NSString * const kPassByServiceUUID = @"12345678-1234-1234-1234-123456789ABC";
 static NSString * const kPassByCharacteristicUUID = @"87654321-4321-4321-4321-CBA987654321";
 static NSString * const kPassByDeviceIdentifierUUID = @"11111111-2222-3333-4444-555555555555";
 
+// Bound on peripherals kept for connection requests; matches ConnectionPolicy's default
+static const NSUInteger kMaxKnownPeripherals = 1024;
+
+static PassBy::DeviceId peripheralHandle(CBPeripheral *peripheral) {
+    uuid_t bytes;
+    [peripheral.identifier getUUIDBytes:bytes];
+    return PassBy::DeviceId::fromBytes(bytes);
+}
+
+static int64_t steadyMicroseconds() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
 @interface PassByBLEManager ()
 
 @property (nonatomic, strong) CBCentralManager *centralManager;
@@ -18,11 +35,20 @@ static NSString * const kPassByDeviceIdentifierUUID = @"11111111-2222-3333-4444-
 @property (nonatomic, strong) NSString *pendingServiceUUID;
 // Custom property implemented manually
 @property (nonatomic, strong) NSMutableSet<CBPeripheral*> *connectingPeripherals;
+// PassBy advertisers seen while scanning, so the scheduler's handles can be connected
+@property (nonatomic, strong) NSMutableDictionary<NSUUID*, CBPeripheral*> *knownPeripherals;
+// Start of the current connect/read stage per connecting peripheral, for the core's metrics
+@property (nonatomic, strong) NSMutableDictionary<NSUUID*, NSNumber*> *stageStarts;
+@property (nonatomic, assign, readwrite, nullable) PassBy::PassByManager *manager;
 
 @end
 
 @implementation PassByBLEManager {
     NSString *_internalDeviceIdentifier;
+    // Radio on/off requests queued for the main queue and not applied yet
+    std::atomic<int> _queuedRadioRequests;
+    // Set by detachManager; main queue only
+    BOOL _detached;
 }
 
 // Custom setter for validation
@@ -52,11 +78,14 @@ static NSString * const kPassByDeviceIdentifierUUID = @"11111111-2222-3333-4444-
         _peripheralManager = [[CBPeripheralManager alloc] initWithDelegate:self queue:nil];
         _isScanning = NO;
         _isAdvertising = NO;
+        _queuedRadioRequests = 0;
         
         // Generate fixed device identifier for this app session
         NSString *newUUID = [[NSUUID UUID] UUIDString];
         self.deviceIdentifier = newUUID;  // Use setter for validation
         _connectingPeripherals = [[NSMutableSet alloc] init];
+        _knownPeripherals = [[NSMutableDictionary alloc] init];
+        _stageStarts = [[NSMutableDictionary alloc] init];
         
         NSLog(@"PassByBLEManager initialized with device identifier: %@ (type: %@)", self.deviceIdentifier, [self.deviceIdentifier class]);
     }
@@ -67,10 +96,57 @@ static NSString * const kPassByDeviceIdentifierUUID = @"11111111-2222-3333-4444-
     return _isScanning || _isAdvertising;
 }
 
-- (BOOL)startBLEWithServiceUUID:(nullable NSString*)serviceUUID {
+// CoreBluetooth and the peripheral tables belong to the main queue, but the core also
+// parks and resumes the radio from its dispatch thread (duty cycle). Requests made off
+// the main queue are applied there asynchronously, in order, and report success.
+- (BOOL)startBLEWithServiceUUID:(nullable NSString*)serviceUUID manager:(PassBy::PassByManager*)manager {
+    if ([self queueRadioRequest:^{ [self applyStartBLEWithServiceUUID:serviceUUID manager:manager]; }]) {
+        return YES;
+    }
+    return [self applyStartBLEWithServiceUUID:serviceUUID manager:manager];
+}
+
+- (BOOL)stopBLE {
+    if ([self queueRadioRequest:^{ [self applyStopBLE]; }]) {
+        return YES;
+    }
+    return [self applyStopBLE];
+}
+
+- (void)detachManager {
+    dispatch_block_t detach = ^{
+        self->_detached = YES;
+        self.manager = nullptr;
+    };
+    if ([NSThread isMainThread]) {
+        detach();
+    } else {
+        dispatch_sync(dispatch_get_main_queue(), detach);
+    }
+}
+
+#pragma mark - Private Methods
+
+// Queue request on the main queue unless this is the main thread with nothing queued
+// before it, so requests apply in the order they were made
+- (BOOL)queueRadioRequest:(dispatch_block_t)request {
+    if ([NSThread isMainThread] && _queuedRadioRequests.load() == 0) {
+        return NO;
+    }
+    ++_queuedRadioRequests;
+    dispatch_async(dispatch_get_main_queue(), ^{
+        request();
+        --self->_queuedRadioRequests;
+    });
+    return YES;
+}
+
+- (BOOL)applyStartBLEWithServiceUUID:(nullable NSString*)serviceUUID manager:(PassBy::PassByManager*)manager {
     if (self.isActive) {
         return NO;
     }
+    // A start queued before detachManager must not attach the manager again
+    self.manager = _detached ? nullptr : manager;
     
     [self startScanningWithServiceUUID:serviceUUID];
     [self startAdvertising];
@@ -78,7 +154,9 @@ static NSString * const kPassByDeviceIdentifierUUID = @"11111111-2222-3333-4444-
     return YES;
 }
 
-- (BOOL)stopBLE {
+- (BOOL)applyStopBLE {
+    // Nothing is reported after a stop, even if the radio was off already
+    self.manager = nullptr;
     if (!self.isActive) {
         return NO;
     }
@@ -89,8 +167,6 @@ static NSString * const kPassByDeviceIdentifierUUID = @"11111111-2222-3333-4444-
     return YES;
 }
 
-#pragma mark - Private Methods
-
 - (void)startScanningWithServiceUUID:(nullable NSString*)serviceUUID {
     if (!_isScanning) {
         _isScanning = YES;
@@ -123,6 +199,99 @@ static NSString * const kPassByDeviceIdentifierUUID = @"11111111-2222-3333-4444-
         _isScanning = NO;
         NSLog(@"Stopped BLE scanning");
     }
+    // The core cancels its chains on stop; drop everything it could still ask for
+    for (CBPeripheral *peripheral in _connectingPeripherals) {
+        [_centralManager cancelPeripheralConnection:peripheral];
+    }
+    [_connectingPeripherals removeAllObjects];
+    [_knownPeripherals removeAllObjects];
+    [_stageStarts removeAllObjects];
+}
+
+// Report the stage that started at the last mark for peripheral, and start the next one
+- (void)completeStage:(PassBy::PipelineStage)stage forPeripheral:(CBPeripheral *)peripheral {
+    NSNumber *start = _stageStarts[peripheral.identifier];
+    int64_t now = steadyMicroseconds();
+    PassBy::PassByManager *manager = self.manager;
+    if (start && manager) {
+        manager->recordStageLatency(stage, std::chrono::microseconds(now - start.longLongValue));
+    }
+    _stageStarts[peripheral.identifier] = @(now);
+}
+
+// Identifier carried in the advertisement itself (AdvertisementCodec), if any
+- (BOOL)decodeAdvertisedIdentifier:(NSDictionary<NSString *,id> *)advertisementData
+                               into:(PassBy::AdvertisedIdentifier &)advertised {
+    NSData *manufacturerData = advertisementData[CBAdvertisementDataManufacturerDataKey];
+    if (manufacturerData &&
+        PassBy::AdvertisementCodec::decodeManufacturerData(static_cast<const uint8_t *>(manufacturerData.bytes),
+                                                           manufacturerData.length, advertised)) {
+        return YES;
+    }
+    NSDictionary<CBUUID *, NSData *> *serviceData = advertisementData[CBAdvertisementDataServiceDataKey];
+    NSString *serviceKey = [NSString stringWithFormat:@"%04X", PassBy::AdvertisementCodec::kServiceUuid16];
+    NSData *payload = serviceData[[CBUUID UUIDWithString:serviceKey]];
+    return payload &&
+           PassBy::AdvertisementCodec::decodeServiceData(static_cast<const uint8_t *>(payload.bytes), payload.length,
+                                                         advertised);
+}
+
+// First service UUID the advertisement lists, if it is a full 128-bit one
+- (BOOL)decodeAdvertisedService:(NSDictionary<NSString *,id> *)advertisementData into:(PassBy::DeviceId &)service {
+    NSArray<CBUUID *> *services = advertisementData[CBAdvertisementDataServiceUUIDsKey];
+    if (services.count == 0) {
+        services = advertisementData[CBAdvertisementDataOverflowServiceUUIDsKey];
+    }
+    NSData *data = services.firstObject.data;
+    if (data.length != PassBy::DeviceId::kSize) {
+        return NO;
+    }
+    service = PassBy::DeviceId::fromBytes(static_cast<const uint8_t *>(data.bytes));
+    return YES;
+}
+
+- (BOOL)isPassByAdvertisement:(NSDictionary<NSString *,id> *)advertisementData {
+    // A filtered scan only reports PassBy advertisers
+    if (self.pendingServiceUUID.length > 0) {
+        return YES;
+    }
+    CBUUID *service = [CBUUID UUIDWithString:kPassByServiceUUID];
+    // Backgrounded iOS advertisers move their service UUIDs to the overflow area
+    return [advertisementData[CBAdvertisementDataServiceUUIDsKey] containsObject:service] ||
+           [advertisementData[CBAdvertisementDataOverflowServiceUUIDsKey] containsObject:service];
+}
+
+- (void)connectPeripheralWithIdentifier:(NSUUID*)identifier {
+    dispatch_async(dispatch_get_main_queue(), ^{
+        PassBy::PassByManager *manager = self.manager;
+        if (!manager) {
+            return;
+        }
+        CBPeripheral *peripheral = self.knownPeripherals[identifier];
+        if (!peripheral || !self.isScanning || [self.connectingPeripherals containsObject:peripheral]) {
+            uuid_t bytes;
+            [identifier getUUIDBytes:bytes];
+            manager->onPeripheralConnectionFailed(PassBy::DeviceId::fromBytes(bytes));
+            return;
+        }
+        NSLog(@"Connecting to PassBy device: %@", identifier.UUIDString);
+        [self.connectingPeripherals addObject:peripheral];
+        self.stageStarts[identifier] = @(steadyMicroseconds());
+        peripheral.delegate = self;
+        [self.centralManager connectPeripheral:peripheral options:nil];
+    });
+}
+
+- (void)cancelPeripheralWithIdentifier:(NSUUID*)identifier {
+    dispatch_async(dispatch_get_main_queue(), ^{
+        CBPeripheral *peripheral = self.knownPeripherals[identifier];
+        if (peripheral && [self.connectingPeripherals containsObject:peripheral]) {
+            // The core already gave up on this chain; do not report it again
+            [self.connectingPeripherals removeObject:peripheral];
+            [self.stageStarts removeObjectForKey:identifier];
+            [self.centralManager cancelPeripheralConnection:peripheral];
+        }
+    });
 }
 
 - (void)startAdvertising {
@@ -187,8 +356,9 @@ static NSString * const kPassByDeviceIdentifierUUID = @"11111111-2222-3333-4444-
  * The following sequence outlines the complete flow from discovering a peripheral
  * to obtaining its characteristic UUID values:
  * 
- * 1. didDiscoverPeripheral - Peripheral device is discovered during scanning
- * 2. connectPeripheral - Initiate connection to the discovered peripheral
+ * 1. didDiscoverPeripheral - Peripheral device is discovered during scanning and
+ *    reported to the core's ConnectionScheduler via the manager
+ * 2. connectPeripheral - Initiate connection when the scheduler asks for it
  * 3. didConnectPeripheral - Connection established successfully
  * 4. discoverServices - Begin service discovery on the connected peripheral
  * 5. didDiscoverServices - Services are discovered and enumerated
@@ -196,7 +366,13 @@ static NSString * const kPassByDeviceIdentifierUUID = @"11111111-2222-3333-4444-
  * 7. didDiscoverCharacteristicsForService - Characteristics are discovered
  * 8. readValueForCharacteristic - Initiate reading of characteristic values
  * 9. didUpdateValueForCharacteristic - Characteristic value read completed
- * 10. onDeviceDiscovered - Results reported to C++ layer via PassByBridge
+ * 10. onPeripheralIdentifierRead - Results reported to the C++ manager
+ *
+ * Steps 2-3, 4-7 and 8-9 are timed as the Connect, ServiceDiscovery and
+ * CharacteristicRead stages of the core's metrics (recordStageLatency).
+ *
+ * A failure at any step ends in didFailToConnect or didDisconnect, which report
+ * onPeripheralConnectionFailed so the scheduler can back off.
  * 
  * This flow ensures proper BLE communication protocol adherence and retrieves
  * the device identifier from the kPassByDeviceIdentifierUUID characteristic.
@@ -228,6 +404,10 @@ static NSString * const kPassByDeviceIdentifierUUID = @"11111111-2222-3333-4444-
  didDiscoverPeripheral:(CBPeripheral *)peripheral
      advertisementData:(NSDictionary<NSString *,id> *)advertisementData
                   RSSI:(NSNumber *)RSSI {
+    PassBy::PassByManager *manager = self.manager;
+    if (!manager) {
+        return;
+    }
     
     NSString *deviceUUID = peripheral.identifier.UUIDString;
     NSString *deviceName = peripheral.name ?: @"Unknown";
@@ -235,14 +415,38 @@ static NSString * const kPassByDeviceIdentifierUUID = @"11111111-2222-3333-4444-
     NSLog(@"Discovered device: %@ (Name: %@, RSSI: %@)", deviceUUID, deviceName, RSSI);
     
     NSLog(@"Advertisement Data: %@", advertisementData);
-    if (![_connectingPeripherals containsObject:peripheral]) {
-        NSLog(@"Connecting to PassBy device: %@", deviceUUID);
-        [_connectingPeripherals addObject:peripheral];
-        peripheral.delegate = self;
-        [_centralManager connectPeripheral:peripheral options:nil];
-    } else {
-        NSLog(@"Already connecting to device: %@", deviceUUID);
+    
+    // Peers that advertise their identifier are discovered without connecting
+    PassBy::AdvertisedIdentifier advertised;
+    if ([self decodeAdvertisedIdentifier:advertisementData into:advertised]) {
+        // With the service it advertised and the RSSI, subscription filters can match it
+        PassBy::DeviceId service;
+        if ([self decodeAdvertisedService:advertisementData into:service]) {
+            manager->onDeviceDiscovered(advertised.id, service, RSSI.intValue);
+        } else {
+            manager->onDeviceDiscovered(advertised.id, RSSI.intValue);
+        }
+        return;
+    }
+    
+    if (![self isPassByAdvertisement:advertisementData]) {
+        return;
+    }
+    
+    // Keep the peripheral so a later connect request can find it
+    if (!_knownPeripherals[peripheral.identifier]) {
+        if (_knownPeripherals.count >= kMaxKnownPeripherals) {
+            for (NSUUID *identifier in [_knownPeripherals allKeys]) {
+                if (![_connectingPeripherals containsObject:_knownPeripherals[identifier]]) {
+                    [_knownPeripherals removeObjectForKey:identifier];
+                }
+            }
+        }
+        _knownPeripherals[peripheral.identifier] = peripheral;
     }
+    
+    // The core decides whether and when to connect
+    manager->onPeripheralDiscovered(peripheralHandle(peripheral), RSSI.intValue);
 }
 
 #pragma mark - CBPeripheralManagerDelegate
@@ -276,17 +480,23 @@ static NSString * const kPassByDeviceIdentifierUUID = @"11111111-2222-3333-4444-
     if (error) {
         NSLog(@"Error starting advertising: %@", error.localizedDescription);
         _isAdvertising = NO;
-        
-        // Notify failure via bridge
+    }
+    PassBy::PassByManager *manager = self.manager;
+    if (!manager) {
+        return;
+    }
+    
+    if (error) {
+        // Notify failure to the manager
         std::string errorMessage = std::string([error.localizedDescription UTF8String]);
-        PassBy::PassByBridge::onAdvertisingStarted("", false, errorMessage);
+        manager->onAdvertisingStarted("", false, errorMessage);
     } else {
         NSLog(@"Started advertising successfully with device identifier: %@", self.deviceIdentifier);
         
-        // Notify success with fixed device identifier via bridge using getter
+        // Notify success with fixed device identifier using getter
         NSString *identifierString = self.deviceIdentifier;  // Use getter for validation
         std::string deviceIdString = std::string([identifierString UTF8String]);
-        PassBy::PassByBridge::onAdvertisingStarted(deviceIdString, true);
+        manager->onAdvertisingStarted(deviceIdString, true);
     }
 }
 
@@ -294,21 +504,40 @@ static NSString * const kPassByDeviceIdentifierUUID = @"11111111-2222-3333-4444-
 
 - (void)centralManager:(CBCentralManager *)central didConnectPeripheral:(CBPeripheral *)peripheral {
     NSLog(@"Connected to peripheral: %@", peripheral.identifier.UUIDString);
+    [self completeStage:PassBy::PipelineStage::Connect forPeripheral:peripheral];
     [peripheral discoverServices:@[[CBUUID UUIDWithString:kPassByServiceUUID]]];
 }
 
 - (void)centralManager:(CBCentralManager *)central didDisconnectPeripheral:(CBPeripheral *)peripheral error:(NSError *)error {
     NSLog(@"Disconnected from peripheral: %@", peripheral.identifier.UUIDString);
-    [_connectingPeripherals removeObject:peripheral];
     
     if (error) {
         NSLog(@"Disconnection error: %@", error.localizedDescription);
     }
+    
+    // Still connecting means the chain ended before the identifier was read
+    [_stageStarts removeObjectForKey:peripheral.identifier];
+    if ([_connectingPeripherals containsObject:peripheral]) {
+        [_connectingPeripherals removeObject:peripheral];
+        PassBy::PassByManager *manager = self.manager;
+        if (!manager) {
+            return;
+        }
+        manager->onPeripheralConnectionFailed(peripheralHandle(peripheral));
+    }
 }
 
 - (void)centralManager:(CBCentralManager *)central didFailToConnectPeripheral:(CBPeripheral *)peripheral error:(NSError *)error {
     NSLog(@"Failed to connect to peripheral: %@ with error: %@", peripheral.identifier.UUIDString, error.localizedDescription);
-    [_connectingPeripherals removeObject:peripheral];
+    [_stageStarts removeObjectForKey:peripheral.identifier];
+    if ([_connectingPeripherals containsObject:peripheral]) {
+        [_connectingPeripherals removeObject:peripheral];
+        PassBy::PassByManager *manager = self.manager;
+        if (!manager) {
+            return;
+        }
+        manager->onPeripheralConnectionFailed(peripheralHandle(peripheral));
+    }
 }
 
 - (void)peripheral:(CBPeripheral *)peripheral didDiscoverServices:(NSError *)error {
@@ -339,6 +568,7 @@ didDiscoverCharacteristicsForService:(CBService *)service
     for (CBCharacteristic *characteristic in service.characteristics) {
         if ([characteristic.UUID.UUIDString isEqualToString:kPassByDeviceIdentifierUUID]) {
             NSLog(@"Found device identifier characteristic, reading value");
+            [self completeStage:PassBy::PipelineStage::ServiceDiscovery forPeripheral:peripheral];
             [peripheral readValueForCharacteristic:characteristic];
         }
     }
@@ -354,20 +584,28 @@ didUpdateValueForCharacteristic:(CBCharacteristic *)characteristic
     }
     
     if ([characteristic.UUID.UUIDString isEqualToString:kPassByDeviceIdentifierUUID]) {
-        NSString *deviceIdentifier = [[NSString alloc] initWithData:characteristic.value encoding:NSUTF8StringEncoding];
+        NSData *identifierData = characteristic.value;
         
-        NSLog(@"Retrieved device identifier: %@ from peripheral: %@", deviceIdentifier, peripheral.identifier.UUIDString);
+        NSLog(@"Retrieved device identifier (%lu bytes) from peripheral: %@", (unsigned long)identifierData.length, peripheral.identifier.UUIDString);
         
-        // Report to C++ layer via bridge using the custom identifier
-        if (deviceIdentifier && deviceIdentifier.length > 0) {
-            PassBy::PassByBridge::onDeviceDiscovered([deviceIdentifier UTF8String]);
-        } else {
-            // Fallback to system identifier if custom identifier is invalid
-            PassBy::PassByBridge::onDeviceDiscovered([@"invalid-device-UUID" UTF8String]);
+        [self completeStage:PassBy::PipelineStage::CharacteristicRead forPeripheral:peripheral];
+        [_stageStarts removeObjectForKey:peripheral.identifier];
+        
+        // Report to the C++ manager using the custom identifier.
+        // The characteristic bytes are passed as a view; nothing is copied on the way in.
+        [_connectingPeripherals removeObject:peripheral];
+        // Fallback to system identifier if custom identifier is invalid
+        std::string_view identifier = identifierData.length > 0
+            ? std::string_view(static_cast<const char *>(identifierData.bytes), identifierData.length)
+            : std::string_view("invalid-device-UUID");
+        PassBy::PassByManager *manager = self.manager;
+        if (manager) {
+            manager->onPeripheralIdentifierRead(peripheralHandle(peripheral), identifier);
         }
         
         // Disconnect to free resources
         [_centralManager cancelPeripheralConnection:peripheral];
+        [_knownPeripherals removeObjectForKey:peripheral.identifier];
     }
     else {
         NSLog(@"Received update for characteristic: %@, but not the device identifier", characteristic.UUID.UUIDString);
@@ -20,6 +20,8 @@ public:
     bool startBLE(const std::string& serviceUUID = "") override;
     bool stopBLE() override;
     bool isBLEActive() const override;
+    bool connectPeripheral(const DeviceId& peripheral) override;
+    void cancelPeripheral(const DeviceId& peripheral) override;
 
 private:
     PassByBLEManager* m_bleManager;
@@ -9,6 +9,9 @@ iOSPlatform::iOSPlatform() {
 
 iOSPlatform::~iOSPlatform() {
     if (m_bleManager) {
+        // The manager is destroyed right after its platform: detach synchronously, as
+        // stopBLE only queues its work off the main thread
+        [m_bleManager detachManager];
         [m_bleManager stopBLE];
         m_bleManager = nil;
     }
@@ -21,7 +24,7 @@ bool iOSPlatform::startBLE(const std::string& serviceUUID) {
     
     NSString* nsServiceUUID = serviceUUID.empty() ? nil : [NSString stringWithUTF8String:serviceUUID.c_str()];
     NSLog(@"Starting BLE with service UUID: %@", nsServiceUUID);
-    return [m_bleManager startBLEWithServiceUUID:nsServiceUUID];
+    return [m_bleManager startBLEWithServiceUUID:nsServiceUUID manager:manager()];
 }
 
 bool iOSPlatform::stopBLE() {
@@ -38,4 +41,21 @@ bool iOSPlatform::isBLEActive() const {
     return m_bleManager.isActive;
 }
 
+bool iOSPlatform::connectPeripheral(const DeviceId& peripheral) {
+    if (!m_bleManager) {
+        return false;
+    }
+    NSUUID* identifier = [[NSUUID alloc] initWithUUIDBytes:peripheral.bytes()];
+    [m_bleManager connectPeripheralWithIdentifier:identifier];
+    return true;
+}
+
+void iOSPlatform::cancelPeripheral(const DeviceId& peripheral) {
+    if (!m_bleManager) {
+        return;
+    }
+    NSUUID* identifier = [[NSUUID alloc] initWithUUIDBytes:peripheral.bytes()];
+    [m_bleManager cancelPeripheralWithIdentifier:identifier];
+}
+
 } // namespace PassBy
\ No newline at end of file
@@ -0,0 +1,32 @@
+#!/bin/bash
+
+# PassBy Benchmark Script
+# Builds PassByBench in Release mode and writes JSON results for comparing releases
+
+set -e  # Exit on any error
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$SCRIPT_DIR"
+BENCH_BUILD_DIR="$PROJECT_ROOT/build_bench"
+OUTPUT_FILE="${1:-$BENCH_BUILD_DIR/passby_bench.json}"
+
+echo "⏱️  Building PassByBench..."
+mkdir -p "$BENCH_BUILD_DIR"
+cd "$BENCH_BUILD_DIR"
+
+cmake \
+    -DCMAKE_BUILD_TYPE=Release \
+    -DBUILD_TESTING=OFF \
+    -DPASSBY_BUILD_BENCHMARKS=ON \
+    "$PROJECT_ROOT"
+
+make -j$(nproc 2>/dev/null || sysctl -n hw.ncpu) PassByBench
+
+echo ""
+echo "🚀 Running benchmarks..."
+echo "========================"
+./PassByBench --benchmark_out="$OUTPUT_FILE" --benchmark_out_format=json "${@:2}"
+
+echo ""
+echo "📍 Results: $OUTPUT_FILE"
+echo "Compare two runs with: compare.py benchmarks <baseline.json> <candidate.json>"
@@ -0,0 +1,156 @@
+#include "../internal/AdvertisementCodec.h"
+#include <cstring>
+
+namespace PassBy {
+
+// Payload layout
+static constexpr size_t kHeaderSize = 2;
+static constexpr size_t kChecksumOffset = kHeaderSize + DeviceId::kSize;
+
+uint16_t AdvertisementCodec::checksum(const uint8_t* data, size_t length) {
+    // CRC-16/CCITT-FALSE
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; ++i) {
+        crc ^= static_cast<uint16_t>(data[i] << 8);
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+size_t AdvertisementCodec::encodePayload(const DeviceId& id, uint8_t flags, uint8_t* out, size_t capacity) {
+    if (capacity < kPayloadSize) {
+        return 0;
+    }
+    out[0] = kMagic;
+    out[1] = static_cast<uint8_t>(kVersion << 4 | (flags & 0x0F));
+    std::memcpy(out + kHeaderSize, id.bytes(), DeviceId::kSize);
+    uint16_t crc = checksum(out, kChecksumOffset);
+    out[kChecksumOffset] = static_cast<uint8_t>(crc >> 8);
+    out[kChecksumOffset + 1] = static_cast<uint8_t>(crc);
+    return kPayloadSize;
+}
+
+static size_t encodeStructure(uint8_t type, uint16_t prefix, const DeviceId& id, uint8_t flags, uint8_t* out,
+                              size_t capacity) {
+    if (capacity < AdvertisementCodec::kStructureSize) {
+        return 0;
+    }
+    out[0] = static_cast<uint8_t>(AdvertisementCodec::kStructureSize - 1);
+    out[1] = type;
+    out[2] = static_cast<uint8_t>(prefix);
+    out[3] = static_cast<uint8_t>(prefix >> 8);
+    AdvertisementCodec::encodePayload(id, flags, out + 4, capacity - 4);
+    return AdvertisementCodec::kStructureSize;
+}
+
+size_t AdvertisementCodec::encodeManufacturerStructure(const DeviceId& id, uint8_t flags, uint8_t* out,
+                                                       size_t capacity) {
+    return encodeStructure(kAdTypeManufacturerData, kCompanyId, id, flags, out, capacity);
+}
+
+size_t AdvertisementCodec::encodeServiceDataStructure(const DeviceId& id, uint8_t flags, uint8_t* out,
+                                                      size_t capacity) {
+    return encodeStructure(kAdTypeServiceData16, kServiceUuid16, id, flags, out, capacity);
+}
+
+bool AdvertisementCodec::decodePayload(const uint8_t* data, size_t length, AdvertisedIdentifier& out) {
+    if (length < kPayloadSize || data[0] != kMagic) {
+        return false;
+    }
+    // Newer layouts may differ; leave those peers to the GATT path
+    uint8_t version = data[1] >> 4;
+    if (version != kVersion) {
+        return false;
+    }
+    uint16_t expected = static_cast<uint16_t>(data[kChecksumOffset] << 8 | data[kChecksumOffset + 1]);
+    if (checksum(data, kChecksumOffset) != expected) {
+        return false;
+    }
+    out.id = DeviceId::fromBytes(data + kHeaderSize);
+    out.version = version;
+    out.flags = data[1] & 0x0F;
+    return true;
+}
+
+static uint16_t readLittleEndian16(const uint8_t* data) {
+    return static_cast<uint16_t>(data[0] | data[1] << 8);
+}
+
+bool AdvertisementCodec::decodeManufacturerData(const uint8_t* data, size_t length, AdvertisedIdentifier& out) {
+    if (length < 2 || readLittleEndian16(data) != kCompanyId) {
+        return false;
+    }
+    return decodePayload(data + 2, length - 2, out);
+}
+
+bool AdvertisementCodec::decodeServiceData(const uint8_t* data, size_t length, AdvertisedIdentifier& out) {
+    return decodePayload(data, length, out);
+}
+
+bool AdvertisementCodec::decodeAdvertisement(const uint8_t* data, size_t length, AdvertisedIdentifier& out) {
+    size_t offset = 0;
+    while (offset < length) {
+        size_t structureLength = data[offset];
+        if (structureLength == 0) {
+            // Zero padding after the last structure
+            break;
+        }
+        if (offset + 1 + structureLength > length) {
+            return false;
+        }
+        uint8_t type = data[offset + 1];
+        const uint8_t* body = data + offset + 2;
+        size_t bodyLength = structureLength - 1;
+        if (type == kAdTypeManufacturerData && decodeManufacturerData(body, bodyLength, out)) {
+            return true;
+        }
+        if (type == kAdTypeServiceData16 && bodyLength >= 2 && readLittleEndian16(body) == kServiceUuid16 &&
+            decodeServiceData(body + 2, bodyLength - 2, out)) {
+            return true;
+        }
+        offset += 1 + structureLength;
+    }
+    return false;
+}
+
+bool AdvertisementCodec::decodeServiceUuid(const uint8_t* data, size_t length, DeviceId& out) {
+    // 0000xxxx-0000-1000-8000-00805f9b34fb
+    static const uint8_t kBaseUuid[DeviceId::kSize] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00,
+                                                       0x80, 0x00, 0x00, 0x80, 0x5f, 0x9b, 0x34, 0xfb};
+    size_t offset = 0;
+    while (offset < length) {
+        size_t structureLength = data[offset];
+        if (structureLength == 0) {
+            break;
+        }
+        if (offset + 1 + structureLength > length) {
+            return false;
+        }
+        uint8_t type = data[offset + 1];
+        const uint8_t* body = data + offset + 2;
+        size_t bodyLength = structureLength - 1;
+        uint8_t bytes[DeviceId::kSize];
+        if ((type == kAdTypeCompleteServices128 || type == kAdTypeIncompleteServices128) &&
+            bodyLength >= DeviceId::kSize) {
+            // Little-endian on air
+            for (size_t i = 0; i < DeviceId::kSize; ++i) {
+                bytes[i] = body[DeviceId::kSize - 1 - i];
+            }
+            out = DeviceId::fromBytes(bytes);
+            return true;
+        }
+        if ((type == kAdTypeCompleteServices16 || type == kAdTypeIncompleteServices16) && bodyLength >= 2) {
+            std::memcpy(bytes, kBaseUuid, sizeof(bytes));
+            bytes[2] = body[1];
+            bytes[3] = body[0];
+            out = DeviceId::fromBytes(bytes);
+            return true;
+        }
+        offset += 1 + structureLength;
+    }
+    return false;
+}
+
+} // namespace PassBy
@@ -0,0 +1,169 @@
+#include "PassBy/CallbackExecutor.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace PassBy {
+
+namespace {
+
+class InlineExecutor : public CallbackExecutor {
+public:
+    void execute(const DeviceId&, std::function<void()> task) override {
+        task();
+    }
+};
+
+class ThreadPoolExecutor : public CallbackExecutor {
+public:
+    explicit ThreadPoolExecutor(const ExecutorOptions& options)
+        : m_capacity(std::max<size_t>(options.queueCapacity, 1)), m_policy(options.backpressure),
+          m_stopping(false), m_submitted(0), m_finished(0), m_dropped(0) {
+        size_t threads = std::max<size_t>(options.threads, 1);
+        for (size_t i = 0; i < threads; ++i) {
+            m_threads.emplace_back(&ThreadPoolExecutor::workerLoop, this);
+        }
+    }
+
+    ~ThreadPoolExecutor() override {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_ready.notify_all();
+        m_room.notify_all();
+        // Workers run what is still queued before exiting
+        for (auto& thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    void execute(const DeviceId& key, std::function<void()> task) override {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        ++m_submitted;
+
+        bool coalesce = m_policy == BackpressurePolicy::CoalesceByDevice && !key.isNull();
+        if (coalesce) {
+            auto pending = m_pending.find(key);
+            if (pending != m_pending.end()) {
+                // The newer report supersedes the queued one, keeping its place in line
+                pending->second->task = std::move(task);
+                dropLocked();
+                return;
+            }
+        }
+
+        if (m_queue.size() >= m_capacity) {
+            switch (m_policy) {
+                case BackpressurePolicy::Block:
+                    m_room.wait(lock, [this] { return m_queue.size() < m_capacity || m_stopping; });
+                    break;
+                case BackpressurePolicy::DropNewest:
+                    dropLocked();
+                    return;
+                case BackpressurePolicy::DropOldest:
+                case BackpressurePolicy::CoalesceByDevice:
+                    forget(m_queue.front());
+                    m_queue.pop_front();
+                    dropLocked();
+                    break;
+            }
+        }
+
+        m_queue.push_back(Entry{key, std::move(task)});
+        if (coalesce) {
+            m_pending[key] = std::prev(m_queue.end());
+        }
+        lock.unlock();
+        m_ready.notify_one();
+    }
+
+    void drain() override {
+        if (isExecutorThread()) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        uint64_t target = m_submitted;
+        m_idle.wait(lock, [&] { return m_finished >= target; });
+    }
+
+    bool isExecutorThread() const override {
+        std::thread::id self = std::this_thread::get_id();
+        return std::any_of(m_threads.begin(), m_threads.end(),
+                           [self](const std::thread& thread) { return thread.get_id() == self; });
+    }
+
+    uint64_t droppedCount() const override {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Entry {
+        DeviceId key;
+        std::function<void()> task;
+    };
+
+    void forget(const Entry& entry) {
+        if (m_policy == BackpressurePolicy::CoalesceByDevice && !entry.key.isNull()) {
+            m_pending.erase(entry.key);
+        }
+    }
+
+    void dropLocked() {
+        ++m_finished;
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        m_idle.notify_all();
+    }
+
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;) {
+            m_ready.wait(lock, [this] { return !m_queue.empty() || m_stopping; });
+            if (m_queue.empty()) {
+                return;
+            }
+            Entry entry = std::move(m_queue.front());
+            forget(entry);
+            m_queue.pop_front();
+            lock.unlock();
+            m_room.notify_one();
+
+            entry.task();
+
+            lock.lock();
+            ++m_finished;
+            m_idle.notify_all();
+        }
+    }
+
+    const size_t m_capacity;
+    const BackpressurePolicy m_policy;
+    std::mutex m_mutex;
+    std::condition_variable m_ready;    // Workers: a task was queued
+    std::condition_variable m_room;     // Block: a slot was freed
+    std::condition_variable m_idle;     // drain(): a task finished or was dropped
+    std::list<Entry> m_queue;
+    std::unordered_map<DeviceId, std::list<Entry>::iterator, DeviceIdHash> m_pending;  // CoalesceByDevice
+    bool m_stopping;
+    uint64_t m_submitted;
+    uint64_t m_finished;
+    std::atomic<uint64_t> m_dropped;
+    std::vector<std::thread> m_threads;
+};
+
+} // namespace
+
+std::shared_ptr<CallbackExecutor> CallbackExecutor::inlineExecutor() {
+    return std::make_shared<InlineExecutor>();
+}
+
+std::shared_ptr<CallbackExecutor> CallbackExecutor::threadPool(const ExecutorOptions& options) {
+    return std::make_shared<ThreadPoolExecutor>(options);
+}
+
+} // namespace PassBy
@@ -0,0 +1,134 @@
+#include "../internal/ConnectionScheduler.h"
+#include <algorithm>
+
+namespace PassBy {
+
+// Ranking: one dB of signal is worth this many ms of recency
+static constexpr int64_t kRecencyMsPerDb = 250;
+
+ConnectionScheduler::ConnectionScheduler()
+    : m_maxConcurrent(0), m_timeoutMs(0), m_initialBackoffMs(0), m_maxBackoffMs(0), m_lifetimeMs(0),
+      m_maxTracked(0), m_inFlight(0), m_changed(false), m_nextDeadlineMs(kNoDeadline), m_ignored(0) {
+    configure(ConnectionPolicy());
+}
+
+void ConnectionScheduler::configure(const ConnectionPolicy& policy) {
+    m_maxConcurrent = std::max<size_t>(policy.maxConcurrentConnections, 1);
+    m_timeoutMs = std::max<int64_t>(policy.connectionTimeout.count(), 1);
+    m_initialBackoffMs = std::max<int64_t>(policy.initialBackoff.count(), 0);
+    m_maxBackoffMs = std::max<int64_t>(policy.maxBackoff.count(), m_initialBackoffMs);
+    m_lifetimeMs = std::max<int64_t>(policy.candidateLifetime.count(), 1);
+    m_maxTracked = std::max<size_t>(policy.maxTrackedPeripherals, m_maxConcurrent);
+    m_changed = true;
+}
+
+void ConnectionScheduler::onAdvertisement(const DeviceId& peripheral, int rssi, int64_t nowMs) {
+    Peripheral* state = m_peripherals.find(peripheral);
+    if (!state) {
+        if (m_peripherals.size() >= m_maxTracked) {
+            ++m_ignored;
+            return;
+        }
+        state = m_peripherals.insert(peripheral).first;
+    }
+    state->lastSeenMs = std::max(state->lastSeenMs, nowMs);
+    state->rssi = static_cast<int16_t>(rssi);
+    if (!state->connecting && m_inFlight < m_maxConcurrent) {
+        m_changed = true;
+    }
+}
+
+bool ConnectionScheduler::onResolved(const DeviceId& peripheral, int* rssi) {
+    Peripheral* state = m_peripherals.find(peripheral);
+    if (state && rssi) {
+        *rssi = state->rssi;
+    }
+    if (!state || !state->connecting) {
+        return false;
+    }
+    --m_inFlight;
+    m_peripherals.erase(peripheral);
+    m_changed = true;
+    return true;
+}
+
+void ConnectionScheduler::onFailed(const DeviceId& peripheral, int64_t nowMs) {
+    Peripheral* state = m_peripherals.find(peripheral);
+    if (state && state->connecting) {
+        fail(*state, nowMs);
+    }
+}
+
+void ConnectionScheduler::fail(Peripheral& state, int64_t nowMs) {
+    state.connecting = false;
+    ++state.failures;
+    state.notBeforeMs = nowMs + backoffMs(state.failures);
+    --m_inFlight;
+    m_changed = true;
+}
+
+int64_t ConnectionScheduler::backoffMs(uint32_t failures) const {
+    int64_t delay = m_initialBackoffMs;
+    for (uint32_t i = 1; i < failures && delay < m_maxBackoffMs; ++i) {
+        delay *= 2;
+    }
+    return std::min(delay, m_maxBackoffMs);
+}
+
+void ConnectionScheduler::poll(int64_t nowMs) {
+    m_toConnect.clear();
+    m_timedOut.clear();
+    m_ranked.clear();
+    m_stale.clear();
+    m_nextDeadlineMs = kNoDeadline;
+
+    m_peripherals.forEach([&](const DeviceId& peripheral, Peripheral& state) {
+        if (state.connecting) {
+            if (nowMs >= state.deadlineMs) {
+                m_timedOut.push_back(peripheral);
+                fail(state, nowMs);
+            } else {
+                m_nextDeadlineMs = std::min(m_nextDeadlineMs, state.deadlineMs);
+                return;
+            }
+        }
+
+        bool fresh = nowMs - state.lastSeenMs < m_lifetimeMs;
+        if (!fresh) {
+            // Out of range; keep it only while its backoff still matters
+            if (nowMs >= state.notBeforeMs) {
+                m_stale.push_back(peripheral);
+            }
+            return;
+        }
+        if (nowMs < state.notBeforeMs) {
+            m_nextDeadlineMs = std::min(m_nextDeadlineMs, state.notBeforeMs);
+            return;
+        }
+        int64_t score = state.rssi * kRecencyMsPerDb - (nowMs - state.lastSeenMs);
+        m_ranked.emplace_back(score, peripheral);
+    });
+
+    for (const DeviceId& peripheral : m_stale) {
+        m_peripherals.erase(peripheral);
+    }
+
+    size_t slots = m_maxConcurrent > m_inFlight ? m_maxConcurrent - m_inFlight : 0;
+    size_t count = std::min(slots, m_ranked.size());
+    std::partial_sort(m_ranked.begin(), m_ranked.begin() + count, m_ranked.end(),
+                      [](const std::pair<int64_t, DeviceId>& a, const std::pair<int64_t, DeviceId>& b) {
+                          return a.first != b.first ? a.first > b.first : a.second < b.second;
+                      });
+    for (size_t i = 0; i < count; ++i) {
+        Peripheral* state = m_peripherals.find(m_ranked[i].second);
+        state->connecting = true;
+        state->deadlineMs = nowMs + m_timeoutMs;
+        m_nextDeadlineMs = std::min(m_nextDeadlineMs, state->deadlineMs);
+        ++m_inFlight;
+        m_toConnect.push_back(m_ranked[i].second);
+    }
+    // Timeouts above are handled by this pass already
+    m_changed = false;
+}
+
+} // namespace PassBy
@@ -0,0 +1,120 @@
+#include "PassBy/DeviceId.h"
+
+namespace PassBy {
+
+namespace {
+
+// Character offsets of the hyphens in 8-4-4-4-12 form
+bool isHyphenPosition(size_t index) {
+    return index == 8 || index == 13 || index == 18 || index == 23;
+}
+
+// Nibble value per character: 0-15 for uppercase hex, 16-31 for lowercase hex, 0xFF otherwise
+struct HexTable {
+    uint8_t values[256];
+
+    HexTable() {
+        for (auto& v : values) v = 0xFF;
+        for (int c = '0'; c <= '9'; ++c) values[c] = static_cast<uint8_t>(c - '0');
+        for (int c = 'A'; c <= 'F'; ++c) values[c] = static_cast<uint8_t>(c - 'A' + 10);
+        for (int c = 'a'; c <= 'f'; ++c) values[c] = static_cast<uint8_t>(c - 'a' + 26);
+    }
+};
+
+const HexTable kHexTable;
+
+int hexValue(char c, bool allowLowercase) {
+    uint8_t value = kHexTable.values[static_cast<uint8_t>(c)];
+    if (value < 16) return value;
+    if (allowLowercase && value < 32) return value - 16;
+    return -1;
+}
+
+bool parseUUID(std::string_view text, bool allowLowercase, uint8_t* out) {
+    if (text.size() != DeviceId::kStringLength) {
+        return false;
+    }
+
+    size_t byteIndex = 0;
+    for (size_t i = 0; i < DeviceId::kStringLength;) {
+        if (isHyphenPosition(i)) {
+            if (text[i] != '-') {
+                return false;
+            }
+            ++i;
+            continue;
+        }
+        int high = hexValue(text[i], allowLowercase);
+        int low = hexValue(text[i + 1], allowLowercase);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        out[byteIndex++] = static_cast<uint8_t>((high << 4) | low);
+        i += 2;
+    }
+    return true;
+}
+
+// 64-bit hash over arbitrary bytes (multiply-xorshift per 8-byte lane)
+uint64_t hashBytes(std::string_view text, uint64_t seed) {
+    uint64_t h = seed ^ (text.size() * 0x9E3779B97F4A7C15ULL);
+    size_t i = 0;
+    for (; i + 8 <= text.size(); i += 8) {
+        uint64_t lane;
+        std::memcpy(&lane, text.data() + i, sizeof(lane));
+        h = (h ^ lane) * 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 33;
+    }
+    uint64_t tail = 0;
+    for (size_t shift = 0; i < text.size(); ++i, shift += 8) {
+        tail |= static_cast<uint64_t>(static_cast<uint8_t>(text[i])) << shift;
+    }
+    h = (h ^ tail) * 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 29;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 32;
+    return h;
+}
+
+} // namespace
+
+bool DeviceId::parse(std::string_view text, DeviceId& out) {
+    return parseUUID(text, true, out.m_bytes);
+}
+
+DeviceId DeviceId::fromString(std::string_view text, bool* isCanonical) {
+    DeviceId id;
+    bool canonical = parseUUID(text, false, id.m_bytes);
+    if (!canonical) {
+        uint64_t high = hashBytes(text, 0x243F6A8885A308D3ULL);
+        uint64_t low = hashBytes(text, 0x13198A2E03707344ULL);
+        std::memcpy(id.m_bytes, &high, sizeof(high));
+        std::memcpy(id.m_bytes + 8, &low, sizeof(low));
+    }
+    if (isCanonical) {
+        *isCanonical = canonical;
+    }
+    return id;
+}
+
+void DeviceId::format(char* out) const {
+    static const char kHexDigits[] = "0123456789ABCDEF";
+    size_t byteIndex = 0;
+    for (size_t i = 0; i < kStringLength;) {
+        if (isHyphenPosition(i)) {
+            out[i++] = '-';
+            continue;
+        }
+        out[i++] = kHexDigits[m_bytes[byteIndex] >> 4];
+        out[i++] = kHexDigits[m_bytes[byteIndex] & 0x0F];
+        ++byteIndex;
+    }
+}
+
+std::string DeviceId::toString() const {
+    std::string result(kStringLength, '\0');
+    format(&result[0]);
+    return result;
+}
+
+} // namespace PassBy
@@ -0,0 +1,51 @@
+#include "../internal/DiscoveryBatcher.h"
+#include "../internal/EncounterStore.h"
+
+namespace PassBy {
+
+DiscoveryBatcher::DiscoveryBatcher()
+    : m_count(0), m_eventCount(0), m_batchStartMs(0), m_flushIntervalMs(0), m_maxEvents(1) {}
+
+void DiscoveryBatcher::configure(int64_t flushIntervalMs, size_t maxEvents) {
+    m_flushIntervalMs = flushIntervalMs > 0 ? flushIntervalMs : 0;
+    m_maxEvents = maxEvents > 0 ? maxEvents : 1;
+}
+
+bool DiscoveryBatcher::add(const EncounterRecord& record, const EncounterStore& store, int64_t nowMs) {
+    using std::chrono::milliseconds;
+    using std::chrono::system_clock;
+
+    if (m_count == 0) {
+        m_batchStartMs = nowMs;
+    }
+    ++m_eventCount;
+
+    auto inserted = m_index.insert(record.id);
+    if (inserted.second) {
+        *inserted.first = static_cast<uint32_t>(m_count);
+        if (m_count == m_entries.size()) {
+            m_entries.emplace_back();
+        }
+        ++m_count;
+    }
+
+    // Repeat sightings overwrite the entry with the store's latest state
+    EncounterInfo& entry = m_entries[*inserted.first];
+    if (inserted.second) {
+        store.identifierString(record, entry.uuid);
+        entry.id = record.id;
+    }
+    entry.firstSeen = system_clock::time_point(milliseconds(record.firstSeenMs));
+    entry.lastSeen = system_clock::time_point(milliseconds(record.lastSeenMs));
+    entry.hitCount = record.hitCount;
+
+    return m_eventCount >= m_maxEvents;
+}
+
+void DiscoveryBatcher::reset() {
+    m_count = 0;
+    m_eventCount = 0;
+    m_index.clear(false);
+}
+
+} // namespace PassBy
@@ -0,0 +1,84 @@
+#include "../internal/DutyCycleController.h"
+#include <algorithm>
+
+namespace PassBy {
+
+DutyCycleController::DutyCycleController()
+    : m_windowMs(0), m_maxWindowMs(0), m_targetLatencyMs(0), m_maxLatencyMs(0), m_running(false),
+      m_radioOn(false), m_windowStartMs(0), m_windowEndMs(0), m_nextStartMs(0), m_periodMs(0),
+      m_newInWindow(0), m_windows(0) {
+    configure(DutyCycleOptions());
+}
+
+void DutyCycleController::configure(const DutyCycleOptions& options) {
+    m_windowMs = std::max<int64_t>(options.window.count(), 1);
+    m_maxWindowMs = std::max<int64_t>(options.maxWindow.count(), m_windowMs);
+    m_targetLatencyMs = std::max<int64_t>(options.targetLatency.count(), m_windowMs);
+    m_maxLatencyMs = std::max<int64_t>(options.maxLatency.count(), m_targetLatencyMs);
+    m_periodMs = std::min(std::max(m_periodMs, m_targetLatencyMs), m_maxLatencyMs);
+}
+
+void DutyCycleController::start(int64_t nowMs) {
+    m_running = true;
+    m_periodMs = m_targetLatencyMs;
+    m_windows = 0;
+    openWindow(nowMs);
+}
+
+void DutyCycleController::stop() {
+    m_running = false;
+    m_radioOn = false;
+}
+
+void DutyCycleController::openWindow(int64_t nowMs) {
+    m_radioOn = true;
+    m_windowStartMs = nowMs;
+    m_windowEndMs = nowMs + m_windowMs;
+    m_newInWindow = 0;
+    ++m_windows;
+}
+
+void DutyCycleController::onNewPeer(int64_t nowMs) {
+    if (!m_running || !m_radioOn) {
+        return;
+    }
+    ++m_newInWindow;
+    // Keep listening while the neighbourhood is still changing
+    m_windowEndMs = std::max(m_windowEndMs, std::min(nowMs + m_windowMs, m_windowStartMs + m_maxWindowMs));
+}
+
+DutyCycleController::Action DutyCycleController::poll(int64_t nowMs) {
+    if (!m_running) {
+        return Action::None;
+    }
+
+    if (m_radioOn) {
+        if (nowMs < m_windowEndMs) {
+            return Action::None;
+        }
+        m_periodMs = m_newInWindow > 0 ? m_targetLatencyMs : std::min(m_periodMs * 2, m_maxLatencyMs);
+        m_nextStartMs = std::max(m_windowStartMs + m_periodMs, m_windowEndMs);
+        if (nowMs >= m_nextStartMs) {
+            // No gap left between windows; stay on rather than toggling the radio
+            openWindow(nowMs);
+            return Action::None;
+        }
+        m_radioOn = false;
+        return Action::RadioOff;
+    }
+
+    if (nowMs < m_nextStartMs) {
+        return Action::None;
+    }
+    openWindow(nowMs);
+    return Action::RadioOn;
+}
+
+int64_t DutyCycleController::nextDeadlineMs() const {
+    if (!m_running) {
+        return kNoDeadline;
+    }
+    return m_radioOn ? m_windowEndMs : m_nextStartMs;
+}
+
+} // namespace PassBy
@@ -0,0 +1,105 @@
+#include "../internal/EncounterAggregator.h"
+
+namespace PassBy {
+
+namespace {
+
+// Red-black tree node around an index key (three pointers and the colour)
+constexpr size_t kIndexNodeOverhead = 4 * sizeof(void*);
+
+} // namespace
+
+EncounterAggregator::EncounterAggregator(int64_t sessionGapMs, double rssiSmoothing, size_t maxDevices)
+    : m_sessionGapMs(sessionGapMs), m_rssiSmoothing(rssiSmoothing), m_maxDevices(maxDevices), m_aliasBytes(0) {}
+
+EncounterAggregator::Key EncounterAggregator::keyFor(EncounterRanking ranking, const DeviceId& id,
+                                                     const EncounterAggregate& aggregate) {
+    switch (ranking) {
+        case EncounterRanking::MostFrequent:
+            return Key{aggregate.visits, static_cast<int64_t>(aggregate.sightings), id};
+        case EncounterRanking::LongestDwell:
+            return Key{aggregate.dwellMs(), aggregate.lastSeenMs, id};
+        case EncounterRanking::MostRecent:
+            break;
+    }
+    return Key{aggregate.lastSeenMs, 0, id};
+}
+
+void EncounterAggregator::record(const DeviceId& id, int64_t nowMs, bool hasRssi, int rssi, std::string_view alias) {
+    EncounterAggregate* aggregate = m_devices.find(id);
+    if (!aggregate) {
+        if (m_maxDevices > 0 && m_devices.size() >= m_maxDevices) {
+            evictLeastRecent();
+        }
+        aggregate = m_devices.insert(id).first;
+        aggregate->firstSeenMs = nowMs;
+        aggregate->lastSeenMs = nowMs;
+        aggregate->visitStartMs = nowMs;
+        aggregate->closedDwellMs = 0;
+        aggregate->sightings = 1;
+        aggregate->visits = 1;
+        aggregate->hasRssi = hasRssi;
+        aggregate->rssi = hasRssi ? rssi : 0;
+        aggregate->alias.assign(alias);
+        m_aliasBytes += aggregate->alias.size();
+        for (size_t i = 0; i < kEncounterRankingCount; ++i) {
+            m_indexes[i].insert(keyFor(static_cast<EncounterRanking>(i), id, *aggregate));
+        }
+        return;
+    }
+
+    // Take the entries out under their old keys, re-key them in place afterwards
+    Index::node_type nodes[kEncounterRankingCount];
+    for (size_t i = 0; i < kEncounterRankingCount; ++i) {
+        nodes[i] = m_indexes[i].extract(keyFor(static_cast<EncounterRanking>(i), id, *aggregate));
+    }
+
+    if (nowMs - aggregate->lastSeenMs > m_sessionGapMs) {
+        aggregate->closedDwellMs += aggregate->lastSeenMs - aggregate->visitStartMs;
+        aggregate->visitStartMs = nowMs;
+        ++aggregate->visits;
+    }
+    // A clock stepping back counts towards the current visit without shortening it
+    if (nowMs > aggregate->lastSeenMs) {
+        aggregate->lastSeenMs = nowMs;
+    }
+    ++aggregate->sightings;
+    if (hasRssi) {
+        aggregate->rssi = aggregate->hasRssi ? aggregate->rssi + m_rssiSmoothing * (rssi - aggregate->rssi) : rssi;
+        aggregate->hasRssi = true;
+    }
+
+    for (size_t i = 0; i < kEncounterRankingCount; ++i) {
+        nodes[i].value() = keyFor(static_cast<EncounterRanking>(i), id, *aggregate);
+        m_indexes[i].insert(std::move(nodes[i]));
+    }
+}
+
+void EncounterAggregator::evictLeastRecent() {
+    const Index& recency = m_indexes[static_cast<size_t>(EncounterRanking::MostRecent)];
+    if (recency.empty()) {
+        return;
+    }
+    DeviceId victim = recency.rbegin()->id;
+    EncounterAggregate* aggregate = m_devices.find(victim);
+    for (size_t i = 0; i < kEncounterRankingCount; ++i) {
+        m_indexes[i].erase(keyFor(static_cast<EncounterRanking>(i), victim, *aggregate));
+    }
+    m_aliasBytes -= aggregate->alias.size();
+    m_devices.erase(victim);
+}
+
+void EncounterAggregator::clear() {
+    m_devices.clear();
+    for (auto& index : m_indexes) {
+        index.clear();
+    }
+    m_aliasBytes = 0;
+}
+
+size_t EncounterAggregator::memoryUsage() const {
+    return m_devices.memoryUsage() + m_aliasBytes +
+           m_devices.size() * kEncounterRankingCount * (sizeof(Key) + kIndexNodeOverhead);
+}
+
+} // namespace PassBy
@@ -0,0 +1,278 @@
+#include "PassBy/EncounterExport.h"
+#include <chrono>
+#include <cstring>
+
+namespace PassBy {
+
+namespace {
+
+constexpr char kMagic[8] = {'P', 'B', 'Y', 'E', 'N', 'C', 'E', 'X'};
+constexpr uint32_t kFormatVersion = 1;
+constexpr size_t kHeaderSize = 32;
+constexpr size_t kMaxVarintLength = 10;
+
+void putFixed(std::vector<uint8_t>& out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void putSigned(std::vector<uint8_t>& out, int64_t value) {
+    putVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+int64_t toMs(std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
+// Reads from a buffer that may end mid-record: running out sets `incomplete`, a
+// value no writer produces sets `malformed`
+class Cursor {
+public:
+    Cursor(const uint8_t* data, size_t size) : m_data(data), m_size(size), m_offset(0) {}
+
+    bool incomplete = false;
+    bool malformed = false;
+
+    bool ok() const { return !incomplete && !malformed; }
+    size_t offset() const { return m_offset; }
+
+    const uint8_t* bytes(size_t length) {
+        if (!ok() || length > m_size - m_offset) {
+            incomplete = incomplete || !malformed;
+            return nullptr;
+        }
+        const uint8_t* start = m_data + m_offset;
+        m_offset += length;
+        return start;
+    }
+
+    uint64_t fixed(size_t length) {
+        const uint8_t* start = bytes(length);
+        uint64_t value = 0;
+        for (size_t i = 0; start && i < length; ++i) {
+            value |= uint64_t(start[i]) << (8 * i);
+        }
+        return value;
+    }
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (size_t i = 0; i < kMaxVarintLength; ++i) {
+            const uint8_t* b = bytes(1);
+            if (!b) {
+                return 0;
+            }
+            value |= uint64_t(*b & 0x7F) << (7 * i);
+            if (!(*b & 0x80)) {
+                return value;
+            }
+        }
+        malformed = true;
+        return 0;
+    }
+
+    int64_t signedVarint() {
+        uint64_t value = varint();
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_offset;
+};
+
+} // namespace
+
+EncounterExportWriter::EncounterExportWriter(ExportSink sink, size_t chunkSize)
+    : m_sink(std::move(sink)), m_chunkSize(chunkSize > 0 ? chunkSize : 1), m_expected(0), m_added(0),
+      m_bytesWritten(0), m_baseMs(0), m_failed(false) {
+    m_buffer.reserve(m_chunkSize + kHeaderSize);
+}
+
+bool EncounterExportWriter::begin(uint64_t count, int64_t baseMs) {
+    m_expected = count;
+    m_baseMs = baseMs;
+    m_buffer.insert(m_buffer.end(), kMagic, kMagic + sizeof(kMagic));
+    putFixed(m_buffer, kFormatVersion, 4);
+    putFixed(m_buffer, 0, 4);
+    putFixed(m_buffer, count, 8);
+    putFixed(m_buffer, static_cast<uint64_t>(baseMs), 8);
+    return m_buffer.size() < m_chunkSize || flush();
+}
+
+bool EncounterExportWriter::add(const EncounterView& encounter) {
+    if (m_failed || m_added == m_expected || (m_added > 0 && !(m_lastId < encounter.id))) {
+        m_failed = true;
+        return false;
+    }
+    m_lastId = encounter.id;
+    ++m_added;
+
+    int64_t firstSeenMs = toMs(encounter.firstSeen);
+    if (firstSeenMs < m_baseMs) {
+        m_failed = true;
+        return false;
+    }
+
+    char canonical[DeviceId::kStringLength];
+    encounter.id.format(canonical);
+    bool hasAlias = !encounter.uuid.empty() && encounter.uuid != std::string_view(canonical, sizeof(canonical));
+    if (hasAlias && encounter.uuid.size() > EncounterExportDecoder::kMaxAliasLength) {
+        m_failed = true;
+        return false;
+    }
+
+    m_buffer.insert(m_buffer.end(), encounter.id.bytes(), encounter.id.bytes() + DeviceId::kSize);
+    putVarint(m_buffer, static_cast<uint64_t>(firstSeenMs - m_baseMs));
+    putSigned(m_buffer, toMs(encounter.lastSeen) - firstSeenMs);
+    putVarint(m_buffer, (uint64_t(encounter.hitCount) << 1) | (hasAlias ? 1 : 0));
+    if (hasAlias) {
+        putVarint(m_buffer, encounter.uuid.size());
+        m_buffer.insert(m_buffer.end(), encounter.uuid.begin(), encounter.uuid.end());
+    }
+    return m_buffer.size() < m_chunkSize || flush();
+}
+
+bool EncounterExportWriter::finish() {
+    return flush() && m_added == m_expected;
+}
+
+bool EncounterExportWriter::flush() {
+    if (m_failed) {
+        return false;
+    }
+    if (!m_buffer.empty()) {
+        if (!m_sink(m_buffer.data(), m_buffer.size())) {
+            m_failed = true;
+            return false;
+        }
+        m_bytesWritten += m_buffer.size();
+        m_buffer.clear();
+    }
+    return true;
+}
+
+EncounterExportDecoder::EncounterExportDecoder()
+    : m_expected(0), m_decoded(0), m_baseMs(0), m_haveHeader(false), m_failed(false) {}
+
+bool EncounterExportDecoder::feed(const uint8_t* data, size_t size,
+                                  const std::function<void(const EncounterView&)>& onEncounter) {
+    if (m_failed) {
+        return false;
+    }
+
+    // Decode straight from the input unless a partial record is waiting to be completed
+    const uint8_t* input = data;
+    size_t length = size;
+    if (!m_buffer.empty()) {
+        m_buffer.insert(m_buffer.end(), data, data + size);
+        input = m_buffer.data();
+        length = m_buffer.size();
+    }
+
+    size_t offset = 0;
+    while (offset < length) {
+        if (m_haveHeader && m_decoded == m_expected) {
+            // Bytes past the last announced record
+            m_failed = true;
+            return false;
+        }
+        size_t used = m_haveHeader ? decodeRecord(input + offset, length - offset, onEncounter)
+                                   : decodeHeader(input + offset, length - offset);
+        if (m_failed) {
+            return false;
+        }
+        if (used == 0) {
+            break;
+        }
+        offset += used;
+    }
+
+    if (input == m_buffer.data()) {
+        m_buffer.erase(m_buffer.begin(), m_buffer.begin() + offset);
+    } else {
+        m_buffer.assign(input + offset, input + length);
+    }
+    return true;
+}
+
+bool EncounterExportDecoder::finished() const {
+    return !m_failed && m_haveHeader && m_decoded == m_expected && m_buffer.empty();
+}
+
+size_t EncounterExportDecoder::decodeHeader(const uint8_t* data, size_t size) {
+    if (size < kHeaderSize) {
+        return 0;
+    }
+    Cursor in(data, size);
+    const uint8_t* magic = in.bytes(sizeof(kMagic));
+    uint32_t version = static_cast<uint32_t>(in.fixed(4));
+    in.fixed(4);
+    m_expected = in.fixed(8);
+    m_baseMs = static_cast<int64_t>(in.fixed(8));
+    if (std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 || version != kFormatVersion) {
+        m_failed = true;
+        return 0;
+    }
+    m_haveHeader = true;
+    return kHeaderSize;
+}
+
+size_t EncounterExportDecoder::decodeRecord(const uint8_t* data, size_t size,
+                                            const std::function<void(const EncounterView&)>& onEncounter) {
+    using std::chrono::milliseconds;
+    using std::chrono::system_clock;
+
+    Cursor in(data, size);
+    const uint8_t* idBytes = in.bytes(DeviceId::kSize);
+    uint64_t firstOffset = in.varint();
+    int64_t duration = in.signedVarint();
+    uint64_t countAndFlag = in.varint();
+    std::string_view alias;
+    if (in.ok() && (countAndFlag & 1)) {
+        uint64_t aliasLength = in.varint();
+        if (in.ok() && aliasLength > kMaxAliasLength) {
+            in.malformed = true;
+        }
+        const uint8_t* text = in.bytes(static_cast<size_t>(aliasLength));
+        if (text) {
+            alias = std::string_view(reinterpret_cast<const char*>(text), static_cast<size_t>(aliasLength));
+        }
+    }
+    if (in.malformed || (in.ok() && (countAndFlag >> 1) > UINT32_MAX)) {
+        m_failed = true;
+        return 0;
+    }
+    if (in.incomplete) {
+        return 0;
+    }
+
+    EncounterView view;
+    view.id = DeviceId::fromBytes(idBytes);
+    if (alias.empty()) {
+        m_uuid.resize(DeviceId::kStringLength);
+        view.id.format(&m_uuid[0]);
+        view.uuid = m_uuid;
+    } else {
+        view.uuid = alias;
+    }
+    int64_t firstSeenMs = m_baseMs + static_cast<int64_t>(firstOffset);
+    view.firstSeen = system_clock::time_point(milliseconds(firstSeenMs));
+    view.lastSeen = system_clock::time_point(milliseconds(firstSeenMs + duration));
+    view.hitCount = static_cast<uint32_t>(countAndFlag >> 1);
+    ++m_decoded;
+    onEncounter(view);
+    return in.offset();
+}
+
+} // namespace PassBy
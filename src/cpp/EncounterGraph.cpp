@@ -0,0 +1,284 @@
+#include "PassBy/EncounterGraph.h"
+#include "../internal/DeviceIdTable.h"
+#include "../internal/Parallel.h"
+#include <algorithm>
+#include <chrono>
+#include <unordered_set>
+
+namespace PassBy {
+
+namespace {
+
+constexpr size_t kMinPerThread = 4096;
+
+int64_t toMs(std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
+uint32_t clampDuration(int64_t durationMs) {
+    return static_cast<uint32_t>(std::min<int64_t>(std::max<int64_t>(durationMs, 0), UINT32_MAX));
+}
+
+} // namespace
+
+EncounterGraph::EncounterGraph() : m_nodeIndex(new DeviceIdTable<uint32_t>()) {}
+
+EncounterGraph::~EncounterGraph() = default;
+EncounterGraph::EncounterGraph(EncounterGraph&&) noexcept = default;
+EncounterGraph& EncounterGraph::operator=(EncounterGraph&&) noexcept = default;
+
+bool EncounterGraph::findNode(const DeviceId& node, uint32_t* index) const {
+    const uint32_t* found = m_nodeIndex ? m_nodeIndex->find(node) : nullptr;
+    if (found) {
+        *index = *found;
+    }
+    return found != nullptr;
+}
+
+bool EncounterGraph::contains(const DeviceId& node) const {
+    uint32_t index;
+    return findNode(node, &index);
+}
+
+const EncounterGraph::Interval* EncounterGraph::firstInWindow(uint32_t edge, const TimeWindow& window) const {
+    // Merged intervals are disjoint, so their ends are sorted like their starts
+    const Interval* begin = m_intervals.data() + m_intervalOffsets[edge];
+    const Interval* end = m_intervals.data() + m_intervalOffsets[edge + 1];
+    return std::partition_point(begin, end, [&](const Interval& interval) {
+        return interval.startMs + interval.durationMs < window.fromMs;
+    });
+}
+
+bool EncounterGraph::isActive(uint32_t edge, const TimeWindow& window) const {
+    const Interval* first = firstInWindow(edge, window);
+    return first != m_intervals.data() + m_intervalOffsets[edge + 1] && first->startMs < window.toMs;
+}
+
+std::vector<GraphContact> EncounterGraph::contacts(const DeviceId& node, const TimeWindow& window) const {
+    std::vector<GraphContact> contacts;
+    uint32_t index;
+    if (!findNode(node, &index)) {
+        return contacts;
+    }
+    for (uint64_t i = m_adjacencyOffsets[index]; i < m_adjacencyOffsets[index + 1]; ++i) {
+        const Adjacent& adjacent = m_adjacency[i];
+        const Interval* end = m_intervals.data() + m_intervalOffsets[adjacent.edge + 1];
+        GraphContact contact;
+        for (const Interval* interval = firstInWindow(adjacent.edge, window);
+             interval != end && interval->startMs < window.toMs; ++interval) {
+            int64_t from = std::max(interval->startMs, window.fromMs);
+            int64_t to = std::min(interval->startMs + interval->durationMs, window.toMs);
+            ++contact.encounters;
+            contact.overlapMs += std::max<int64_t>(to - from, 0);
+            contact.hits += interval->hits;
+        }
+        if (contact.encounters > 0) {
+            contact.id = m_nodes[adjacent.node];
+            contacts.push_back(contact);
+        }
+    }
+    return contacts;
+}
+
+size_t EncounterGraph::contactCount(const DeviceId& node, const TimeWindow& window) const {
+    uint32_t index;
+    if (!findNode(node, &index)) {
+        return 0;
+    }
+    size_t count = 0;
+    for (uint64_t i = m_adjacencyOffsets[index]; i < m_adjacencyOffsets[index + 1]; ++i) {
+        count += isActive(m_adjacency[i].edge, window) ? 1 : 0;
+    }
+    return count;
+}
+
+std::vector<GraphNeighbour> EncounterGraph::neighbourhood(const DeviceId& node, size_t hops,
+                                                          const TimeWindow& window) const {
+    std::vector<GraphNeighbour> reached;
+    uint32_t start;
+    if (!findNode(node, &start)) {
+        return reached;
+    }
+
+    // Breadth-first, one frontier per hop
+    std::unordered_set<uint32_t> visited{start};
+    std::vector<uint32_t> frontier{start};
+    std::vector<uint32_t> next;
+    for (uint32_t hop = 1; hop <= hops && !frontier.empty(); ++hop) {
+        next.clear();
+        for (uint32_t current : frontier) {
+            for (uint64_t i = m_adjacencyOffsets[current]; i < m_adjacencyOffsets[current + 1]; ++i) {
+                const Adjacent& adjacent = m_adjacency[i];
+                if (isActive(adjacent.edge, window) && visited.insert(adjacent.node).second) {
+                    next.push_back(adjacent.node);
+                    reached.push_back(GraphNeighbour{m_nodes[adjacent.node], hop});
+                }
+            }
+        }
+        frontier.swap(next);
+    }
+    return reached;
+}
+
+size_t EncounterGraph::memoryUsage() const {
+    return m_nodes.capacity() * sizeof(DeviceId) + (m_nodeIndex ? m_nodeIndex->memoryUsage() : 0) +
+           m_adjacencyOffsets.capacity() * sizeof(uint64_t) + m_adjacency.capacity() * sizeof(Adjacent) +
+           m_intervalOffsets.capacity() * sizeof(uint64_t) + m_intervals.capacity() * sizeof(Interval);
+}
+
+EncounterGraphBuilder::EncounterGraphBuilder(size_t threads)
+    : m_threads(threads), m_nodeIndex(new DeviceIdTable<uint32_t>()) {}
+
+EncounterGraphBuilder::~EncounterGraphBuilder() = default;
+
+uint32_t EncounterGraphBuilder::nodeFor(const DeviceId& id) {
+    auto inserted = m_nodeIndex->insert(id);
+    if (inserted.second) {
+        *inserted.first = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.push_back(id);
+    }
+    return *inserted.first;
+}
+
+void EncounterGraphBuilder::add(const DeviceId& observer, const DeviceId& peer, int64_t firstSeenMs,
+                                int64_t lastSeenMs, uint32_t hitCount) {
+    if (observer == peer) {
+        return;
+    }
+    uint32_t a = nodeFor(observer);
+    uint32_t b = nodeFor(peer);
+    m_reports.push_back(Report{std::min(a, b), std::max(a, b), std::min(firstSeenMs, lastSeenMs),
+                               clampDuration(lastSeenMs - firstSeenMs), hitCount});
+}
+
+void EncounterGraphBuilder::add(const DeviceId& observer, const EncounterView& encounter) {
+    add(observer, encounter.id, toMs(encounter.firstSeen), toMs(encounter.lastSeen), encounter.hitCount);
+}
+
+void EncounterGraphBuilder::reserve(size_t reports) {
+    m_reports.reserve(reports);
+}
+
+EncounterGraph EncounterGraphBuilder::build() {
+    EncounterGraph graph;
+    const size_t reportCount = m_reports.size();
+    const size_t nodeCount = m_nodes.size();
+
+    // 1. Reports grouped by edge, in time order within each
+    parallelSort(m_reports.begin(), m_reports.end(), m_threads, [](const Report& a, const Report& b) {
+        if (a.low != b.low) {
+            return a.low < b.low;
+        }
+        if (a.high != b.high) {
+            return a.high < b.high;
+        }
+        return a.startMs < b.startMs;
+    });
+
+    // 2. Edge boundaries: scan over "starts an edge" flags gives each edge's index
+    auto startsEdge = [&](size_t i) {
+        return i == 0 || m_reports[i].low != m_reports[i - 1].low || m_reports[i].high != m_reports[i - 1].high;
+    };
+    std::vector<uint64_t> edgeIndex(reportCount);
+    parallelFor(reportCount, m_threads, kMinPerThread, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            edgeIndex[i] = startsEdge(i) ? 1 : 0;
+        }
+    });
+    const size_t edgeCount = static_cast<size_t>(parallelExclusiveScan(edgeIndex, m_threads));
+    std::vector<uint64_t> edgeFirst(edgeCount + 1, reportCount);
+    parallelFor(reportCount, m_threads, kMinPerThread, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (startsEdge(i)) {
+                edgeFirst[edgeIndex[i]] = i;
+            }
+        }
+    });
+    edgeIndex = std::vector<uint64_t>();
+
+    // 3. Overlapping reports of an edge merged: count per edge, scan into offsets, write
+    auto mergeEdge = [&](size_t edge, EncounterGraph::Interval* out) {
+        size_t count = 0;
+        int64_t start = 0;
+        int64_t end = 0;
+        uint64_t hits = 0;
+        for (uint64_t i = edgeFirst[edge]; i < edgeFirst[edge + 1]; ++i) {
+            const Report& report = m_reports[i];
+            int64_t reportEnd = report.startMs + report.durationMs;
+            if (i > edgeFirst[edge] && report.startMs <= end) {
+                end = std::max(end, reportEnd);
+                hits += report.hits;
+                continue;
+            }
+            if (i > edgeFirst[edge] && out) {
+                out[count - 1] = EncounterGraph::Interval{start, clampDuration(end - start),
+                                                          static_cast<uint32_t>(std::min<uint64_t>(hits, UINT32_MAX))};
+            }
+            ++count;
+            start = report.startMs;
+            end = reportEnd;
+            hits = report.hits;
+        }
+        if (count > 0 && out) {
+            out[count - 1] = EncounterGraph::Interval{start, clampDuration(end - start),
+                                                      static_cast<uint32_t>(std::min<uint64_t>(hits, UINT32_MAX))};
+        }
+        return count;
+    };
+    graph.m_intervalOffsets.assign(edgeCount + 1, 0);
+    parallelFor(edgeCount, m_threads, kMinPerThread, [&](size_t begin, size_t end) {
+        for (size_t edge = begin; edge < end; ++edge) {
+            graph.m_intervalOffsets[edge] = mergeEdge(edge, nullptr);
+        }
+    });
+    graph.m_intervals.resize(parallelExclusiveScan(graph.m_intervalOffsets, m_threads));
+    graph.m_intervalOffsets[edgeCount] = graph.m_intervals.size();
+    parallelFor(edgeCount, m_threads, kMinPerThread, [&](size_t begin, size_t end) {
+        for (size_t edge = begin; edge < end; ++edge) {
+            mergeEdge(edge, graph.m_intervals.data() + graph.m_intervalOffsets[edge]);
+        }
+    });
+
+    // 4. Both directions of every edge sorted by (node, neighbour), then CSR offsets
+    struct Directed {
+        uint32_t node;
+        uint32_t neighbour;
+        uint32_t edge;
+    };
+    std::vector<Directed> directed(2 * edgeCount);
+    parallelFor(edgeCount, m_threads, kMinPerThread, [&](size_t begin, size_t end) {
+        for (size_t edge = begin; edge < end; ++edge) {
+            const Report& report = m_reports[edgeFirst[edge]];
+            uint32_t index = static_cast<uint32_t>(edge);
+            directed[2 * edge] = Directed{report.low, report.high, index};
+            directed[2 * edge + 1] = Directed{report.high, report.low, index};
+        }
+    });
+    m_reports = std::vector<Report>();
+    edgeFirst = std::vector<uint64_t>();
+    parallelSort(directed.begin(), directed.end(), m_threads, [](const Directed& a, const Directed& b) {
+        return a.node != b.node ? a.node < b.node : a.neighbour < b.neighbour;
+    });
+
+    graph.m_adjacency.resize(directed.size());
+    graph.m_adjacencyOffsets.assign(nodeCount + 1, directed.size());
+    parallelFor(directed.size(), m_threads, kMinPerThread, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            graph.m_adjacency[i] = EncounterGraph::Adjacent{directed[i].neighbour, directed[i].edge};
+            // A node's first entry sets its offset, and those of any edgeless nodes before it
+            if (i == 0 || directed[i].node != directed[i - 1].node) {
+                for (uint32_t node = i == 0 ? 0 : directed[i - 1].node + 1; node <= directed[i].node; ++node) {
+                    graph.m_adjacencyOffsets[node] = i;
+                }
+            }
+        }
+    });
+
+    graph.m_nodes = std::move(m_nodes);
+    graph.m_nodeIndex = std::move(m_nodeIndex);
+    m_nodes = std::vector<DeviceId>();
+    m_nodeIndex.reset(new DeviceIdTable<uint32_t>());
+    return graph;
+}
+
+} // namespace PassBy
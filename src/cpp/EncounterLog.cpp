@@ -0,0 +1,463 @@
+#include "../internal/EncounterLog.h"
+#include "../internal/EncounterStore.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace PassBy {
+
+namespace {
+
+constexpr char kMagic[8] = {'P', 'B', 'Y', 'L', 'O', 'G', '\0', '\0'};
+constexpr uint32_t kFormatVersion = 1;
+
+constexpr uint8_t kEntryEncounter = 1;
+
+// Mapping grows by doubling from here, in steps of at most kMaxGrowth
+constexpr size_t kInitialFileSize = 64 * 1024;
+constexpr size_t kMaxGrowth = 64 * 1024 * 1024;
+
+// Do not bother compacting small logs
+constexpr size_t kCompactMinEntries = 4096;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t reserved[2];
+};
+
+// Entry layout: EntryHeader, EncounterEntry, alias bytes, zero padding to 8 bytes.
+// The checksum covers everything after itself; size == 0 marks the end of the log.
+struct EntryHeader {
+    uint32_t checksum;
+    uint16_t size;
+    uint8_t type;
+    uint8_t aliasLength;
+};
+
+struct EncounterEntry {
+    uint8_t id[DeviceId::kSize];
+    int64_t firstSeenMs;
+    int64_t lastSeenMs;
+    uint32_t hitCount;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(FileHeader) == 32, "unexpected FileHeader padding");
+static_assert(sizeof(EntryHeader) == 8, "unexpected EntryHeader padding");
+static_assert(sizeof(EncounterEntry) == 40, "unexpected EncounterEntry padding");
+
+size_t entrySize(size_t aliasLength) {
+    return (sizeof(EntryHeader) + sizeof(EncounterEntry) + aliasLength + 7) & ~size_t(7);
+}
+
+// Multiply-xorshift over 8-byte lanes; fast enough to verify hundreds of MB/s on load
+uint32_t checksum(const uint8_t* data, size_t size) {
+    uint64_t h = 0x9E3779B97F4A7C15ULL ^ size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t lane;
+        std::memcpy(&lane, data + i, sizeof(lane));
+        h = (h ^ lane) * 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 32;
+    }
+    for (; i < size; ++i) {
+        h = (h ^ data[i]) * 0xC4CEB9FE1A85EC53ULL;
+    }
+    h ^= h >> 29;
+    return static_cast<uint32_t>(h ^ (h >> 32));
+}
+
+// Validate the entry at offset; returns its size, 0 at the end or on a torn entry
+size_t validEntrySize(const uint8_t* data, size_t offset, size_t limit) {
+    if (offset + sizeof(EntryHeader) > limit) {
+        return 0;
+    }
+    EntryHeader header;
+    std::memcpy(&header, data + offset, sizeof(header));
+    if (header.size < sizeof(EntryHeader) || header.size % 8 != 0 || offset + header.size > limit) {
+        return 0;
+    }
+    if (checksum(data + offset + sizeof(uint32_t), header.size - sizeof(uint32_t)) != header.checksum) {
+        return 0;
+    }
+    return header.size;
+}
+
+} // namespace
+
+// A rewrite running on its own thread, from records copied out of the store
+struct EncounterLog::PendingCompaction {
+    std::vector<EncounterRecord> records;
+    std::vector<std::string> aliases;   // Parallel to records
+    uint64_t generation = 0;            // Store generation at the copy
+    std::string tempPath;
+    EncounterLog log;                   // Writer thread only, until written
+    bool ok = false;
+    std::atomic<bool> written{false};
+    std::atomic<bool> cancelled{false};
+    std::thread writer;
+};
+
+EncounterLog::EncounterLog()
+    : m_fd(-1), m_data(nullptr), m_mappedSize(0), m_tail(0), m_entryCount(0) {}
+
+EncounterLog::~EncounterLog() {
+    close();
+}
+
+bool EncounterLog::open(const std::string& path) {
+    close();
+
+    m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (m_fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(m_fd, &info) != 0) {
+        close();
+        return false;
+    }
+
+    size_t fileSize = static_cast<size_t>(info.st_size);
+    if (fileSize != 0 && fileSize < sizeof(FileHeader)) {
+        close();
+        return false;
+    }
+
+    FileHeader header;
+    bool fresh = fileSize == 0;
+    if (!fresh) {
+        if (pread(m_fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+            close();
+            return false;
+        }
+        // A crash before the header reached the disk leaves an all-zero file: start over
+        static const FileHeader kZeroHeader = {};
+        fresh = std::memcmp(&header, &kZeroHeader, sizeof(header)) == 0;
+        if (!fresh && (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+                       header.version != kFormatVersion || header.headerSize != sizeof(FileHeader))) {
+            close();
+            return false;
+        }
+    }
+
+    if (fresh) {
+        // The header is durable before any entry can be written through the mapping
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kFormatVersion;
+        header.headerSize = sizeof(FileHeader);
+        fileSize = kInitialFileSize;
+        if (ftruncate(m_fd, 0) != 0 ||
+            pwrite(m_fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+            ftruncate(m_fd, static_cast<off_t>(fileSize)) != 0 || fsync(m_fd) != 0) {
+            close();
+            return false;
+        }
+    }
+
+    if (!map(fileSize)) {
+        close();
+        return false;
+    }
+
+    m_path = path;
+    m_tail = scan();
+    return true;
+}
+
+void EncounterLog::close() {
+    abandonCompaction();
+    if (m_data) {
+        sync(true);
+    }
+    unmap();
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    m_path.clear();
+    m_tail = 0;
+    m_entryCount = 0;
+}
+
+size_t EncounterLog::scan() {
+    size_t offset = sizeof(FileHeader);
+    m_entryCount = 0;
+    while (size_t size = validEntrySize(m_data, offset, m_mappedSize)) {
+        offset += size;
+        ++m_entryCount;
+    }
+
+    // Clear a torn entry so later appends are not followed by its leftovers
+    if (offset + sizeof(EntryHeader) <= m_mappedSize) {
+        EntryHeader header;
+        std::memcpy(&header, m_data + offset, sizeof(header));
+        if (header.size != 0 || header.checksum != 0) {
+            size_t end = std::min(m_mappedSize, offset + std::max<size_t>(header.size, sizeof(EntryHeader)));
+            std::memset(m_data + offset, 0, end - offset);
+        }
+    }
+    return offset;
+}
+
+size_t EncounterLog::load(EncounterStore& store, int64_t nowMs) const {
+    if (!m_data) {
+        return 0;
+    }
+
+    // Assume mostly distinct devices, as in a compacted log
+    store.reserve(store.size() + m_entryCount);
+
+    size_t count = 0;
+    size_t offset = sizeof(FileHeader);
+    while (offset < m_tail) {
+        EntryHeader header;
+        std::memcpy(&header, m_data + offset, sizeof(header));
+        if (header.type == kEntryEncounter) {
+            EncounterEntry entry;
+            std::memcpy(&entry, m_data + offset + sizeof(header), sizeof(entry));
+            std::string_view alias(reinterpret_cast<const char*>(m_data + offset + sizeof(header) + sizeof(entry)),
+                                   header.aliasLength);
+            store.restore(DeviceId::fromBytes(entry.id), entry.firstSeenMs, entry.lastSeenMs, entry.hitCount,
+                          alias, nowMs);
+            ++count;
+        }
+        // Unknown entry types from newer versions are skipped
+        offset += header.size;
+    }
+    return count;
+}
+
+bool EncounterLog::append(const EncounterRecord& record, std::string_view alias) {
+    if (!m_data || alias.size() > UINT8_MAX) {
+        return false;
+    }
+
+    size_t size = entrySize(alias.size());
+    if (!ensureCapacity(m_tail + size)) {
+        return false;
+    }
+
+    // Payload first; the checksum is written last and validates the whole entry
+    uint8_t* entryData = m_data + m_tail;
+    EncounterEntry entry;
+    std::memcpy(entry.id, record.id.bytes(), DeviceId::kSize);
+    entry.firstSeenMs = record.firstSeenMs;
+    entry.lastSeenMs = record.lastSeenMs;
+    entry.hitCount = record.hitCount;
+    entry.reserved = 0;
+    std::memcpy(entryData + sizeof(EntryHeader), &entry, sizeof(entry));
+    if (!alias.empty()) {
+        std::memcpy(entryData + sizeof(EntryHeader) + sizeof(entry), alias.data(), alias.size());
+    }
+
+    EntryHeader header;
+    header.size = static_cast<uint16_t>(size);
+    header.type = kEntryEncounter;
+    header.aliasLength = static_cast<uint8_t>(alias.size());
+    std::memcpy(entryData + sizeof(uint32_t), reinterpret_cast<const uint8_t*>(&header) + sizeof(uint32_t),
+                sizeof(EntryHeader) - sizeof(uint32_t));
+    header.checksum = checksum(entryData + sizeof(uint32_t), size - sizeof(uint32_t));
+    std::memcpy(entryData, &header.checksum, sizeof(uint32_t));
+
+    m_tail += size;
+    ++m_entryCount;
+    return true;
+}
+
+bool EncounterLog::reset() {
+    if (!m_data) {
+        return false;
+    }
+    abandonCompaction();
+    unmap();
+    if (ftruncate(m_fd, sizeof(FileHeader)) != 0 || ftruncate(m_fd, kInitialFileSize) != 0 ||
+        !map(kInitialFileSize)) {
+        close();
+        return false;
+    }
+    m_tail = sizeof(FileHeader);
+    m_entryCount = 0;
+    return true;
+}
+
+bool EncounterLog::compact(const EncounterStore& store, int64_t nowMs) {
+    if (!m_data) {
+        return false;
+    }
+    abandonCompaction();
+
+    std::string path = m_path;
+    std::string tempPath = path + ".compact";
+    std::remove(tempPath.c_str());
+    {
+        EncounterLog compacted;
+        if (!compacted.open(tempPath)) {
+            return false;
+        }
+        bool ok = compacted.ensureCapacity(sizeof(FileHeader) + store.size() * entrySize(0));
+        store.forEach(nowMs, [&](const EncounterRecord& record) {
+            ok = ok && compacted.append(record, store.aliasOf(record));
+        });
+        if (ok) {
+            compacted.sync(true);
+            ok = fsync(compacted.m_fd) == 0;
+        }
+        if (!ok) {
+            compacted.close();
+            std::remove(tempPath.c_str());
+            return false;
+        }
+    }
+
+    // rename() is atomic: a crash leaves either the old or the compacted log
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return open(path);
+}
+
+bool EncounterLog::startCompaction(const EncounterStore& store, int64_t nowMs) {
+    if (!m_data || m_pending) {
+        return false;
+    }
+
+    std::unique_ptr<PendingCompaction> pending(new PendingCompaction());
+    pending->generation = store.generation();
+    pending->records.reserve(store.size());
+    pending->aliases.reserve(store.size());
+    store.forEach(nowMs, [&](const EncounterRecord& record) {
+        pending->records.push_back(record);
+        pending->aliases.emplace_back(store.aliasOf(record));
+    });
+    pending->tempPath = m_path + ".compact";
+
+    PendingCompaction* job = pending.get();
+    job->writer = std::thread([job] {
+        std::remove(job->tempPath.c_str());
+        EncounterLog& log = job->log;
+        bool ok = log.open(job->tempPath) &&
+                  log.ensureCapacity(sizeof(FileHeader) + job->records.size() * entrySize(0));
+        for (size_t i = 0; ok && i < job->records.size(); ++i) {
+            ok = !job->cancelled.load(std::memory_order_relaxed) && log.append(job->records[i], job->aliases[i]);
+        }
+        if (ok) {
+            log.sync(true);
+            ok = fsync(log.m_fd) == 0;
+        }
+        job->ok = ok;
+        job->written.store(true, std::memory_order_release);
+    });
+    m_pending = std::move(pending);
+    return true;
+}
+
+bool EncounterLog::finishCompaction(const EncounterStore& store, int64_t nowMs, bool wait) {
+    if (!m_pending || (!wait && !m_pending->written.load(std::memory_order_acquire))) {
+        return false;
+    }
+    std::unique_ptr<PendingCompaction> job = std::move(m_pending);
+    job->writer.join();
+    EncounterLog& compacted = job->log;
+
+    // What changed after the copy only reached the current file
+    if (job->ok) {
+        auto append = [&](const EncounterRecord& record) { compacted.append(record, store.aliasOf(record)); };
+        if (!store.changesSince(job->generation, nowMs, append, [](const DeviceId&) {})) {
+            store.forEach(nowMs, append);
+        }
+    }
+
+    // rename() is atomic: a crash leaves either the old or the compacted log
+    if (!job->ok || std::rename(job->tempPath.c_str(), m_path.c_str()) != 0) {
+        compacted.close();
+        std::remove(job->tempPath.c_str());
+        return false;
+    }
+
+    // Take over the compacted file as it is mapped; the old one is unlinked already
+    unmap();
+    ::close(m_fd);
+    m_fd = compacted.m_fd;
+    m_data = compacted.m_data;
+    m_mappedSize = compacted.m_mappedSize;
+    m_tail = compacted.m_tail;
+    m_entryCount = compacted.m_entryCount;
+    compacted.m_fd = -1;
+    compacted.m_data = nullptr;
+    compacted.m_mappedSize = 0;
+    return true;
+}
+
+void EncounterLog::abandonCompaction() {
+    if (!m_pending) {
+        return;
+    }
+    m_pending->cancelled.store(true, std::memory_order_relaxed);
+    m_pending->writer.join();
+    m_pending->log.close();
+    std::remove(m_pending->tempPath.c_str());
+    m_pending.reset();
+}
+
+bool EncounterLog::shouldCompact(size_t liveRecords) const {
+    return m_entryCount >= kCompactMinEntries && m_entryCount > 2 * liveRecords;
+}
+
+void EncounterLog::sync(bool wait) {
+    if (m_data) {
+        msync(m_data, m_mappedSize, wait ? MS_SYNC : MS_ASYNC);
+    }
+}
+
+bool EncounterLog::map(size_t size) {
+    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    m_data = static_cast<uint8_t*>(data);
+    m_mappedSize = size;
+    return true;
+}
+
+void EncounterLog::unmap() {
+    if (m_data) {
+        munmap(m_data, m_mappedSize);
+        m_data = nullptr;
+        m_mappedSize = 0;
+    }
+}
+
+bool EncounterLog::ensureCapacity(size_t required) {
+    if (required <= m_mappedSize) {
+        return true;
+    }
+    size_t size = m_mappedSize;
+    while (size < required) {
+        size += std::min(size, kMaxGrowth);
+    }
+    // ftruncate zero-fills, which keeps the end-of-log marker intact
+    size_t previousSize = m_mappedSize;
+    unmap();
+    if (ftruncate(m_fd, static_cast<off_t>(size)) == 0 && map(size)) {
+        return true;
+    }
+    if (!map(previousSize)) {
+        close();
+    }
+    return false;
+}
+
+} // namespace PassBy
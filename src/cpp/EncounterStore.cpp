@@ -0,0 +1,505 @@
+#include "../internal/EncounterStore.h"
+#include "../internal/DiscoveryEvent.h"
+#include <algorithm>
+#include <cstring>
+
+namespace PassBy {
+
+// Slots inspected by the expiry hand on every update
+static constexpr size_t kExpiryStepsPerUpdate = 2;
+
+// Removals remembered for changesSince() without a memory budget, at least.
+// With a budget the history holds maxRecords removals and is part of the budget.
+static constexpr size_t kMinRemovalHistory = 1024;
+
+static_assert(EncounterStore::kMaxInlineAliasLength >= DiscoveryEvent::kMaxIdentifierLength,
+              "Discovered aliases must fit inline");
+
+EncounterStore::EncounterStore()
+    : m_removedHead(0), m_removedCount(0), m_retainers(0), m_ttlMs(0), m_budgetBytes(0), m_maxRecords(0), m_clockHand(0), m_expiryHand(0),
+      m_evicted(0), m_expired(0), m_generation(0), m_historyStart(0), m_newest(kNoSlot),
+      m_oldest(kNoSlot), m_trackChanges(false) {}
+
+size_t EncounterStore::recordsForBudget(size_t maxMemoryBytes) {
+    auto bytesFor = [](size_t count) {
+        // Record, free slot, change list, removal history and inline alias per record
+        return count * (sizeof(EncounterRecord) + 2 * sizeof(uint32_t) + sizeof(Removal) + sizeof(InlineAlias)) +
+               DeviceIdMap<uint32_t>::bytesForCapacity(DeviceIdMap<uint32_t>::capacityFor(count));
+    };
+
+    // Largest count that fits, by binary search
+    size_t low = 0;
+    size_t high = maxMemoryBytes / sizeof(EncounterRecord) + 1;
+    while (low + 1 < high) {
+        size_t mid = low + (high - low) / 2;
+        if (bytesFor(mid) <= maxMemoryBytes) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+void EncounterStore::configure(int64_t ttlMs, size_t maxMemoryBytes) {
+    m_ttlMs = ttlMs > 0 ? ttlMs : 0;
+    m_budgetBytes = maxMemoryBytes;
+    rebuild();
+}
+
+void EncounterStore::rebuild() {
+    size_t maxRecords = m_budgetBytes > 0 ? std::max<size_t>(recordsForBudget(m_budgetBytes), 1) : 0;
+    if (maxRecords == m_maxRecords) {
+        return;
+    }
+    m_maxRecords = maxRecords;
+
+    // Rebuild the storage for the new budget, keeping the most recently seen records
+    struct Live {
+        EncounterRecord record;
+        std::string alias;
+    };
+    std::vector<Live> live;
+    live.reserve(size());
+    for (const auto& record : m_records) {
+        if (record.occupied) {
+            live.push_back(Live{record, std::string(aliasOf(record))});
+        }
+    }
+    if (m_maxRecords > 0 && live.size() > m_maxRecords) {
+        std::sort(live.begin(), live.end(), [](const Live& a, const Live& b) {
+            return a.record.lastSeenMs > b.record.lastSeenMs;
+        });
+        for (size_t i = m_maxRecords; i < live.size(); ++i) {
+            retain(live[i].record, live[i].alias);
+            noteRemoval(live[i].record.id);
+        }
+        m_evicted += live.size() - m_maxRecords;
+        live.resize(m_maxRecords);
+    }
+
+    m_aliases.clear();
+    m_inlineAliases.clear();
+    m_inlineAliases.shrink_to_fit();
+    m_inlineAliases.resize(m_maxRecords);
+    m_records.clear();
+    m_records.shrink_to_fit();
+    m_freeSlots.clear();
+    m_freeSlots.shrink_to_fit();
+    m_changed.clear();
+    m_changed.shrink_to_fit();
+    m_index.clear();
+    if (m_maxRecords > 0) {
+        m_records.reserve(m_maxRecords);
+        m_freeSlots.reserve(m_maxRecords);
+        m_changed.reserve(m_maxRecords);
+        m_index.reserve(m_maxRecords);
+    }
+    resizeRemovalHistory(m_maxRecords > 0 ? m_maxRecords : std::max(kMinRemovalHistory, m_removedCount));
+    // Relink the journal in generation order
+    std::sort(live.begin(), live.end(), [](const Live& a, const Live& b) {
+        return a.record.generation < b.record.generation;
+    });
+    m_newest = kNoSlot;
+    m_oldest = kNoSlot;
+    for (const auto& entry : live) {
+        const EncounterRecord& record = entry.record;
+        uint32_t slot = static_cast<uint32_t>(m_records.size());
+        *m_index.insert(record.id).first = slot;
+        m_records.push_back(record);
+        setAlias(slot, entry.alias);
+        m_records[slot].newer = kNoSlot;
+        m_records[slot].older = m_newest;
+        if (m_newest != kNoSlot) {
+            m_records[m_newest].newer = slot;
+        } else {
+            m_oldest = slot;
+        }
+        m_newest = slot;
+        if (record.dirty) {
+            m_changed.push_back(slot);
+        }
+    }
+    m_clockHand = 0;
+    m_expiryHand = 0;
+}
+
+const EncounterRecord* EncounterStore::record(const DeviceId& id, int64_t nowMs, std::string_view alias, bool* isNew) {
+    expire(nowMs, kExpiryStepsPerUpdate);
+
+    if (uint32_t* existing = m_index.find(id)) {
+        EncounterRecord& record = m_records[*existing];
+        bool expired = isExpired(record, nowMs);
+        if (expired) {
+            // Gone longer than the TTL: this is a new encounter
+            retain(record, aliasOf(record));
+            noteCreated(id);
+            ++m_expired;
+            record.firstSeenMs = nowMs;
+            record.hitCount = 0;
+        }
+        record.lastSeenMs = std::max(record.lastSeenMs, nowMs);
+        ++record.hitCount;
+        record.referenced = !expired;
+        touch(*existing);
+        markChanged(*existing);
+        if (isNew) {
+            *isNew = expired;
+        }
+        return &record;
+    }
+
+    uint32_t slot = allocateSlot(nowMs);
+    if (slot == kNoSlot) {
+        return nullptr;
+    }
+
+    EncounterRecord& record = m_records[slot];
+    record.id = id;
+    record.firstSeenMs = nowMs;
+    record.lastSeenMs = nowMs;
+    record.hitCount = 1;
+    record.occupied = true;
+    record.referenced = false;
+    record.hasAlias = false;
+    record.dirty = false;
+    record.newer = kNoSlot;
+    record.older = kNoSlot;
+    *m_index.insert(id).first = slot;
+    noteCreated(id);
+    setAlias(slot, alias);
+    touch(slot);
+    markChanged(slot);
+    if (isNew) {
+        *isNew = true;
+    }
+    return &record;
+}
+
+const EncounterRecord* EncounterStore::find(const DeviceId& id, int64_t nowMs) const {
+    const uint32_t* slot = m_index.find(id);
+    if (!slot || isExpired(m_records[*slot], nowMs)) {
+        return nullptr;
+    }
+    return &m_records[*slot];
+}
+
+void EncounterStore::restore(const DeviceId& id, int64_t firstSeenMs, int64_t lastSeenMs, uint32_t hitCount,
+                             std::string_view alias, int64_t nowMs) {
+    if (m_ttlMs > 0 && nowMs - lastSeenMs >= m_ttlMs) {
+        return;
+    }
+
+    uint32_t slot;
+    if (uint32_t* existing = m_index.find(id)) {
+        slot = *existing;
+    } else {
+        slot = allocateSlot(nowMs);
+        if (slot == kNoSlot) {
+            return;
+        }
+        m_records[slot] = EncounterRecord{};
+        m_records[slot].id = id;
+        m_records[slot].occupied = true;
+        m_records[slot].newer = kNoSlot;
+        m_records[slot].older = kNoSlot;
+        *m_index.insert(id).first = slot;
+        noteCreated(id);
+    }
+    touch(slot);
+
+    EncounterRecord& record = m_records[slot];
+    record.firstSeenMs = firstSeenMs;
+    record.lastSeenMs = lastSeenMs;
+    record.hitCount = hitCount;
+    setAlias(slot, alias);
+}
+
+void EncounterStore::reserve(size_t count) {
+    if (m_maxRecords == 0) {
+        m_records.reserve(count);
+        m_index.reserve(count);
+    }
+}
+
+std::string_view EncounterStore::aliasOf(const EncounterRecord& record) const {
+    if (!record.hasAlias) {
+        return std::string_view();
+    }
+    if (!m_inlineAliases.empty()) {
+        const InlineAlias& alias = m_inlineAliases[static_cast<size_t>(&record - m_records.data())];
+        return std::string_view(alias.text, alias.length);
+    }
+    const std::string* alias = m_aliases.find(record.id);
+    return alias ? std::string_view(*alias) : std::string_view();
+}
+
+std::string EncounterStore::identifierString(const EncounterRecord& record) const {
+    std::string result;
+    identifierString(record, result);
+    return result;
+}
+
+void EncounterStore::identifierString(const EncounterRecord& record, std::string& out) const {
+    std::string_view alias = aliasOf(record);
+    if (!alias.empty()) {
+        out.assign(alias.data(), alias.size());
+        return;
+    }
+    out.resize(DeviceId::kStringLength);
+    record.id.format(&out[0]);
+}
+
+void EncounterStore::expire(int64_t nowMs, size_t maxSteps) {
+    if (m_ttlMs == 0 || m_records.empty()) {
+        return;
+    }
+    for (size_t step = 0; step < maxSteps; ++step) {
+        if (m_expiryHand >= m_records.size()) {
+            m_expiryHand = 0;
+        }
+        EncounterRecord& record = m_records[m_expiryHand];
+        if (record.occupied && isExpired(record, nowMs)) {
+            release(static_cast<uint32_t>(m_expiryHand));
+            m_freeSlots.push_back(static_cast<uint32_t>(m_expiryHand));
+            ++m_expired;
+        }
+        ++m_expiryHand;
+    }
+}
+
+void EncounterStore::expireStale(int64_t nowMs) {
+    if (m_ttlMs == 0) {
+        return;
+    }
+    while (m_oldest != kNoSlot && isExpired(m_records[m_oldest], nowMs)) {
+        uint32_t slot = m_oldest;
+        release(slot);
+        m_freeSlots.push_back(slot);
+        ++m_expired;
+    }
+}
+
+void EncounterStore::setChangeTracking(bool enabled) {
+    m_trackChanges = enabled;
+    if (!enabled) {
+        for (uint32_t slot : m_changed) {
+            m_records[slot].dirty = false;
+        }
+        m_changed.clear();
+    }
+}
+
+void EncounterStore::clear() {
+    if (m_retainers > 0) {
+        for (const auto& record : m_records) {
+            if (record.occupied) {
+                retain(record, aliasOf(record));
+            }
+        }
+    }
+    m_records.clear();
+    m_freeSlots.clear();
+    m_changed.clear();
+    m_removedHead = 0;
+    m_removedCount = 0;
+    m_newest = kNoSlot;
+    m_oldest = kNoSlot;
+    m_historyStart = ++m_generation;
+    m_aliases.clear();
+    if (m_maxRecords > 0) {
+        // Keep the preallocated index so the next discoveries do not rehash
+        m_index.clear(false);
+    } else {
+        m_records.shrink_to_fit();
+        m_freeSlots.shrink_to_fit();
+        m_changed.shrink_to_fit();
+        resizeRemovalHistory(0);
+        m_index.clear();
+    }
+    m_clockHand = 0;
+    m_expiryHand = 0;
+}
+
+size_t EncounterStore::memoryUsage() const {
+    size_t bytes = m_records.capacity() * sizeof(EncounterRecord) +
+                   (m_freeSlots.capacity() + m_changed.capacity()) * sizeof(uint32_t) +
+                   m_removed.capacity() * sizeof(Removal) + m_inlineAliases.capacity() * sizeof(InlineAlias) +
+                   m_index.memoryUsage() + m_aliases.memoryUsage();
+    m_aliases.forEach([&](const DeviceId&, const std::string& alias) {
+        bytes += alias.capacity() > 15 ? alias.capacity() + 1 : 0;
+    });
+    return bytes;
+}
+
+uint32_t EncounterStore::allocateSlot(int64_t nowMs) {
+    if (!m_freeSlots.empty()) {
+        uint32_t slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        return slot;
+    }
+    if (m_maxRecords == 0 || m_records.size() < m_maxRecords) {
+        m_records.push_back(EncounterRecord{});
+        return static_cast<uint32_t>(m_records.size() - 1);
+    }
+    return evictWithClock(nowMs);
+}
+
+uint32_t EncounterStore::evictWithClock(int64_t nowMs) {
+    // Every referenced record loses its bit on the first pass, so two passes always find a victim
+    for (size_t step = 0; step < 2 * m_records.size(); ++step) {
+        if (m_clockHand >= m_records.size()) {
+            m_clockHand = 0;
+        }
+        uint32_t slot = static_cast<uint32_t>(m_clockHand++);
+        EncounterRecord& record = m_records[slot];
+        if (!record.occupied) {
+            return slot;
+        }
+        if (isExpired(record, nowMs)) {
+            ++m_expired;
+        } else if (record.referenced) {
+            record.referenced = false;
+            continue;
+        } else {
+            ++m_evicted;
+        }
+        release(slot);
+        return slot;
+    }
+    return kNoSlot;
+}
+
+void EncounterStore::setAlias(uint32_t slot, std::string_view alias) {
+    EncounterRecord& record = m_records[slot];
+    if (m_inlineAliases.empty()) {
+        if (record.hasAlias && alias.empty()) {
+            m_aliases.erase(record.id);
+        }
+        record.hasAlias = !alias.empty();
+        if (record.hasAlias) {
+            m_aliases.insert(record.id).first->assign(alias.data(), alias.size());
+        }
+    } else {
+        record.hasAlias = !alias.empty() && alias.size() <= kMaxInlineAliasLength;
+        if (record.hasAlias) {
+            m_inlineAliases[slot].length = static_cast<uint8_t>(alias.size());
+            std::memcpy(m_inlineAliases[slot].text, alias.data(), alias.size());
+        }
+    }
+}
+
+void EncounterStore::release(uint32_t slot) {
+    EncounterRecord& record = m_records[slot];
+    retain(record, aliasOf(record));
+    m_index.erase(record.id);
+    if (record.hasAlias && m_inlineAliases.empty()) {
+        m_aliases.erase(record.id);
+    }
+    record.occupied = false;
+    record.dirty = false;
+    unlink(slot);
+    noteRemoval(record.id);
+}
+
+void EncounterStore::touch(uint32_t slot) {
+    EncounterRecord& record = m_records[slot];
+    record.generation = ++m_generation;
+    if (m_newest == slot) {
+        return;
+    }
+    unlink(slot);
+    record.older = m_newest;
+    if (m_newest != kNoSlot) {
+        m_records[m_newest].newer = slot;
+    } else {
+        m_oldest = slot;
+    }
+    m_newest = slot;
+}
+
+void EncounterStore::unlink(uint32_t slot) {
+    EncounterRecord& record = m_records[slot];
+    if (record.newer != kNoSlot) {
+        m_records[record.newer].older = record.older;
+    } else if (m_newest == slot) {
+        m_newest = record.older;
+    }
+    if (record.older != kNoSlot) {
+        m_records[record.older].newer = record.newer;
+    } else if (m_oldest == slot) {
+        m_oldest = record.newer;
+    }
+    record.newer = kNoSlot;
+    record.older = kNoSlot;
+}
+
+void EncounterStore::noteRemoval(const DeviceId& id) {
+    uint64_t generation = ++m_generation;
+    if (m_removedCount == m_removed.size()) {
+        if (m_maxRecords == 0 && m_removed.size() < std::max(kMinRemovalHistory, m_index.size())) {
+            resizeRemovalHistory(std::max(kMinRemovalHistory, 2 * m_removed.size()));
+        } else if (m_removed.empty()) {
+            m_historyStart = generation;
+            return;
+        } else {
+            // Forget the oldest removal; changesSince() before it needs a resync
+            m_historyStart = std::max(m_historyStart, m_removed[m_removedHead].generation);
+            m_removedHead = (m_removedHead + 1) % m_removed.size();
+            --m_removedCount;
+        }
+    }
+    m_removed[(m_removedHead + m_removedCount) % m_removed.size()] = Removal{generation, id};
+    ++m_removedCount;
+}
+
+void EncounterStore::resizeRemovalHistory(size_t capacity) {
+    // Keep the newest entries that fit, oldest first
+    size_t kept = std::min(m_removedCount, capacity);
+    std::vector<Removal> removed;
+    removed.reserve(capacity);
+    for (size_t i = m_removedCount - kept; i < m_removedCount; ++i) {
+        removed.push_back(m_removed[(m_removedHead + i) % m_removed.size()]);
+    }
+    if (kept < m_removedCount) {
+        const Removal& newestDropped = m_removed[(m_removedHead + m_removedCount - kept - 1) % m_removed.size()];
+        m_historyStart = std::max(m_historyStart, newestDropped.generation);
+    }
+    removed.resize(capacity);
+    m_removed.swap(removed);
+    m_removedHead = 0;
+    m_removedCount = kept;
+}
+
+void EncounterStore::retainHistory(bool enabled) {
+    if (enabled) {
+        ++m_retainers;
+    } else if (m_retainers > 0 && --m_retainers == 0) {
+        m_retained.clear();
+        m_retained.shrink_to_fit();
+        m_created.clear();
+    }
+}
+
+void EncounterStore::retain(const EncounterRecord& record, std::string_view alias) {
+    // Removed (or restarted) as of the next generation
+    if (m_retainers > 0) {
+        const uint64_t* created = m_created.find(record.id);
+        m_retained.push_back(Retained{record, std::string(alias), m_generation + 1, created ? *created : 0});
+    }
+}
+
+void EncounterStore::noteCreated(const DeviceId& id) {
+    if (m_retainers > 0) {
+        *m_created.insert(id).first = m_generation + 1;
+    }
+}
+
+void EncounterStore::markChanged(uint32_t slot) {
+    if (m_trackChanges && !m_records[slot].dirty) {
+        m_records[slot].dirty = true;
+        m_changed.push_back(slot);
+    }
+}
+
+} // namespace PassBy
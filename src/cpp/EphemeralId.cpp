@@ -0,0 +1,190 @@
+#include "PassBy/EphemeralId.h"
+#include "../internal/DeviceIdTable.h"
+#include "../internal/Parallel.h"
+#include "../internal/Sha256.h"
+#include <algorithm>
+
+namespace PassBy {
+
+namespace {
+
+constexpr char kDerivationLabel[] = "PassBy ephemeral id";
+
+// Below this many derivations per thread, starting a thread costs more than it saves
+constexpr size_t kMinDerivationsPerThread = 256;
+
+} // namespace
+
+DeviceId EphemeralId::derive(const ContactSecret& secret, int64_t interval) {
+    uint8_t counter[8];
+    for (int i = 0; i < 8; ++i) {
+        counter[i] = static_cast<uint8_t>(static_cast<uint64_t>(interval) >> (56 - 8 * i));
+    }
+    uint8_t digest[Sha256::kDigestSize];
+    hmacSha256(secret.data(), secret.size(), kDerivationLabel, sizeof(kDerivationLabel) - 1, counter,
+               sizeof(counter), digest);
+
+    // Looks like any random UUID on air
+    digest[6] = static_cast<uint8_t>((digest[6] & 0x0F) | 0x40);
+    digest[8] = static_cast<uint8_t>((digest[8] & 0x3F) | 0x80);
+    return DeviceId::fromBytes(digest);
+}
+
+int64_t EphemeralId::intervalAt(int64_t unixMs, std::chrono::milliseconds intervalLength) {
+    int64_t length = std::max<int64_t>(intervalLength.count(), 1);
+    int64_t interval = unixMs / length;
+    return (unixMs % length < 0) ? interval - 1 : interval;
+}
+
+EphemeralIdTable::EphemeralIdTable(const EphemeralTableOptions& options)
+    : m_options(options), m_contactSlots(new DeviceIdTable<uint32_t>()),
+      m_identifiers(new DeviceIdTable<Entry>()), m_firstInterval(0), m_hasWindow(false) {}
+
+EphemeralIdTable::~EphemeralIdTable() = default;
+
+void EphemeralIdTable::addContact(const DeviceId& contact, const ContactSecret& secret) {
+    addContacts({{contact, secret}});
+}
+
+void EphemeralIdTable::addContacts(const std::vector<std::pair<DeviceId, ContactSecret>>& contacts) {
+    std::vector<uint32_t> slots;
+    slots.reserve(contacts.size());
+    for (const auto& contact : contacts) {
+        // A replaced secret takes its old identifiers with it
+        removeContact(contact.first);
+
+        uint32_t slot;
+        if (!m_freeSlots.empty()) {
+            slot = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        } else {
+            slot = static_cast<uint32_t>(m_contacts.size());
+            m_contacts.emplace_back();
+        }
+        m_contacts[slot].id = contact.first;
+        m_contacts[slot].secret = contact.second;
+        m_contacts[slot].active = true;
+        *m_contactSlots->insert(contact.first).first = slot;
+        slots.push_back(slot);
+    }
+    if (m_hasWindow) {
+        derive(m_firstInterval, m_windowIds.size(), slots);
+    }
+}
+
+bool EphemeralIdTable::removeContact(const DeviceId& contact) {
+    const uint32_t* found = m_contactSlots->find(contact);
+    if (!found) {
+        return false;
+    }
+    uint32_t slot = *found;
+    for (int64_t interval = m_firstInterval; m_hasWindow && interval <= lastInterval(); ++interval) {
+        DeviceId id = EphemeralId::derive(m_contacts[slot].secret, interval);
+        const Entry* entry = m_identifiers->find(id);
+        if (entry && entry->contact == slot) {
+            m_identifiers->erase(id);
+        }
+    }
+    m_contacts[slot] = Contact();
+    m_freeSlots.push_back(slot);
+    m_contactSlots->erase(contact);
+    return true;
+}
+
+void EphemeralIdTable::advanceTo(int64_t unixMs) {
+    int64_t first = EphemeralId::intervalAt(unixMs, m_options.interval) - static_cast<int64_t>(m_options.pastIntervals);
+    size_t count = m_options.pastIntervals + m_options.futureIntervals + 1;
+
+    if (!m_hasWindow || first < m_firstInterval || first > lastInterval()) {
+        m_identifiers->clear();
+        m_windowIds.assign(count, std::vector<DeviceId>());
+        m_firstInterval = first;
+        m_hasWindow = true;
+        derive(first, count, activeSlots());
+        return;
+    }
+
+    while (m_firstInterval < first) {
+        dropFront();
+    }
+    int64_t next = lastInterval() + 1;
+    size_t added = count - m_windowIds.size();
+    m_windowIds.resize(count);
+    derive(next, added, activeSlots());
+}
+
+bool EphemeralIdTable::resolve(const DeviceId& ephemeral, EphemeralMatch* match) const {
+    const Entry* entry = m_identifiers->find(ephemeral);
+    if (!entry) {
+        return false;
+    }
+    if (match) {
+        match->contact = m_contacts[entry->contact].id;
+        match->interval = entry->interval;
+    }
+    return true;
+}
+
+size_t EphemeralIdTable::contactCount() const {
+    return m_contactSlots->size();
+}
+
+size_t EphemeralIdTable::size() const {
+    return m_identifiers->size();
+}
+
+size_t EphemeralIdTable::memoryUsage() const {
+    size_t bytes = m_contactSlots->memoryUsage() + m_identifiers->memoryUsage() +
+                   m_contacts.capacity() * sizeof(Contact) + m_freeSlots.capacity() * sizeof(uint32_t);
+    for (const auto& ids : m_windowIds) {
+        bytes += ids.capacity() * sizeof(DeviceId);
+    }
+    return bytes;
+}
+
+void EphemeralIdTable::derive(int64_t first, size_t count, const std::vector<uint32_t>& slots) {
+    if (count == 0 || slots.empty()) {
+        return;
+    }
+
+    // HMACs in parallel, then a serial pass into the hash table
+    std::vector<DeviceId> ids(count * slots.size());
+    parallelFor(ids.size(), m_options.threads, kMinDerivationsPerThread, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            ids[i] = EphemeralId::derive(m_contacts[slots[i % slots.size()]].secret,
+                                         first + static_cast<int64_t>(i / slots.size()));
+        }
+    });
+
+    m_identifiers->reserve(m_identifiers->size() + ids.size());
+    for (size_t i = 0; i < ids.size(); ++i) {
+        int64_t interval = first + static_cast<int64_t>(i / slots.size());
+        *m_identifiers->insert(ids[i]).first = Entry{slots[i % slots.size()], interval};
+        m_windowIds[static_cast<size_t>(interval - m_firstInterval)].push_back(ids[i]);
+    }
+}
+
+std::vector<uint32_t> EphemeralIdTable::activeSlots() const {
+    std::vector<uint32_t> slots;
+    slots.reserve(m_contactSlots->size());
+    for (uint32_t slot = 0; slot < m_contacts.size(); ++slot) {
+        if (m_contacts[slot].active) {
+            slots.push_back(slot);
+        }
+    }
+    return slots;
+}
+
+void EphemeralIdTable::dropFront() {
+    for (const DeviceId& id : m_windowIds.front()) {
+        // Skip identifiers already removed with their contact
+        const Entry* entry = m_identifiers->find(id);
+        if (entry && entry->interval == m_firstInterval) {
+            m_identifiers->erase(id);
+        }
+    }
+    m_windowIds.pop_front();
+    ++m_firstInterval;
+}
+
+} // namespace PassBy
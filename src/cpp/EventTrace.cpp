@@ -0,0 +1,380 @@
+#include "../internal/EventTrace.h"
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace PassBy {
+
+namespace {
+
+constexpr char kMagic[8] = {'P', 'B', 'Y', 'T', 'R', 'A', 'C', 'E'};
+constexpr uint32_t kFormatVersion = 1;
+constexpr size_t kHeaderSize = 32;
+
+// Buffered records are written out past this size
+constexpr size_t kFlushThreshold = 64 * 1024;
+
+int64_t steadyNs() {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void putFixed(std::vector<uint8_t>& out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void putSigned(std::vector<uint8_t>& out, int64_t value) {
+    putVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+void putBytes(std::vector<uint8_t>& out, const void* data, size_t length) {
+    putVarint(out, length);
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    out.insert(out.end(), bytes, bytes + length);
+}
+
+void putId(std::vector<uint8_t>& out, const DeviceId& id) {
+    out.insert(out.end(), id.bytes(), id.bytes() + DeviceId::kSize);
+}
+
+// Bounds-checked decoding over a record; any read past the end marks it failed
+class Decoder {
+public:
+    Decoder(const uint8_t* data, size_t size, size_t offset) : m_data(data), m_size(size), m_offset(offset) {}
+
+    bool failed() const { return m_failed; }
+    size_t offset() const { return m_offset; }
+
+    uint8_t byte() {
+        if (m_offset >= m_size) {
+            m_failed = true;
+            return 0;
+        }
+        return m_data[m_offset++];
+    }
+
+    uint64_t fixed(size_t bytes) {
+        uint64_t value = 0;
+        for (size_t i = 0; i < bytes; ++i) {
+            value |= uint64_t(byte()) << (8 * i);
+        }
+        return value;
+    }
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t b = byte();
+            value |= uint64_t(b & 0x7F) << shift;
+            if (!(b & 0x80)) {
+                return value;
+            }
+        }
+        m_failed = true;
+        return 0;
+    }
+
+    int64_t signedVarint() {
+        uint64_t value = varint();
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    const uint8_t* bytes(size_t length) {
+        if (m_failed || length > m_size - m_offset) {
+            m_failed = true;
+            return nullptr;
+        }
+        const uint8_t* start = m_data + m_offset;
+        m_offset += length;
+        return start;
+    }
+
+    std::string_view text() {
+        size_t length = static_cast<size_t>(varint());
+        const uint8_t* start = bytes(length);
+        return start ? std::string_view(reinterpret_cast<const char*>(start), length) : std::string_view();
+    }
+
+    DeviceId id() {
+        const uint8_t* start = bytes(DeviceId::kSize);
+        return start ? DeviceId::fromBytes(start) : DeviceId();
+    }
+
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_offset;
+    bool m_failed = false;
+};
+
+} // namespace
+
+EventTraceWriter::EventTraceWriter() : m_fd(-1), m_startNs(0), m_lastNs(0), m_events(0) {}
+
+EventTraceWriter::~EventTraceWriter() {
+    close();
+}
+
+bool EventTraceWriter::open(const std::string& path, int64_t startWallMs) {
+    close();
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (m_fd < 0) {
+        return false;
+    }
+
+    m_buffer.clear();
+    m_buffer.reserve(kFlushThreshold * 2);
+    m_buffer.insert(m_buffer.end(), kMagic, kMagic + sizeof(kMagic));
+    putFixed(m_buffer, kFormatVersion, 4);
+    putFixed(m_buffer, kHeaderSize, 4);
+    putFixed(m_buffer, static_cast<uint64_t>(startWallMs), 8);
+    putFixed(m_buffer, 0, 8);
+    if (!flushLocked()) {
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    m_startNs = steadyNs();
+    m_lastNs = 0;
+    m_events = 0;
+    return true;
+}
+
+void EventTraceWriter::append(const TraceEvent& event) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_fd < 0) {
+        return;
+    }
+
+    int64_t timeNs = steadyNs() - m_startNs;
+    if (timeNs < m_lastNs) {
+        timeNs = m_lastNs;
+    }
+    m_buffer.push_back(static_cast<uint8_t>(event.type));
+    putVarint(m_buffer, static_cast<uint64_t>(timeNs - m_lastNs));
+    m_lastNs = timeNs;
+
+    switch (event.type) {
+        case TraceEventType::DeviceDiscovered:
+            putBytes(m_buffer, event.text.data(), event.text.size());
+            break;
+        case TraceEventType::DeviceIdDiscovered:
+            putId(m_buffer, event.id);
+            break;
+        case TraceEventType::ServiceDeviceDiscovered:
+            putBytes(m_buffer, event.text.data(), event.text.size());
+            putId(m_buffer, event.service);
+            putSigned(m_buffer, event.rssi);
+            break;
+        case TraceEventType::PeripheralDiscovered:
+            putId(m_buffer, event.id);
+            putSigned(m_buffer, event.rssi);
+            break;
+        case TraceEventType::PeripheralAdvertisement:
+            putId(m_buffer, event.id);
+            putSigned(m_buffer, event.rssi);
+            putBytes(m_buffer, event.data, event.length);
+            break;
+        case TraceEventType::PeripheralIdentifierRead:
+            putId(m_buffer, event.id);
+            putBytes(m_buffer, event.text.data(), event.text.size());
+            break;
+        case TraceEventType::PeripheralConnectionFailed:
+            putId(m_buffer, event.id);
+            break;
+        case TraceEventType::AdvertisingStarted:
+            m_buffer.push_back(event.success ? 1 : 0);
+            putBytes(m_buffer, event.text.data(), event.text.size());
+            putBytes(m_buffer, event.detail.data(), event.detail.size());
+            break;
+        case TraceEventType::StageLatency:
+            m_buffer.push_back(static_cast<uint8_t>(event.stage));
+            putSigned(m_buffer, event.value);
+            break;
+        case TraceEventType::RssiDeviceIdDiscovered:
+            putId(m_buffer, event.id);
+            putSigned(m_buffer, event.rssi);
+            break;
+        case TraceEventType::ServiceDeviceIdDiscovered:
+            putId(m_buffer, event.id);
+            putId(m_buffer, event.service);
+            putSigned(m_buffer, event.rssi);
+            break;
+    }
+    ++m_events;
+
+    if (m_buffer.size() >= kFlushThreshold) {
+        flushLocked();
+    }
+}
+
+bool EventTraceWriter::flushLocked() {
+    size_t written = 0;
+    while (written < m_buffer.size()) {
+        ssize_t result = ::write(m_fd, m_buffer.data() + written, m_buffer.size() - written);
+        if (result < 0) {
+            m_buffer.clear();
+            return false;
+        }
+        written += static_cast<size_t>(result);
+    }
+    m_buffer.clear();
+    return true;
+}
+
+uint64_t EventTraceWriter::close() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_fd < 0) {
+        return m_events;
+    }
+    flushLocked();
+    ::close(m_fd);
+    m_fd = -1;
+    return m_events;
+}
+
+bool EventTraceWriter::isOpen() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_fd >= 0;
+}
+
+EventTraceReader::EventTraceReader() : m_offset(0), m_timeNs(0), m_startWallMs(0), m_truncated(false) {}
+
+bool EventTraceReader::open(const std::string& path) {
+    m_data.clear();
+    rewind();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+    m_data.resize(static_cast<size_t>(info.st_size));
+    size_t read = 0;
+    while (read < m_data.size()) {
+        ssize_t result = ::read(fd, m_data.data() + read, m_data.size() - read);
+        if (result <= 0) {
+            break;
+        }
+        read += static_cast<size_t>(result);
+    }
+    ::close(fd);
+    m_data.resize(read);
+
+    Decoder header(m_data.data(), m_data.size(), 0);
+    const uint8_t* magic = header.bytes(sizeof(kMagic));
+    uint32_t version = static_cast<uint32_t>(header.fixed(4));
+    uint32_t headerSize = static_cast<uint32_t>(header.fixed(4));
+    m_startWallMs = static_cast<int64_t>(header.fixed(8));
+    if (header.failed() || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 || version != kFormatVersion ||
+        headerSize < kHeaderSize || headerSize > m_data.size()) {
+        m_data.clear();
+        return false;
+    }
+    m_data.erase(m_data.begin(), m_data.begin() + headerSize);
+    rewind();
+    return true;
+}
+
+void EventTraceReader::rewind() {
+    m_offset = 0;
+    m_timeNs = 0;
+    m_truncated = false;
+}
+
+bool EventTraceReader::next(TraceEvent& event) {
+    if (m_offset >= m_data.size()) {
+        return false;
+    }
+
+    Decoder in(m_data.data(), m_data.size(), m_offset);
+    event = TraceEvent(static_cast<TraceEventType>(in.byte()));
+    int64_t timeNs = m_timeNs + static_cast<int64_t>(in.varint());
+    event.timeNs = timeNs;
+
+    bool known = true;
+    switch (event.type) {
+        case TraceEventType::DeviceDiscovered:
+            event.text = in.text();
+            break;
+        case TraceEventType::DeviceIdDiscovered:
+            event.id = in.id();
+            break;
+        case TraceEventType::ServiceDeviceDiscovered:
+            event.text = in.text();
+            event.service = in.id();
+            event.rssi = static_cast<int32_t>(in.signedVarint());
+            break;
+        case TraceEventType::PeripheralDiscovered:
+            event.id = in.id();
+            event.rssi = static_cast<int32_t>(in.signedVarint());
+            break;
+        case TraceEventType::PeripheralAdvertisement: {
+            event.id = in.id();
+            event.rssi = static_cast<int32_t>(in.signedVarint());
+            event.length = static_cast<size_t>(in.varint());
+            event.data = in.bytes(event.length);
+            break;
+        }
+        case TraceEventType::PeripheralIdentifierRead:
+            event.id = in.id();
+            event.text = in.text();
+            break;
+        case TraceEventType::PeripheralConnectionFailed:
+            event.id = in.id();
+            break;
+        case TraceEventType::AdvertisingStarted:
+            event.success = in.byte() != 0;
+            event.text = in.text();
+            event.detail = in.text();
+            break;
+        case TraceEventType::StageLatency:
+            event.stage = static_cast<PipelineStage>(in.byte());
+            event.value = in.signedVarint();
+            known = static_cast<size_t>(event.stage) < kPipelineStageCount;
+            break;
+        case TraceEventType::RssiDeviceIdDiscovered:
+            event.id = in.id();
+            event.rssi = static_cast<int32_t>(in.signedVarint());
+            break;
+        case TraceEventType::ServiceDeviceIdDiscovered:
+            event.id = in.id();
+            event.service = in.id();
+            event.rssi = static_cast<int32_t>(in.signedVarint());
+            break;
+        default:
+            known = false;
+            break;
+    }
+
+    // A torn or unknown record ends the trace; nothing after it can be framed
+    if (in.failed() || !known) {
+        m_truncated = true;
+        m_offset = m_data.size();
+        return false;
+    }
+    m_offset = in.offset();
+    m_timeNs = timeNs;
+    return true;
+}
+
+} // namespace PassBy
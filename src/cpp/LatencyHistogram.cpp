@@ -0,0 +1,57 @@
+#include "../internal/LatencyHistogram.h"
+#include <algorithm>
+
+namespace PassBy {
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_sum.store(0, std::memory_order_relaxed);
+    m_min.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+LatencySummary LatencyHistogram::summary() const {
+    uint64_t counts[kBucketCount];
+    uint64_t total = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+
+    LatencySummary summary;
+    if (total == 0) {
+        return summary;
+    }
+    uint64_t minValue = m_min.load(std::memory_order_relaxed);
+    uint64_t maxValue = m_max.load(std::memory_order_relaxed);
+    minValue = std::min(minValue, maxValue);    // A writer may be between its updates
+    summary.count = total;
+    summary.min = std::chrono::microseconds(minValue);
+    summary.max = std::chrono::microseconds(maxValue);
+    summary.mean = std::chrono::microseconds(m_sum.load(std::memory_order_relaxed) / total);
+
+    // Smallest bucket bound with at least fraction of the values at or below it
+    auto percentile = [&](double fraction) {
+        uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(fraction * total + 0.5));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return std::chrono::microseconds(std::min(std::max(bucketUpperBound(i), minValue), maxValue));
+            }
+        }
+        return std::chrono::microseconds(maxValue);
+    };
+    summary.p50 = percentile(0.50);
+    summary.p90 = percentile(0.90);
+    summary.p99 = percentile(0.99);
+    return summary;
+}
+
+} // namespace PassBy
@@ -2,121 +2,1560 @@
 #include "../internal/PassByBridge.h"
 #include "../internal/PlatformInterface.h"
 #include "../internal/PlatformFactory.h"
+#include "../internal/MPSCRingBuffer.h"
+#include "../internal/DiscoveryEvent.h"
+#include "../internal/EncounterStore.h"
+#include "../internal/EncounterLog.h"
+#include "../internal/DiscoveryBatcher.h"
+#include "../internal/ConnectionScheduler.h"
+#include "../internal/ResolvedPeripheralCache.h"
+#include "../internal/AdvertisementCodec.h"
+#include "../internal/DutyCycleController.h"
+#include "../internal/SubscriptionMatcher.h"
+#include "../internal/PipelineMetrics.h"
+#include "../internal/EventTrace.h"
+#include "../internal/RecentlySeenFilter.h"
+#include "../internal/EncounterAggregator.h"
+#include <algorithm>
+#include <chrono>
 
 namespace PassBy {
 
+// Bridge events buffered between producers and the dispatch thread
+static constexpr size_t kEventQueueCapacity = 4096;
+
+// Longest the registry snapshot lags behind the encounter store between flushes
+static constexpr int64_t kSnapshotIntervalMs = 100;
+
+// Fewest encounters exportEncounters() collects per pass over the store
+static constexpr size_t kExportBatchSize = 1024;
+
+// Scanning session as seen by readers
+struct SessionState {
+    bool scanning = false;
+    std::string serviceUUID;
+};
+
+// Copy of the encounter store for readers
+struct RegistrySnapshot {
+    uint64_t version = 0;   // m_registryVersion it was taken at
+    int64_t ttlMs = 0;      // Records may expire after the snapshot was taken
+    std::vector<EncounterInfo> encounters;
+    
+    bool isLive(const EncounterInfo& info, int64_t nowMs) const {
+        using namespace std::chrono;
+        return ttlMs <= 0 || nowMs - duration_cast<milliseconds>(info.lastSeen.time_since_epoch()).count() < ttlMs;
+    }
+};
+
+// One subscribe() call
+struct Subscription {
+    SubscriptionId id = 0;
+    SubscriptionFilter filter;
+    std::vector<DeviceId> services;     // Parsed filter.serviceUUIDs
+    std::shared_ptr<DeviceDiscoveredCallback> callback;
+};
+
+// Subscriptions compiled for the dispatch thread: matcher entry i calls callbacks[i].
+// The startScanning() session is an entry without a callback.
+struct SubscriptionSet {
+    SubscriptionMatcher matcher;
+    std::vector<std::shared_ptr<DeviceDiscoveredCallback>> callbacks;
+    
+    SubscriptionSet(std::vector<SubscriptionMatcher::Filter> filters, bool scanFiltered)
+        : matcher(std::move(filters), scanFiltered) {}
+};
+
+static_assert(SubscriptionFilter::kAnyRssi == SubscriptionMatcher::kAnyRssi, "RSSI sentinels differ");
+static_assert(DeviceView::kUnknownRssi == SubscriptionMatcher::kUnknownRssi, "RSSI sentinels differ");
+
+// The per-discovery callbacks, inline or as a callback executor task
+static void runDiscoveryCallbacks(const DeviceView& view, const DeviceViewCallback* viewCallback,
+                                  const DeviceDiscoveredCallback* callback, const SubscriptionSet* subscriptions,
+                                  const std::vector<size_t>& matched) {
+    if (viewCallback) {
+        (*viewCallback)(view);
+    }
+    if (callback) {
+        DeviceInfo device(std::string(view.uuid), view.id);
+        (*callback)(device);
+    }
+    for (size_t index : matched) {
+        if (const auto& subscriber = subscriptions->callbacks[index]) {
+            DeviceInfo device(std::string(view.uuid), view.id);
+            (*subscriber)(device);
+        }
+    }
+}
+
 // Static member definitions
 std::unique_ptr<PassByManager> PassByManager::s_instance = nullptr;
+std::atomic<PassByManager*> PassByManager::s_current{nullptr};
 std::mutex PassByManager::s_mutex;
 
 PassByManager& PassByManager::getInstance() {
+    PassByManager* current = s_current.load(std::memory_order_acquire);
+    if (current) {
+        return *current;
+    }
+    
     std::lock_guard<std::mutex> lock(s_mutex);
     if (!s_instance) {
-        // Use a temporary unique_ptr to ensure proper initialization
-        auto temp = std::unique_ptr<PassByManager>(new PassByManager());
-        s_instance = std::move(temp);
+        s_instance = std::make_unique<PassByManager>();
+        // The default context also receives events from unbound platform code
+        PassByBridge::setManager(s_instance.get());
+        s_current.store(s_instance.get(), std::memory_order_release);
     }
     return *s_instance;
 }
 
 
-PassByManager::PassByManager() : m_isScanning(false), m_deviceCallback(nullptr), m_advertisingCallback(nullptr), m_currentServiceUUID("") {
-    // Create platform using factory
-    m_platform = PlatformFactory::createPlatform();
+PassByManager::PassByManager() : PassByManager(PlatformFactory::createPlatform()) {
+}
+
+PassByManager::PassByManager(std::unique_ptr<PlatformInterface> platform)
+    : m_session(std::make_shared<const SessionState>()), m_nextSubscriptionId(1), m_platformScanning(false),
+      m_encounters(new EncounterStore()), m_deviceCallback(nullptr), m_advertisingCallback(nullptr),
+      m_platform(std::move(platform)), m_registrySnapshot(std::make_shared<RegistrySnapshot>()),
+      m_registryVersion(0), m_snapshotPublishedMs(0),
+      m_eventQueue(new MPSCRingBuffer<DiscoveryEvent>(kEventQueueCapacity)), m_droppedEvents(0),
+      m_controlQueued(0), m_controlApplied(0),
+      m_metrics(new PipelineMetrics()), m_tracing(false),
+      m_dispatchSleeping(false), m_dispatchRunning(true), m_processedEvents(0), m_flushWaiters(0),
+      m_batcher(new DiscoveryBatcher()), m_scheduler(new ConnectionScheduler()),
+      m_resolvedCache(new ResolvedPeripheralCache()), m_dutyCycle(new DutyCycleController()),
+      m_scanSessionActive(false), m_radioParked(false), m_advertisingReported(false) {
+    applyConnectionPolicy(ConnectionPolicy());
+    
+    // The platform reports to this context
+    if (m_platform) {
+        m_platform->attach(this);
+    }
     
-    // Automatically register this manager with the bridge
-    PassByBridge::setManager(this);
+    // Dispatch thread owns all event-driven state mutation and runs user callbacks
+    m_dispatchThread = std::thread(&PassByManager::dispatchLoop, this);
 }
 
 PassByManager::~PassByManager() {
-    if (m_isScanning) {
+    if (isScanning()) {
         stopScanning();
     }
+    
+    // Stop routing bridge events here before tearing down the queue
+    if (PassByBridge::getManager() == this) {
+        PassByBridge::setManager(nullptr);
+    }
+    
+    // Pending events are discarded. The platform goes before the queue it reports into.
+    stopDispatchThread();
+    drainCallbackExecutor();
+    m_platform.reset();
+    closeEncounterLog();
+    stopEventTrace();
 }
 
 bool PassByManager::startScanning(const std::string& serviceUUID) {
-    if (m_isScanning) {
+    std::lock_guard<std::mutex> sessionLock(m_sessionMutex);
+    if (session()->scanning) {
         return false;
     }
     
-    // Store the service UUID for this scanning session
-    m_currentServiceUUID = serviceUUID;
-    
-    // Use platform interface if available
-    if (m_platform) {
-        if (m_platform->startBLE(serviceUUID)) {
-            m_isScanning = true;
-            return true;
-        }
+    if (!updateScan(true, serviceUUID)) {
         return false;
     }
-    
-    // Default behavior for testing
-    m_isScanning = true;
+    publishSession(true, serviceUUID);
+    publishSubscriptions(true, serviceUUID);
     return true;
 }
 
 bool PassByManager::stopScanning() {
-    if (!m_isScanning) {
+    std::lock_guard<std::mutex> sessionLock(m_sessionMutex);
+    if (!session()->scanning) {
         return false;
     }
     
-    // Use platform interface if available
-    if (m_platform) {
-        if (m_platform->stopBLE()) {
-            m_isScanning = false;
-            m_currentServiceUUID.clear(); // Clear service UUID when stopping
-            return true;
-        }
+    // Subscriptions may keep the platform scanning
+    if (!updateScan(false, "")) {
         return false;
     }
+    publishSession(false, "");
+    publishSubscriptions(false, "");
     
-    // Default behavior for testing
-    m_isScanning = false;
-    m_currentServiceUUID.clear(); // Clear service UUID when stopping
+    // Everything reported before the stop reaches the batch callback before we return
+    requestBatchFlush();
+    flushEvents();
+    
+    std::lock_guard<std::mutex> lock(m_devicesMutex);
+    if (m_encounterLog) {
+        m_encounterLog->sync();
+    }
     return true;
 }
 
 bool PassByManager::isScanning() const {
-    return m_isScanning;
+    return session()->scanning;
+}
+
+SubscriptionId PassByManager::subscribe(const SubscriptionFilter& filter, DeviceDiscoveredCallback callback) {
+    auto subscription = std::make_shared<Subscription>();
+    subscription->filter = filter;
+    for (const std::string& service : filter.serviceUUIDs) {
+        DeviceId id;
+        if (!DeviceId::parse(service, id)) {
+            return 0;
+        }
+        subscription->services.push_back(id);
+    }
+    if (callback) {
+        subscription->callback = std::make_shared<DeviceDiscoveredCallback>(std::move(callback));
+    }
+    
+    std::lock_guard<std::mutex> sessionLock(m_sessionMutex);
+    auto current = session();
+    subscription->id = m_nextSubscriptionId++;
+    m_subscriptions.push_back(subscription);
+    if (!updateScan(current->scanning, current->serviceUUID)) {
+        m_subscriptions.pop_back();
+        return 0;
+    }
+    publishSubscriptions(current->scanning, current->serviceUUID);
+    return subscription->id;
+}
+
+bool PassByManager::unsubscribe(SubscriptionId id) {
+    {
+        std::lock_guard<std::mutex> sessionLock(m_sessionMutex);
+        auto it = std::find_if(m_subscriptions.begin(), m_subscriptions.end(),
+                               [id](const std::shared_ptr<const Subscription>& subscription) {
+                                   return subscription->id == id;
+                               });
+        if (it == m_subscriptions.end()) {
+            return false;
+        }
+        
+        // Stops delivering even if the platform scan cannot be narrowed
+        auto current = session();
+        m_subscriptions.erase(it);
+        updateScan(current->scanning, current->serviceUUID);
+        publishSubscriptions(current->scanning, current->serviceUUID);
+    }
+    
+    // The callback may be running; it is not called again once this returns
+    flushEvents();
+    return true;
+}
+
+std::string PassByManager::scanFilter(bool sessionScanning, const std::string& sessionService) const {
+    // Platforms take one service filter: the one everybody wants, or none (the matcher filters)
+    const std::string* filter = nullptr;
+    DeviceId filterId;
+    bool filterParsed = false;
+    auto merge = [&](const std::string& service) {
+        if (!filter) {
+            filter = &service;
+            filterParsed = DeviceId::parse(service, filterId);
+            return true;
+        }
+        DeviceId id;
+        if (filterParsed && DeviceId::parse(service, id)) {
+            return id == filterId;
+        }
+        return service == *filter;
+    };
+    
+    if (sessionScanning && (sessionService.empty() || !merge(sessionService))) {
+        return "";
+    }
+    for (const auto& subscription : m_subscriptions) {
+        if (subscription->filter.serviceUUIDs.empty()) {
+            return "";
+        }
+        for (const std::string& service : subscription->filter.serviceUUIDs) {
+            if (!merge(service)) {
+                return "";
+            }
+        }
+    }
+    return filter ? *filter : std::string();
+}
+
+bool PassByManager::updateScan(bool sessionScanning, const std::string& sessionService) {
+    bool wanted = sessionScanning || !m_subscriptions.empty();
+    std::string filter = wanted ? scanFilter(sessionScanning, sessionService) : std::string();
+    if (m_platformScanning && wanted && filter == m_platformFilter) {
+        return true;
+    }
+    
+    std::string previous = m_platformFilter;
+    bool restarting = m_platformScanning;
+    if (m_platformScanning) {
+        // Take the radio back from the duty cycle before stopping it; a parked radio is off already
+        pushControlEvent(DiscoveryEvent::Type::DutyCycleStop);
+        flushEvents();
+        if (m_platform && !m_radioParked && !m_platform->stopBLE()) {
+            pushDutyCycleStart(previous);
+            return false;
+        }
+        m_platformScanning = false;
+        
+        // No connection scheduled by the core outlives the scan
+        pushControlEvent(DiscoveryEvent::Type::StopConnections);
+    }
+    if (!wanted) {
+        return true;
+    }
+    
+    // Ordered before the advertising report of the start below, so that one is delivered
+    // and the duty cycle's restarts within the session are not
+    pushControlEvent(DiscoveryEvent::Type::DutyCycleStop);
+    if (m_platform && !m_platform->startBLE(filter)) {
+        // Keep the scan the others had
+        if (restarting && m_platform->startBLE(previous)) {
+            m_platformScanning = true;
+            pushDutyCycleStart(previous);
+        }
+        return false;
+    }
+    m_platformScanning = true;
+    m_platformFilter = filter;
+    pushDutyCycleStart(filter);
+    return true;
+}
+
+void PassByManager::publishSubscriptions(bool sessionScanning, const std::string& sessionService) {
+    std::shared_ptr<const SubscriptionSet> set;
+    if (!m_subscriptions.empty()) {
+        std::vector<SubscriptionMatcher::Filter> filters;
+        std::vector<std::shared_ptr<DeviceDiscoveredCallback>> callbacks;
+        if (sessionScanning) {
+            // An unparsable session filter is taken to be a platform-specific name: accept everything
+            SubscriptionMatcher::Filter filter;
+            DeviceId service;
+            if (DeviceId::parse(sessionService, service)) {
+                filter.services.push_back(service);
+            }
+            filters.push_back(std::move(filter));
+            callbacks.push_back(nullptr);
+        }
+        for (const auto& subscription : m_subscriptions) {
+            SubscriptionMatcher::Filter filter;
+            filter.services = subscription->services;
+            filter.prefixes = subscription->filter.identifierPrefixes;
+            filter.minRssi = subscription->filter.minRssi;
+            filters.push_back(std::move(filter));
+            callbacks.push_back(subscription->callback);
+        }
+        auto compiled = std::make_shared<SubscriptionSet>(std::move(filters), !m_platformFilter.empty());
+        compiled->callbacks = std::move(callbacks);
+        set = std::move(compiled);
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(m_callbackMutex);
+        m_subscriptionSet = std::move(set);
+    }
+    pushControlEvent(DiscoveryEvent::Type::ConfigurationChanged);
+}
+
+std::shared_ptr<const SessionState> PassByManager::session() const {
+    return std::atomic_load_explicit(&m_session, std::memory_order_acquire);
+}
+
+void PassByManager::publishSession(bool scanning, const std::string& serviceUUID) {
+    auto state = std::make_shared<SessionState>();
+    state->scanning = scanning;
+    state->serviceUUID = serviceUUID;
+    std::atomic_store_explicit(&m_session, std::shared_ptr<const SessionState>(std::move(state)),
+                               std::memory_order_release);
 }
 
 void PassByManager::setDeviceDiscoveredCallback(DeviceDiscoveredCallback callback) {
-    m_deviceCallback = callback;
+    auto holder = callback ? std::make_shared<DeviceDiscoveredCallback>(std::move(callback)) : nullptr;
+    std::lock_guard<std::mutex> lock(m_callbackMutex);
+    m_deviceCallback = std::move(holder);
+}
+
+void PassByManager::setDeviceViewCallback(DeviceViewCallback callback) {
+    auto holder = callback ? std::make_shared<DeviceViewCallback>(std::move(callback)) : nullptr;
+    std::lock_guard<std::mutex> lock(m_callbackMutex);
+    m_deviceViewCallback = std::move(holder);
+}
+
+void PassByManager::setDeviceBatchCallback(DeviceBatchCallback callback, const BatchOptions& options) {
+    std::shared_ptr<const BatchSubscription> holder;
+    if (callback) {
+        holder = std::make_shared<BatchSubscription>(BatchSubscription{std::move(callback), options});
+    }
+    std::lock_guard<std::mutex> lock(m_callbackMutex);
+    m_batchSubscription = std::move(holder);
+}
+
+void PassByManager::setConnectionPolicy(const ConnectionPolicy& policy) {
+    auto holder = std::make_shared<const ConnectionPolicy>(policy);
+    {
+        std::lock_guard<std::mutex> lock(m_callbackMutex);
+        m_connectionPolicy = std::move(holder);
+    }
+    // Applied by the dispatch thread on its next pass
+    pushControlEvent(DiscoveryEvent::Type::ConfigurationChanged);
+}
+
+void PassByManager::setDutyCycle(const DutyCycleOptions& options) {
+    auto holder = std::make_shared<const DutyCycleOptions>(options);
+    {
+        std::lock_guard<std::mutex> lock(m_callbackMutex);
+        m_dutyCycleOptions = std::move(holder);
+    }
+    pushControlEvent(DiscoveryEvent::Type::ConfigurationChanged);
+}
+
+void PassByManager::setDuplicateFilter(const DuplicateFilterOptions& options) {
+    auto holder = std::make_shared<const DuplicateFilterOptions>(options);
+    {
+        std::lock_guard<std::mutex> lock(m_callbackMutex);
+        m_duplicateFilterOptions = std::move(holder);
+    }
+    pushControlEvent(DiscoveryEvent::Type::ConfigurationChanged);
 }
 
 void PassByManager::setAdvertisingStartedCallback(AdvertisingStartedCallback callback) {
-    m_advertisingCallback = callback;
+    auto holder = callback ? std::make_shared<AdvertisingStartedCallback>(std::move(callback)) : nullptr;
+    std::lock_guard<std::mutex> lock(m_callbackMutex);
+    m_advertisingCallback = std::move(holder);
+}
+
+void PassByManager::setCallbackExecutor(std::shared_ptr<CallbackExecutor> executor) {
+    std::shared_ptr<CallbackExecutor> previous;
+    {
+        std::lock_guard<std::mutex> lock(m_callbackMutex);
+        previous = std::move(m_callbackExecutor);
+        m_callbackExecutor = std::move(executor);
+    }
+    // Events already queued may still go to the previous executor; let them finish there
+    if (previous && !previous->isExecutorThread()) {
+        flushEvents();
+        previous->drain();
+    }
+}
+
+std::shared_ptr<CallbackExecutor> PassByManager::callbackExecutor() const {
+    std::lock_guard<std::mutex> lock(m_callbackMutex);
+    return m_callbackExecutor;
 }
 
+void PassByManager::drainCallbackExecutor() {
+    if (auto executor = callbackExecutor()) {
+        executor->drain();
+    }
+}
+
+namespace {
+
+void fillEncounterInfo(const EncounterStore& store, const EncounterRecord& record, EncounterInfo& info) {
+    using std::chrono::milliseconds;
+    using std::chrono::system_clock;
+    
+    store.identifierString(record, info.uuid);
+    info.id = record.id;
+    info.firstSeen = system_clock::time_point(milliseconds(record.firstSeenMs));
+    info.lastSeen = system_clock::time_point(milliseconds(record.lastSeenMs));
+    info.hitCount = record.hitCount;
+}
+
+} // namespace
+
 std::vector<std::string> PassByManager::getDiscoveredDevices() const {
-    return std::vector<std::string>(m_discoveredDevices.begin(), m_discoveredDevices.end());
+    int64_t now = currentTimeMs();
+    auto snapshot = registrySnapshot();
+    std::vector<std::string> devices;
+    devices.reserve(snapshot->encounters.size());
+    for (const auto& encounter : snapshot->encounters) {
+        if (snapshot->isLive(encounter, now)) {
+            devices.push_back(encounter.uuid);
+        }
+    }
+    return devices;
 }
 
 void PassByManager::clearDiscoveredDevices() {
-    m_discoveredDevices.clear();
+    if (onDispatchThread()) {
+        clearDevices();
+        return;
+    }
+    pushControlEvent(DiscoveryEvent::Type::ClearDevices);
+    flushEvents();
 }
 
-const std::string& PassByManager::getCurrentServiceUUID() const {
-    return m_currentServiceUUID;
+void PassByManager::clearDevices() {
+    std::lock_guard<std::mutex> lock(m_devicesMutex);
+    m_encounters->clear();
+    if (m_encounterLog) {
+        m_encounterLog->reset();
+    }
+    registryChanged();
+    if (m_duplicateFilter) {
+        m_duplicateFilter->clear();
+    }
+    if (m_aggregator) {
+        m_aggregator->clear();
+    }
 }
 
-void PassByManager::onDeviceDiscovered(const std::string& uuid) {
-    // Store device in memory
-    m_discoveredDevices.insert(uuid);
+void PassByManager::registryChanged() {
+    m_registryVersion.fetch_add(1, std::memory_order_release);
+}
+
+std::shared_ptr<const RegistrySnapshot> PassByManager::registrySnapshot() const {
+    return std::atomic_load_explicit(&m_registrySnapshot, std::memory_order_acquire);
+}
+
+bool PassByManager::registrySnapshotStale() const {
+    return registrySnapshot()->version < m_registryVersion.load(std::memory_order_acquire);
+}
+
+void PassByManager::publishRegistrySnapshot() const {
+    int64_t now = currentTimeMs();
+    std::lock_guard<std::mutex> lock(m_devicesMutex);
+    // Refill the snapshot published before the current one if no reader holds it any more
+    // (nothing else can take a reference to it), so steady-state publishing does not allocate
+    std::shared_ptr<RegistrySnapshot> snapshot = std::move(m_spareSnapshot);
+    if (!snapshot || snapshot.use_count() > 1) {
+        snapshot = std::make_shared<RegistrySnapshot>();
+    }
+#ifndef __SANITIZE_THREAD__   // GCC warns that ThreadSanitizer does not model fences
+    std::atomic_thread_fence(std::memory_order_acquire);   // After the last reader's release
+#endif
+    snapshot->version = m_registryVersion.load(std::memory_order_relaxed);
+    snapshot->ttlMs = m_encounters->ttlMs();
+    auto& encounters = snapshot->encounters;
+    size_t count = 0;
+    m_encounters->forEach(now, [&](const EncounterRecord& record) {
+        if (count == encounters.size()) {
+            encounters.emplace_back();
+        }
+        fillEncounterInfo(*m_encounters, record, encounters[count++]);
+    });
+    encounters.resize(count);
+    // Published under the lock, so a callback publishing too cannot put an older one back
+    auto previous = std::atomic_exchange_explicit(&m_registrySnapshot, std::shared_ptr<const RegistrySnapshot>(snapshot),
+                                                  std::memory_order_acq_rel);
+    m_spareSnapshot = std::const_pointer_cast<RegistrySnapshot>(previous);
+}
+
+std::vector<EncounterInfo> PassByManager::getEncounters() const {
+    int64_t now = currentTimeMs();
+    auto snapshot = registrySnapshot();
+    std::vector<EncounterInfo> encounters;
+    encounters.reserve(snapshot->encounters.size());
+    for (const auto& encounter : snapshot->encounters) {
+        if (snapshot->isLive(encounter, now)) {
+            encounters.push_back(encounter);
+        }
+    }
+    return encounters;
+}
+
+bool PassByManager::exportEncounters(const ExportSink& sink, size_t chunkSize) const {
+    using namespace std::chrono;
     
-    // Call user callback if set
-    if (m_deviceCallback) {
-        DeviceInfo device(uuid);
-        m_deviceCallback(device);
+    // Streamed from the store in id-ordered batches, taking the device lock only to collect
+    // each batch. The store retains what changes in between, so exactly the encounters live
+    // when the export began are written, each with its latest state.
+    int64_t now = currentTimeMs();
+    uint64_t count = 0;
+    uint64_t generation;
+    int64_t baseMs = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_devicesMutex);
+        m_encounters->forEach(now, [&](const EncounterRecord& record) {
+            baseMs = count == 0 ? record.firstSeenMs : std::min(baseMs, record.firstSeenMs);
+            ++count;
+        });
+        generation = m_encounters->generation();
+        m_encounters->retainHistory(true);
     }
+    
+    // At most about 16 passes over the store, however large it is
+    size_t batchSize = std::max<size_t>(kExportBatchSize, static_cast<size_t>(count / 16 + 1));
+    struct Candidate {
+        const EncounterRecord* record;
+        std::string_view alias;
+    };
+    struct Entry {
+        DeviceId id;
+        int64_t firstSeenMs;
+        int64_t lastSeenMs;
+        uint32_t hitCount;
+        std::string alias;
+    };
+    auto byId = [](const Candidate& a, const Candidate& b) { return a.record->id < b.record->id; };
+    std::vector<Candidate> heap;
+    std::vector<Entry> batch;
+    heap.reserve(batchSize);
+    
+    EncounterExportWriter writer(sink, chunkSize);
+    bool ok = writer.begin(count, baseMs);
+    uint64_t written = 0;
+    DeviceId after;
+    while (ok && written < count) {
+        {
+            // The batchSize lowest ids after the previous batch
+            std::lock_guard<std::mutex> lock(m_devicesMutex);
+            heap.clear();
+            m_encounters->forEachAsOf(generation, now, [&](const EncounterRecord& record, std::string_view alias) {
+                if (written > 0 && !(after < record.id)) {
+                    return;
+                }
+                if (heap.size() == batchSize) {
+                    if (!(record.id < heap.front().record->id)) {
+                        return;
+                    }
+                    std::pop_heap(heap.begin(), heap.end(), byId);
+                    heap.pop_back();
+                }
+                heap.push_back(Candidate{&record, alias});
+                std::push_heap(heap.begin(), heap.end(), byId);
+            });
+            std::sort_heap(heap.begin(), heap.end(), byId);
+            batch.resize(heap.size());
+            for (size_t i = 0; i < heap.size(); ++i) {
+                const EncounterRecord& record = *heap[i].record;
+                batch[i].id = record.id;
+                batch[i].firstSeenMs = record.firstSeenMs;
+                batch[i].lastSeenMs = record.lastSeenMs;
+                batch[i].hitCount = record.hitCount;
+                batch[i].alias.assign(heap[i].alias.data(), heap[i].alias.size());
+            }
+        }
+        if (batch.empty()) {
+            break;
+        }
+        for (const Entry& entry : batch) {
+            ok = writer.add(EncounterView{entry.alias, entry.id, system_clock::time_point(milliseconds(entry.firstSeenMs)),
+                                          system_clock::time_point(milliseconds(entry.lastSeenMs)), entry.hitCount});
+            if (!ok) {
+                break;
+            }
+        }
+        written += batch.size();
+        after = batch.back().id;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(m_devicesMutex);
+        m_encounters->retainHistory(false);
+    }
+    return ok && writer.finish();
+}
+
+EncounterDelta PassByManager::getDiscoveredSince(uint64_t generation) const {
+    int64_t now = currentTimeMs();
+    std::lock_guard<std::mutex> lock(m_devicesMutex);
+    // Devices that timed out since the caller's generation are reported as removed
+    m_encounters->expireStale(now);
+    EncounterDelta delta;
+    delta.generation = m_encounters->generation();
+    
+    auto changed = [&](const EncounterRecord& record) {
+        delta.changed.emplace_back();
+        fillEncounterInfo(*m_encounters, record, delta.changed.back());
+    };
+    auto removed = [&](const DeviceId& id) {
+        // Skip devices that came back after being removed
+        if (!m_encounters->find(id, now)) {
+            delta.removed.push_back(id);
+        }
+    };
+    
+    if (generation > delta.generation || !m_encounters->changesSince(generation, now, changed, removed)) {
+        delta.reset = true;
+        delta.changed.clear();
+        delta.removed.clear();
+        delta.changed.reserve(m_encounters->size());
+        m_encounters->forEach(now, changed);
+    }
+    return delta;
+}
+
+void PassByManager::visitEncounters(const EncounterVisitor& visitor) const {
+    using std::chrono::milliseconds;
+    using std::chrono::system_clock;
+    
+    int64_t now = currentTimeMs();
+    auto snapshot = registrySnapshot();
+    for (const auto& encounter : snapshot->encounters) {
+        if (snapshot->isLive(encounter, now)) {
+            visitor(EncounterView{encounter.uuid, encounter.id, encounter.firstSeen, encounter.lastSeen,
+                                  encounter.hitCount});
+        }
+    }
+}
+
+void PassByManager::setEncounterPolicy(const EncounterPolicy& policy) {
+    {
+        std::lock_guard<std::mutex> lock(m_devicesMutex);
+        m_encounters->configure(policy.timeToLive.count(), policy.maxMemoryBytes);
+        registryChanged();
+    }
+    publishRegistrySnapshot();
+}
+
+size_t PassByManager::getEncounterMemoryUsage() const {
+    std::lock_guard<std::mutex> lock(m_devicesMutex);
+    return m_encounters->memoryUsage();
+}
+
+void PassByManager::setAggregation(const AggregationOptions& options) {
+    std::unique_ptr<EncounterAggregator> aggregator;
+    if (options.enabled) {
+        aggregator.reset(new EncounterAggregator(options.sessionGap.count(), options.rssiSmoothing,
+                                                 options.maxDevices));
+    }
+    std::lock_guard<std::mutex> lock(m_devicesMutex);
+    m_aggregator = std::move(aggregator);
+}
+
+std::vector<EncounterStats> PassByManager::getTopEncounters(EncounterRanking ranking, size_t k) const {
+    using std::chrono::milliseconds;
+    using std::chrono::system_clock;
+    
+    std::vector<EncounterStats> top;
+    std::lock_guard<std::mutex> lock(m_devicesMutex);
+    if (!m_aggregator) {
+        return top;
+    }
+    top.reserve(std::min(k, m_aggregator->size()));
+    m_aggregator->top(ranking, k, [&](const DeviceId& id, const EncounterAggregate& aggregate) {
+        EncounterStats stats;
+        stats.uuid = aggregate.alias.empty() ? id.toString() : aggregate.alias;
+        stats.id = id;
+        stats.firstSeen = system_clock::time_point(milliseconds(aggregate.firstSeenMs));
+        stats.lastSeen = system_clock::time_point(milliseconds(aggregate.lastSeenMs));
+        stats.sightings = aggregate.sightings;
+        stats.visits = aggregate.visits;
+        stats.dwell = milliseconds(aggregate.dwellMs());
+        stats.hasRssi = aggregate.hasRssi;
+        stats.rssi = aggregate.rssi;
+        top.push_back(std::move(stats));
+    });
+    return top;
+}
+
+bool PassByManager::openEncounterLog(const std::string& path) {
+    closeEncounterLog();
+    
+    auto log = std::unique_ptr<EncounterLog>(new EncounterLog());
+    if (!log->open(path)) {
+        return false;
+    }
+    
+    int64_t now = currentTimeMs();
+    {
+        std::lock_guard<std::mutex> lock(m_devicesMutex);
+        bool hadEncounters = m_encounters->size() > 0;
+        log->load(*m_encounters, now);
+        if (hadEncounters) {
+            // Encounters from before the log was opened are not in it yet
+            log->compact(*m_encounters, now);
+        }
+        m_encounters->setChangeTracking(true);
+        registryChanged();
+        m_encounterLog = std::move(log);
+    }
+    publishRegistrySnapshot();
+    return true;
+}
+
+void PassByManager::closeEncounterLog() {
+    // Let the dispatch thread persist everything already reported
+    flushEvents();
+    
+    std::lock_guard<std::mutex> lock(m_devicesMutex);
+    if (!m_encounterLog) {
+        return;
+    }
+    m_encounters->drainChanges([&](const EncounterRecord& record) {
+        m_encounterLog->append(record, m_encounters->aliasOf(record));
+    });
+    m_encounters->setChangeTracking(false);
+    m_encounterLog->close();
+    m_encounterLog.reset();
+}
+
+void PassByManager::persistEncounters() {
+    std::lock_guard<std::mutex> lock(m_devicesMutex);
+    if (!m_encounterLog) {
+        return;
+    }
+    // One entry per changed device per burst, however often it was seen
+    m_encounters->drainChanges([&](const EncounterRecord& record) {
+        m_encounterLog->append(record, m_encounters->aliasOf(record));
+    });
+    // Only the copy of the live records happens under the lock; the rewrite and its fsync
+    // run on the log's own thread and are picked up by a later burst
+    if (m_encounterLog->isCompacting()) {
+        m_encounterLog->finishCompaction(*m_encounters, currentTimeMs());
+    } else if (m_encounterLog->shouldCompact(m_encounters->size())) {
+        m_encounterLog->startCompaction(*m_encounters, currentTimeMs());
+    }
+}
+
+int64_t PassByManager::steadyTimeMs() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t PassByManager::currentTimeMs() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+std::string PassByManager::getCurrentServiceUUID() const {
+    return session()->serviceUUID;
+}
+
+bool PassByManager::startEventTrace(const std::string& path) {
+    std::lock_guard<std::mutex> lock(m_traceMutex);
+    auto trace = std::make_shared<EventTraceWriter>();
+    if (!trace->open(path, currentTimeMs())) {
+        return false;
+    }
+    if (auto previous = std::atomic_exchange(&m_trace, trace)) {
+        previous->close();
+    }
+    m_tracing.store(true, std::memory_order_release);
+    return true;
+}
+
+uint64_t PassByManager::stopEventTrace() {
+    std::lock_guard<std::mutex> lock(m_traceMutex);
+    m_tracing.store(false, std::memory_order_release);
+    // A producer still holding the writer finds it closed
+    auto trace = std::atomic_exchange(&m_trace, std::shared_ptr<EventTraceWriter>());
+    return trace ? trace->close() : 0;
+}
+
+void PassByManager::traceEvent(const TraceEvent& event) {
+    if (auto trace = std::atomic_load(&m_trace)) {
+        trace->append(event);
+    }
+}
+
+void PassByManager::onDeviceDiscovered(std::string_view uuid) {
+    if (m_tracing.load(std::memory_order_relaxed)) {
+        TraceEvent event(TraceEventType::DeviceDiscovered);
+        event.text = uuid;
+        traceEvent(event);
+    }
+    queueDiscovery(DiscoveryEvent::Type::DeviceDiscovered, DeviceId(), uuid, nullptr,
+                   SubscriptionMatcher::kUnknownRssi);
+}
+
+void PassByManager::onDeviceDiscovered(std::string_view uuid, const DeviceId& service, int rssi) {
+    if (m_tracing.load(std::memory_order_relaxed)) {
+        TraceEvent event(TraceEventType::ServiceDeviceDiscovered);
+        event.text = uuid;
+        event.service = service;
+        event.rssi = rssi;
+        traceEvent(event);
+    }
+    queueDiscovery(DiscoveryEvent::Type::DeviceDiscovered, DeviceId(), uuid, &service, rssi);
+}
+
+void PassByManager::onPeripheralIdentifierRead(const DeviceId& peripheral, std::string_view uuid) {
+    if (m_tracing.load(std::memory_order_relaxed)) {
+        TraceEvent event(TraceEventType::PeripheralIdentifierRead);
+        event.id = peripheral;
+        event.text = uuid;
+        traceEvent(event);
+    }
+    queueDiscovery(DiscoveryEvent::Type::PeripheralIdentifierRead, peripheral, uuid, nullptr,
+                   SubscriptionMatcher::kUnknownRssi);
+}
+
+void PassByManager::queueDiscovery(DiscoveryEvent::Type type, const DeviceId& peripheral, std::string_view uuid,
+                                   const DeviceId* service, int rssi) {
+    if (uuid.size() > DiscoveryEvent::kMaxIdentifierLength) {
+        m_droppedEvents.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    
+    // Parse once at the bridge boundary; keep the text only for non-UUID identifiers
+    bool canonical = false;
+    DeviceId id = DeviceId::fromString(uuid, &canonical);
+    int64_t now = currentTimeMs();
+    int64_t queuedUs = PipelineMetrics::now();
+    
+    bool queued = m_eventQueue->tryPush([&](DiscoveryEvent& event) {
+        event.type = type;
+        event.deviceId = id;
+        event.peripheral = peripheral;
+        event.timestampMs = now;
+        event.queuedUs = queuedUs;
+        event.canonicalId = canonical;
+        event.setIdentifier(canonical ? std::string_view() : uuid);
+        event.hasService = service != nullptr;
+        event.service = service ? *service : DeviceId();
+        event.rssi = static_cast<int16_t>(rssi);
+    });
+    if (!queued) {
+        m_droppedEvents.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    wakeDispatchThread();
+}
+
+void PassByManager::onPeripheralDiscovered(const DeviceId& peripheral, int rssi) {
+    if (m_tracing.load(std::memory_order_relaxed)) {
+        TraceEvent event(TraceEventType::PeripheralDiscovered);
+        event.id = peripheral;
+        event.rssi = rssi;
+        traceEvent(event);
+    }
+    queuePeripheral(peripheral, nullptr, rssi);
+}
+
+void PassByManager::queuePeripheral(const DeviceId& peripheral, const DeviceId* service, int rssi) {
+    int64_t now = currentTimeMs();
+    int64_t queuedUs = PipelineMetrics::now();
+    
+    bool queued = m_eventQueue->tryPush([&](DiscoveryEvent& event) {
+        event.type = DiscoveryEvent::Type::PeripheralDiscovered;
+        event.peripheral = peripheral;
+        event.rssi = static_cast<int16_t>(rssi);
+        event.hasService = service != nullptr;
+        event.service = service ? *service : DeviceId();
+        event.timestampMs = now;
+        event.queuedUs = queuedUs;
+    });
+    if (!queued) {
+        m_droppedEvents.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    wakeDispatchThread();
+}
+
+void PassByManager::onPeripheralAdvertisement(const DeviceId& peripheral, int rssi, const uint8_t* data,
+                                              size_t length) {
+    if (m_tracing.load(std::memory_order_relaxed)) {
+        TraceEvent event(TraceEventType::PeripheralAdvertisement);
+        event.id = peripheral;
+        event.rssi = rssi;
+        event.data = data;
+        event.length = length;
+        traceEvent(event);
+    }
+    
+    DeviceId service;
+    const DeviceId* advertisedService =
+        AdvertisementCodec::decodeServiceUuid(data, length, service) ? &service : nullptr;
+    
+    // Peers that advertise their identifier need no connection at all
+    AdvertisedIdentifier advertised;
+    if (AdvertisementCodec::decodeAdvertisement(data, length, advertised)) {
+        queueIdentifier(advertised.id, advertisedService, rssi);
+        return;
+    }
+    queuePeripheral(peripheral, advertisedService, rssi);
+}
+
+void PassByManager::onPeripheralConnectionFailed(const DeviceId& peripheral) {
+    if (m_tracing.load(std::memory_order_relaxed)) {
+        TraceEvent event(TraceEventType::PeripheralConnectionFailed);
+        event.id = peripheral;
+        traceEvent(event);
+    }
+    
+    // Losing this would keep a connection slot taken until the timeout, so wait for
+    // room (except on the dispatch thread, which is the one making room)
+    auto fill = [&](DiscoveryEvent& event) {
+        event.type = DiscoveryEvent::Type::PeripheralConnectionFailed;
+        event.peripheral = peripheral;
+    };
+    bool onDispatchThread = std::this_thread::get_id() == m_dispatchThread.get_id();
+    while (!m_eventQueue->tryPush(fill)) {
+        if (onDispatchThread) {
+            m_droppedEvents.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        std::this_thread::yield();
+    }
+    wakeDispatchThread();
+}
+
+void PassByManager::onDeviceDiscovered(const DeviceId& id) {
+    if (m_tracing.load(std::memory_order_relaxed)) {
+        TraceEvent event(TraceEventType::DeviceIdDiscovered);
+        event.id = id;
+        traceEvent(event);
+    }
+    queueIdentifier(id, nullptr, SubscriptionMatcher::kUnknownRssi);
+}
+
+void PassByManager::onDeviceDiscovered(const DeviceId& id, int rssi) {
+    if (m_tracing.load(std::memory_order_relaxed)) {
+        TraceEvent event(TraceEventType::RssiDeviceIdDiscovered);
+        event.id = id;
+        event.rssi = rssi;
+        traceEvent(event);
+    }
+    queueIdentifier(id, nullptr, rssi);
+}
+
+void PassByManager::onDeviceDiscovered(const DeviceId& id, const DeviceId& service, int rssi) {
+    if (m_tracing.load(std::memory_order_relaxed)) {
+        TraceEvent event(TraceEventType::ServiceDeviceIdDiscovered);
+        event.id = id;
+        event.service = service;
+        event.rssi = rssi;
+        traceEvent(event);
+    }
+    queueIdentifier(id, &service, rssi);
+}
+
+void PassByManager::queueIdentifier(const DeviceId& id, const DeviceId* service, int rssi) {
+    int64_t now = currentTimeMs();
+    int64_t queuedUs = PipelineMetrics::now();
+    
+    bool queued = m_eventQueue->tryPush([&](DiscoveryEvent& event) {
+        event.type = DiscoveryEvent::Type::DeviceDiscovered;
+        event.deviceId = id;
+        event.timestampMs = now;
+        event.queuedUs = queuedUs;
+        event.canonicalId = true;
+        event.setIdentifier(std::string_view());
+        event.hasService = service != nullptr;
+        event.service = service ? *service : DeviceId();
+        event.rssi = static_cast<int16_t>(rssi);
+    });
+    if (!queued) {
+        m_droppedEvents.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    wakeDispatchThread();
 }
 
 void PassByManager::onAdvertisingStarted(const std::string& peripheralUUID, bool success, const std::string& errorMessage) {
-    // Call user callback if set
-    if (m_advertisingCallback) {
-        AdvertisingInfo info(peripheralUUID, success, errorMessage);
-        m_advertisingCallback(info);
+    if (m_tracing.load(std::memory_order_relaxed)) {
+        TraceEvent event(TraceEventType::AdvertisingStarted);
+        event.text = peripheralUUID;
+        event.success = success;
+        event.detail = errorMessage;
+        traceEvent(event);
+    }
+    
+    if (peripheralUUID.size() > DiscoveryEvent::kMaxIdentifierLength) {
+        m_droppedEvents.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    
+    bool queued = m_eventQueue->tryPush([&](DiscoveryEvent& event) {
+        event.type = DiscoveryEvent::Type::AdvertisingStarted;
+        event.success = success;
+        event.setIdentifier(peripheralUUID);
+        event.errorMessage = errorMessage;
+    });
+    if (!queued) {
+        m_droppedEvents.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    wakeDispatchThread();
+}
+
+bool PassByManager::onDispatchThread() const {
+    return std::this_thread::get_id() == m_dispatchThread.get_id();
+}
+
+void PassByManager::flushEvents() {
+    if (onDispatchThread()) {
+        return;
+    }
+    auto executor = callbackExecutor();
+    if (executor && executor->isExecutorThread()) {
+        return;
+    }
+    
+    uint64_t controlTarget = m_controlQueued.load(std::memory_order_acquire);
+    uint64_t target = m_eventQueue->enqueuePosition();
+    {
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_flushWaiters.fetch_add(1);
+        m_flushCondition.wait(lock, [&] {
+            return (m_processedEvents.load(std::memory_order_acquire) >= target &&
+                    m_controlApplied.load(std::memory_order_acquire) >= controlTarget) ||
+                   !m_dispatchRunning;
+        });
+        m_flushWaiters.fetch_sub(1);
+    }
+    
+    // Readers see everything flushed, without waiting for the next scheduled snapshot
+    if (registrySnapshotStale()) {
+        publishRegistrySnapshot();
+    }
+    
+    // Then the callbacks those events handed to the executor
+    if (executor) {
+        executor->drain();
+    }
+}
+
+void PassByManager::requestBatchFlush() {
+    pushControlEvent(DiscoveryEvent::Type::FlushBatch);
+}
+
+void PassByManager::pushDutyCycleStart(const std::string& serviceUUID) {
+    // Published like the other settings: a queue slot only holds a short identifier
+    {
+        std::lock_guard<std::mutex> lock(m_callbackMutex);
+        m_scanFilter = std::make_shared<const std::string>(serviceUUID);
+    }
+    pushControlEvent(DiscoveryEvent::Type::DutyCycleStart);
+}
+
+void PassByManager::pushControlEvent(DiscoveryEvent::Type type) {
+    // Never lost, and never waits for room in the event queue: the caller may be a
+    // callback on the dispatch thread, or one the dispatch thread is blocked on
+    {
+        std::lock_guard<std::mutex> lock(m_controlMutex);
+        m_controlEvents.push_back(ControlEvent{type, m_eventQueue->enqueuePosition()});
+        m_controlQueued.fetch_add(1, std::memory_order_seq_cst);
+    }
+    wakeDispatchThread();
+}
+
+void PassByManager::applyControlEvents() {
+    if (m_controlQueued.load(std::memory_order_acquire) == m_controlApplied.load(std::memory_order_relaxed)) {
+        return;
+    }
+    uint64_t consumed = m_eventQueue->dequeuePosition();
+    for (;;) {
+        DiscoveryEvent event;
+        {
+            std::lock_guard<std::mutex> lock(m_controlMutex);
+            if (m_controlEvents.empty() || m_controlEvents.front().queuePosition > consumed) {
+                return;
+            }
+            event.type = m_controlEvents.front().type;
+            m_controlEvents.pop_front();
+        }
+        dispatchEvent(event);
+        m_controlApplied.fetch_add(1, std::memory_order_release);
+    }
+}
+
+uint64_t PassByManager::getDroppedEventCount() const {
+    return m_droppedEvents.load(std::memory_order_relaxed);
+}
+
+uint64_t PassByManager::getDroppedCallbackCount() const {
+    auto executor = callbackExecutor();
+    return executor ? executor->droppedCount() : 0;
+}
+
+MetricsSnapshot PassByManager::getMetricsSnapshot() const {
+    MetricsSnapshot snapshot;
+    m_metrics->snapshot(snapshot);
+    snapshot.droppedEvents = m_droppedEvents.load(std::memory_order_relaxed);
+    snapshot.droppedCallbacks = getDroppedCallbackCount();
+    snapshot.queueDepth = m_eventQueue->sizeApprox();
+    return snapshot;
+}
+
+void PassByManager::recordStageLatency(PipelineStage stage, std::chrono::microseconds latency) {
+    if (m_tracing.load(std::memory_order_relaxed)) {
+        TraceEvent event(TraceEventType::StageLatency);
+        event.stage = stage;
+        event.value = latency.count();
+        traceEvent(event);
+    }
+    m_metrics->recordLatency(stage, latency.count());
+}
+
+void PassByManager::wakeDispatchThread() const {
+    // Only touch the mutex when the dispatch thread is parked; pairs with the
+    // seq_cst publish in MPSCRingBuffer::tryPush
+    if (m_dispatchSleeping.load(std::memory_order_seq_cst)) {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_wakeCondition.notify_one();
+    }
+}
+
+void PassByManager::stopDispatchThread() {
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_dispatchRunning = false;
+    }
+    m_wakeCondition.notify_one();
+    m_flushCondition.notify_all();
+    if (m_dispatchThread.joinable()) {
+        m_dispatchThread.join();
+    }
+}
+
+void PassByManager::dispatchLoop() {
+    auto handler = [this](DiscoveryEvent& event) { dispatchEvent(event); };
+    
+    auto wakeup = [this] {
+        return !m_dispatchRunning || m_eventQueue->hasPending() ||
+               m_controlQueued.load() != m_controlApplied.load(std::memory_order_relaxed);
+    };
+    
+    for (;;) {
+        if (PipelineMetrics::kEnabled) {
+            m_metrics->observeQueueDepth(m_eventQueue->sizeApprox());
+        }
+        
+        // Bounded so progress is published regularly under sustained load
+        uint64_t consumed = 0;
+        for (;;) {
+            applyControlEvents();
+            if (consumed >= kEventQueueCapacity || !m_eventQueue->tryConsume(handler)) {
+                break;
+            }
+            ++consumed;
+        }
+        
+        // Persist before publishing progress, so flushEvents() also covers the log
+        if (consumed > 0) {
+            persistEncounters();
+            m_processedEvents.fetch_add(consumed, std::memory_order_release);
+        }
+        
+        int64_t steadyNow = steadyTimeMs();
+        if (m_batcher->isDue(steadyNow)) {
+            deliverBatch();
+        }
+        runDutyCycle(steadyNow);
+        runConnectionScheduler(steadyNow);
+        // Readers only load the snapshot, so rebuild it at most every kSnapshotIntervalMs
+        bool snapshotStale = registrySnapshotStale();
+        if (snapshotStale && steadyNow - m_snapshotPublishedMs >= kSnapshotIntervalMs) {
+            publishRegistrySnapshot();
+            m_snapshotPublishedMs = steadyNow;
+            snapshotStale = false;
+        }
+        
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        if (m_flushWaiters.load() > 0) {
+            m_flushCondition.notify_all();
+        }
+        if (!m_dispatchRunning) {
+            break;
+        }
+        
+        m_dispatchSleeping.store(true, std::memory_order_seq_cst);
+        // Wake up in time for the pending batch's flush interval, connection deadlines and snapshot
+        int64_t deadlineMs = std::min(m_scheduler->nextDeadlineMs(), m_dutyCycle->nextDeadlineMs());
+        if (!m_batcher->empty()) {
+            deadlineMs = std::min(deadlineMs, m_batcher->deadlineMs());
+        }
+        if (snapshotStale) {
+            deadlineMs = std::min(deadlineMs, m_snapshotPublishedMs + kSnapshotIntervalMs);
+        }
+        if (deadlineMs == ConnectionScheduler::kNoDeadline) {
+            m_wakeCondition.wait(lock, wakeup);
+        } else {
+            auto deadline = std::chrono::steady_clock::time_point(std::chrono::milliseconds(deadlineMs));
+            m_wakeCondition.wait_until(lock, deadline, wakeup);
+        }
+        m_dispatchSleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
+void PassByManager::runConnectionScheduler(int64_t nowMs) {
+    std::shared_ptr<const ConnectionPolicy> policy;
+    {
+        std::lock_guard<std::mutex> lock(m_callbackMutex);
+        policy = m_connectionPolicy;
+    }
+    if (policy != m_activeConnectionPolicy) {
+        m_activeConnectionPolicy = policy;
+        applyConnectionPolicy(policy ? *policy : ConnectionPolicy());
+    }
+    
+    if (!m_scheduler->needsPoll(nowMs)) {
+        return;
+    }
+    m_scheduler->poll(nowMs);
+    if (!m_platform) {
+        return;
+    }
+    for (const DeviceId& peripheral : m_scheduler->timedOut()) {
+        m_platform->cancelPeripheral(peripheral);
+        m_metrics->add(PipelineMetrics::Counter::ConnectionTimeouts);
+    }
+    for (const DeviceId& peripheral : m_scheduler->toConnect()) {
+        if (m_platform->connectPeripheral(peripheral)) {
+            m_metrics->add(PipelineMetrics::Counter::ConnectionsStarted);
+        } else {
+            m_scheduler->onFailed(peripheral, nowMs);
+            m_metrics->add(PipelineMetrics::Counter::ConnectionFailures);
+        }
+    }
+}
+
+void PassByManager::runDutyCycle(int64_t nowMs) {
+    std::shared_ptr<const DutyCycleOptions> options;
+    {
+        std::lock_guard<std::mutex> lock(m_callbackMutex);
+        options = m_dutyCycleOptions;
+    }
+    if (options != m_activeDutyCycleOptions) {
+        m_activeDutyCycleOptions = options;
+        m_dutyCycle->configure(options ? *options : DutyCycleOptions());
+    }
+    
+    bool enabled = options && options->enabled;
+    if (!enabled && m_dutyCycle->isRunning()) {
+        // Disabled mid-session: leave the radio on
+        if (m_radioParked && m_platform) {
+            m_platform->startBLE(m_dutyCycleServiceUUID);
+        }
+        m_radioParked = false;
+        m_dutyCycle->stop();
+    } else if (enabled && m_scanSessionActive && !m_dutyCycle->isRunning()) {
+        m_dutyCycle->start(nowMs);
+    }
+    
+    switch (m_dutyCycle->poll(nowMs)) {
+        case DutyCycleController::Action::RadioOff:
+            // Chains do not survive the radio going off
+            cancelConnections();
+            if (m_platform) {
+                m_platform->stopBLE();
+            }
+            m_radioParked = true;
+            break;
+        case DutyCycleController::Action::RadioOn:
+            if (m_platform) {
+                m_platform->startBLE(m_dutyCycleServiceUUID);
+            }
+            m_radioParked = false;
+            break;
+        case DutyCycleController::Action::None:
+            break;
+    }
+}
+
+void PassByManager::cancelConnections() {
+    m_scheduler->reset([this](const DeviceId& peripheral) {
+        if (m_platform) {
+            m_platform->cancelPeripheral(peripheral);
+        }
+    });
+}
+
+void PassByManager::applyConnectionPolicy(const ConnectionPolicy& policy) {
+    m_scheduler->configure(policy);
+    m_resolvedCache->configure(policy.resolvedLifetime.count(), policy.maxResolvedPeripherals);
+}
+
+void PassByManager::deliverBatch() {
+    if (m_activeBatch && !m_batcher->empty()) {
+        if (auto executor = callbackExecutor()) {
+            // The batcher's storage is reused, so the task gets a copy
+            EncounterSpan pending = m_batcher->pending();
+            std::vector<EncounterInfo> encounters(pending.begin(), pending.end());
+            executor->execute(DeviceId(), [batch = m_activeBatch, encounters = std::move(encounters)] {
+                batch->callback(EncounterSpan(encounters.data(), encounters.size()));
+            });
+        } else {
+            m_activeBatch->callback(m_batcher->pending());
+        }
+    }
+    m_batcher->reset();
+}
+
+void PassByManager::handleDiscovery(DiscoveryEvent& event) {
+    std::shared_ptr<DeviceDiscoveredCallback> callback;
+    std::shared_ptr<DeviceViewCallback> viewCallback;
+    std::shared_ptr<const BatchSubscription> batch;
+    std::shared_ptr<const SubscriptionSet> subscriptions;
+    std::shared_ptr<const DuplicateFilterOptions> duplicateOptions;
+    std::shared_ptr<CallbackExecutor> executor;
+    {
+        std::lock_guard<std::mutex> lock(m_callbackMutex);
+        callback = m_deviceCallback;
+        viewCallback = m_deviceViewCallback;
+        batch = m_batchSubscription;
+        subscriptions = m_subscriptionSet;
+        duplicateOptions = m_duplicateFilterOptions;
+        executor = m_callbackExecutor;
+    }
+    if (duplicateOptions != m_activeDuplicateFilterOptions) {
+        m_activeDuplicateFilterOptions = duplicateOptions;
+        m_duplicateFilter.reset();
+        if (duplicateOptions && duplicateOptions->enabled) {
+            m_duplicateFilter.reset(new RecentlySeenFilter(duplicateOptions->slices,
+                                                           duplicateOptions->sliceDuration.count(),
+                                                           duplicateOptions->devicesPerSlice,
+                                                           duplicateOptions->falsePositiveRate));
+        }
+    }
+    
+    char canonical[DeviceId::kStringLength];
+    DeviceView view;
+    view.id = event.deviceId;
+    view.uuid = event.identifierView();
+    view.seenAt = std::chrono::system_clock::time_point(std::chrono::milliseconds(event.timestampMs));
+    view.rssi = event.rssi;
+    view.hasService = event.hasService;
+    view.service = event.service;
+    if (event.canonicalId && (subscriptions || callback || viewCallback)) {
+        event.deviceId.format(canonical);
+        view.uuid = std::string_view(canonical, sizeof(canonical));
+    }
+    
+    // With subscriptions, only what the session or a subscriber asked for is kept
+    m_matchedSubscriptions.clear();
+    if (subscriptions) {
+        subscriptions->matcher.match(event.hasService ? &event.service : nullptr, event.rssi, view.uuid,
+                                     [this](size_t index) { m_matchedSubscriptions.push_back(index); });
+        if (m_matchedSubscriptions.empty()) {
+            m_metrics->add(PipelineMetrics::Counter::FilteredDiscoveries);
+            return;
+        }
+    }
+    
+    // A replaced batch callback still receives what was collected for it
+    if (batch != m_activeBatch) {
+        deliverBatch();
+        m_activeBatch = batch;
+        if (batch) {
+            m_batcher->configure(batch->options.flushInterval.count(), batch->options.maxEvents);
+        }
+    }
+    
+    // Repeats within the filter's horizon only refresh the encounter store
+    bool duplicate = m_duplicateFilter && m_duplicateFilter->testAndInsert(event.deviceId, event.timestampMs);
+    
+    // Store device in memory
+    bool batchFull = false;
+    bool isNew = false;
+    {
+        std::lock_guard<std::mutex> lock(m_devicesMutex);
+        const EncounterRecord* record =
+            m_encounters->record(event.deviceId, event.timestampMs, event.identifierView(), &isNew);
+        if (record && batch && !duplicate) {
+            batchFull = m_batcher->add(*record, *m_encounters, steadyTimeMs());
+        }
+        if (m_aggregator) {
+            bool hasRssi = event.rssi != SubscriptionMatcher::kUnknownRssi;
+            m_aggregator->record(event.deviceId, event.timestampMs, hasRssi, event.rssi,
+                                 event.canonicalId ? std::string_view() : event.identifierView());
+        }
+        registryChanged();
+    }
+    if (isNew) {
+        m_dutyCycle->onNewPeer(steadyTimeMs());
+    }
+    if (batchFull) {
+        deliverBatch();
+    }
+    if (duplicate) {
+        m_metrics->add(PipelineMetrics::Counter::DuplicateDiscoveries);
+        return;
+    }
+    
+    // Call user callbacks if set; a task owns copies of what the view borrows
+    if (!executor) {
+        runDiscoveryCallbacks(view, viewCallback.get(), callback.get(), subscriptions.get(), m_matchedSubscriptions);
+    } else if (viewCallback || callback || !m_matchedSubscriptions.empty()) {
+        executor->execute(event.deviceId, [viewCallback, callback, subscriptions, matched = m_matchedSubscriptions,
+                                           uuid = std::string(view.uuid), view] {
+            DeviceView owned = view;
+            owned.uuid = uuid;
+            runDiscoveryCallbacks(owned, viewCallback.get(), callback.get(), subscriptions.get(), matched);
+        });
+    }
+    m_metrics->add(PipelineMetrics::Counter::Discoveries);
+    m_metrics->recordSince(PipelineStage::Delivery, event.queuedUs);
+}
+
+void PassByManager::dispatchEvent(DiscoveryEvent& event) {
+    switch (event.type) {
+        case DiscoveryEvent::Type::DeviceDiscovered:
+            handleDiscovery(event);
+            break;
+        case DiscoveryEvent::Type::PeripheralDiscovered: {
+            m_metrics->add(PipelineMetrics::Counter::Advertisements);
+            m_metrics->recordSince(PipelineStage::Advertisement, event.queuedUs);
+            int64_t steadyNow = steadyTimeMs();
+            if (const auto* resolved = m_resolvedCache->lookup(event.peripheral, steadyNow)) {
+                // Already read: report the peer again without connecting
+                event.deviceId = resolved->id;
+                event.canonicalId = resolved->canonical;
+                event.setIdentifier(resolved->identifierView());
+                handleDiscovery(event);
+            } else {
+                m_scheduler->onAdvertisement(event.peripheral, event.rssi, steadyNow);
+            }
+            break;
+        }
+        case DiscoveryEvent::Type::PeripheralIdentifierRead: {
+            // A chain that already timed out still delivers a valid identifier
+            int rssi = SubscriptionMatcher::kUnknownRssi;
+            m_scheduler->onResolved(event.peripheral, &rssi);
+            event.rssi = static_cast<int16_t>(rssi);
+            m_resolvedCache->insert(event.peripheral, event.deviceId, event.canonicalId,
+                                    event.identifierView(), steadyTimeMs());
+            handleDiscovery(event);
+            break;
+        }
+        case DiscoveryEvent::Type::PeripheralConnectionFailed:
+            m_scheduler->onFailed(event.peripheral, steadyTimeMs());
+            m_metrics->add(PipelineMetrics::Counter::ConnectionFailures);
+            break;
+        case DiscoveryEvent::Type::StopConnections:
+            cancelConnections();
+            break;
+        case DiscoveryEvent::Type::DutyCycleStart: {
+            std::lock_guard<std::mutex> lock(m_callbackMutex);
+            m_scanSessionActive = true;
+            m_dutyCycleServiceUUID = m_scanFilter ? *m_scanFilter : std::string();
+            m_radioParked = false;
+            // Started by runDutyCycle() if enabled
+            break;
+        }
+        case DiscoveryEvent::Type::DutyCycleStop:
+            m_scanSessionActive = false;
+            m_advertisingReported = false;
+            m_dutyCycle->stop();
+            break;
+        case DiscoveryEvent::Type::ConfigurationChanged:
+            break;
+        case DiscoveryEvent::Type::ClearDevices:
+            clearDevices();
+            break;
+        case DiscoveryEvent::Type::AdvertisingStarted: {
+            // The duty cycle restarts advertising with the radio on every window; report
+            // the platform's start once (failures always)
+            if (event.success && m_advertisingReported) {
+                break;
+            }
+            m_advertisingReported = event.success;
+            
+            // Call user callback if set
+            std::shared_ptr<AdvertisingStartedCallback> callback;
+            std::shared_ptr<CallbackExecutor> executor;
+            {
+                std::lock_guard<std::mutex> lock(m_callbackMutex);
+                callback = m_advertisingCallback;
+                executor = m_callbackExecutor;
+            }
+            if (callback) {
+                AdvertisingInfo info(event.identifierString(), event.success, event.errorMessage);
+                if (executor) {
+                    executor->execute(DeviceId(), [callback, info = std::move(info)] { (*callback)(info); });
+                } else {
+                    (*callback)(info);
+                }
+            }
+            break;
+        }
+        case DiscoveryEvent::Type::FlushBatch:
+            deliverBatch();
+            break;
     }
 }
 
@@ -3,26 +3,81 @@
 
 namespace PassBy {
 
-PassByManager* PassByBridge::s_manager = nullptr;
+std::atomic<PassByManager*> PassByBridge::s_manager{nullptr};
 
 void PassByBridge::setManager(PassByManager* manager) {
-    s_manager = manager;
+    s_manager.store(manager, std::memory_order_release);
 }
 
-void PassByBridge::onDeviceDiscovered(const std::string& uuid) {
-    if (s_manager) {
-        s_manager->onDeviceDiscovered(uuid);
+void PassByBridge::onDeviceDiscovered(std::string_view uuid) {
+    if (PassByManager* manager = s_manager.load(std::memory_order_acquire)) {
+        manager->onDeviceDiscovered(uuid);
+    }
+}
+
+void PassByBridge::onDeviceDiscovered(const DeviceId& id) {
+    if (PassByManager* manager = s_manager.load(std::memory_order_acquire)) {
+        manager->onDeviceDiscovered(id);
+    }
+}
+
+void PassByBridge::onDeviceDiscovered(std::string_view uuid, const DeviceId& service, int rssi) {
+    if (PassByManager* manager = s_manager.load(std::memory_order_acquire)) {
+        manager->onDeviceDiscovered(uuid, service, rssi);
+    }
+}
+
+void PassByBridge::onDeviceDiscovered(const DeviceId& id, int rssi) {
+    if (PassByManager* manager = s_manager.load(std::memory_order_acquire)) {
+        manager->onDeviceDiscovered(id, rssi);
+    }
+}
+
+void PassByBridge::onDeviceDiscovered(const DeviceId& id, const DeviceId& service, int rssi) {
+    if (PassByManager* manager = s_manager.load(std::memory_order_acquire)) {
+        manager->onDeviceDiscovered(id, service, rssi);
+    }
+}
+
+void PassByBridge::onPeripheralDiscovered(const DeviceId& peripheral, int rssi) {
+    if (PassByManager* manager = s_manager.load(std::memory_order_acquire)) {
+        manager->onPeripheralDiscovered(peripheral, rssi);
+    }
+}
+
+void PassByBridge::onPeripheralAdvertisement(const DeviceId& peripheral, int rssi, const uint8_t* data,
+                                             size_t length) {
+    if (PassByManager* manager = s_manager.load(std::memory_order_acquire)) {
+        manager->onPeripheralAdvertisement(peripheral, rssi, data, length);
+    }
+}
+
+void PassByBridge::onPeripheralIdentifierRead(const DeviceId& peripheral, std::string_view uuid) {
+    if (PassByManager* manager = s_manager.load(std::memory_order_acquire)) {
+        manager->onPeripheralIdentifierRead(peripheral, uuid);
+    }
+}
+
+void PassByBridge::onPeripheralConnectionFailed(const DeviceId& peripheral) {
+    if (PassByManager* manager = s_manager.load(std::memory_order_acquire)) {
+        manager->onPeripheralConnectionFailed(peripheral);
+    }
+}
+
+void PassByBridge::recordStageLatency(PipelineStage stage, std::chrono::microseconds latency) {
+    if (PassByManager* manager = s_manager.load(std::memory_order_acquire)) {
+        manager->recordStageLatency(stage, latency);
     }
 }
 
 void PassByBridge::onAdvertisingStarted(const std::string& peripheralUUID, bool success, const std::string& errorMessage) {
-    if (s_manager) {
-        s_manager->onAdvertisingStarted(peripheralUUID, success, errorMessage);
+    if (PassByManager* manager = s_manager.load(std::memory_order_acquire)) {
+        manager->onAdvertisingStarted(peripheralUUID, success, errorMessage);
     }
 }
 
 PassByManager* PassByBridge::getManager() {
-    return s_manager;
+    return s_manager.load(std::memory_order_acquire);
 }
 
 } // namespace PassBy
\ No newline at end of file
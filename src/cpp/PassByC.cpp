@@ -0,0 +1,200 @@
+#include "PassBy/passby_c.h"
+#include "PassBy/PassBy.h"
+#include "../internal/PassByC.h"
+#include "../internal/PlatformFactory.h"
+#include "../internal/SPSCRingBuffer.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+static_assert(sizeof(passby_event) == 48, "passby_event layout is part of the ABI");
+static_assert(offsetof(passby_event, timestamp_ms) == 32, "passby_event layout is part of the ABI");
+static_assert(std::is_trivially_copyable<passby_event>::value, "passby_event must stay plain data");
+
+// The manager's discovery callbacks run on its dispatch thread (no callback executor is
+// ever set here), so that thread is the ring's single producer
+struct passby_context {
+    PassBy::SPSCRingBuffer<passby_event> ring;
+    std::atomic<uint64_t> dropped{0};
+    uint32_t sequence = 0;      // Dispatch thread only
+    uint32_t peeked = 0;        // Consumer only: unreleased records of the last peek
+    // Declared last so the dispatch thread stops before the ring goes away
+    std::unique_ptr<PassBy::PassByManager> manager;
+
+    explicit passby_context(uint32_t ringCapacity) : ring(ringCapacity) {}
+
+    template <typename Fill>
+    void push(uint8_t type, Fill&& fill) {
+        // Sequence numbers count dropped events too, so the host sees the gap
+        uint32_t number = sequence++;
+        bool pushed = ring.tryPush([&](passby_event& event) {
+            std::memset(&event, 0, sizeof(event));
+            event.type = type;
+            event.sequence = number;
+            fill(event);
+        });
+        if (!pushed) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+};
+
+namespace PassBy {
+
+namespace {
+
+int64_t toMs(std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
+void connect(passby_context* context) {
+    context->manager->setDeviceViewCallback([context](const DeviceView& view) {
+        context->push(PASSBY_EVENT_DEVICE_DISCOVERED, [&](passby_event& event) {
+            std::memcpy(event.device_id, view.id.bytes(), DeviceId::kSize);
+            event.timestamp_ms = toMs(view.seenAt);
+            if (view.rssi != DeviceView::kUnknownRssi) {
+                event.rssi = static_cast<int16_t>(view.rssi);
+                event.flags |= PASSBY_EVENT_HAS_RSSI;
+            }
+            if (view.hasService) {
+                std::memcpy(event.service, view.service.bytes(), DeviceId::kSize);
+                event.flags |= PASSBY_EVENT_HAS_SERVICE;
+            }
+        });
+    });
+    context->manager->setAdvertisingStartedCallback([context](const AdvertisingInfo& info) {
+        DeviceId peripheral = DeviceId::fromString(info.peripheralUUID);
+        int64_t now = toMs(std::chrono::system_clock::now());
+        context->push(PASSBY_EVENT_ADVERTISING_STARTED, [&](passby_event& event) {
+            std::memcpy(event.device_id, peripheral.bytes(), DeviceId::kSize);
+            event.timestamp_ms = now;
+            event.flags = info.success ? PASSBY_EVENT_SUCCESS : 0;
+        });
+    });
+}
+
+} // namespace
+
+passby_context* createCContext(std::unique_ptr<PlatformInterface> platform, uint32_t ringCapacity) {
+    if (!platform) {
+        return nullptr;
+    }
+    std::unique_ptr<passby_context> context(new passby_context(ringCapacity));
+    context->manager.reset(new PassByManager(std::move(platform)));
+    connect(context.get());
+    return context.release();
+}
+
+PassByManager& contextManager(passby_context* context) {
+    return *context->manager;
+}
+
+} // namespace PassBy
+
+extern "C" {
+
+uint32_t passby_abi_version(void) {
+    return PASSBY_C_ABI_VERSION;
+}
+
+const char* passby_version(void) {
+    try {
+        static const std::string version = PassBy::PassByManager::getVersion();
+        return version.c_str();
+    } catch (...) {
+        return "";
+    }
+}
+
+passby_context* passby_create(uint32_t ring_capacity) {
+    // No exception may cross into the host
+    try {
+        return PassBy::createCContext(PassBy::PlatformFactory::createPlatform(), ring_capacity);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void passby_destroy(passby_context* context) {
+    // Destructors do not throw
+    delete context;
+}
+
+int passby_start_scanning(passby_context* context, const char* service_uuid) {
+    try {
+        return context->manager->startScanning(service_uuid ? service_uuid : "") ? 1 : 0;
+    } catch (...) {
+        return 0;
+    }
+}
+
+int passby_stop_scanning(passby_context* context) {
+    try {
+        return context->manager->stopScanning() ? 1 : 0;
+    } catch (...) {
+        return 0;
+    }
+}
+
+int passby_is_scanning(const passby_context* context) {
+    try {
+        return context->manager->isScanning() ? 1 : 0;
+    } catch (...) {
+        return 0;
+    }
+}
+
+void passby_flush(passby_context* context) {
+    try {
+        context->manager->flushEvents();
+    } catch (...) {
+    }
+}
+
+uint32_t passby_poll_events(passby_context* context, passby_event* events, uint32_t max_events) {
+    try {
+        // Takes over whatever a previous peek left unreleased
+        context->peeked = 0;
+        return static_cast<uint32_t>(context->ring.pop(events, max_events));
+    } catch (...) {
+        return 0;
+    }
+}
+
+uint32_t passby_peek_events(passby_context* context, const passby_event** events) {
+    try {
+        context->peeked = static_cast<uint32_t>(context->ring.peek(events));
+        return context->peeked;
+    } catch (...) {
+        *events = nullptr;
+        context->peeked = 0;
+        return 0;
+    }
+}
+
+void passby_release_events(passby_context* context, uint32_t count) {
+    try {
+        // Never past what the host was handed, or the producer would overwrite unread slots
+        count = std::min(count, context->peeked);
+        context->peeked -= count;
+        context->ring.release(count);
+    } catch (...) {
+    }
+}
+
+uint64_t passby_dropped_events(const passby_context* context) {
+    return context->dropped.load(std::memory_order_relaxed);
+}
+
+void passby_format_uuid(const uint8_t uuid[16], char out[37]) {
+    try {
+        PassBy::DeviceId::fromBytes(uuid).format(out);
+        out[PassBy::DeviceId::kStringLength] = '\0';
+    } catch (...) {
+        out[0] = '\0';
+    }
+}
+
+} // extern "C"
@@ -0,0 +1,23 @@
+#include "../internal/PlatformFactory.h"
+#include <mutex>
+
+namespace PassBy {
+
+static std::mutex s_creatorMutex;
+static PlatformFactory::Creator s_creator;
+
+std::unique_ptr<PlatformInterface> PlatformFactory::createPlatform() {
+    Creator creator;
+    {
+        std::lock_guard<std::mutex> lock(s_creatorMutex);
+        creator = s_creator;
+    }
+    return creator ? creator() : createDefaultPlatform();
+}
+
+void PlatformFactory::setPlatformCreator(Creator creator) {
+    std::lock_guard<std::mutex> lock(s_creatorMutex);
+    s_creator = std::move(creator);
+}
+
+} // namespace PassBy
@@ -0,0 +1,119 @@
+#include "../internal/RecentlySeenFilter.h"
+#include <algorithm>
+#include <cmath>
+
+namespace PassBy {
+
+namespace {
+
+// Bloom filter size for n items at false positive rate p: m = -n ln p / (ln 2)^2, k = m/n ln 2
+size_t bitsFor(size_t capacity, double rate) {
+    double bits = -static_cast<double>(capacity) * std::log(rate) / (std::log(2.0) * std::log(2.0));
+    return std::max<size_t>(64, (static_cast<size_t>(std::ceil(bits)) + 63) & ~size_t(63));
+}
+
+size_t hashesFor(size_t bits, size_t capacity) {
+    double hashes = static_cast<double>(bits) / static_cast<double>(capacity) * std::log(2.0);
+    return std::min<size_t>(32, std::max<size_t>(1, static_cast<size_t>(std::lround(hashes))));
+}
+
+uint64_t mix(uint64_t value) {
+    value ^= value >> 31;
+    value *= 0xBF58476D1CE4E5B9ULL;
+    value ^= value >> 29;
+    value *= 0x94D049BB133111EBULL;
+    return value ^ (value >> 32);
+}
+
+} // namespace
+
+RecentlySeenFilter::RecentlySeenFilter(size_t slices, int64_t sliceMs, size_t capacity, double falsePositiveRate)
+    : m_sliceMs(std::max<int64_t>(sliceMs, 1)), m_latestEpoch(-1) {
+    slices = std::max<size_t>(slices, 1);
+    capacity = std::max<size_t>(capacity, 1);
+    double rate = std::min(std::max(falsePositiveRate, 1e-12), 0.5) / static_cast<double>(slices);
+    m_bits = bitsFor(capacity, rate);
+    m_hashes = hashesFor(m_bits, capacity);
+    m_slices.resize(slices);
+    for (Slice& slice : m_slices) {
+        slice.words.assign(m_bits / 64, 0);
+    }
+}
+
+int64_t RecentlySeenFilter::epochOf(int64_t nowMs) const {
+    // A clock stepping back keeps using the newest slice rather than reviving an old one
+    return std::max(std::max<int64_t>(nowMs, 0) / m_sliceMs, m_latestEpoch);
+}
+
+RecentlySeenFilter::Probe RecentlySeenFilter::probe(const DeviceId& id) const {
+    uint64_t h1 = id.hash();
+    return {h1, mix(h1) | 1};
+}
+
+bool RecentlySeenFilter::sliceContains(const Slice& slice, const Probe& probe) const {
+    uint64_t position = probe.h1;
+    for (size_t i = 0; i < m_hashes; ++i, position += probe.h2) {
+        uint64_t bit = position % m_bits;
+        if (!(slice.words[bit / 64] & (uint64_t(1) << (bit % 64)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RecentlySeenFilter::inWindow(const Slice& slice, int64_t epoch) const {
+    return slice.epoch >= 0 && slice.epoch <= epoch && epoch - slice.epoch < static_cast<int64_t>(m_slices.size());
+}
+
+RecentlySeenFilter::Slice& RecentlySeenFilter::sliceFor(int64_t epoch) {
+    Slice& slice = m_slices[static_cast<size_t>(epoch) % m_slices.size()];
+    if (slice.epoch != epoch) {
+        // The slot's previous slice has aged out of the window
+        std::fill(slice.words.begin(), slice.words.end(), 0);
+        slice.epoch = epoch;
+    }
+    return slice;
+}
+
+bool RecentlySeenFilter::contains(const DeviceId& id, int64_t nowMs) const {
+    int64_t epoch = epochOf(nowMs);
+    Probe hashes = probe(id);
+    for (const Slice& slice : m_slices) {
+        if (inWindow(slice, epoch) && sliceContains(slice, hashes)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void RecentlySeenFilter::insert(const DeviceId& id, int64_t nowMs) {
+    int64_t epoch = epochOf(nowMs);
+    m_latestEpoch = epoch;
+    Slice& slice = sliceFor(epoch);
+    Probe hashes = probe(id);
+    uint64_t position = hashes.h1;
+    for (size_t i = 0; i < m_hashes; ++i, position += hashes.h2) {
+        uint64_t bit = position % m_bits;
+        slice.words[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+}
+
+bool RecentlySeenFilter::testAndInsert(const DeviceId& id, int64_t nowMs) {
+    bool seen = contains(id, nowMs);
+    insert(id, nowMs);
+    return seen;
+}
+
+void RecentlySeenFilter::clear() {
+    for (Slice& slice : m_slices) {
+        std::fill(slice.words.begin(), slice.words.end(), 0);
+        slice.epoch = -1;
+    }
+    m_latestEpoch = -1;
+}
+
+size_t RecentlySeenFilter::memoryUsage() const {
+    return sizeof(*this) + m_slices.size() * (sizeof(Slice) + m_bits / 8);
+}
+
+} // namespace PassBy
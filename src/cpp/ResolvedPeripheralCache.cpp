@@ -0,0 +1,111 @@
+#include "../internal/ResolvedPeripheralCache.h"
+#include <algorithm>
+#include <cstring>
+
+namespace PassBy {
+
+ResolvedPeripheralCache::ResolvedPeripheralCache()
+    : m_ttlMs(0), m_maxEntries(0), m_clockHand(0), m_hits(0), m_misses(0) {}
+
+void ResolvedPeripheralCache::configure(int64_t ttlMs, size_t maxEntries) {
+    m_ttlMs = std::max<int64_t>(ttlMs, 0);
+    m_maxEntries = m_ttlMs > 0 ? maxEntries : 0;
+    if (m_entries.size() > m_maxEntries) {
+        clear();
+    }
+}
+
+void ResolvedPeripheralCache::insert(const DeviceId& peripheral, const DeviceId& id, bool canonical,
+                                     std::string_view text, int64_t nowMs) {
+    if (!enabled() || (!canonical && text.size() > kMaxIdentifierLength)) {
+        return;
+    }
+
+    uint32_t slot;
+    if (const uint32_t* existing = m_index.find(peripheral)) {
+        slot = *existing;
+    } else {
+        slot = allocateSlot(nowMs);
+        *m_index.insert(peripheral).first = slot;
+    }
+
+    Entry& entry = m_entries[slot];
+    entry.peripheral = peripheral;
+    entry.id = id;
+    entry.resolvedMs = nowMs;
+    entry.occupied = true;
+    entry.referenced = false;
+    entry.canonical = canonical;
+    entry.textLength = canonical ? 0 : static_cast<uint8_t>(text.size());
+    if (entry.textLength > 0) {
+        std::memcpy(entry.text, text.data(), entry.textLength);
+    }
+}
+
+const ResolvedPeripheralCache::Entry* ResolvedPeripheralCache::lookup(const DeviceId& peripheral, int64_t nowMs) {
+    const uint32_t* slot = enabled() ? m_index.find(peripheral) : nullptr;
+    if (!slot) {
+        ++m_misses;
+        return nullptr;
+    }
+    Entry& entry = m_entries[*slot];
+    if (isExpired(entry, nowMs)) {
+        // Read it again; the peer may have restarted with a new identifier
+        release(*slot);
+        ++m_misses;
+        return nullptr;
+    }
+    entry.referenced = true;
+    ++m_hits;
+    return &entry;
+}
+
+void ResolvedPeripheralCache::erase(const DeviceId& peripheral) {
+    if (const uint32_t* slot = m_index.find(peripheral)) {
+        release(*slot);
+    }
+}
+
+void ResolvedPeripheralCache::clear() {
+    m_entries.clear();
+    m_freeSlots.clear();
+    m_index.clear();
+    m_clockHand = 0;
+}
+
+uint32_t ResolvedPeripheralCache::allocateSlot(int64_t nowMs) {
+    if (!m_freeSlots.empty()) {
+        uint32_t slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        return slot;
+    }
+    if (m_entries.size() < m_maxEntries) {
+        m_entries.push_back(Entry());
+        return static_cast<uint32_t>(m_entries.size() - 1);
+    }
+
+    // Every referenced entry loses its bit on the first pass, so two passes always find a victim
+    for (;;) {
+        if (m_clockHand >= m_entries.size()) {
+            m_clockHand = 0;
+        }
+        uint32_t slot = static_cast<uint32_t>(m_clockHand++);
+        Entry& entry = m_entries[slot];
+        if (entry.referenced && !isExpired(entry, nowMs)) {
+            entry.referenced = false;
+            continue;
+        }
+        m_index.erase(entry.peripheral);
+        entry.occupied = false;
+        return slot;
+    }
+}
+
+void ResolvedPeripheralCache::release(uint32_t slot) {
+    Entry& entry = m_entries[slot];
+    m_index.erase(entry.peripheral);
+    entry.occupied = false;
+    m_freeSlots.push_back(slot);
+}
+
+} // namespace PassBy
@@ -0,0 +1,139 @@
+#include "../internal/Sha256.h"
+#include <algorithm>
+#include <cstring>
+
+namespace PassBy {
+
+namespace {
+
+constexpr uint32_t kRoundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+uint32_t rotr(uint32_t value, int bits) {
+    return (value >> bits) | (value << (32 - bits));
+}
+
+} // namespace
+
+Sha256::Sha256() : m_blockLength(0), m_totalLength(0) {
+    static constexpr uint32_t kInitialState[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                                  0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    std::memcpy(m_state, kInitialState, sizeof(m_state));
+}
+
+void Sha256::update(const void* data, size_t length) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    m_totalLength += length;
+    if (m_blockLength > 0) {
+        size_t take = std::min(length, kBlockSize - m_blockLength);
+        std::memcpy(m_block + m_blockLength, bytes, take);
+        m_blockLength += take;
+        bytes += take;
+        length -= take;
+        if (m_blockLength < kBlockSize) {
+            return;
+        }
+        compress(m_block);
+        m_blockLength = 0;
+    }
+    for (; length >= kBlockSize; bytes += kBlockSize, length -= kBlockSize) {
+        compress(bytes);
+    }
+    std::memcpy(m_block, bytes, length);
+    m_blockLength = length;
+}
+
+void Sha256::finish(uint8_t out[kDigestSize]) {
+    uint64_t bitLength = m_totalLength * 8;
+    uint8_t padding[kBlockSize + 8] = {0x80};
+    size_t padLength = (m_blockLength < 56 ? 56 : 120) - m_blockLength;
+    for (int i = 0; i < 8; ++i) {
+        padding[padLength + i] = static_cast<uint8_t>(bitLength >> (56 - 8 * i));
+    }
+    update(padding, padLength + 8);
+    for (int i = 0; i < 8; ++i) {
+        out[4 * i] = static_cast<uint8_t>(m_state[i] >> 24);
+        out[4 * i + 1] = static_cast<uint8_t>(m_state[i] >> 16);
+        out[4 * i + 2] = static_cast<uint8_t>(m_state[i] >> 8);
+        out[4 * i + 3] = static_cast<uint8_t>(m_state[i]);
+    }
+}
+
+void Sha256::compress(const uint8_t block[kBlockSize]) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; ++i) {
+        w[i] = (uint32_t(block[4 * i]) << 24) | (uint32_t(block[4 * i + 1]) << 16) |
+               (uint32_t(block[4 * i + 2]) << 8) | uint32_t(block[4 * i + 3]);
+    }
+    for (int i = 16; i < 64; ++i) {
+        uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = m_state[0], b = m_state[1], c = m_state[2], d = m_state[3];
+    uint32_t e = m_state[4], f = m_state[5], g = m_state[6], h = m_state[7];
+    for (int i = 0; i < 64; ++i) {
+        uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + kRoundConstants[i] + w[i];
+        uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    m_state[0] += a;
+    m_state[1] += b;
+    m_state[2] += c;
+    m_state[3] += d;
+    m_state[4] += e;
+    m_state[5] += f;
+    m_state[6] += g;
+    m_state[7] += h;
+}
+
+void hmacSha256(const uint8_t* key, size_t keyLength, const void* data, size_t length, const void* data2,
+                size_t length2, uint8_t out[Sha256::kDigestSize]) {
+    uint8_t block[Sha256::kBlockSize] = {};
+    if (keyLength > Sha256::kBlockSize) {
+        Sha256 keyHash;
+        keyHash.update(key, keyLength);
+        keyHash.finish(block);
+    } else {
+        std::memcpy(block, key, keyLength);
+    }
+
+    uint8_t pad[Sha256::kBlockSize];
+    for (size_t i = 0; i < Sha256::kBlockSize; ++i) {
+        pad[i] = block[i] ^ 0x36;
+    }
+    Sha256 inner;
+    inner.update(pad, sizeof(pad));
+    inner.update(data, length);
+    if (data2) {
+        inner.update(data2, length2);
+    }
+    uint8_t innerDigest[Sha256::kDigestSize];
+    inner.finish(innerDigest);
+
+    for (size_t i = 0; i < Sha256::kBlockSize; ++i) {
+        pad[i] = block[i] ^ 0x5c;
+    }
+    Sha256 outer;
+    outer.update(pad, sizeof(pad));
+    outer.update(innerDigest, sizeof(innerDigest));
+    outer.finish(out);
+}
+
+} // namespace PassBy
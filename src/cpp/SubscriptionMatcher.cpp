@@ -0,0 +1,69 @@
+#include "../internal/SubscriptionMatcher.h"
+#include <map>
+
+namespace PassBy {
+
+SubscriptionMatcher::SubscriptionMatcher(std::vector<Filter> filters, bool scanFiltered)
+    : m_filters(std::move(filters)), m_scanFiltered(scanFiltered), m_epoch(0) {
+    size_t count = m_filters.size();
+    m_needs.resize(count, 0);
+    m_hits.resize(count, 0);
+    m_epochs.resize(count, 0);
+
+    // Group filter indices by key, then lay each group out as one slice of m_indices
+    std::vector<std::pair<DeviceId, uint32_t>> services;
+    std::map<std::string_view, std::vector<uint32_t>> prefixes;
+    for (uint32_t index = 0; index < count; ++index) {
+        Filter& filter = m_filters[index];
+        if (!filter.services.empty()) {
+            m_needs[index] |= kNeedsService;
+            std::sort(filter.services.begin(), filter.services.end());
+            filter.services.erase(std::unique(filter.services.begin(), filter.services.end()),
+                                  filter.services.end());
+            for (const DeviceId& service : filter.services) {
+                services.emplace_back(service, index);
+            }
+        }
+        if (!filter.prefixes.empty()) {
+            m_needs[index] |= kNeedsPrefix;
+            for (const std::string& prefix : filter.prefixes) {
+                std::vector<uint32_t>& group = prefixes[prefix];
+                if (group.empty() || group.back() != index) {
+                    group.push_back(index);
+                }
+            }
+        } else {
+            m_withoutPrefix.push_back(index);
+        }
+        if (m_needs[index] == 0) {
+            m_unfiltered.push_back(index);
+        }
+    }
+
+    std::sort(services.begin(), services.end());
+    m_services.reserve(services.size());
+    for (size_t i = 0; i < services.size();) {
+        Range range;
+        range.begin = static_cast<uint32_t>(m_indices.size());
+        const DeviceId& service = services[i].first;
+        for (; i < services.size() && services[i].first == service; ++i) {
+            m_indices.push_back(services[i].second);
+        }
+        range.count = static_cast<uint32_t>(m_indices.size()) - range.begin;
+        *m_services.insert(service).first = range;
+    }
+
+    m_prefixes.reserve(prefixes.size());
+    for (const auto& entry : prefixes) {
+        Range range;
+        range.begin = static_cast<uint32_t>(m_indices.size());
+        range.count = static_cast<uint32_t>(entry.second.size());
+        m_indices.insert(m_indices.end(), entry.second.begin(), entry.second.end());
+        m_prefixes.emplace(entry.first, range);
+        m_prefixLengths.push_back(entry.first.size());
+    }
+    std::sort(m_prefixLengths.begin(), m_prefixLengths.end());
+    m_prefixLengths.erase(std::unique(m_prefixLengths.begin(), m_prefixLengths.end()), m_prefixLengths.end());
+}
+
+} // namespace PassBy
@@ -0,0 +1,74 @@
+#include "../internal/TraceReplayer.h"
+#include "PassBy/PassBy.h"
+#include <thread>
+
+namespace PassBy {
+
+ReplayStats TraceReplayer::replay(EventTraceReader& reader, PassByManager& manager, const ReplayOptions& options) {
+    using Clock = std::chrono::steady_clock;
+    ReplayStats stats;
+    Clock::time_point start = Clock::now();
+    bool paced = options.speed > 0.0;
+    int64_t firstNs = -1;
+
+    TraceEvent event;
+    while (reader.next(event)) {
+        if (firstNs < 0) {
+            firstNs = event.timeNs;
+        }
+        if (paced) {
+            auto offset = std::chrono::nanoseconds(static_cast<int64_t>((event.timeNs - firstNs) / options.speed));
+            std::this_thread::sleep_until(start + offset);
+        }
+        deliver(event, manager);
+        ++stats.events;
+        if (!paced && options.drainInterval > 0 && stats.events % options.drainInterval == 0) {
+            manager.flushEvents();
+        }
+        stats.traceDuration = std::chrono::nanoseconds(event.timeNs - firstNs);
+    }
+
+    stats.elapsed = Clock::now() - start;
+    stats.truncated = reader.truncated();
+    return stats;
+}
+
+void TraceReplayer::deliver(const TraceEvent& event, PassByManager& manager) {
+    switch (event.type) {
+        case TraceEventType::DeviceDiscovered:
+            manager.onDeviceDiscovered(event.text);
+            break;
+        case TraceEventType::DeviceIdDiscovered:
+            manager.onDeviceDiscovered(event.id);
+            break;
+        case TraceEventType::ServiceDeviceDiscovered:
+            manager.onDeviceDiscovered(event.text, event.service, event.rssi);
+            break;
+        case TraceEventType::PeripheralDiscovered:
+            manager.onPeripheralDiscovered(event.id, event.rssi);
+            break;
+        case TraceEventType::PeripheralAdvertisement:
+            manager.onPeripheralAdvertisement(event.id, event.rssi, event.data, event.length);
+            break;
+        case TraceEventType::PeripheralIdentifierRead:
+            manager.onPeripheralIdentifierRead(event.id, event.text);
+            break;
+        case TraceEventType::PeripheralConnectionFailed:
+            manager.onPeripheralConnectionFailed(event.id);
+            break;
+        case TraceEventType::AdvertisingStarted:
+            manager.onAdvertisingStarted(std::string(event.text), event.success, std::string(event.detail));
+            break;
+        case TraceEventType::StageLatency:
+            manager.recordStageLatency(event.stage, std::chrono::microseconds(event.value));
+            break;
+        case TraceEventType::RssiDeviceIdDiscovered:
+            manager.onDeviceDiscovered(event.id, event.rssi);
+            break;
+        case TraceEventType::ServiceDeviceIdDiscovered:
+            manager.onDeviceDiscovered(event.id, event.service, event.rssi);
+            break;
+    }
+}
+
+} // namespace PassBy
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <PassBy/DeviceId.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace PassBy {
+
+// Identifier carried in an advertisement, so a peer is discovered without connecting
+struct AdvertisedIdentifier {
+    DeviceId id;
+    uint8_t version = 0;
+    uint8_t flags = 0;
+};
+
+// Binary PassBy identifier for advertisement payloads.
+// Payload (20 bytes): 'P', version << 4 | flags, 16 identifier bytes, CRC-16/CCITT of
+// the first 18 bytes (big-endian). It travels as manufacturer data or as 16-bit
+// service data, which both fit a legacy 31-byte advertisement next to the flags.
+// Peers without a payload, or with a version this build does not know, are read
+// over GATT as before.
+class AdvertisementCodec {
+public:
+    static constexpr size_t kPayloadSize = 20;
+    static constexpr uint8_t kMagic = 'P';
+    static constexpr uint8_t kVersion = 1;
+
+    // Placeholders until the product has assigned numbers (0xFFFF is reserved for testing)
+    static constexpr uint16_t kCompanyId = 0xFFFF;
+    static constexpr uint16_t kServiceUuid16 = 0xFFFF;
+
+    // Payload flags
+    static constexpr uint8_t kFlagGattIdentifier = 0x01;   // Also serves the GATT characteristic
+
+    // AD structure types (Bluetooth Core Supplement, part A)
+    static constexpr uint8_t kAdTypeIncompleteServices16 = 0x02;
+    static constexpr uint8_t kAdTypeCompleteServices16 = 0x03;
+    static constexpr uint8_t kAdTypeIncompleteServices128 = 0x06;
+    static constexpr uint8_t kAdTypeCompleteServices128 = 0x07;
+    static constexpr uint8_t kAdTypeServiceData16 = 0x16;
+    static constexpr uint8_t kAdTypeManufacturerData = 0xFF;
+
+    // Size of the AD structures written by the encode*Structure functions
+    static constexpr size_t kStructureSize = 2 + 2 + kPayloadSize;
+
+    // Write the payload; returns bytes written, 0 if `capacity` is too small
+    static size_t encodePayload(const DeviceId& id, uint8_t flags, uint8_t* out, size_t capacity);
+
+    // Whole AD structures (length, type, company id or service UUID, payload)
+    static size_t encodeManufacturerStructure(const DeviceId& id, uint8_t flags, uint8_t* out, size_t capacity);
+    static size_t encodeServiceDataStructure(const DeviceId& id, uint8_t flags, uint8_t* out, size_t capacity);
+
+    // Decode a payload; extra trailing bytes are ignored
+    static bool decodePayload(const uint8_t* data, size_t length, AdvertisedIdentifier& out);
+
+    // Manufacturer data as platforms hand it out: company id (little-endian), then payload
+    static bool decodeManufacturerData(const uint8_t* data, size_t length, AdvertisedIdentifier& out);
+
+    // Service data for kServiceUuid16 (without the UUID)
+    static bool decodeServiceData(const uint8_t* data, size_t length, AdvertisedIdentifier& out);
+
+    // Search raw advertising data (a sequence of AD structures, e.g. an advertisement
+    // followed by its scan response). Malformed structures end the search.
+    static bool decodeAdvertisement(const uint8_t* data, size_t length, AdvertisedIdentifier& out);
+
+    // First service UUID listed in raw advertising data; 16-bit UUIDs are expanded
+    // with the Bluetooth base UUID
+    static bool decodeServiceUuid(const uint8_t* data, size_t length, DeviceId& out);
+
+    static uint16_t checksum(const uint8_t* data, size_t length);
+};
+
+} // namespace PassBy
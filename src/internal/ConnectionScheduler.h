@@ -0,0 +1,97 @@
+#pragma once
+
+#include <PassBy/PassByTypes.h>
+#include "DeviceIdTable.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace PassBy {
+
+// Decides which advertising peripherals the platform connects to, and when.
+// Candidates are ranked by signal strength and how recently they were heard,
+// at most maxConcurrentConnections chains run at once, stalled chains time out,
+// and failures back off exponentially per peripheral. Peripherals are identified
+// by the platform's handle. Owned by the dispatch thread; times are steady ms.
+class ConnectionScheduler {
+public:
+    static constexpr int64_t kNoDeadline = std::numeric_limits<int64_t>::max();
+
+    ConnectionScheduler();
+
+    void configure(const ConnectionPolicy& policy);
+
+    // An advertisement from a PassBy peripheral
+    void onAdvertisement(const DeviceId& peripheral, int rssi, int64_t nowMs);
+
+    // The chain for peripheral finished with an identifier; returns false if it was not in flight.
+    // `rssi` receives the last advertisement's RSSI if the peripheral is tracked.
+    bool onResolved(const DeviceId& peripheral, int* rssi = nullptr);
+
+    // The chain for peripheral failed; ignored unless it is in flight
+    void onFailed(const DeviceId& peripheral, int64_t nowMs);
+
+    // True when poll() has work: new candidates, free slots or a passed deadline
+    bool needsPoll(int64_t nowMs) const { return m_changed || nowMs >= m_nextDeadlineMs; }
+
+    // Time out stalled chains and pick the next peripherals to connect.
+    // Results are in timedOut() and toConnect() until the next call.
+    void poll(int64_t nowMs);
+
+    const std::vector<DeviceId>& toConnect() const { return m_toConnect; }
+    const std::vector<DeviceId>& timedOut() const { return m_timedOut; }
+
+    // Forget every peripheral; visits the handles of chains still in flight
+    template <typename F>
+    void reset(F&& cancel) {
+        m_peripherals.forEach([&](const DeviceId& peripheral, Peripheral& state) {
+            if (state.connecting) {
+                cancel(peripheral);
+            }
+        });
+        m_peripherals.clear();
+        m_inFlight = 0;
+        m_changed = false;
+        m_nextDeadlineMs = kNoDeadline;
+    }
+
+    // Earliest time poll() has something to do, kNoDeadline if none
+    int64_t nextDeadlineMs() const { return m_changed ? 0 : m_nextDeadlineMs; }
+
+    size_t inFlight() const { return m_inFlight; }
+    size_t trackedCount() const { return m_peripherals.size(); }
+    uint64_t ignoredCount() const { return m_ignored; }
+
+private:
+    struct Peripheral {
+        int64_t lastSeenMs = 0;
+        int64_t notBeforeMs = 0;    // Backoff: no new chain before this
+        int64_t deadlineMs = 0;     // Timeout of the running chain
+        uint32_t failures = 0;      // Consecutive
+        int16_t rssi = 0;
+        bool connecting = false;
+    };
+
+    int64_t backoffMs(uint32_t failures) const;
+    void fail(Peripheral& state, int64_t nowMs);
+
+    DeviceIdMap<Peripheral> m_peripherals;
+    std::vector<std::pair<int64_t, DeviceId>> m_ranked;    // Reused by poll()
+    std::vector<DeviceId> m_stale;
+    std::vector<DeviceId> m_toConnect;
+    std::vector<DeviceId> m_timedOut;
+    size_t m_maxConcurrent;
+    int64_t m_timeoutMs;
+    int64_t m_initialBackoffMs;
+    int64_t m_maxBackoffMs;
+    int64_t m_lifetimeMs;
+    size_t m_maxTracked;
+    size_t m_inFlight;
+    bool m_changed;
+    int64_t m_nextDeadlineMs;
+    uint64_t m_ignored;
+};
+
+} // namespace PassBy
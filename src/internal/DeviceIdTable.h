@@ -0,0 +1,379 @@
+#pragma once
+
+#include <PassBy/DeviceId.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PASSBY_GROUP_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define PASSBY_GROUP_NEON 1
+#endif
+
+namespace PassBy {
+
+namespace detail {
+
+// Control byte per slot: empty, deleted (tombstone) or the 7 low hash bits of a full slot
+using ControlByte = int8_t;
+constexpr ControlByte kCtrlEmpty = -128;
+constexpr ControlByte kCtrlDeleted = -2;
+constexpr size_t kGroupWidth = 16;
+
+// Set of matching slots in a group; one bit per slot (one nibble on NEON)
+class GroupMask {
+public:
+#if defined(PASSBY_GROUP_NEON)
+    static constexpr int kShift = 2;
+#else
+    static constexpr int kShift = 0;
+#endif
+
+    explicit GroupMask(uint64_t bits) : m_bits(bits) {}
+
+    bool any() const { return m_bits != 0; }
+    size_t lowest() const { return static_cast<size_t>(__builtin_ctzll(m_bits)) >> kShift; }
+    void clearLowest() { m_bits &= m_bits - 1; }
+
+private:
+    uint64_t m_bits;
+};
+
+// Sixteen control bytes probed at once
+class Group {
+public:
+    explicit Group(const ControlByte* ctrl) {
+#if defined(PASSBY_GROUP_SSE2)
+        m_ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+#elif defined(PASSBY_GROUP_NEON)
+        m_ctrl = vld1q_s8(ctrl);
+#else
+        std::memcpy(m_ctrl, ctrl, kGroupWidth);
+#endif
+    }
+
+    GroupMask match(ControlByte h2) const {
+#if defined(PASSBY_GROUP_SSE2)
+        return GroupMask(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), m_ctrl))));
+#elif defined(PASSBY_GROUP_NEON)
+        return neonMask(vceqq_s8(m_ctrl, vdupq_n_s8(h2)));
+#else
+        uint64_t bits = 0;
+        for (size_t i = 0; i < kGroupWidth; ++i) {
+            bits |= static_cast<uint64_t>(m_ctrl[i] == h2) << i;
+        }
+        return GroupMask(bits);
+#endif
+    }
+
+    GroupMask matchEmpty() const {
+        return match(kCtrlEmpty);
+    }
+
+    // Empty and deleted are the only negative values below -1
+    GroupMask matchEmptyOrDeleted() const {
+#if defined(PASSBY_GROUP_SSE2)
+        return GroupMask(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), m_ctrl))));
+#elif defined(PASSBY_GROUP_NEON)
+        return neonMask(vcltq_s8(m_ctrl, vdupq_n_s8(-1)));
+#else
+        uint64_t bits = 0;
+        for (size_t i = 0; i < kGroupWidth; ++i) {
+            bits |= static_cast<uint64_t>(m_ctrl[i] < -1) << i;
+        }
+        return GroupMask(bits);
+#endif
+    }
+
+private:
+#if defined(PASSBY_GROUP_SSE2)
+    __m128i m_ctrl;
+#elif defined(PASSBY_GROUP_NEON)
+    static GroupMask neonMask(uint8x16_t lanes) {
+        // Narrow each 8-bit lane to a nibble, keep one bit per nibble
+        uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(lanes), 4);
+        return GroupMask(vget_lane_u64(vreinterpret_u64_u8(narrowed), 0) & 0x8888888888888888ULL);
+    }
+
+    int8x16_t m_ctrl;
+#else
+    ControlByte m_ctrl[kGroupWidth];
+#endif
+};
+
+} // namespace detail
+
+// Open-addressing hash table keyed by DeviceId (SwissTable layout).
+// Slots are probed sixteen at a time by comparing 7-bit hash tags in the control bytes,
+// so a lookup usually touches one control group and one key. Keys and values live in
+// separate arrays; DeviceIdTable<void> is a set and stores keys only.
+template <typename Value>
+class DeviceIdTable {
+    static constexpr bool kHasValue = !std::is_void<Value>::value;
+
+public:
+    using Mapped = typename std::conditional<kHasValue, Value, char>::type;
+
+    DeviceIdTable() : m_capacity(0), m_size(0), m_deleted(0) {}
+
+    DeviceIdTable(const DeviceIdTable&) = delete;
+    DeviceIdTable& operator=(const DeviceIdTable&) = delete;
+
+    DeviceIdTable(DeviceIdTable&& other) noexcept { moveFrom(other); }
+
+    DeviceIdTable& operator=(DeviceIdTable&& other) noexcept {
+        if (this != &other) {
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    // Insert `id` if absent. Returns the value slot (nullptr for sets) and whether it was inserted.
+    std::pair<Mapped*, bool> insert(const DeviceId& id) {
+        uint64_t hash = id.hash();
+        size_t existing = findIndex(id, hash);
+        if (existing != kNotFound) {
+            return {valueAt(existing), false};
+        }
+
+        if (m_size + m_deleted + 1 > maxLoad(m_capacity)) {
+            // Grow when genuinely full, otherwise just drop the tombstones
+            rehash(m_size + 1 > growthLimit(m_capacity) ? m_capacity * 2 : m_capacity);
+        }
+
+        size_t index = findInsertSlot(hash);
+        if (m_ctrl[index] == detail::kCtrlDeleted) {
+            --m_deleted;
+        }
+        m_ctrl[index] = h2(hash);
+        m_keys[index] = id;
+        ++m_size;
+        return {valueAt(index), true};
+    }
+
+    Mapped* find(const DeviceId& id) {
+        size_t index = findIndex(id, id.hash());
+        return index == kNotFound ? nullptr : valueAt(index);
+    }
+
+    const Mapped* find(const DeviceId& id) const {
+        return const_cast<DeviceIdTable*>(this)->find(id);
+    }
+
+    bool contains(const DeviceId& id) const {
+        return m_size != 0 && findIndex(id, id.hash()) != kNotFound;
+    }
+
+    bool erase(const DeviceId& id) {
+        size_t index = findIndex(id, id.hash());
+        if (index == kNotFound) {
+            return false;
+        }
+        if constexpr (kHasValue) {
+            m_values[index] = Mapped();
+        }
+        --m_size;
+
+        // A group that still has an empty slot has never been full, so no probe
+        // sequence continues past it and the slot can go back to empty
+        size_t base = index & ~(detail::kGroupWidth - 1);
+        if (detail::Group(&m_ctrl[base]).matchEmpty().any()) {
+            m_ctrl[index] = detail::kCtrlEmpty;
+        } else {
+            m_ctrl[index] = detail::kCtrlDeleted;
+            ++m_deleted;
+        }
+        return true;
+    }
+
+    // Remove everything; keeps the allocated slots when releaseMemory is false
+    void clear(bool releaseMemory = true) {
+        if (releaseMemory) {
+            m_ctrl.reset();
+            m_keys.reset();
+            m_values.reset();
+            m_capacity = 0;
+        } else if (m_capacity > 0) {
+            std::memset(m_ctrl.get(), static_cast<uint8_t>(detail::kCtrlEmpty), m_capacity);
+            if constexpr (kHasValue) {
+                for (size_t i = 0; i < m_capacity; ++i) {
+                    m_values[i] = Mapped();
+                }
+            }
+        }
+        m_size = 0;
+        m_deleted = 0;
+    }
+
+    // Make room for `count` elements without further rehashing
+    void reserve(size_t count) {
+        size_t capacity = capacityFor(count);
+        if (capacity > m_capacity) {
+            rehash(capacity);
+        }
+    }
+
+    // Smallest capacity that holds `count` elements without rehashing
+    static size_t capacityFor(size_t count) {
+        size_t capacity = detail::kGroupWidth;
+        while (growthLimit(capacity) < count) {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    size_t capacity() const { return m_capacity; }
+
+    // Heap bytes held by the table
+    size_t memoryUsage() const {
+        return bytesForCapacity(m_capacity);
+    }
+
+    static size_t bytesForCapacity(size_t capacity) {
+        size_t perSlot = sizeof(detail::ControlByte) + sizeof(DeviceId) + (kHasValue ? sizeof(Mapped) : 0);
+        return capacity * perSlot;
+    }
+
+    // Visit every element: f(const DeviceId&) for sets, f(const DeviceId&, Value&) for maps
+    template <typename F>
+    void forEach(F&& f) const {
+        for (size_t i = 0; i < m_capacity; ++i) {
+            if (m_ctrl[i] >= 0) {
+                if constexpr (kHasValue) {
+                    f(m_keys[i], m_values[i]);
+                } else {
+                    f(m_keys[i]);
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr size_t kNotFound = static_cast<size_t>(-1);
+
+    // Full plus deleted slots allowed before rehashing (7/8)
+    static size_t maxLoad(size_t capacity) {
+        return capacity - capacity / 8;
+    }
+
+    // Elements allowed before the table doubles (3/4); the gap to maxLoad is room for
+    // tombstones so in-place rehashes stay infrequent
+    static size_t growthLimit(size_t capacity) {
+        return capacity - capacity / 4;
+    }
+
+    static detail::ControlByte h2(uint64_t hash) {
+        return static_cast<detail::ControlByte>(hash & 0x7F);
+    }
+
+    size_t groupMask() const {
+        return m_capacity / detail::kGroupWidth - 1;
+    }
+
+    Mapped* valueAt(size_t index) const {
+        return kHasValue ? &m_values[index] : nullptr;
+    }
+
+    size_t findIndex(const DeviceId& id, uint64_t hash) const {
+        if (m_capacity == 0) {
+            return kNotFound;
+        }
+        size_t mask = groupMask();
+        size_t group = (hash >> 7) & mask;
+        for (size_t step = 1;; ++step) {
+            size_t base = group * detail::kGroupWidth;
+            detail::Group g(&m_ctrl[base]);
+            for (detail::GroupMask match = g.match(h2(hash)); match.any(); match.clearLowest()) {
+                size_t index = base + match.lowest();
+                if (m_keys[index] == id) {
+                    return index;
+                }
+            }
+            if (g.matchEmpty().any() || step > mask) {
+                return kNotFound;
+            }
+            // Triangular probing visits every group when the group count is a power of two
+            group = (group + step) & mask;
+        }
+    }
+
+    size_t findInsertSlot(uint64_t hash) const {
+        size_t mask = groupMask();
+        size_t group = (hash >> 7) & mask;
+        for (size_t step = 1;; ++step) {
+            size_t base = group * detail::kGroupWidth;
+            detail::GroupMask free = detail::Group(&m_ctrl[base]).matchEmptyOrDeleted();
+            if (free.any()) {
+                return base + free.lowest();
+            }
+            group = (group + step) & mask;
+        }
+    }
+
+    void rehash(size_t newCapacity) {
+        if (newCapacity < detail::kGroupWidth) {
+            newCapacity = detail::kGroupWidth;
+        }
+
+        std::unique_ptr<detail::ControlByte[]> oldCtrl = std::move(m_ctrl);
+        std::unique_ptr<DeviceId[]> oldKeys = std::move(m_keys);
+        std::unique_ptr<Mapped[]> oldValues = std::move(m_values);
+        size_t oldCapacity = m_capacity;
+
+        m_ctrl.reset(new detail::ControlByte[newCapacity]);
+        std::memset(m_ctrl.get(), static_cast<uint8_t>(detail::kCtrlEmpty), newCapacity);
+        m_keys.reset(new DeviceId[newCapacity]);
+        if constexpr (kHasValue) {
+            m_values.reset(new Mapped[newCapacity]);
+        }
+        m_capacity = newCapacity;
+        m_deleted = 0;
+
+        for (size_t i = 0; i < oldCapacity; ++i) {
+            if (oldCtrl[i] < 0) {
+                continue;
+            }
+            uint64_t hash = oldKeys[i].hash();
+            size_t index = findInsertSlot(hash);
+            m_ctrl[index] = h2(hash);
+            m_keys[index] = oldKeys[i];
+            if constexpr (kHasValue) {
+                m_values[index] = std::move(oldValues[i]);
+            }
+        }
+    }
+
+    void moveFrom(DeviceIdTable& other) {
+        m_ctrl = std::move(other.m_ctrl);
+        m_keys = std::move(other.m_keys);
+        m_values = std::move(other.m_values);
+        m_capacity = other.m_capacity;
+        m_size = other.m_size;
+        m_deleted = other.m_deleted;
+        other.m_capacity = 0;
+        other.m_size = 0;
+        other.m_deleted = 0;
+    }
+
+    std::unique_ptr<detail::ControlByte[]> m_ctrl;
+    std::unique_ptr<DeviceId[]> m_keys;
+    std::unique_ptr<Mapped[]> m_values;
+    size_t m_capacity;
+    size_t m_size;
+    size_t m_deleted;
+};
+
+using DeviceIdSet = DeviceIdTable<void>;
+
+template <typename Value>
+using DeviceIdMap = DeviceIdTable<Value>;
+
+} // namespace PassBy
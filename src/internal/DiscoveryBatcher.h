@@ -0,0 +1,60 @@
+#pragma once
+
+#include <PassBy/PassByTypes.h>
+#include "DeviceIdTable.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace PassBy {
+
+struct EncounterRecord;
+class EncounterStore;
+
+// Batch callback together with its flush options
+struct BatchSubscription {
+    DeviceBatchCallback callback;
+    BatchOptions options;
+};
+
+// Coalesces sightings into batches of distinct devices for the batch callback.
+// Entries and their strings are reused across batches, so a steady stream of
+// known devices does not allocate. Owned by the dispatch thread.
+class DiscoveryBatcher {
+public:
+    DiscoveryBatcher();
+
+    void configure(int64_t flushIntervalMs, size_t maxEvents);
+
+    // Add one sighting at steady time nowMs. Returns true once the batch holds maxEvents sightings.
+    bool add(const EncounterRecord& record, const EncounterStore& store, int64_t nowMs);
+
+    bool empty() const { return m_count == 0; }
+
+    // Whether the pending batch has reached its flush interval
+    bool isDue(int64_t nowMs) const {
+        return m_count > 0 && nowMs >= deadlineMs();
+    }
+
+    // Steady time at which the pending batch must be flushed
+    int64_t deadlineMs() const { return m_batchStartMs + m_flushIntervalMs; }
+
+    // View of the pending batch; valid until reset()
+    EncounterSpan pending() const {
+        return EncounterSpan(m_entries.data(), m_count);
+    }
+
+    // Start a new batch, keeping allocated entries
+    void reset();
+
+private:
+    std::vector<EncounterInfo> m_entries;
+    size_t m_count;
+    DeviceIdMap<uint32_t> m_index;
+    size_t m_eventCount;
+    int64_t m_batchStartMs;
+    int64_t m_flushIntervalMs;
+    size_t m_maxEvents;
+};
+
+} // namespace PassBy
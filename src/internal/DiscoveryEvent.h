@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <PassBy/DeviceId.h>
+
+namespace PassBy {
+
+// Namespace scope so PassBy.h can forward-declare it
+enum class DiscoveryEventType : uint8_t {
+    DeviceDiscovered,
+    AdvertisingStarted,
+    FlushBatch,                 // Deliver the pending discovery batch now
+    PeripheralDiscovered,       // Advertisement from a connectable peripheral
+    PeripheralIdentifierRead,   // Connect/read chain finished; also a DeviceDiscovered
+    PeripheralConnectionFailed,
+    StopConnections,            // Cancel every chain in flight
+    DutyCycleStart,             // Scanning started; identifier holds the service UUID
+    DutyCycleStop,
+    ConfigurationChanged,       // Wake the dispatch thread to apply new settings
+    ClearDevices                // clearDiscoveredDevices() from another thread
+};
+
+// Fixed-size event passed from PassByBridge to the PassByManager dispatch thread.
+// Identifiers are parsed to a DeviceId on the producer side; the original text is
+// kept inline only when it is not a canonical UUID, so producers never allocate.
+struct DiscoveryEvent {
+    using Type = DiscoveryEventType;
+
+    static constexpr size_t kMaxIdentifierLength = 63;
+
+    Type type = Type::DeviceDiscovered;
+    bool success = false;
+    bool canonicalId = false;
+    bool hasService = false;
+    int16_t rssi = 0;           // SubscriptionMatcher::kUnknownRssi if not reported
+    DeviceId deviceId;
+    DeviceId peripheral;        // Platform handle for Peripheral* events
+    DeviceId service;           // Advertised service, if hasService
+    int64_t timestampMs = 0;    // Wall clock at the bridge
+    int64_t queuedUs = 0;       // PipelineMetrics::now() at the bridge, for discoveries
+    uint8_t identifierLength = 0;
+    char identifier[kMaxIdentifierLength];
+    std::string errorMessage; // AdvertisingStarted failures only
+
+    // Returns false if the identifier does not fit
+    bool setIdentifier(std::string_view value) {
+        if (value.size() > kMaxIdentifierLength) {
+            return false;
+        }
+        identifierLength = static_cast<uint8_t>(value.size());
+        if (!value.empty()) {
+            std::memcpy(identifier, value.data(), value.size());
+        }
+        return true;
+    }
+
+    std::string_view identifierView() const {
+        return std::string_view(identifier, identifierLength);
+    }
+
+    std::string identifierString() const {
+        return std::string(identifier, identifierLength);
+    }
+};
+
+} // namespace PassBy
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <PassBy/PassByTypes.h>
+#include <cstdint>
+#include <limits>
+
+namespace PassBy {
+
+// Decides when the radio is on during a scanning session (see DutyCycleOptions).
+// A cycle starts with a radio-on window; a window that found new peers resets the
+// period to targetLatency, a quiet one doubles it up to maxLatency. New peers also
+// keep the current window open, up to maxWindow. Time is passed in by the caller,
+// so the controller runs on the dispatch thread's clock or on a virtual one in tests.
+class DutyCycleController {
+public:
+    static constexpr int64_t kNoDeadline = std::numeric_limits<int64_t>::max();
+
+    enum class Action {
+        None,
+        RadioOn,
+        RadioOff
+    };
+
+    DutyCycleController();
+
+    // Takes effect from the next window; a running session keeps its state
+    void configure(const DutyCycleOptions& options);
+
+    // Begin a session with the radio on (it is turned on by the caller)
+    void start(int64_t nowMs);
+    void stop();
+
+    // A peer not seen before was discovered
+    void onNewPeer(int64_t nowMs);
+
+    // What the caller should do with the radio now
+    Action poll(int64_t nowMs);
+
+    // Next time poll() may return an action, kNoDeadline when stopped
+    int64_t nextDeadlineMs() const;
+
+    bool isRunning() const { return m_running; }
+    bool isRadioOn() const { return m_radioOn; }
+    int64_t periodMs() const { return m_periodMs; }
+    uint64_t windowCount() const { return m_windows; }
+
+private:
+    void openWindow(int64_t nowMs);
+
+    int64_t m_windowMs;
+    int64_t m_maxWindowMs;
+    int64_t m_targetLatencyMs;
+    int64_t m_maxLatencyMs;
+    bool m_running;
+    bool m_radioOn;
+    int64_t m_windowStartMs;
+    int64_t m_windowEndMs;
+    int64_t m_nextStartMs;
+    int64_t m_periodMs;
+    uint32_t m_newInWindow;
+    uint64_t m_windows;
+};
+
+} // namespace PassBy
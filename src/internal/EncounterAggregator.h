@@ -0,0 +1,91 @@
+#pragma once
+
+#include <PassBy/DeviceId.h>
+#include <PassBy/PassByTypes.h>
+#include "DeviceIdTable.h"
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <string_view>
+
+namespace PassBy {
+
+// Running statistics of one device
+struct EncounterAggregate {
+    int64_t firstSeenMs = 0;
+    int64_t lastSeenMs = 0;
+    int64_t visitStartMs = 0;       // First sighting of the current visit
+    int64_t closedDwellMs = 0;      // Summed length of the earlier visits
+    uint64_t sightings = 0;
+    uint32_t visits = 0;
+    bool hasRssi = false;
+    double rssi = 0;                // EWMA, dBm
+    std::string alias;              // Identifier text of non-canonical ids
+
+    int64_t dwellMs() const { return closedDwellMs + (lastSeenMs - visitStartMs); }
+};
+
+// Per-device visit counts, dwell time and smoothed RSSI, updated on each sighting, with
+// one ordered index per EncounterRanking. A sighting moves the device's index entries
+// by reusing their nodes (erase and reinsert without allocating), so an update costs
+// O(log n) and top(k) walks the first k entries of an index: O(k), no pass over the set.
+// A sighting more than sessionGapMs after the previous one starts a new visit. Beyond
+// maxDevices the least recently seen device is dropped. Not thread-safe.
+class EncounterAggregator {
+public:
+    EncounterAggregator(int64_t sessionGapMs, double rssiSmoothing, size_t maxDevices);
+
+    EncounterAggregator(const EncounterAggregator&) = delete;
+    EncounterAggregator& operator=(const EncounterAggregator&) = delete;
+
+    // Sighting at nowMs. rssi is ignored when hasRssi is false; alias as in EncounterStore::record().
+    void record(const DeviceId& id, int64_t nowMs, bool hasRssi, int rssi, std::string_view alias);
+
+    const EncounterAggregate* find(const DeviceId& id) const { return m_devices.find(id); }
+
+    // Visit up to k devices best first: f(const DeviceId&, const EncounterAggregate&)
+    template <typename F>
+    void top(EncounterRanking ranking, size_t k, F&& f) const {
+        const Index& index = m_indexes[static_cast<size_t>(ranking)];
+        for (auto it = index.begin(); it != index.end() && k > 0; ++it, --k) {
+            f(it->id, *m_devices.find(it->id));
+        }
+    }
+
+    void clear();
+
+    size_t size() const { return m_devices.size(); }
+    size_t memoryUsage() const;
+
+private:
+    // Ordering of one index, best first; ties go to the lower id so the order is total
+    struct Key {
+        int64_t primary;
+        int64_t secondary;
+        DeviceId id;
+
+        bool operator<(const Key& other) const {
+            if (primary != other.primary) {
+                return primary > other.primary;
+            }
+            if (secondary != other.secondary) {
+                return secondary > other.secondary;
+            }
+            return id < other.id;
+        }
+    };
+    using Index = std::set<Key>;
+
+    static Key keyFor(EncounterRanking ranking, const DeviceId& id, const EncounterAggregate& aggregate);
+    void evictLeastRecent();
+
+    DeviceIdMap<EncounterAggregate> m_devices;
+    Index m_indexes[kEncounterRankingCount];
+    int64_t m_sessionGapMs;
+    double m_rssiSmoothing;
+    size_t m_maxDevices;
+    size_t m_aliasBytes;
+};
+
+} // namespace PassBy
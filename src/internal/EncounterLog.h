@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace PassBy {
+
+struct EncounterRecord;
+class EncounterStore;
+
+// Append-only encounter log written through a shared memory mapping.
+// Each append is the full state of one encounter; on load the last entry per device wins.
+// Entries carry a checksum and are written payload-first, so a process killed mid-append
+// leaves a torn tail that open() detects and discards. compact() rewrites the file from
+// the live store into a temporary file and renames it over the log; startCompaction()
+// does the same from a copy of the records on a background thread, so the caller's lock
+// on the store is only held for the copy and the final rename.
+// The format is host-endian: logs are local to the device that wrote them.
+class EncounterLog {
+public:
+    EncounterLog();
+    ~EncounterLog();
+
+    EncounterLog(const EncounterLog&) = delete;
+    EncounterLog& operator=(const EncounterLog&) = delete;
+
+    // Open or create the log. Returns false on I/O errors or if the file is not an encounter log.
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+
+    // Restore every entry into store; returns the number of entries read
+    size_t load(EncounterStore& store, int64_t nowMs) const;
+
+    // Append the current state of one record
+    bool append(const EncounterRecord& record, std::string_view alias);
+
+    // Drop every entry
+    bool reset();
+
+    // Rewrite the log with only the live records of store
+    bool compact(const EncounterStore& store, int64_t nowMs);
+
+    // Copy the live records of store and start rewriting the log from them on a background
+    // thread. Appends keep going to the current file until finishCompaction().
+    bool startCompaction(const EncounterStore& store, int64_t nowMs);
+    bool isCompacting() const { return m_pending != nullptr; }
+
+    // Once the background rewrite is written (or after waiting for it when wait is true),
+    // rename it over the log and append what changed in store since startCompaction().
+    // Returns true if the compacted log is now in place.
+    bool finishCompaction(const EncounterStore& store, int64_t nowMs, bool wait = false);
+
+    // True once superseded entries dominate the file
+    bool shouldCompact(size_t liveRecords) const;
+
+    // Schedule dirty pages for writeback (synchronous when wait is true)
+    void sync(bool wait = false);
+
+    const std::string& path() const { return m_path; }
+    size_t entryCount() const { return m_entryCount; }
+    size_t usedBytes() const { return m_tail; }
+
+private:
+    bool map(size_t size);
+    void unmap();
+    bool ensureCapacity(size_t required);
+    size_t scan();
+    void abandonCompaction();
+
+    struct PendingCompaction;
+
+    std::string m_path;
+    int m_fd;
+    uint8_t* m_data;
+    size_t m_mappedSize;
+    size_t m_tail;          // Offset of the next entry
+    size_t m_entryCount;
+    std::unique_ptr<PendingCompaction> m_pending;
+};
+
+} // namespace PassBy
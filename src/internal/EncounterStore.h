@@ -0,0 +1,235 @@
+#pragma once
+
+#include <PassBy/DeviceId.h>
+#include "DeviceIdTable.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace PassBy {
+
+// One tracked device
+struct EncounterRecord {
+    DeviceId id;
+    int64_t firstSeenMs;
+    int64_t lastSeenMs;
+    uint64_t generation;    // Store generation of the last change
+    uint32_t hitCount;
+    uint32_t newer;         // Change journal links (slots), kNoSlot at either end
+    uint32_t older;
+    bool occupied;
+    bool referenced;    // CLOCK reference bit
+    bool hasAlias;      // Identifier text kept (alias table, or inline with a budget)
+    bool dirty;         // Changed since the last drainChanges()
+};
+
+// Encounter registry with TTL expiry and a memory budget.
+// Records live in a slot array indexed by a DeviceIdMap. When the budget is reached a
+// CLOCK hand picks the victim (expired first, then unreferenced), and every update also
+// advances a second hand over a few slots to retire expired records, so both eviction
+// and expiry are amortized O(1). With a budget the storage is allocated up front and
+// never rehashes on the discovery path, alias text included: every slot reserves room
+// for an inline alias within the same budget.
+// Every change bumps a generation counter and moves the record to the head of an
+// intrusive journal, so changesSince() costs O(changes) rather than O(size).
+class EncounterStore {
+public:
+    static constexpr uint32_t kNoSlot = static_cast<uint32_t>(-1);
+
+    // Longest alias kept under a memory budget; longer ones fall back to the canonical form
+    static constexpr size_t kMaxInlineAliasLength = 63;
+
+    EncounterStore();
+
+    // ttlMs == 0 keeps records forever, maxMemoryBytes == 0 means unbounded.
+    // Shrinking the budget evicts immediately.
+    void configure(int64_t ttlMs, size_t maxMemoryBytes);
+
+    // Record a sighting at nowMs. `alias` is the identifier text for non-canonical ids
+    // (empty otherwise). Returns the updated record; `isNew` reports a first sighting.
+    const EncounterRecord* record(const DeviceId& id, int64_t nowMs, std::string_view alias, bool* isNew = nullptr);
+
+    // Live record for id, nullptr if unknown or expired
+    const EncounterRecord* find(const DeviceId& id, int64_t nowMs) const;
+
+    // Insert or overwrite a record with saved state, e.g. from an EncounterLog.
+    // Records already expired at nowMs are skipped. Not reported by drainChanges().
+    void restore(const DeviceId& id, int64_t firstSeenMs, int64_t lastSeenMs, uint32_t hitCount,
+                 std::string_view alias, int64_t nowMs);
+
+    // Preallocate for count records (no-op with a memory budget, which preallocates already)
+    void reserve(size_t count);
+
+    // Alias text of a record, empty for canonical ids
+    std::string_view aliasOf(const EncounterRecord& record) const;
+
+    // Identifier text of a record (alias or canonical form)
+    std::string identifierString(const EncounterRecord& record) const;
+
+    // Same, assigned into `out` so its capacity is reused
+    void identifierString(const EncounterRecord& record, std::string& out) const;
+
+    // Visit every live record
+    template <typename F>
+    void forEach(int64_t nowMs, F&& f) const {
+        for (const auto& record : m_records) {
+            if (record.occupied && !isExpired(record, nowMs)) {
+                f(record);
+            }
+        }
+    }
+
+    // Generation of the most recent change
+    uint64_t generation() const { return m_generation; }
+
+    // Visit live records changed after `generation` (newest first) and ids removed since.
+    // Records that merely timed out count as removed once retired, see expireStale().
+    // Returns false without visiting anything if that history is gone (cleared, or too many
+    // removals since); the caller must then resynchronize with forEach().
+    template <typename Changed, typename Removed>
+    bool changesSince(uint64_t generation, int64_t nowMs, Changed&& changed, Removed&& removed) const {
+        if (generation < m_historyStart) {
+            return false;
+        }
+        for (uint32_t slot = m_newest; slot != kNoSlot && m_records[slot].generation > generation;
+             slot = m_records[slot].older) {
+            if (!isExpired(m_records[slot], nowMs)) {
+                changed(m_records[slot]);
+            }
+        }
+        for (size_t i = m_removedCount; i > 0; --i) {
+            const Removal& removal = m_removed[(m_removedHead + i - 1) % m_removed.size()];
+            if (removal.generation <= generation) {
+                break;
+            }
+            removed(removal.id);
+        }
+        return true;
+    }
+
+    // Remember which records record() changes, for drainChanges()
+    void setChangeTracking(bool enabled);
+
+    // Visit each live record changed since the last call, once
+    template <typename F>
+    void drainChanges(F&& f) {
+        for (uint32_t slot : m_changed) {
+            EncounterRecord& record = m_records[slot];
+            if (record.dirty) {
+                record.dirty = false;
+                if (record.occupied) {
+                    f(static_cast<const EncounterRecord&>(record));
+                }
+            }
+        }
+        m_changed.clear();
+    }
+
+    // While retaining (calls nest), a copy of every record removed or restarted is kept
+    // aside and new records are noted, so a reader walking the store in several passes,
+    // releasing its lock in between, can still see the records of an earlier generation
+    void retainHistory(bool enabled);
+
+    // Visit the records that were live at nowMs as of `generation`, a generation() taken
+    // while retaining: those still stored with their current state, and copies of those
+    // removed since. f(record, alias) is called in no particular order.
+    template <typename F>
+    void forEachAsOf(uint64_t generation, int64_t nowMs, F&& f) const {
+        forEach(nowMs, [&](const EncounterRecord& record) {
+            const uint64_t* created = m_created.find(record.id);
+            if (!created || *created <= generation) {
+                f(record, aliasOf(record));
+            }
+        });
+        for (const auto& retained : m_retained) {
+            if (retained.removedGeneration > generation && retained.createdGeneration <= generation &&
+                !isExpired(retained.record, nowMs)) {
+                f(retained.record, std::string_view(retained.alias));
+            }
+        }
+    }
+
+    // Retire up to maxSteps slots' worth of expired records
+    void expire(int64_t nowMs, size_t maxSteps);
+
+    // Retire every expired record from the least recently changed end of the journal, so
+    // changesSince() reports them; O(expired). Stops at the first live record, which only
+    // lets a record restore() left out of order wait for the expiry hand.
+    void expireStale(int64_t nowMs);
+
+    void clear();
+
+    size_t size() const { return m_index.size(); }
+    int64_t ttlMs() const { return m_ttlMs; }
+    size_t maxRecords() const { return m_maxRecords; }
+    size_t memoryUsage() const;
+    uint64_t evictedCount() const { return m_evicted; }
+    uint64_t expiredCount() const { return m_expired; }
+
+    // Number of records that fit in maxMemoryBytes, inline alias text included
+    static size_t recordsForBudget(size_t maxMemoryBytes);
+
+private:
+    bool isExpired(const EncounterRecord& record, int64_t nowMs) const {
+        return m_ttlMs > 0 && nowMs - record.lastSeenMs >= m_ttlMs;
+    }
+
+    void rebuild();
+    void setAlias(uint32_t slot, std::string_view alias);
+    uint32_t allocateSlot(int64_t nowMs);
+    uint32_t evictWithClock(int64_t nowMs);
+    void release(uint32_t slot);
+    void markChanged(uint32_t slot);
+    void touch(uint32_t slot);
+    void unlink(uint32_t slot);
+    void noteRemoval(const DeviceId& id);
+    void resizeRemovalHistory(size_t capacity);
+    void retain(const EncounterRecord& record, std::string_view alias);
+    void noteCreated(const DeviceId& id);
+
+    struct Removal {
+        uint64_t generation;
+        DeviceId id;
+    };
+
+    struct Retained {
+        EncounterRecord record;
+        std::string alias;
+        uint64_t removedGeneration;
+        uint64_t createdGeneration;    // 0 unless created while retaining
+    };
+
+    struct InlineAlias {
+        uint8_t length;
+        char text[kMaxInlineAliasLength];
+    };
+
+    std::vector<EncounterRecord> m_records;
+    std::vector<uint32_t> m_freeSlots;
+    std::vector<uint32_t> m_changed;   // Slots with the dirty bit set
+    std::vector<Removal> m_removed;    // Ring of recent removals
+    size_t m_removedHead;               // Oldest entry
+    size_t m_removedCount;
+    DeviceIdMap<uint32_t> m_index;
+    DeviceIdMap<std::string> m_aliases;           // Without a budget
+    std::vector<InlineAlias> m_inlineAliases;     // With a budget, per slot
+    std::vector<Retained> m_retained;             // While retaining, outside the budget
+    DeviceIdMap<uint64_t> m_created;              // Generation of records created while retaining
+    size_t m_retainers;
+    int64_t m_ttlMs;
+    size_t m_budgetBytes;       // 0 = unbounded
+    size_t m_maxRecords;        // 0 = unbounded
+    size_t m_clockHand;
+    size_t m_expiryHand;
+    uint64_t m_evicted;
+    uint64_t m_expired;
+    uint64_t m_generation;
+    uint64_t m_historyStart;    // changesSince() is complete for generations >= this
+    uint32_t m_newest;          // Journal ends
+    uint32_t m_oldest;
+    bool m_trackChanges;
+};
+
+} // namespace PassBy
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <PassBy/DeviceId.h>
+#include <PassBy/PassByTypes.h>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace PassBy {
+
+// One platform call into a PassByManager, as captured in an event trace
+enum class TraceEventType : uint8_t {
+    DeviceDiscovered = 1,           // text
+    DeviceIdDiscovered,             // id
+    ServiceDeviceDiscovered,        // text, service, rssi
+    PeripheralDiscovered,           // id (peripheral handle), rssi
+    PeripheralAdvertisement,        // id, rssi, data
+    PeripheralIdentifierRead,       // id, text
+    PeripheralConnectionFailed,     // id
+    AdvertisingStarted,             // text, success, detail (error message)
+    StageLatency,                   // stage, value (microseconds)
+    RssiDeviceIdDiscovered,         // id, rssi (values are stored, so new types go last)
+    ServiceDeviceIdDiscovered       // id, service, rssi
+};
+
+// Only the fields listed for the type are meaningful. Views point into the caller's
+// buffers when recording and into the reader's buffer when replaying.
+struct TraceEvent {
+    TraceEventType type;
+    int64_t timeNs = 0;             // Since the trace started
+    DeviceId id;
+    DeviceId service;
+    int32_t rssi = 0;
+    bool success = false;
+    PipelineStage stage = PipelineStage::Advertisement;
+    int64_t value = 0;
+    std::string_view text;
+    std::string_view detail;
+    const uint8_t* data = nullptr;
+    size_t length = 0;
+
+    explicit TraceEvent(TraceEventType eventType = TraceEventType::DeviceDiscovered) : type(eventType) {}
+};
+
+// Trace format: a 32-byte header, then one record per event: type byte, varint
+// nanoseconds since the previous record, then the type's fields (ids as 16 raw bytes,
+// integers as zigzag varints, text and data length-prefixed). Little-endian, so a trace
+// captured on a device replays on any host. A record cut short by a crash ends the trace.
+
+// Appends events to a trace file. Safe to call from any thread: events are stamped
+// and encoded under a mutex, so records are in timestamp order, and written out in
+// large blocks.
+class EventTraceWriter {
+public:
+    EventTraceWriter();
+    ~EventTraceWriter();
+
+    EventTraceWriter(const EventTraceWriter&) = delete;
+    EventTraceWriter& operator=(const EventTraceWriter&) = delete;
+
+    // Create or truncate the trace at path. Returns false on I/O errors.
+    bool open(const std::string& path, int64_t startWallMs);
+
+    // Record event at the current time (event.timeNs is ignored). No-op once closed.
+    void append(const TraceEvent& event);
+
+    // Write out buffered records and close; returns the number of events recorded
+    uint64_t close();
+
+    bool isOpen() const;
+
+private:
+    bool flushLocked();
+
+    mutable std::mutex m_mutex;
+    int m_fd;
+    int64_t m_startNs;
+    int64_t m_lastNs;
+    uint64_t m_events;
+    std::vector<uint8_t> m_buffer;
+};
+
+// Reads a whole trace into memory and iterates its events
+class EventTraceReader {
+public:
+    EventTraceReader();
+
+    // Returns false if the file cannot be read or is not an event trace
+    bool open(const std::string& path);
+
+    // Next event in order; returns false at the end of the trace
+    bool next(TraceEvent& event);
+
+    // Start over from the first event
+    void rewind();
+
+    // Wall clock (ms since the epoch) when recording started
+    int64_t startWallMs() const { return m_startWallMs; }
+
+    // The last record was incomplete (recording was interrupted)
+    bool truncated() const { return m_truncated; }
+
+private:
+    std::vector<uint8_t> m_data;
+    size_t m_offset;
+    int64_t m_timeNs;
+    int64_t m_startWallMs;
+    bool m_truncated;
+};
+
+} // namespace PassBy
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <PassBy/PassByTypes.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace PassBy {
+
+// Lock-free log-linear (HDR-style) histogram of microsecond latencies. Values below 16
+// get a bucket each; above that every power of two is split into 16 buckets, so a
+// bucket's bounds are within 1/16 of each other. record() is a few relaxed atomic
+// adds and may be called from any thread; summary() is consistent once writers stop.
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 4;
+    static constexpr uint64_t kSubBucketCount = uint64_t(1) << kSubBucketBits;
+    static constexpr int kMaxMagnitude = 36;        // Values are clamped to 2^36 us (~19 hours)
+    static constexpr uint64_t kMaxValue = (uint64_t(1) << kMaxMagnitude) - 1;
+    static constexpr size_t kBucketCount = kSubBucketCount * (kMaxMagnitude - kSubBucketBits + 1);
+
+    LatencyHistogram();
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(uint64_t valueUs) {
+        if (valueUs > kMaxValue) {
+            valueUs = kMaxValue;
+        }
+        m_buckets[bucketFor(valueUs)].fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(valueUs, std::memory_order_relaxed);
+        updateMin(valueUs);
+        updateMax(valueUs);
+    }
+
+    LatencySummary summary() const;
+    void reset();
+
+    static size_t bucketFor(uint64_t value) {
+        if (value < kSubBucketCount) {
+            return static_cast<size_t>(value);
+        }
+        int magnitude = 63 - countLeadingZeros(value);
+        int shift = magnitude - kSubBucketBits;
+        uint64_t top = value >> shift;      // In [kSubBucketCount, 2 * kSubBucketCount)
+        return static_cast<size_t>((shift + 1) * kSubBucketCount + (top - kSubBucketCount));
+    }
+
+    // Largest value that lands in bucket
+    static uint64_t bucketUpperBound(size_t bucket) {
+        if (bucket < kSubBucketCount) {
+            return bucket;
+        }
+        int shift = static_cast<int>(bucket / kSubBucketCount) - 1;
+        uint64_t top = kSubBucketCount + bucket % kSubBucketCount;
+        return ((top + 1) << shift) - 1;
+    }
+
+private:
+    static int countLeadingZeros(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_clzll(value);
+#else
+        int count = 0;
+        for (uint64_t bit = uint64_t(1) << 63; !(value & bit); bit >>= 1) {
+            ++count;
+        }
+        return count;
+#endif
+    }
+
+    void updateMin(uint64_t value) {
+        uint64_t current = m_min.load(std::memory_order_relaxed);
+        while (value < current && !m_min.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    void updateMax(uint64_t value) {
+        uint64_t current = m_max.load(std::memory_order_relaxed);
+        while (value > current && !m_max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    std::atomic<uint64_t> m_buckets[kBucketCount];
+    std::atomic<uint64_t> m_sum;
+    std::atomic<uint64_t> m_min;
+    std::atomic<uint64_t> m_max;
+};
+
+} // namespace PassBy
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace PassBy {
+
+// Bounded lock-free multi-producer / single-consumer ring buffer.
+// Each slot carries a sequence number (Vyukov style): producers claim a ticket with
+// one CAS, fill the slot in place and publish it; the single consumer reads slots in
+// ticket order. No allocation after construction, producers never block.
+template <typename T>
+class MPSCRingBuffer {
+public:
+    explicit MPSCRingBuffer(size_t capacity)
+        : m_capacity(roundUpToPowerOfTwo(capacity)), m_mask(m_capacity - 1),
+          m_slots(new Slot[m_capacity]), m_enqueuePos(0), m_dequeuePos(0) {
+        for (size_t i = 0; i < m_capacity; ++i) {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MPSCRingBuffer(const MPSCRingBuffer&) = delete;
+    MPSCRingBuffer& operator=(const MPSCRingBuffer&) = delete;
+
+    // Claim a slot and let `fill(T&)` write into it in place.
+    // Returns false (without calling fill) when the buffer is full.
+    template <typename Fill>
+    bool tryPush(Fill&& fill) {
+        size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &m_slots[pos & m_mask];
+            size_t seq = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // Full
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        fill(slot->value);
+        // seq_cst so a producer's later check of the consumer's sleep flag cannot be
+        // reordered before the publish (see PassByManager's wakeup protocol)
+        slot->sequence.store(pos + 1, std::memory_order_seq_cst);
+        return true;
+    }
+
+    // Consumer only: hand the oldest published element to `consume(T&)`.
+    // Returns false when nothing is ready.
+    template <typename Consume>
+    bool tryConsume(Consume&& consume) {
+        size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        Slot& slot = m_slots[pos & m_mask];
+        size_t seq = slot.sequence.load(std::memory_order_acquire);
+        if (seq != pos + 1) {
+            return false;
+        }
+
+        consume(slot.value);
+        slot.sequence.store(pos + m_capacity, std::memory_order_release);
+        m_dequeuePos.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Whether the next element in order has been published
+    bool hasPending() const {
+        size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        return m_slots[pos & m_mask].sequence.load(std::memory_order_seq_cst) == pos + 1;
+    }
+
+    size_t capacity() const { return m_capacity; }
+
+    // Number of tickets handed out to producers so far
+    uint64_t enqueuePosition() const { return m_enqueuePos.load(std::memory_order_acquire); }
+
+    // Number of elements consumed so far
+    uint64_t dequeuePosition() const { return m_dequeuePos.load(std::memory_order_acquire); }
+
+    // Approximate number of queued elements (exact when quiescent)
+    size_t sizeApprox() const {
+        uint64_t tail = enqueuePosition();
+        uint64_t head = dequeuePosition();
+        return tail > head ? static_cast<size_t>(tail - head) : 0;
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    static size_t roundUpToPowerOfTwo(size_t value) {
+        size_t result = 2;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const size_t m_capacity;
+    const size_t m_mask;
+    std::unique_ptr<Slot[]> m_slots;
+
+    // Producer and consumer cursors live on separate cache lines
+    alignas(64) std::atomic<size_t> m_enqueuePos;
+    alignas(64) std::atomic<size_t> m_dequeuePos;
+};
+
+} // namespace PassBy
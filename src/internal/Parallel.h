@@ -0,0 +1,109 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+namespace PassBy {
+
+// Fork-join helpers for bulk construction work (no pool: threads live for one call)
+
+// Threads to use for `requested` (0: one per core)
+inline size_t threadCount(size_t requested) {
+    return requested > 0 ? requested : std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Run body(begin, end) over contiguous pieces of [0, count) on up to `threads` threads,
+// at least minPerThread items each, the first piece on the calling thread
+template <typename F>
+void parallelFor(size_t count, size_t threads, size_t minPerThread, F&& body) {
+    threads = std::min(threadCount(threads), std::max<size_t>(1, count / std::max<size_t>(minPerThread, 1)));
+    if (threads <= 1) {
+        body(size_t(0), count);
+        return;
+    }
+
+    size_t perThread = (count + threads - 1) / threads;
+    std::vector<std::thread> workers;
+    for (size_t begin = perThread; begin < count; begin += perThread) {
+        workers.emplace_back([&body, begin, end = std::min(count, begin + perThread)] { body(begin, end); });
+    }
+    body(size_t(0), perThread);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+// Sort pieces in parallel, then merge neighbouring runs pairwise, also in parallel
+template <typename RandomIt, typename Less>
+void parallelSort(RandomIt first, RandomIt last, size_t threads, Less less) {
+    constexpr size_t kMinPerThread = 1 << 14;
+    size_t count = static_cast<size_t>(last - first);
+    size_t runs = std::min(threadCount(threads), std::max<size_t>(1, count / kMinPerThread));
+    if (runs <= 1) {
+        std::sort(first, last, less);
+        return;
+    }
+
+    std::vector<RandomIt> bounds;
+    for (size_t i = 0; i <= runs; ++i) {
+        bounds.push_back(first + static_cast<std::ptrdiff_t>(count * i / runs));
+    }
+    parallelFor(runs, runs, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            std::sort(bounds[i], bounds[i + 1], less);
+        }
+    });
+    for (size_t width = 1; width < runs; width *= 2) {
+        size_t merges = (runs + 2 * width - 1) / (2 * width);
+        parallelFor(merges, merges, 1, [&](size_t begin, size_t end) {
+            for (size_t m = begin; m < end; ++m) {
+                size_t left = m * 2 * width;
+                size_t middle = std::min(left + width, runs);
+                size_t right = std::min(left + 2 * width, runs);
+                if (middle < right) {
+                    std::inplace_merge(bounds[left], bounds[middle], bounds[right], less);
+                }
+            }
+        });
+    }
+}
+
+// Replace values with their exclusive prefix sums; returns the total
+template <typename T>
+T parallelExclusiveScan(std::vector<T>& values, size_t threads) {
+    constexpr size_t kMinPerThread = 1 << 16;
+    size_t blocks = std::min(threadCount(threads), std::max<size_t>(1, values.size() / kMinPerThread));
+    size_t perBlock = (values.size() + blocks - 1) / std::max<size_t>(blocks, 1);
+    std::vector<T> sums(blocks, T());
+
+    // Block totals, their offsets, then each block scanned from its offset
+    parallelFor(blocks, blocks, 1, [&](size_t begin, size_t end) {
+        for (size_t b = begin; b < end; ++b) {
+            for (size_t i = b * perBlock; i < std::min(values.size(), (b + 1) * perBlock); ++i) {
+                sums[b] += values[i];
+            }
+        }
+    });
+    T total = T();
+    for (T& sum : sums) {
+        T blockSum = sum;
+        sum = total;
+        total += blockSum;
+    }
+    parallelFor(blocks, blocks, 1, [&](size_t begin, size_t end) {
+        for (size_t b = begin; b < end; ++b) {
+            T running = sums[b];
+            for (size_t i = b * perBlock; i < std::min(values.size(), (b + 1) * perBlock); ++i) {
+                T value = values[i];
+                values[i] = running;
+                running += value;
+            }
+        }
+    });
+    return total;
+}
+
+} // namespace PassBy
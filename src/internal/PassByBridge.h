@@ -1,19 +1,54 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <atomic>
+#include <PassBy/DeviceId.h>
+#include <PassBy/PassByTypes.h>
 
 namespace PassBy {
 
 class PassByManager;
 
-// Bridge class for platform-specific code to communicate with PassByManager
+// Routes events from platform code that is not bound to a context to the default
+// context (PassByManager::getInstance()). Platforms owned by a PassByManager report to
+// it directly through PlatformInterface::manager().
 class PassByBridge {
 public:
     // Set the manager instance to receive callbacks
     static void setManager(PassByManager* manager);
     
-    // Called by platform-specific code when device is discovered
-    static void onDeviceDiscovered(const std::string& uuid);
+    // Called by platform-specific code when device is discovered.
+    // Only queues the event; callbacks run later on the manager's dispatch thread.
+    // The identifier is copied, so it may point into a transient buffer. Does not allocate.
+    static void onDeviceDiscovered(std::string_view uuid);
+    
+    // Same for an identifier already in binary form (e.g. 16 UUID bytes read over GATT)
+    static void onDeviceDiscovered(const DeviceId& id);
+    
+    // Same with the advertised service (if known) and RSSI, for subscription filters
+    static void onDeviceDiscovered(std::string_view uuid, const DeviceId& service, int rssi);
+    static void onDeviceDiscovered(const DeviceId& id, int rssi);
+    static void onDeviceDiscovered(const DeviceId& id, const DeviceId& service, int rssi);
+    
+    // Advertisement from a peripheral that serves the PassByService. The core decides
+    // whether and when to connect, through PlatformInterface::connectPeripheral.
+    // `peripheral` is the platform's handle (e.g. CBPeripheral.identifier).
+    static void onPeripheralDiscovered(const DeviceId& peripheral, int rssi);
+    
+    // Same with the raw advertising data (AD structures). A peer whose advertisement
+    // carries its identifier (see AdvertisementCodec) is discovered right away; others
+    // go to the connection scheduler as above. Does not allocate.
+    static void onPeripheralAdvertisement(const DeviceId& peripheral, int rssi, const uint8_t* data, size_t length);
+    
+    // The connect/read chain for peripheral read its PassBy identifier
+    static void onPeripheralIdentifierRead(const DeviceId& peripheral, std::string_view uuid);
+    
+    // The connect/read chain for peripheral failed or disconnected before reading
+    static void onPeripheralConnectionFailed(const DeviceId& peripheral);
+    
+    // Duration of a connect/read stage measured by the platform (see PipelineStage)
+    static void recordStageLatency(PipelineStage stage, std::chrono::microseconds latency);
     
     // Called by platform-specific code when advertising is started
     static void onAdvertisingStarted(const std::string& peripheralUUID, bool success, const std::string& errorMessage = "");
@@ -22,7 +57,7 @@ public:
     static PassByManager* getManager();
 
 private:
-    static PassByManager* s_manager;
+    static std::atomic<PassByManager*> s_manager;
 };
 
 } // namespace PassBy
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <PassBy/passby_c.h>
+
+namespace PassBy {
+
+class PassByManager;
+class PlatformInterface;
+
+// C context on the given platform (e.g. a SimulatedPlatform) instead of the factory's
+passby_context* createCContext(std::unique_ptr<PlatformInterface> platform, uint32_t ringCapacity);
+
+// The manager behind a C context, for platform glue and tests
+PassByManager& contextManager(passby_context* context);
+
+} // namespace PassBy
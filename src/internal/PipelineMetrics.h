@@ -0,0 +1,103 @@
+#pragma once
+
+#include <PassBy/PassByTypes.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef PASSBY_ENABLE_METRICS
+#include "LatencyHistogram.h"
+#endif
+
+namespace PassBy {
+
+// Counters and per-stage latency histograms of one PassByManager. Every method is
+// lock-free and safe from any thread. Built without PASSBY_ENABLE_METRICS the class is
+// empty and its methods are inline no-ops, so instrumented call sites compile to nothing
+// (now() is constant 0, so not even the clock is read).
+class PipelineMetrics {
+public:
+    enum class Counter {
+        Advertisements,
+        Discoveries,
+        FilteredDiscoveries,
+        DuplicateDiscoveries,
+        ConnectionsStarted,
+        ConnectionFailures,
+        ConnectionTimeouts,
+        Count
+    };
+
+#ifdef PASSBY_ENABLE_METRICS
+    static constexpr bool kEnabled = true;
+
+    // Microseconds on the steady clock
+    static int64_t now() {
+        using namespace std::chrono;
+        return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+    }
+
+    PipelineMetrics() : m_maxQueueDepth(0) {
+        for (auto& counter : m_counters) {
+            counter.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void add(Counter counter, uint64_t count = 1) {
+        m_counters[static_cast<size_t>(counter)].fetch_add(count, std::memory_order_relaxed);
+    }
+
+    void recordLatency(PipelineStage stage, int64_t elapsedUs) {
+        m_latency[static_cast<size_t>(stage)].record(elapsedUs > 0 ? static_cast<uint64_t>(elapsedUs) : 0);
+    }
+
+    // Stage that started at startUs (a now() value) and ended now; startUs 0 means untimed
+    void recordSince(PipelineStage stage, int64_t startUs) {
+        if (startUs != 0) {
+            recordLatency(stage, now() - startUs);
+        }
+    }
+
+    void observeQueueDepth(size_t depth) {
+        size_t current = m_maxQueueDepth.load(std::memory_order_relaxed);
+        while (depth > current && !m_maxQueueDepth.compare_exchange_weak(current, depth, std::memory_order_relaxed)) {
+        }
+    }
+
+    void snapshot(MetricsSnapshot& out) const {
+        out.enabled = true;
+        for (size_t i = 0; i < kPipelineStageCount; ++i) {
+            out.latency[i] = m_latency[i].summary();
+        }
+        out.advertisements = value(Counter::Advertisements);
+        out.discoveries = value(Counter::Discoveries);
+        out.filteredDiscoveries = value(Counter::FilteredDiscoveries);
+        out.duplicateDiscoveries = value(Counter::DuplicateDiscoveries);
+        out.connectionsStarted = value(Counter::ConnectionsStarted);
+        out.connectionFailures = value(Counter::ConnectionFailures);
+        out.connectionTimeouts = value(Counter::ConnectionTimeouts);
+        out.maxQueueDepth = m_maxQueueDepth.load(std::memory_order_relaxed);
+    }
+
+private:
+    uint64_t value(Counter counter) const {
+        return m_counters[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> m_counters[static_cast<size_t>(Counter::Count)];
+    LatencyHistogram m_latency[kPipelineStageCount];
+    std::atomic<size_t> m_maxQueueDepth;
+#else
+    static constexpr bool kEnabled = false;
+
+    static constexpr int64_t now() { return 0; }
+    void add(Counter, uint64_t = 1) {}
+    void recordLatency(PipelineStage, int64_t) {}
+    void recordSince(PipelineStage, int64_t) {}
+    void observeQueueDepth(size_t) {}
+    void snapshot(MetricsSnapshot&) const {}
+#endif
+};
+
+} // namespace PassBy
@@ -1,13 +1,24 @@
 #pragma once
 
 #include "PlatformInterface.h"
+#include <functional>
 #include <memory>
 
 namespace PassBy {
 
 class PlatformFactory {
 public:
+    using Creator = std::function<std::unique_ptr<PlatformInterface>()>;
+    
+    // Create the platform for a new manager (the override if one is set)
     static std::unique_ptr<PlatformInterface> createPlatform();
+    
+    // Create platforms with `creator` from now on, e.g. a SimulatedPlatform; nullptr restores the default
+    static void setPlatformCreator(Creator creator);
+
+private:
+    // Build target's native platform, defined per platform
+    static std::unique_ptr<PlatformInterface> createDefaultPlatform();
 };
 
-} // namespace PassBy
\ No newline at end of file
+} // namespace PassBy
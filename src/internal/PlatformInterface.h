@@ -1,10 +1,16 @@
 #pragma once
 
 #include <string>
+#include <PassBy/DeviceId.h>
 
 namespace PassBy {
 
-// Abstract interface for platform-specific BLE operations
+class PassByManager;
+
+// Abstract interface for platform-specific BLE operations.
+// startBLE/stopBLE are called from the thread that starts or stops scanning and, when a
+// duty cycle is configured, from the manager's dispatch thread; implementations must be
+// safe to call from any thread.
 class PlatformInterface {
 public:
     virtual ~PlatformInterface() = default;
@@ -17,6 +23,23 @@ public:
     
     // Check if BLE is active
     virtual bool isBLEActive() const = 0;
+    
+    // Start the connect/read chain for a peripheral reported through
+    // PassByBridge::onPeripheralDiscovered. The outcome is reported through
+    // onPeripheralIdentifierRead or onPeripheralConnectionFailed. Called from the
+    // manager's dispatch thread; return false if the chain cannot be started.
+    virtual bool connectPeripheral(const DeviceId& /*peripheral*/) { return false; }
+    
+    // Abort a chain started by connectPeripheral (timed out, or scanning stopped)
+    virtual void cancelPeripheral(const DeviceId& /*peripheral*/) {}
+    
+    // Context this platform reports its events to. Set by the owning PassByManager
+    // before any other call; the platform is destroyed before the manager.
+    void attach(PassByManager* manager) { m_manager = manager; }
+    PassByManager* manager() const { return m_manager; }
+
+private:
+    PassByManager* m_manager = nullptr;
 };
 
 } // namespace PassBy
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <PassBy/DeviceId.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace PassBy {
+
+// "Probably seen in the last N slices" over a ring of Bloom filters, one per time slice
+// (e.g. a day). Inserts go to the current slice; a lookup checks every slice still in
+// the window. A slice leaving the window is cleared when its slot is reused, so memory is
+// fixed at construction however many identifiers are seen. Each slice is sized for
+// `capacity` distinct identifiers at falsePositiveRate / slices, so a lookup over the whole
+// window stays at about falsePositiveRate; past capacity the rate rises, memory does not.
+// Time is passed in by the caller. Not thread-safe (used by the dispatch thread).
+class RecentlySeenFilter {
+public:
+    RecentlySeenFilter(size_t slices, int64_t sliceMs, size_t capacity, double falsePositiveRate);
+
+    RecentlySeenFilter(const RecentlySeenFilter&) = delete;
+    RecentlySeenFilter& operator=(const RecentlySeenFilter&) = delete;
+
+    // True if id was probably seen in the window ending at nowMs; records the sighting either way
+    bool testAndInsert(const DeviceId& id, int64_t nowMs);
+
+    // Lookup without recording
+    bool contains(const DeviceId& id, int64_t nowMs) const;
+
+    void insert(const DeviceId& id, int64_t nowMs);
+
+    void clear();
+
+    size_t sliceCount() const { return m_slices.size(); }
+    size_t bitsPerSlice() const { return m_bits; }
+    size_t hashCount() const { return m_hashes; }
+    size_t memoryUsage() const;
+
+private:
+    struct Slice {
+        int64_t epoch = -1;     // nowMs / sliceMs it holds; -1 when empty
+        std::vector<uint64_t> words;
+    };
+
+    // Bit positions by double hashing: h1 + i * h2
+    struct Probe {
+        uint64_t h1;
+        uint64_t h2;
+    };
+
+    int64_t epochOf(int64_t nowMs) const;
+    Probe probe(const DeviceId& id) const;
+    bool sliceContains(const Slice& slice, const Probe& probe) const;
+    bool inWindow(const Slice& slice, int64_t epoch) const;
+    Slice& sliceFor(int64_t epoch);
+
+    std::vector<Slice> m_slices;
+    int64_t m_sliceMs;
+    int64_t m_latestEpoch;
+    size_t m_bits;
+    size_t m_hashes;
+};
+
+} // namespace PassBy
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <PassBy/DeviceId.h>
+#include "DeviceIdTable.h"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace PassBy {
+
+// Identifiers already read from peripherals, keyed by the platform's peripheral handle,
+// so a peer that advertises again is reported without another connect/read chain.
+// Entries expire after ttlMs; when maxEntries is reached a CLOCK hand picks the victim
+// (expired first, then not hit since the last sweep). Owned by the dispatch thread;
+// times are steady ms.
+class ResolvedPeripheralCache {
+public:
+    static constexpr size_t kMaxIdentifierLength = 63;
+
+    struct Entry {
+        DeviceId peripheral;
+        DeviceId id;
+        int64_t resolvedMs;
+        bool occupied;
+        bool referenced;    // CLOCK reference bit
+        bool canonical;     // Identifier is a UUID; otherwise its text is kept
+        uint8_t textLength;
+        char text[kMaxIdentifierLength];
+
+        std::string_view identifierView() const { return std::string_view(text, textLength); }
+    };
+
+    ResolvedPeripheralCache();
+
+    // ttlMs == 0 or maxEntries == 0 disables the cache. Shrinking drops entries.
+    void configure(int64_t ttlMs, size_t maxEntries);
+
+    bool enabled() const { return m_ttlMs > 0 && m_maxEntries > 0; }
+
+    // Remember what peripheral resolved to. `text` is the identifier for non-canonical ids.
+    void insert(const DeviceId& peripheral, const DeviceId& id, bool canonical, std::string_view text,
+                int64_t nowMs);
+
+    // Fresh entry for peripheral, nullptr on a miss. Counts hits and misses.
+    const Entry* lookup(const DeviceId& peripheral, int64_t nowMs);
+
+    void erase(const DeviceId& peripheral);
+    void clear();
+
+    size_t size() const { return m_index.size(); }
+    uint64_t hitCount() const { return m_hits; }
+    uint64_t missCount() const { return m_misses; }
+
+private:
+    bool isExpired(const Entry& entry, int64_t nowMs) const {
+        return nowMs - entry.resolvedMs >= m_ttlMs;
+    }
+
+    uint32_t allocateSlot(int64_t nowMs);
+    void release(uint32_t slot);
+
+    std::vector<Entry> m_entries;
+    std::vector<uint32_t> m_freeSlots;
+    DeviceIdMap<uint32_t> m_index;
+    int64_t m_ttlMs;
+    size_t m_maxEntries;
+    size_t m_clockHand;
+    uint64_t m_hits;
+    uint64_t m_misses;
+};
+
+} // namespace PassBy
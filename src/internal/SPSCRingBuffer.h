@@ -0,0 +1,101 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace PassBy {
+
+// Bounded lock-free single-producer / single-consumer ring buffer of trivially copyable
+// records. Elements sit in one contiguous array, so the consumer can read a run of them
+// in place (peek) and hand the slots back afterwards (release). No allocation after
+// construction; neither side ever blocks.
+template <typename T>
+class SPSCRingBuffer {
+public:
+    explicit SPSCRingBuffer(size_t capacity)
+        : m_capacity(roundUpToPowerOfTwo(capacity)), m_mask(m_capacity - 1), m_slots(new T[m_capacity]),
+          m_writePos(0), m_cachedReadPos(0), m_readPos(0), m_cachedWritePos(0) {}
+
+    SPSCRingBuffer(const SPSCRingBuffer&) = delete;
+    SPSCRingBuffer& operator=(const SPSCRingBuffer&) = delete;
+
+    // Producer only: let `fill(T&)` write the next slot in place.
+    // Returns false (without calling fill) when the buffer is full.
+    template <typename Fill>
+    bool tryPush(Fill&& fill) {
+        size_t pos = m_writePos.load(std::memory_order_relaxed);
+        if (pos - m_cachedReadPos == m_capacity) {
+            m_cachedReadPos = m_readPos.load(std::memory_order_acquire);
+            if (pos - m_cachedReadPos == m_capacity) {
+                return false; // Full
+            }
+        }
+        fill(m_slots[pos & m_mask]);
+        m_writePos.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only: the oldest published elements that are contiguous in memory (up to
+    // the end of the array); returns their number. They stay valid until release().
+    size_t peek(const T** first) {
+        size_t pos = m_readPos.load(std::memory_order_relaxed);
+        if (m_cachedWritePos == pos) {
+            m_cachedWritePos = m_writePos.load(std::memory_order_acquire);
+        }
+        *first = &m_slots[pos & m_mask];
+        return std::min(m_cachedWritePos - pos, m_capacity - (pos & m_mask));
+    }
+
+    // Consumer only: hand back the first count elements of the last peek
+    void release(size_t count) {
+        m_readPos.store(m_readPos.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+    // Consumer only: copy out up to max elements, across the wrap; returns the number copied
+    size_t pop(T* out, size_t max) {
+        size_t copied = 0;
+        while (copied < max) {
+            const T* first;
+            size_t count = std::min(peek(&first), max - copied);
+            if (count == 0) {
+                break;
+            }
+            std::copy(first, first + count, out + copied);
+            release(count);
+            copied += count;
+        }
+        return copied;
+    }
+
+    size_t capacity() const { return m_capacity; }
+
+    // Approximate number of queued elements (exact when quiescent)
+    size_t sizeApprox() const {
+        size_t head = m_readPos.load(std::memory_order_acquire);
+        size_t tail = m_writePos.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+private:
+    static size_t roundUpToPowerOfTwo(size_t value) {
+        size_t result = 2;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const size_t m_capacity;
+    const size_t m_mask;
+    std::unique_ptr<T[]> m_slots;
+
+    // Each side's cursor, with its last view of the other side's, on its own cache line
+    alignas(64) std::atomic<size_t> m_writePos;
+    size_t m_cachedReadPos;
+    alignas(64) std::atomic<size_t> m_readPos;
+    size_t m_cachedWritePos;
+};
+
+} // namespace PassBy
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace PassBy {
+
+// SHA-256 (FIPS 180-4), incremental
+class Sha256 {
+public:
+    static constexpr size_t kDigestSize = 32;
+    static constexpr size_t kBlockSize = 64;
+
+    Sha256();
+
+    void update(const void* data, size_t length);
+
+    // Writes the digest; the object must not be updated afterwards
+    void finish(uint8_t out[kDigestSize]);
+
+private:
+    void compress(const uint8_t block[kBlockSize]);
+
+    uint32_t m_state[8];
+    uint8_t m_block[kBlockSize];
+    size_t m_blockLength;
+    uint64_t m_totalLength;
+};
+
+// HMAC-SHA256 (RFC 2104) of the concatenation of data and data2 (data2 may be null)
+void hmacSha256(const uint8_t* key, size_t keyLength, const void* data, size_t length, const void* data2,
+                size_t length2, uint8_t out[Sha256::kDigestSize]);
+
+} // namespace PassBy
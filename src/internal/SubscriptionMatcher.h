@@ -0,0 +1,136 @@
+#pragma once
+
+#include <PassBy/DeviceId.h>
+#include "DeviceIdTable.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace PassBy {
+
+// Subscription filters compiled into lookup tables, so matching a discovery costs
+// one hash lookup for its service and one per distinct prefix length, however many
+// subscriptions there are. Built whenever subscriptions change; match() is for one
+// thread at a time (the dispatch thread) since it keeps scratch state.
+class SubscriptionMatcher {
+public:
+    // RSSI of events the platform reported without one (the HCI "not available" value)
+    static constexpr int kUnknownRssi = 127;
+    static constexpr int kAnyRssi = -128;
+
+    struct Filter {
+        std::vector<DeviceId> services;
+        std::vector<std::string> prefixes;
+        int minRssi = kAnyRssi;
+    };
+
+    SubscriptionMatcher() : SubscriptionMatcher(std::vector<Filter>(), false) {}
+
+    // `scanFiltered`: the platform only reports devices advertising a service some filter
+    // asks for, so events without a service satisfy service criteria. Without it they
+    // only match filters that have none.
+    SubscriptionMatcher(std::vector<Filter> filters, bool scanFiltered);
+
+    SubscriptionMatcher(const SubscriptionMatcher&) = delete;
+    SubscriptionMatcher& operator=(const SubscriptionMatcher&) = delete;
+
+    size_t size() const { return m_filters.size(); }
+    bool empty() const { return m_filters.empty(); }
+
+    // Call visit(index) once for every filter the discovery matches, in no particular order.
+    // `service` is nullptr when unknown. Does not allocate.
+    template <typename F>
+    void match(const DeviceId* service, int rssi, std::string_view identifier, F&& visit) const;
+
+private:
+    static constexpr uint8_t kNeedsService = 0x01;
+    static constexpr uint8_t kNeedsPrefix = 0x02;
+    static constexpr uint8_t kVisited = 0x80;
+
+    // Slice of m_indices
+    struct Range {
+        uint32_t begin = 0;
+        uint32_t count = 0;
+    };
+
+    bool rssiPasses(size_t index, int rssi) const {
+        int minRssi = m_filters[index].minRssi;
+        return minRssi == kAnyRssi || (rssi != kUnknownRssi && rssi >= minRssi);
+    }
+
+    std::vector<Filter> m_filters;
+    std::vector<uint8_t> m_needs;
+    bool m_scanFiltered;
+
+    std::vector<uint32_t> m_indices;                // Filter indices, sliced by the tables
+    std::vector<uint32_t> m_unfiltered;             // No service or prefix criterion
+    std::vector<uint32_t> m_withoutPrefix;          // No prefix criterion
+    DeviceIdMap<Range> m_services;
+    std::unordered_map<std::string_view, Range> m_prefixes;     // Views into m_filters
+    std::vector<size_t> m_prefixLengths;            // Distinct, ascending
+
+    // Scratch for match(): criteria met per filter, valid where m_epochs matches
+    mutable std::vector<uint8_t> m_hits;
+    mutable std::vector<uint32_t> m_epochs;
+    mutable uint32_t m_epoch;
+};
+
+template <typename F>
+void SubscriptionMatcher::match(const DeviceId* service, int rssi, std::string_view identifier, F&& visit) const {
+    if (m_filters.empty()) {
+        return;
+    }
+    if (++m_epoch == 0) {
+        std::fill(m_epochs.begin(), m_epochs.end(), 0);
+        m_epoch = 1;
+    }
+
+    // Criteria this event can satisfy without a table hit
+    uint8_t implied = (!service && m_scanFiltered) ? kNeedsService : 0;
+    auto mark = [&](uint32_t index, uint8_t met) {
+        if (m_epochs[index] != m_epoch) {
+            m_epochs[index] = m_epoch;
+            m_hits[index] = implied;
+        }
+        uint8_t& hits = m_hits[index];
+        if (hits & kVisited) {
+            return;
+        }
+        hits |= met;
+        if ((hits & m_needs[index]) == m_needs[index]) {
+            hits |= kVisited;
+            if (rssiPasses(index, rssi)) {
+                visit(static_cast<size_t>(index));
+            }
+        }
+    };
+
+    for (uint32_t index : implied ? m_withoutPrefix : m_unfiltered) {
+        mark(index, 0);
+    }
+    if (service) {
+        if (const Range* range = m_services.find(*service)) {
+            for (uint32_t i = 0; i < range->count; ++i) {
+                mark(m_indices[range->begin + i], kNeedsService);
+            }
+        }
+    }
+    for (size_t length : m_prefixLengths) {
+        if (length > identifier.size()) {
+            break;
+        }
+        auto it = m_prefixes.find(identifier.substr(0, length));
+        if (it == m_prefixes.end()) {
+            continue;
+        }
+        for (uint32_t i = 0; i < it->second.count; ++i) {
+            mark(m_indices[it->second.begin + i], kNeedsPrefix);
+        }
+    }
+}
+
+} // namespace PassBy
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "EventTrace.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace PassBy {
+
+class PassByManager;
+
+struct ReplayOptions {
+    // Multiplier on the recorded pace (2.0 replays twice as fast); 0 replays as fast as possible
+    double speed = 1.0;
+    
+    // Unpaced replays wait for the dispatch thread every this many events, so the event
+    // queue does not overflow (0: never wait, to see what an overload drops)
+    size_t drainInterval = 1024;
+};
+
+struct ReplayStats {
+    uint64_t events = 0;
+    std::chrono::nanoseconds traceDuration{0};     // Time covered by the replayed events
+    std::chrono::nanoseconds elapsed{0};           // Time the replay took
+    bool truncated = false;                         // The trace ended in an incomplete record
+};
+
+// Feeds a recorded trace into a PassByManager through the calls it was recorded from,
+// on the calling thread. Replay into a context without a radio (constructed with a null
+// platform) to reproduce a field capture: recorded connect/read results are replayed, so
+// the scheduler's own connection attempts simply fail.
+class TraceReplayer {
+public:
+    // Replay the remaining events of reader. Does not wait for the dispatch thread;
+    // call manager.flushEvents() before inspecting the result.
+    static ReplayStats replay(EventTraceReader& reader, PassByManager& manager,
+                              const ReplayOptions& options = ReplayOptions());
+
+    // Issue the manager call event was recorded from
+    static void deliver(const TraceEvent& event, PassByManager& manager);
+};
+
+} // namespace PassBy
@@ -3,7 +3,7 @@
 
 namespace PassBy {
 
-std::unique_ptr<PlatformInterface> PlatformFactory::createPlatform() {
+std::unique_ptr<PlatformInterface> PlatformFactory::createDefaultPlatform() {
     return std::make_unique<iOSPlatform>();
 }
 
@@ -0,0 +1,89 @@
+#include "SimulatedPlatform.h"
+#include "../../internal/PlatformFactory.h"
+#include "PassBy/PassBy.h"
+
+namespace PassBy {
+
+SimulatedPlatform::SimulatedPlatform(std::shared_ptr<VirtualRadio> radio, const std::string& localIdentifier)
+    : m_radio(std::move(radio)), m_localIdentifier(localIdentifier), m_isActive(false) {
+    // The radio only reports while scanning, i.e. after attach(); like the iOS delegate,
+    // the handlers drop what arrives with no manager attached
+    m_radio->setDiscoveryHandler([this](const VirtualPeer& peer) {
+        if (!manager()) {
+            return;
+        }
+        DeviceId service;
+        if (DeviceId::parse(peer.serviceUUID, service)) {
+            manager()->onDeviceDiscovered(peer.identifier, service, peer.rssi);
+        } else {
+            manager()->onDeviceDiscovered(peer.identifier);
+        }
+    });
+
+    ScheduledHandlers scheduled;
+    scheduled.advertisement = [this](const DeviceId& peripheral, int rssi, const uint8_t* data, size_t length) {
+        if (manager()) {
+            manager()->onPeripheralAdvertisement(peripheral, rssi, data, length);
+        }
+    };
+    scheduled.identifierRead = [this](const DeviceId& peripheral, const VirtualPeer& peer) {
+        if (manager()) {
+            manager()->onPeripheralIdentifierRead(peripheral, peer.identifier);
+        }
+    };
+    scheduled.connectionFailed = [this](const DeviceId& peripheral) {
+        if (manager()) {
+            manager()->onPeripheralConnectionFailed(peripheral);
+        }
+    };
+    m_radio->setScheduledHandlers(std::move(scheduled));
+}
+
+SimulatedPlatform::~SimulatedPlatform() {
+    m_radio->setScanning(false);
+    m_radio->setDiscoveryHandler(nullptr);
+    m_radio->setScheduledHandlers(ScheduledHandlers());
+}
+
+bool SimulatedPlatform::startBLE(const std::string& serviceUUID) {
+    if (m_isActive.exchange(true)) {
+        return false;
+    }
+    m_radio->setScanning(true, serviceUUID);
+    if (manager()) {
+        manager()->onAdvertisingStarted(m_localIdentifier, true);
+    }
+    return true;
+}
+
+bool SimulatedPlatform::stopBLE() {
+    if (!m_isActive.exchange(false)) {
+        return false;
+    }
+    m_radio->setScanning(false);
+    return true;
+}
+
+bool SimulatedPlatform::isBLEActive() const {
+    return m_isActive;
+}
+
+bool SimulatedPlatform::connectPeripheral(const DeviceId& peripheral) {
+    return m_radio->connect(peripheral);
+}
+
+void SimulatedPlatform::cancelPeripheral(const DeviceId& peripheral) {
+    m_radio->cancel(peripheral);
+}
+
+void SimulatedPlatform::install(std::shared_ptr<VirtualRadio> radio) {
+    if (!radio) {
+        PlatformFactory::setPlatformCreator(nullptr);
+        return;
+    }
+    PlatformFactory::setPlatformCreator([radio]() -> std::unique_ptr<PlatformInterface> {
+        return std::make_unique<SimulatedPlatform>(radio);
+    });
+}
+
+} // namespace PassBy
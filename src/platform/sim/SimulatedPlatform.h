@@ -0,0 +1,34 @@
+#pragma once
+
+#include "../../internal/PlatformInterface.h"
+#include "VirtualRadio.h"
+#include <atomic>
+#include <memory>
+
+namespace PassBy {
+
+// PlatformInterface backed by a VirtualRadio instead of a BLE stack.
+// Identifiers read from virtual peers are reported to the owning PassByManager like on a
+// device; in the radio's Scheduled mode advertisements and connection results are too.
+// Give each context its own VirtualRadio: a radio reports to the last platform created on it.
+class SimulatedPlatform : public PlatformInterface {
+public:
+    explicit SimulatedPlatform(std::shared_ptr<VirtualRadio> radio, const std::string& localIdentifier = "");
+    ~SimulatedPlatform() override;
+
+    bool startBLE(const std::string& serviceUUID = "") override;
+    bool stopBLE() override;
+    bool isBLEActive() const override;
+    bool connectPeripheral(const DeviceId& peripheral) override;
+    void cancelPeripheral(const DeviceId& peripheral) override;
+
+    // Make PlatformFactory create SimulatedPlatforms on `radio` (nullptr restores the default)
+    static void install(std::shared_ptr<VirtualRadio> radio);
+
+private:
+    std::shared_ptr<VirtualRadio> m_radio;
+    std::string m_localIdentifier;
+    std::atomic<bool> m_isActive;     // Switched from the manager's threads, see PlatformInterface
+};
+
+} // namespace PassBy
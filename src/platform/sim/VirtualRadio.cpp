@@ -0,0 +1,350 @@
+#include "VirtualRadio.h"
+#include <PassBy/DeviceId.h>
+#include "../../internal/AdvertisementCodec.h"
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+namespace PassBy {
+
+// Advertising events get 0-10 ms of random delay, as in BLE
+static constexpr int64_t kAdvertisingJitterMs = 10;
+
+// Per-advertisement RSSI noise, +/- dB
+static constexpr int kRssiNoiseDb = 4;
+
+// Leading bytes of peripheral handles handed out by a VirtualRadio
+static constexpr uint8_t kHandleMarker[4] = {'S', 'I', 'M', 'P'};
+
+static constexpr int64_t kNever = std::numeric_limits<int64_t>::max();
+
+VirtualRadio::VirtualRadio(uint64_t seed, size_t workerThreads)
+    : m_seed(seed), m_crowdRng(seed ^ 0xC0FFEE), m_workerThreads(std::max<size_t>(workerThreads, 1)),
+      m_nowMs(0), m_scanning(false), m_mode(ConnectionMode::Autonomous) {}
+
+uint64_t VirtualRadio::nextRandom(uint64_t& state) {
+    // splitmix64
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+double VirtualRadio::nextUnit(uint64_t& state) {
+    return static_cast<double>(nextRandom(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+void VirtualRadio::setConditions(const RadioConditions& conditions) {
+    m_conditions = conditions;
+}
+
+size_t VirtualRadio::addPeer(const VirtualPeer& peer) {
+    PeerState state;
+    state.peer = peer;
+    state.rngState = m_seed ^ (0xA24BAED4963EE407ULL * (m_peers.size() + 1));
+    state.peer.advertisingIntervalMs = std::max<int64_t>(peer.advertisingIntervalMs, 1);
+    // Random phase so peers arriving together do not advertise in lockstep
+    state.nextAdvertisementMs = peer.arriveMs +
+        static_cast<int64_t>(nextRandom(state.rngState) % static_cast<uint64_t>(state.peer.advertisingIntervalMs));
+    state.busyUntilMs = 0;
+    state.advertisementLength = static_cast<uint8_t>(buildAdvertisement(state.peer, state.advertisement));
+    m_peers.push_back(std::move(state));
+    return m_peers.size() - 1;
+}
+
+void VirtualRadio::addCrowd(size_t count, int64_t arriveMs, int64_t leaveMs, int64_t advertisingIntervalMs,
+                            const std::string& serviceUUID, bool advertisesIdentifier) {
+    m_peers.reserve(m_peers.size() + count);
+    for (size_t i = 0; i < count; ++i) {
+        uint8_t bytes[DeviceId::kSize];
+        uint64_t high = nextRandom(m_crowdRng);
+        uint64_t low = nextRandom(m_crowdRng);
+        for (int b = 0; b < 8; ++b) {
+            bytes[b] = static_cast<uint8_t>(high >> (8 * b));
+            bytes[8 + b] = static_cast<uint8_t>(low >> (8 * b));
+        }
+        VirtualPeer peer;
+        peer.identifier = DeviceId::fromBytes(bytes).toString();
+        peer.serviceUUID = serviceUUID;
+        peer.arriveMs = arriveMs;
+        peer.leaveMs = leaveMs;
+        peer.advertisingIntervalMs = advertisingIntervalMs;
+        peer.advertisesIdentifier = advertisesIdentifier;
+        addPeer(peer);
+    }
+}
+
+size_t VirtualRadio::buildAdvertisement(const VirtualPeer& peer, uint8_t* out) {
+    // Flags: LE general discoverable, BR/EDR not supported
+    size_t length = 0;
+    out[length++] = 2;
+    out[length++] = 0x01;
+    out[length++] = 0x06;
+
+    DeviceId id;
+    if (peer.advertisesIdentifier && DeviceId::parse(peer.identifier, id)) {
+        return length + AdvertisementCodec::encodeManufacturerStructure(
+            id, AdvertisementCodec::kFlagGattIdentifier, out + length, kMaxAdvertisementSize - length);
+    }
+
+    // Complete list of 128-bit service UUIDs, little-endian
+    DeviceId service;
+    if (DeviceId::parse(peer.serviceUUID, service)) {
+        out[length++] = 1 + DeviceId::kSize;
+        out[length++] = 0x07;
+        for (size_t i = 0; i < DeviceId::kSize; ++i) {
+            out[length++] = service.bytes()[DeviceId::kSize - 1 - i];
+        }
+    }
+    return length;
+}
+
+void VirtualRadio::setDiscoveryHandler(DiscoveryHandler handler) {
+    std::lock_guard<std::mutex> lock(m_handlerMutex);
+    m_handler = std::move(handler);
+}
+
+void VirtualRadio::setScheduledHandlers(ScheduledHandlers handlers) {
+    std::lock_guard<std::mutex> lock(m_handlerMutex);
+    m_scheduledHandlers = std::move(handlers);
+}
+
+DeviceId VirtualRadio::peripheralHandle(size_t index) {
+    uint8_t bytes[DeviceId::kSize] = {};
+    std::memcpy(bytes, kHandleMarker, sizeof(kHandleMarker));
+    for (int b = 0; b < 8; ++b) {
+        bytes[15 - b] = static_cast<uint8_t>(static_cast<uint64_t>(index) >> (8 * b));
+    }
+    return DeviceId::fromBytes(bytes);
+}
+
+bool VirtualRadio::peerIndexFor(const DeviceId& peripheral, size_t& index) const {
+    const uint8_t* bytes = peripheral.bytes();
+    if (std::memcmp(bytes, kHandleMarker, sizeof(kHandleMarker)) != 0) {
+        return false;
+    }
+    uint64_t value = 0;
+    for (int b = 8; b < 16; ++b) {
+        value = (value << 8) | bytes[b];
+    }
+    if (value >= m_peers.size()) {
+        return false;
+    }
+    index = static_cast<size_t>(value);
+    return true;
+}
+
+bool VirtualRadio::connect(const DeviceId& peripheral) {
+    size_t index;
+    if (m_mode != ConnectionMode::Scheduled || !peerIndexFor(peripheral, index)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_requestMutex);
+    m_connectRequests.push_back(index);
+    return true;
+}
+
+void VirtualRadio::cancel(const DeviceId& peripheral) {
+    size_t index;
+    if (!peerIndexFor(peripheral, index)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_requestMutex);
+    m_cancelRequests.push_back(index);
+}
+
+void VirtualRadio::setScanning(bool scanning, const std::string& serviceFilter) {
+    std::lock_guard<std::mutex> lock(m_scanMutex);
+    m_serviceFilter = serviceFilter;
+    m_scanning.store(scanning);
+}
+
+void VirtualRadio::advance(int64_t durationMs) {
+    runUntil(m_nowMs + durationMs);
+}
+
+void VirtualRadio::runUntil(int64_t timeMs) {
+    if (timeMs <= m_nowMs) {
+        return;
+    }
+
+    DiscoveryHandler handler;
+    ScheduledHandlers scheduled;
+    {
+        std::lock_guard<std::mutex> lock(m_handlerMutex);
+        handler = m_handler;
+        scheduled = m_scheduledHandlers;
+    }
+    // The owning context switches the scanner from its own threads (e.g. the duty cycle)
+    bool scanning;
+    std::string serviceFilter;
+    {
+        std::lock_guard<std::mutex> lock(m_scanMutex);
+        scanning = m_scanning.load();
+        serviceFilter = m_serviceFilter;
+    }
+    if (m_mode == ConnectionMode::Scheduled) {
+        startRequestedConnections(scheduled);
+    }
+
+    size_t workers = std::min(m_workerThreads, std::max<size_t>(m_peers.size(), 1));
+    size_t perWorker = (m_peers.size() + workers - 1) / workers;
+    std::vector<std::thread> threads;
+    for (size_t w = 1; w < workers; ++w) {
+        size_t begin = std::min(w * perWorker, m_peers.size());
+        size_t end = std::min(begin + perWorker, m_peers.size());
+        threads.emplace_back(&VirtualRadio::runPeers, this, begin, end, timeMs, scanning,
+                             std::cref(serviceFilter), std::cref(handler), std::cref(scheduled));
+    }
+    runPeers(0, std::min(perWorker, m_peers.size()), timeMs, scanning, serviceFilter, handler, scheduled);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (m_mode == ConnectionMode::Scheduled) {
+        completeConnections(timeMs, scheduled);
+    }
+    m_nowMs = timeMs;
+}
+
+void VirtualRadio::startRequestedConnections(const ScheduledHandlers& scheduled) {
+    std::vector<size_t> requests;
+    std::vector<size_t> cancels;
+    {
+        std::lock_guard<std::mutex> lock(m_requestMutex);
+        requests.swap(m_connectRequests);
+        cancels.swap(m_cancelRequests);
+    }
+
+    for (size_t peer : cancels) {
+        auto it = std::find_if(m_connections.begin(), m_connections.end(),
+                               [peer](const Connection& c) { return c.peer == peer; });
+        if (it != m_connections.end()) {
+            m_connections.erase(it);
+            m_counters.connectionsCancelled.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    for (size_t peer : requests) {
+        bool busy = std::any_of(m_connections.begin(), m_connections.end(),
+                                [peer](const Connection& c) { return c.peer == peer; });
+        m_counters.connectionAttempts.fetch_add(1, std::memory_order_relaxed);
+        PeerState& state = m_peers[peer];
+        if (busy || m_nowMs < state.peer.arriveMs || m_nowMs >= state.peer.leaveMs) {
+            m_counters.connectionFailures.fetch_add(1, std::memory_order_relaxed);
+            if (scheduled.connectionFailed) {
+                scheduled.connectionFailed(peripheralHandle(peer));
+            }
+            continue;
+        }
+        int64_t completeMs = m_nowMs + m_conditions.connectDurationMs;
+        if (nextUnit(state.rngState) < m_conditions.connectionStallRate) {
+            completeMs = kNever;
+        }
+        m_connections.push_back(Connection{peer, completeMs});
+    }
+
+    uint64_t concurrent = m_connections.size();
+    if (concurrent > m_counters.maxConcurrentConnections.load()) {
+        m_counters.maxConcurrentConnections.store(concurrent);
+    }
+}
+
+void VirtualRadio::completeConnections(int64_t untilMs, const ScheduledHandlers& scheduled) {
+    // In completion order, ties by peer for determinism
+    std::sort(m_connections.begin(), m_connections.end(), [](const Connection& a, const Connection& b) {
+        return a.completeMs != b.completeMs ? a.completeMs < b.completeMs : a.peer < b.peer;
+    });
+    size_t done = 0;
+    for (; done < m_connections.size() && m_connections[done].completeMs < untilMs; ++done) {
+        const Connection& connection = m_connections[done];
+        PeerState& state = m_peers[connection.peer];
+        bool failed = connection.completeMs >= state.peer.leaveMs ||
+                      nextUnit(state.rngState) < m_conditions.connectionFailureRate;
+        DeviceId handle = peripheralHandle(connection.peer);
+        if (failed) {
+            m_counters.connectionFailures.fetch_add(1, std::memory_order_relaxed);
+            if (scheduled.connectionFailed) {
+                scheduled.connectionFailed(handle);
+            }
+            continue;
+        }
+        m_counters.identifiersReported.fetch_add(1, std::memory_order_relaxed);
+        if (scheduled.identifierRead) {
+            scheduled.identifierRead(handle, state.peer);
+        }
+    }
+    m_connections.erase(m_connections.begin(), m_connections.begin() + done);
+}
+
+void VirtualRadio::runPeers(size_t begin, size_t end, int64_t untilMs, bool scanning,
+                            const std::string& serviceFilter, const DiscoveryHandler& handler,
+                            const ScheduledHandlers& scheduled) {
+    const bool autonomous = m_mode == ConnectionMode::Autonomous;
+    for (size_t i = begin; i < end; ++i) {
+        PeerState& state = m_peers[i];
+        const VirtualPeer& peer = state.peer;
+        bool visible = scanning && (serviceFilter.empty() || serviceFilter == peer.serviceUUID);
+
+        while (state.nextAdvertisementMs < untilMs) {
+            int64_t at = state.nextAdvertisementMs;
+            state.nextAdvertisementMs += peer.advertisingIntervalMs +
+                static_cast<int64_t>(nextRandom(state.rngState) % (kAdvertisingJitterMs + 1));
+            if (at >= peer.leaveMs) {
+                state.nextAdvertisementMs = std::numeric_limits<int64_t>::max();
+                break;
+            }
+            if (!visible || at < m_nowMs) {
+                continue;
+            }
+
+            m_counters.advertisements.fetch_add(1, std::memory_order_relaxed);
+            if (nextUnit(state.rngState) < m_conditions.packetLoss) {
+                m_counters.advertisementsLost.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            // Non-PassBy advertisers have nothing to read
+            if (peer.serviceUUID.empty()) {
+                continue;
+            }
+            if (!autonomous) {
+                int noise = static_cast<int>(nextRandom(state.rngState) % (2 * kRssiNoiseDb + 1)) - kRssiNoiseDb;
+                if (scheduled.advertisement) {
+                    scheduled.advertisement(peripheralHandle(i), peer.rssi + noise, state.advertisement,
+                                            state.advertisementLength);
+                }
+                continue;
+            }
+
+            // Busy peers are still being connected
+            if (at < state.busyUntilMs) {
+                continue;
+            }
+            state.busyUntilMs = at + m_conditions.connectDurationMs;
+            m_counters.connectionAttempts.fetch_add(1, std::memory_order_relaxed);
+            if (nextUnit(state.rngState) < m_conditions.connectionFailureRate) {
+                m_counters.connectionFailures.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            m_counters.identifiersReported.fetch_add(1, std::memory_order_relaxed);
+            if (handler) {
+                handler(peer);
+            }
+        }
+    }
+}
+
+RadioStats VirtualRadio::stats() const {
+    RadioStats stats;
+    stats.advertisements = m_counters.advertisements.load();
+    stats.advertisementsLost = m_counters.advertisementsLost.load();
+    stats.connectionAttempts = m_counters.connectionAttempts.load();
+    stats.connectionFailures = m_counters.connectionFailures.load();
+    stats.identifiersReported = m_counters.identifiersReported.load();
+    stats.connectionsCancelled = m_counters.connectionsCancelled.load();
+    stats.maxConcurrentConnections = m_counters.maxConcurrentConnections.load();
+    return stats;
+}
+
+} // namespace PassBy
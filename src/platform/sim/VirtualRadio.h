@@ -0,0 +1,168 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <PassBy/DeviceId.h>
+
+namespace PassBy {
+
+// A simulated nearby device
+struct VirtualPeer {
+    std::string identifier;             // PassBy identifier served over GATT
+    std::string serviceUUID;            // Advertised service UUID (empty: not a PassBy device)
+    int64_t arriveMs = 0;               // Present during [arriveMs, leaveMs)
+    int64_t leaveMs = std::numeric_limits<int64_t>::max();
+    int64_t advertisingIntervalMs = 100;
+    int rssi = -60;                     // Mean received signal strength, dBm
+    bool advertisesIdentifier = false;  // Scheduled mode: identifier in manufacturer data
+};
+
+// Radio impairments applied to every peer
+struct RadioConditions {
+    double packetLoss = 0.0;            // Probability that an advertisement is missed
+    double connectionFailureRate = 0.0; // Probability that the connect/read chain fails
+    int64_t connectDurationMs = 0;      // Time a connect/read chain keeps the peer busy
+    double connectionStallRate = 0.0;   // Scheduled mode: probability a chain never completes
+};
+
+// Who decides to connect
+enum class ConnectionMode {
+    Autonomous,     // The radio runs a chain on every PassBy advertisement (no limits)
+    Scheduled       // Advertisements are reported; chains run only when connect() asks
+};
+
+// Scheduled mode callbacks, called from the thread running advance()
+// (advertisement also from worker threads)
+struct ScheduledHandlers {
+    // Raw advertising data (AD structures)
+    std::function<void(const DeviceId& peripheral, int rssi, const uint8_t* data, size_t length)> advertisement;
+    std::function<void(const DeviceId& peripheral, const VirtualPeer& peer)> identifierRead;
+    std::function<void(const DeviceId& peripheral)> connectionFailed;
+};
+
+struct RadioStats {
+    uint64_t advertisements = 0;        // Advertisements sent while scanning
+    uint64_t advertisementsLost = 0;
+    uint64_t connectionAttempts = 0;
+    uint64_t connectionFailures = 0;
+    uint64_t identifiersReported = 0;
+    uint64_t connectionsCancelled = 0;
+    uint64_t maxConcurrentConnections = 0;  // Scheduled mode
+};
+
+// Virtual radio medium for SimulatedPlatform.
+// Time is virtual and only moves in advance(); peers are split across worker threads
+// that report discoveries concurrently. Every peer draws from its own random stream
+// seeded from the scenario seed, so the events each peer produces do not depend on
+// the thread count or scheduling. In Scheduled mode connections are driven from
+// outside (the core's ConnectionScheduler) and modelled with their duration, failures,
+// stalls and concurrency.
+class VirtualRadio {
+public:
+    using DiscoveryHandler = std::function<void(const VirtualPeer& peer)>;
+
+    explicit VirtualRadio(uint64_t seed = 1, size_t workerThreads = 1);
+
+    void setConditions(const RadioConditions& conditions);
+
+    // Add one peer, returns its index
+    size_t addPeer(const VirtualPeer& peer);
+
+    // Add `count` peers with random UUID identifiers present during [arriveMs, leaveMs)
+    void addCrowd(size_t count, int64_t arriveMs, int64_t leaveMs, int64_t advertisingIntervalMs,
+                  const std::string& serviceUUID, bool advertisesIdentifier = false);
+
+    // Receives every identifier read; called from worker threads
+    void setDiscoveryHandler(DiscoveryHandler handler);
+
+    void setConnectionMode(ConnectionMode mode) { m_mode = mode; }
+    ConnectionMode connectionMode() const { return m_mode; }
+    void setScheduledHandlers(ScheduledHandlers handlers);
+
+    // Scheduled mode: start or abort the chain for a peripheral handle. Thread-safe;
+    // requests take effect at the start of the next advance().
+    bool connect(const DeviceId& peripheral);
+    void cancel(const DeviceId& peripheral);
+
+    // Platform handle of the peer at index, and back (false if not a handle of this radio)
+    static DeviceId peripheralHandle(size_t index);
+    bool peerIndexFor(const DeviceId& peripheral, size_t& index) const;
+
+    // Scanner state, driven by SimulatedPlatform (empty filter: all peers). Thread-safe;
+    // takes effect at the start of the next advance().
+    void setScanning(bool scanning, const std::string& serviceFilter = "");
+    bool isScanning() const { return m_scanning.load(); }
+
+    // Advance virtual time, delivering every event in [now, now + durationMs)
+    void advance(int64_t durationMs);
+    void runUntil(int64_t timeMs);
+
+    int64_t now() const { return m_nowMs; }
+    size_t peerCount() const { return m_peers.size(); }
+    const VirtualPeer& peer(size_t index) const { return m_peers[index].peer; }
+    RadioStats stats() const;
+
+private:
+    static constexpr size_t kMaxAdvertisementSize = 31;     // Legacy advertising PDU
+
+    static size_t buildAdvertisement(const VirtualPeer& peer, uint8_t* out);
+
+    struct PeerState {
+        VirtualPeer peer;
+        uint64_t rngState;
+        int64_t nextAdvertisementMs;
+        int64_t busyUntilMs;
+        uint8_t advertisementLength;
+        uint8_t advertisement[kMaxAdvertisementSize];
+    };
+
+    struct Counters {
+        std::atomic<uint64_t> advertisements{0};
+        std::atomic<uint64_t> advertisementsLost{0};
+        std::atomic<uint64_t> connectionAttempts{0};
+        std::atomic<uint64_t> connectionFailures{0};
+        std::atomic<uint64_t> identifiersReported{0};
+        std::atomic<uint64_t> connectionsCancelled{0};
+        std::atomic<uint64_t> maxConcurrentConnections{0};
+    };
+
+    static uint64_t nextRandom(uint64_t& state);
+    static double nextUnit(uint64_t& state);
+
+    struct Connection {
+        size_t peer;
+        int64_t completeMs;
+    };
+
+    void runPeers(size_t begin, size_t end, int64_t untilMs, bool scanning, const std::string& serviceFilter,
+                  const DiscoveryHandler& handler, const ScheduledHandlers& scheduled);
+    void startRequestedConnections(const ScheduledHandlers& scheduled);
+    void completeConnections(int64_t untilMs, const ScheduledHandlers& scheduled);
+
+    uint64_t m_seed;
+    uint64_t m_crowdRng;
+    size_t m_workerThreads;
+    RadioConditions m_conditions;
+    std::vector<PeerState> m_peers;
+    int64_t m_nowMs;
+    std::mutex m_scanMutex;
+    std::atomic<bool> m_scanning;
+    std::string m_serviceFilter;       // Guarded by m_scanMutex
+    std::mutex m_handlerMutex;
+    DiscoveryHandler m_handler;
+    ScheduledHandlers m_scheduledHandlers;
+    ConnectionMode m_mode;
+    std::mutex m_requestMutex;
+    std::vector<size_t> m_connectRequests;
+    std::vector<size_t> m_cancelRequests;
+    std::vector<Connection> m_connections;     // advance() thread only
+    Counters m_counters;
+};
+
+} // namespace PassBy
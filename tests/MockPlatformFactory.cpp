@@ -17,7 +17,7 @@ public:
     }
 };
 
-std::unique_ptr<PlatformInterface> PlatformFactory::createPlatform() {
+std::unique_ptr<PlatformInterface> PlatformFactory::createDefaultPlatform() {
     return std::make_unique<MockPlatform>();
 }
 
@@ -0,0 +1,29 @@
+#include "TestAllocationCounter.h"
+#include <cstdlib>
+#include <new>
+
+namespace PassBy {
+
+std::atomic<size_t> TestAllocationCounter::s_allocations{0};
+
+} // namespace PassBy
+
+namespace {
+
+void* countedAllocate(size_t size) {
+    PassBy::TestAllocationCounter::s_allocations.fetch_add(1, std::memory_order_relaxed);
+    void* ptr = std::malloc(size ? size : 1);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+} // namespace
+
+void* operator new(size_t size) { return countedAllocate(size); }
+void* operator new[](size_t size) { return countedAllocate(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace PassBy {
+
+// Process-wide heap allocation count, fed by the operator new replacements in
+// TestAllocationCounter.cpp (linked into PassByTests only)
+class TestAllocationCounter {
+public:
+    static size_t allocations() {
+        return s_allocations.load(std::memory_order_relaxed);
+    }
+
+    static std::atomic<size_t> s_allocations;
+};
+
+} // namespace PassBy
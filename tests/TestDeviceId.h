@@ -0,0 +1,20 @@
+#pragma once
+
+#include "PassBy/DeviceId.h"
+#include <cstdint>
+
+namespace PassBy {
+
+// Reproducible device id for tests: n big-endian in the last four bytes, so ids order
+// like their numbers, and tag in the first, to make sets that never collide
+inline DeviceId testDeviceId(uint32_t n, uint8_t tag = 0xA0) {
+    uint8_t bytes[DeviceId::kSize] = {};
+    bytes[0] = tag;
+    bytes[12] = static_cast<uint8_t>(n >> 24);
+    bytes[13] = static_cast<uint8_t>(n >> 16);
+    bytes[14] = static_cast<uint8_t>(n >> 8);
+    bytes[15] = static_cast<uint8_t>(n);
+    return DeviceId::fromBytes(bytes);
+}
+
+} // namespace PassBy
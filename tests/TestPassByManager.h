@@ -10,6 +10,7 @@ public:
     // シングルトンリセット機能
     static void resetForTesting() {
         std::lock_guard<std::mutex> lock(s_mutex);
+        s_current.store(nullptr, std::memory_order_release);
         s_instance.reset();
     }
 };
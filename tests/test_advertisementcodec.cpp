@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+#include "PassBy/PassBy.h"
+#include "../src/internal/PassByBridge.h"
+#include "../src/internal/AdvertisementCodec.h"
+#include "TestPassByManager.h"
+
+using PassBy::AdvertisementCodec;
+
+namespace {
+
+const char* kIdentifier = "0F1E2D3C-4B5A-6978-8796-A5B4C3D2E1F0";
+
+PassBy::DeviceId testId() {
+    return PassBy::DeviceId::fromString(kIdentifier);
+}
+
+// Flags structure followed by `structure`
+std::vector<uint8_t> advertisementWith(const uint8_t* structure, size_t length) {
+    std::vector<uint8_t> data = {0x02, 0x01, 0x06};
+    data.insert(data.end(), structure, structure + length);
+    return data;
+}
+
+} // namespace
+
+TEST(AdvertisementCodecTest, PayloadRoundTrip) {
+    uint8_t payload[AdvertisementCodec::kPayloadSize];
+    ASSERT_EQ(AdvertisementCodec::encodePayload(testId(), AdvertisementCodec::kFlagGattIdentifier, payload,
+                                                sizeof(payload)),
+              AdvertisementCodec::kPayloadSize);
+    EXPECT_EQ(payload[0], 'P');
+    EXPECT_EQ(payload[1] >> 4, AdvertisementCodec::kVersion);
+
+    PassBy::AdvertisedIdentifier decoded;
+    ASSERT_TRUE(AdvertisementCodec::decodePayload(payload, sizeof(payload), decoded));
+    EXPECT_EQ(decoded.id, testId());
+    EXPECT_EQ(decoded.id.toString(), kIdentifier);
+    EXPECT_EQ(decoded.version, AdvertisementCodec::kVersion);
+    EXPECT_EQ(decoded.flags, AdvertisementCodec::kFlagGattIdentifier);
+
+    EXPECT_EQ(AdvertisementCodec::encodePayload(testId(), 0, payload, sizeof(payload) - 1), 0u);
+}
+
+TEST(AdvertisementCodecTest, ChecksumMatchesCcittVector) {
+    const char* text = "123456789";
+    EXPECT_EQ(AdvertisementCodec::checksum(reinterpret_cast<const uint8_t*>(text), 9), 0x29B1);
+}
+
+TEST(AdvertisementCodecTest, RejectsCorruptedAndUnknownPayloads) {
+    uint8_t payload[AdvertisementCodec::kPayloadSize];
+    AdvertisementCodec::encodePayload(testId(), 0, payload, sizeof(payload));
+    PassBy::AdvertisedIdentifier decoded;
+
+    // Any flipped bit fails the checksum
+    for (size_t i = 0; i < sizeof(payload); ++i) {
+        uint8_t corrupted[sizeof(payload)];
+        std::memcpy(corrupted, payload, sizeof(payload));
+        corrupted[i] ^= 0x10;
+        EXPECT_FALSE(AdvertisementCodec::decodePayload(corrupted, sizeof(corrupted), decoded)) << "byte " << i;
+    }
+
+    EXPECT_FALSE(AdvertisementCodec::decodePayload(payload, sizeof(payload) - 1, decoded));
+
+    // A future version with a valid checksum is left to the GATT path
+    payload[1] = static_cast<uint8_t>((AdvertisementCodec::kVersion + 1) << 4);
+    uint16_t crc = AdvertisementCodec::checksum(payload, 18);
+    payload[18] = static_cast<uint8_t>(crc >> 8);
+    payload[19] = static_cast<uint8_t>(crc);
+    EXPECT_FALSE(AdvertisementCodec::decodePayload(payload, sizeof(payload), decoded));
+}
+
+TEST(AdvertisementCodecTest, DecodesManufacturerAndServiceDataStructures) {
+    uint8_t structure[AdvertisementCodec::kStructureSize];
+    PassBy::AdvertisedIdentifier decoded;
+
+    ASSERT_EQ(AdvertisementCodec::encodeManufacturerStructure(testId(), 0, structure, sizeof(structure)),
+              sizeof(structure));
+    auto data = advertisementWith(structure, sizeof(structure));
+    // Fits a legacy advertisement next to the flags
+    EXPECT_LE(data.size(), 31u);
+    ASSERT_TRUE(AdvertisementCodec::decodeAdvertisement(data.data(), data.size(), decoded));
+    EXPECT_EQ(decoded.id, testId());
+    // Platforms that split out manufacturer data hand over the company id and payload
+    ASSERT_TRUE(AdvertisementCodec::decodeManufacturerData(structure + 2, sizeof(structure) - 2, decoded));
+
+    ASSERT_EQ(AdvertisementCodec::encodeServiceDataStructure(testId(), 0, structure, sizeof(structure)),
+              sizeof(structure));
+    data = advertisementWith(structure, sizeof(structure));
+    ASSERT_TRUE(AdvertisementCodec::decodeAdvertisement(data.data(), data.size(), decoded));
+    EXPECT_EQ(decoded.id, testId());
+}
+
+TEST(AdvertisementCodecTest, IgnoresOtherAndMalformedStructures) {
+    PassBy::AdvertisedIdentifier decoded;
+
+    // Another company's manufacturer data, then a local name
+    std::vector<uint8_t> data = {0x02, 0x01, 0x06, 0x05, 0xFF, 0x4C, 0x00, 0x01, 0x02,
+                                 0x07, 0x09, 'P', 'a', 's', 's', 'B', 'y'};
+    EXPECT_FALSE(AdvertisementCodec::decodeAdvertisement(data.data(), data.size(), decoded));
+
+    // A structure running past the end stops the search
+    uint8_t structure[AdvertisementCodec::kStructureSize];
+    AdvertisementCodec::encodeManufacturerStructure(testId(), 0, structure, sizeof(structure));
+    data = advertisementWith(structure, sizeof(structure));
+    EXPECT_FALSE(AdvertisementCodec::decodeAdvertisement(data.data(), data.size() - 1, decoded));
+
+    // Trailing zero padding is fine
+    data.resize(31, 0);
+    EXPECT_TRUE(AdvertisementCodec::decodeAdvertisement(data.data(), data.size(), decoded));
+    EXPECT_FALSE(AdvertisementCodec::decodeAdvertisement(nullptr, 0, decoded));
+}
+
+class AdvertisedDiscoveryTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        PassBy::TestPassByManager::resetForTesting();
+    }
+
+    void TearDown() override {
+        PassBy::TestPassByManager::resetForTesting();
+    }
+};
+
+TEST_F(AdvertisedDiscoveryTest, AdvertisedIdentifierIsDiscoveredWithoutConnecting) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    uint8_t structure[AdvertisementCodec::kStructureSize];
+    AdvertisementCodec::encodeManufacturerStructure(testId(), 0, structure, sizeof(structure));
+    auto data = advertisementWith(structure, sizeof(structure));
+    PassBy::DeviceId peripheral = PassBy::DeviceId::fromString("AAAAAAAA-0000-0000-0000-000000000001");
+
+    PassBy::PassByBridge::onPeripheralAdvertisement(peripheral, -50, data.data(), data.size());
+    manager.flushEvents();
+
+    auto devices = manager.getDiscoveredDevices();
+    ASSERT_EQ(devices.size(), 1u);
+    EXPECT_EQ(devices[0], kIdentifier);
+
+    // Older peers without the payload are left to the connection scheduler
+    std::vector<uint8_t> legacy = {0x02, 0x01, 0x06};
+    PassBy::PassByBridge::onPeripheralAdvertisement(peripheral, -50, legacy.data(), legacy.size());
+    manager.flushEvents();
+    EXPECT_EQ(manager.getDiscoveredDevices().size(), 1u);
+}
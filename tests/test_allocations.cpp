@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "PassBy/PassBy.h"
+#include "../src/internal/PassByBridge.h"
+#include "TestAllocationCounter.h"
+#include "TestPassByManager.h"
+
+class AllocationTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        PassBy::TestPassByManager::resetForTesting();
+        for (int i = 0; i < 64; ++i) {
+            char text[PassBy::DeviceId::kStringLength + 1];
+            std::snprintf(text, sizeof(text), "12345678-1234-1234-1234-%012X", i);
+            identifiers.emplace_back(text);
+        }
+        identifiers.emplace_back("device-alias");
+    }
+
+    void TearDown() override {
+        PassBy::TestPassByManager::resetForTesting();
+    }
+
+    void discoverAll() {
+        for (const auto& identifier : identifiers) {
+            PassBy::PassByBridge::onDeviceDiscovered(identifier.c_str());
+        }
+    }
+
+    std::vector<std::string> identifiers;
+};
+
+TEST_F(AllocationTest, SteadyStateDiscoveryDoesNotAllocate) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    size_t viewed = 0;
+    size_t batched = 0;
+    manager.setDeviceViewCallback([&](const PassBy::DeviceView& view) {
+        viewed += view.uuid.size() > 0;
+    });
+    PassBy::BatchOptions options;
+    options.maxEvents = 32;
+    manager.setDeviceBatchCallback([&](PassBy::EncounterSpan span) { batched += span.size(); }, options);
+
+    // Warm up: every device known, batch buffers grown
+    for (int round = 0; round < 4; ++round) {
+        discoverAll();
+        manager.flushEvents();
+    }
+
+    size_t before = PassBy::TestAllocationCounter::allocations();
+    for (int round = 0; round < 100; ++round) {
+        discoverAll();
+        manager.flushEvents();
+    }
+    size_t allocations = PassBy::TestAllocationCounter::allocations() - before;
+
+    EXPECT_EQ(allocations, 0u);
+    EXPECT_EQ(viewed, 104 * identifiers.size());
+    EXPECT_GT(batched, 0u);
+    EXPECT_EQ(manager.getDroppedEventCount(), 0u);
+}
+
+TEST_F(AllocationTest, BinaryIdentifiersMatchText) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    std::vector<std::string> seen;
+    manager.setDeviceDiscoveredCallback([&](const PassBy::DeviceInfo& device) {
+        seen.push_back(device.uuid);
+    });
+
+    PassBy::DeviceId id;
+    ASSERT_TRUE(PassBy::DeviceId::parse(identifiers[3], id));
+    PassBy::PassByBridge::onDeviceDiscovered(id);
+    PassBy::PassByBridge::onDeviceDiscovered(identifiers[3]);
+    manager.flushEvents();
+
+    ASSERT_EQ(seen.size(), 2u);
+    EXPECT_EQ(seen[0], identifiers[3]);
+    EXPECT_EQ(seen[1], identifiers[3]);
+    EXPECT_EQ(manager.getDiscoveredDevices().size(), 1u);
+}
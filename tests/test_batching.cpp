@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "PassBy/PassBy.h"
+#include "../src/internal/PassByBridge.h"
+#include "TestPassByManager.h"
+
+class BatchCallbackTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        PassBy::TestPassByManager::resetForTesting();
+    }
+
+    void TearDown() override {
+        PassBy::TestPassByManager::resetForTesting();
+    }
+
+    // Copies of each delivered batch
+    std::vector<std::vector<PassBy::EncounterInfo>> batches;
+    std::mutex batchesMutex;
+
+    PassBy::DeviceBatchCallback collector() {
+        return [this](PassBy::EncounterSpan span) {
+            std::lock_guard<std::mutex> lock(batchesMutex);
+            batches.emplace_back(span.begin(), span.end());
+        };
+    }
+
+    size_t batchCount() {
+        std::lock_guard<std::mutex> lock(batchesMutex);
+        return batches.size();
+    }
+};
+
+TEST_F(BatchCallbackTest, CoalescesRepeatSightings) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    PassBy::BatchOptions options;
+    options.flushInterval = std::chrono::seconds(10);
+    manager.setDeviceBatchCallback(collector(), options);
+
+    manager.startScanning();
+    PassBy::PassByBridge::onDeviceDiscovered("device-1");
+    PassBy::PassByBridge::onDeviceDiscovered("device-1");
+    PassBy::PassByBridge::onDeviceDiscovered("device-2");
+    PassBy::PassByBridge::onDeviceDiscovered("device-1");
+
+    // stopScanning delivers the pending batch before returning
+    EXPECT_TRUE(manager.stopScanning());
+    ASSERT_EQ(batches.size(), 1u);
+    ASSERT_EQ(batches[0].size(), 2u);
+    EXPECT_EQ(batches[0][0].uuid, "device-1");
+    EXPECT_EQ(batches[0][0].hitCount, 3u);
+    EXPECT_EQ(batches[0][1].uuid, "device-2");
+    EXPECT_EQ(batches[0][1].hitCount, 1u);
+}
+
+TEST_F(BatchCallbackTest, FlushesAfterMaxEvents) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    PassBy::BatchOptions options;
+    options.flushInterval = std::chrono::seconds(10);
+    options.maxEvents = 3;
+    manager.setDeviceBatchCallback(collector(), options);
+
+    manager.startScanning();
+    PassBy::PassByBridge::onDeviceDiscovered("device-1");
+    PassBy::PassByBridge::onDeviceDiscovered("device-1");
+    PassBy::PassByBridge::onDeviceDiscovered("device-2");
+    PassBy::PassByBridge::onDeviceDiscovered("device-3");
+    manager.flushEvents();
+
+    ASSERT_EQ(batchCount(), 1u);
+    EXPECT_EQ(batches[0].size(), 2u);
+
+    manager.stopScanning();
+    ASSERT_EQ(batches.size(), 2u);
+    ASSERT_EQ(batches[1].size(), 1u);
+    EXPECT_EQ(batches[1][0].uuid, "device-3");
+}
+
+TEST_F(BatchCallbackTest, FlushesAfterInterval) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    PassBy::BatchOptions options;
+    options.flushInterval = std::chrono::milliseconds(20);
+    manager.setDeviceBatchCallback(collector(), options);
+
+    PassBy::PassByBridge::onDeviceDiscovered("device-1");
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (batchCount() == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    ASSERT_EQ(batchCount(), 1u);
+    EXPECT_EQ(batches[0][0].uuid, "device-1");
+}
+
+TEST_F(BatchCallbackTest, PerDeviceCallbackStillFires) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    std::atomic<int> perDevice{0};
+    manager.setDeviceDiscoveredCallback([&](const PassBy::DeviceInfo&) { perDevice.fetch_add(1); });
+    manager.setDeviceBatchCallback(collector());
+
+    manager.startScanning();
+    PassBy::PassByBridge::onDeviceDiscovered("device-1");
+    PassBy::PassByBridge::onDeviceDiscovered("device-1");
+    manager.stopScanning();
+
+    EXPECT_EQ(perDevice.load(), 2);
+    ASSERT_EQ(batches.size(), 1u);
+    EXPECT_EQ(batches[0].size(), 1u);
+}
+
+TEST_F(BatchCallbackTest, DisablingStopsBatches) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    manager.setDeviceBatchCallback(collector());
+    manager.setDeviceBatchCallback(nullptr);
+
+    manager.startScanning();
+    PassBy::PassByBridge::onDeviceDiscovered("device-1");
+    manager.stopScanning();
+
+    EXPECT_TRUE(batches.empty());
+}
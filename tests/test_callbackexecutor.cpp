@@ -0,0 +1,242 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "PassBy/PassBy.h"
+#include "TestPassByManager.h"
+#include "TestDeviceId.h"
+
+namespace {
+
+// Holds a task on an executor thread until opened
+class Gate {
+public:
+    void wait() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_entered = true;
+        m_changed.notify_all();
+        m_changed.wait(lock, [this] { return m_open; });
+    }
+
+    void waitEntered() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_changed.wait(lock, [this] { return m_entered; });
+    }
+
+    void open() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_open = true;
+        m_changed.notify_all();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+    bool m_entered = false;
+    bool m_open = false;
+};
+
+// A one-thread pool whose worker is parked on gate, with `capacity` free slots behind it
+std::shared_ptr<PassBy::CallbackExecutor> blockedPool(Gate& gate, size_t capacity, PassBy::BackpressurePolicy policy) {
+    PassBy::ExecutorOptions options;
+    options.queueCapacity = capacity;
+    options.backpressure = policy;
+    auto executor = PassBy::CallbackExecutor::threadPool(options);
+    executor->execute(PassBy::DeviceId(), [&gate] { gate.wait(); });
+    gate.waitEntered();
+    return executor;
+}
+
+} // namespace
+
+TEST(CallbackExecutorTest, InlineRunsOnTheCallingThread) {
+    auto executor = PassBy::CallbackExecutor::inlineExecutor();
+    std::thread::id ranOn;
+    executor->execute(PassBy::DeviceId(), [&] { ranOn = std::this_thread::get_id(); });
+    EXPECT_EQ(ranOn, std::this_thread::get_id());
+    EXPECT_FALSE(executor->isExecutorThread());
+}
+
+TEST(CallbackExecutorTest, DropNewestKeepsWhatIsQueued) {
+    Gate gate;
+    auto executor = blockedPool(gate, 2, PassBy::BackpressurePolicy::DropNewest);
+    std::vector<int> ran;
+    for (int i = 1; i <= 3; ++i) {
+        executor->execute(PassBy::DeviceId(), [&ran, i] { ran.push_back(i); });
+    }
+    gate.open();
+    executor->drain();
+    EXPECT_EQ(ran, (std::vector<int>{1, 2}));
+    EXPECT_EQ(executor->droppedCount(), 1u);
+}
+
+TEST(CallbackExecutorTest, DropOldestKeepsTheLatest) {
+    Gate gate;
+    auto executor = blockedPool(gate, 2, PassBy::BackpressurePolicy::DropOldest);
+    std::vector<int> ran;
+    for (int i = 1; i <= 4; ++i) {
+        executor->execute(PassBy::DeviceId(), [&ran, i] { ran.push_back(i); });
+    }
+    gate.open();
+    executor->drain();
+    EXPECT_EQ(ran, (std::vector<int>{3, 4}));
+    EXPECT_EQ(executor->droppedCount(), 2u);
+}
+
+TEST(CallbackExecutorTest, CoalesceReplacesTheQueuedTaskForADevice) {
+    Gate gate;
+    auto executor = blockedPool(gate, 8, PassBy::BackpressurePolicy::CoalesceByDevice);
+    std::vector<std::string> ran;
+    executor->execute(PassBy::testDeviceId(1), [&] { ran.push_back("a1"); });
+    executor->execute(PassBy::testDeviceId(2), [&] { ran.push_back("b1"); });
+    executor->execute(PassBy::testDeviceId(1), [&] { ran.push_back("a2"); });
+    executor->execute(PassBy::testDeviceId(1), [&] { ran.push_back("a3"); });
+    gate.open();
+    executor->drain();
+
+    // The latest report for a device runs in the place of the first
+    EXPECT_EQ(ran, (std::vector<std::string>{"a3", "b1"}));
+    EXPECT_EQ(executor->droppedCount(), 2u);
+
+    // Once run, a device queues again
+    executor->execute(PassBy::testDeviceId(1), [&] { ran.push_back("a4"); });
+    executor->drain();
+    EXPECT_EQ(ran.back(), "a4");
+}
+
+TEST(CallbackExecutorTest, BlockWaitsForRoom) {
+    Gate gate;
+    auto executor = blockedPool(gate, 1, PassBy::BackpressurePolicy::Block);
+    std::vector<int> ran;
+    std::thread producer([&] {
+        for (int i = 1; i <= 5; ++i) {
+            executor->execute(PassBy::DeviceId(), [&ran, i] { ran.push_back(i); });
+        }
+    });
+    gate.open();
+    producer.join();
+    executor->drain();
+    EXPECT_EQ(ran, (std::vector<int>{1, 2, 3, 4, 5}));
+    EXPECT_EQ(executor->droppedCount(), 0u);
+}
+
+TEST(CallbackExecutorTest, DrainFromATaskDoesNotWait) {
+    PassBy::ExecutorOptions options;
+    options.threads = 2;
+    auto executor = PassBy::CallbackExecutor::threadPool(options);
+    bool onExecutor = false;
+    executor->execute(PassBy::DeviceId(), [&] {
+        onExecutor = executor->isExecutorThread();
+        executor->drain();
+    });
+    executor->drain();
+    EXPECT_TRUE(onExecutor);
+}
+
+class CallbackExecutorManagerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        PassBy::TestPassByManager::resetForTesting();
+    }
+
+    void TearDown() override {
+        PassBy::TestPassByManager::resetForTesting();
+    }
+};
+
+TEST_F(CallbackExecutorManagerTest, SlowConsumerDoesNotStallDispatch) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    PassBy::ExecutorOptions options;
+    options.queueCapacity = 4;
+    options.backpressure = PassBy::BackpressurePolicy::DropOldest;
+    manager.setCallbackExecutor(PassBy::CallbackExecutor::threadPool(options));
+
+    Gate gate;
+    std::mutex mutex;
+    std::vector<std::string> reported;
+    manager.setDeviceDiscoveredCallback([&](const PassBy::DeviceInfo& device) {
+        gate.wait();
+        std::lock_guard<std::mutex> lock(mutex);
+        reported.push_back(device.uuid);
+    });
+
+    manager.onDeviceDiscovered("device-0");
+    gate.waitEntered();
+    for (int i = 1; i < 100; ++i) {
+        manager.onDeviceDiscovered("device-" + std::to_string(i));
+    }
+
+    // The store keeps up while the callback is stuck on its first device
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (manager.getDiscoveredDevices().size() < 100 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(manager.getDiscoveredDevices().size(), 100u);
+
+    gate.open();
+    manager.flushEvents();
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_EQ(reported, (std::vector<std::string>{"device-0", "device-96", "device-97", "device-98", "device-99"}));
+    EXPECT_EQ(manager.getDroppedCallbackCount(), 95u);
+    EXPECT_EQ(manager.getMetricsSnapshot().droppedCallbacks, 95u);
+}
+
+TEST_F(CallbackExecutorManagerTest, FlushEventsWaitsForTheExecutor) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    manager.setCallbackExecutor(PassBy::CallbackExecutor::threadPool());
+
+    std::thread::id callbackThread;
+    std::vector<std::string> reported;
+    std::vector<std::string> advertised;
+    manager.setDeviceDiscoveredCallback([&](const PassBy::DeviceInfo& device) {
+        callbackThread = std::this_thread::get_id();
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        reported.push_back(device.uuid);
+    });
+    manager.setAdvertisingStartedCallback([&](const PassBy::AdvertisingInfo& info) {
+        advertised.push_back(info.peripheralUUID);
+    });
+
+    manager.onAdvertisingStarted("peripheral", true);
+    for (int i = 0; i < 10; ++i) {
+        manager.onDeviceDiscovered("device-" + std::to_string(i));
+    }
+    manager.flushEvents();
+    EXPECT_EQ(reported.size(), 10u);
+    EXPECT_EQ(reported.front(), "device-0");
+    EXPECT_EQ(advertised, (std::vector<std::string>{"peripheral"}));
+    EXPECT_NE(callbackThread, std::this_thread::get_id());
+
+    // Back to inline
+    manager.setCallbackExecutor(nullptr);
+    manager.onDeviceDiscovered("device-10");
+    manager.flushEvents();
+    EXPECT_EQ(reported.size(), 11u);
+}
+
+TEST_F(CallbackExecutorManagerTest, BatchesAreCopiedForTheExecutor) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    manager.setCallbackExecutor(PassBy::CallbackExecutor::threadPool());
+    std::vector<std::string> batched;
+    PassBy::BatchOptions options;
+    options.maxEvents = 3;
+    manager.setDeviceBatchCallback(
+        [&](PassBy::EncounterSpan batch) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            for (const auto& encounter : batch) {
+                batched.push_back(encounter.uuid);
+            }
+        },
+        options);
+
+    for (int i = 0; i < 6; ++i) {
+        manager.onDeviceDiscovered("device-" + std::to_string(i));
+    }
+    manager.flushEvents();
+    EXPECT_EQ(batched.size(), 6u);
+    EXPECT_EQ(batched.front(), "device-0");
+    EXPECT_EQ(batched.back(), "device-5");
+}
@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "PassBy/PassBy.h"
+#include "PassBy/passby_c.h"
+#include "../src/internal/PassByC.h"
+#include "../src/internal/SPSCRingBuffer.h"
+
+namespace {
+
+const std::string kServiceUUID = "12345678-1234-1234-1234-123456789ABC";
+
+std::string deviceUuid(int n) {
+    char text[PassBy::DeviceId::kStringLength + 1];
+    std::snprintf(text, sizeof(text), "00000000-0000-4000-8000-%012d", n);
+    return text;
+}
+
+void discover(passby_context* context, int first, int count) {
+    for (int n = first; n < first + count; ++n) {
+        PassBy::contextManager(context).onDeviceDiscovered(deviceUuid(n));
+    }
+    passby_flush(context);
+}
+
+} // namespace
+
+TEST(SPSCRingBufferTest, KeepsOrderAcrossThreads) {
+    PassBy::SPSCRingBuffer<uint32_t> ring(64);
+    const uint32_t kCount = 100000;
+    std::thread producer([&] {
+        for (uint32_t i = 0; i < kCount; ++i) {
+            while (!ring.tryPush([i](uint32_t& slot) { slot = i; })) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t next = 0;
+    uint32_t buffer[16];
+    while (next < kCount) {
+        size_t count = ring.pop(buffer, 16);
+        for (size_t i = 0; i < count; ++i) {
+            ASSERT_EQ(buffer[i], next++);
+        }
+        if (count == 0) {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_EQ(ring.sizeApprox(), 0u);
+}
+
+TEST(CApiTest, DrainsDiscoveriesAsRecords) {
+    EXPECT_EQ(passby_abi_version(), static_cast<uint32_t>(PASSBY_C_ABI_VERSION));
+    EXPECT_EQ(std::string(passby_version()), PassBy::PassByManager::getVersion());
+
+    passby_context* context = passby_create(64);
+    ASSERT_NE(context, nullptr);
+    ASSERT_EQ(passby_start_scanning(context, nullptr), 1);
+    EXPECT_EQ(passby_is_scanning(context), 1);
+
+    PassBy::DeviceId service = PassBy::DeviceId::fromString(kServiceUUID);
+    PassBy::contextManager(context).onDeviceDiscovered(deviceUuid(1));
+    PassBy::contextManager(context).onDeviceDiscovered(deviceUuid(2), service, -60);
+    passby_flush(context);
+
+    passby_event events[8];
+    ASSERT_EQ(passby_poll_events(context, events, 8), 2u);
+    EXPECT_EQ(events[0].type, PASSBY_EVENT_DEVICE_DISCOVERED);
+    EXPECT_EQ(events[0].sequence, 0u);
+    EXPECT_EQ(events[0].flags, 0u);
+    EXPECT_GT(events[0].timestamp_ms, 0);
+
+    char text[37];
+    passby_format_uuid(events[1].device_id, text);
+    EXPECT_EQ(std::string(text), deviceUuid(2));
+    EXPECT_EQ(events[1].sequence, 1u);
+    EXPECT_EQ(events[1].flags, PASSBY_EVENT_HAS_RSSI | PASSBY_EVENT_HAS_SERVICE);
+    EXPECT_EQ(events[1].rssi, -60);
+    EXPECT_EQ(PassBy::DeviceId::fromBytes(events[1].service), service);
+    EXPECT_EQ(passby_poll_events(context, events, 8), 0u);
+
+    PassBy::contextManager(context).onAdvertisingStarted(kServiceUUID, true);
+    passby_flush(context);
+    ASSERT_EQ(passby_poll_events(context, events, 8), 1u);
+    EXPECT_EQ(events[0].type, PASSBY_EVENT_ADVERTISING_STARTED);
+    EXPECT_EQ(events[0].flags, PASSBY_EVENT_SUCCESS);
+    EXPECT_EQ(PassBy::DeviceId::fromBytes(events[0].device_id), service);
+
+    EXPECT_EQ(passby_stop_scanning(context), 1);
+    passby_destroy(context);
+}
+
+TEST(CApiTest, PeekHandsOutRecordsInPlaceAcrossTheWrap) {
+    passby_context* context = passby_create(8);
+    ASSERT_NE(context, nullptr);
+    passby_event events[8];
+    discover(context, 0, 6);
+    ASSERT_EQ(passby_poll_events(context, events, 8), 6u);
+
+    // Six more wrap around the end of the eight slots
+    discover(context, 6, 6);
+    const passby_event* first = nullptr;
+    ASSERT_EQ(passby_peek_events(context, &first), 2u);
+    EXPECT_EQ(first[0].sequence, 6u);
+    EXPECT_EQ(first[1].sequence, 7u);
+    EXPECT_EQ(passby_peek_events(context, &first), 2u);   // Still there until released
+    passby_release_events(context, 2);
+    ASSERT_EQ(passby_peek_events(context, &first), 4u);
+    EXPECT_EQ(first[3].sequence, 11u);
+    passby_release_events(context, 4);
+    EXPECT_EQ(passby_peek_events(context, &first), 0u);
+    passby_destroy(context);
+}
+
+TEST(CApiTest, ReleaseStopsAtTheLastPeek) {
+    passby_context* context = passby_create(8);
+    ASSERT_NE(context, nullptr);
+    discover(context, 0, 3);
+    const passby_event* first = nullptr;
+
+    // Nothing was handed out yet
+    passby_release_events(context, 8);
+    ASSERT_EQ(passby_peek_events(context, &first), 3u);
+    passby_release_events(context, 8);
+    EXPECT_EQ(passby_peek_events(context, &first), 0u);
+
+    // Releasing more than peeked never skips events produced afterwards
+    discover(context, 3, 2);
+    ASSERT_EQ(passby_peek_events(context, &first), 2u);
+    EXPECT_EQ(first[0].sequence, 3u);
+    passby_destroy(context);
+}
+
+TEST(CApiTest, FullRingDropsNewestAndLeavesSequenceGap) {
+    passby_context* context = passby_create(4);
+    ASSERT_NE(context, nullptr);
+    discover(context, 0, 6);
+    EXPECT_EQ(passby_dropped_events(context), 2u);
+
+    passby_event events[8];
+    ASSERT_EQ(passby_poll_events(context, events, 8), 4u);
+    EXPECT_EQ(events[3].sequence, 3u);
+    discover(context, 6, 1);
+    ASSERT_EQ(passby_poll_events(context, events, 8), 1u);
+    EXPECT_EQ(events[0].sequence, 6u);
+    passby_destroy(context);
+}
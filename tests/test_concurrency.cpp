@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+#include "PassBy/PassBy.h"
+#include "../src/internal/PassByBridge.h"
+#include "TestPassByManager.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Public API hammered from many threads at once. Meant to be run under
+// ThreadSanitizer too (-DPASSBY_ENABLE_TSAN=ON).
+class ConcurrencyTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        PassBy::TestPassByManager::resetForTesting();
+    }
+
+    void TearDown() override {
+        PassBy::TestPassByManager::resetForTesting();
+    }
+
+    static std::string identifier(int writer, int index) {
+        char buffer[37];
+        std::snprintf(buffer, sizeof(buffer), "%08x-0000-4000-8000-%012x", writer, index);
+        return buffer;
+    }
+};
+
+TEST_F(ConcurrencyTest, ReadersAndWritersRunConcurrently) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> callbacks{0};
+    std::atomic<uint64_t> reads{0};
+    std::vector<std::thread> threads;
+
+    manager.setDeviceViewCallback([&](const PassBy::DeviceView&) { callbacks++; });
+
+    // Platform threads reporting discoveries
+    for (int writer = 0; writer < 2; ++writer) {
+        threads.emplace_back([&, writer] {
+            for (int i = 0; running; i = (i + 1) % 500) {
+                PassBy::PassByBridge::onDeviceDiscovered(identifier(writer, i));
+            }
+        });
+    }
+
+    // App threads changing the session and settings
+    threads.emplace_back([&] {
+        for (int i = 0; running; ++i) {
+            if (manager.startScanning(i % 2 ? "service-a" : "service-b")) {
+                manager.stopScanning();
+            }
+        }
+    });
+    threads.emplace_back([&] {
+        while (running) {
+            manager.clearDiscoveredDevices();
+            manager.setDeviceDiscoveredCallback([&](const PassBy::DeviceInfo&) { callbacks++; });
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    });
+
+    // UI threads reading
+    for (int reader = 0; reader < 4; ++reader) {
+        threads.emplace_back([&] {
+            while (running) {
+                for (const auto& device : manager.getDiscoveredDevices()) {
+                    EXPECT_EQ(device.size(), 36u);
+                }
+                for (const auto& encounter : manager.getEncounters()) {
+                    EXPECT_GE(encounter.hitCount, 1u);
+                    EXPECT_LE(encounter.firstSeen, encounter.lastSeen);
+                }
+                std::string service = manager.getCurrentServiceUUID();
+                EXPECT_TRUE(service.empty() || service == "service-a" || service == "service-b");
+                manager.isScanning();
+                reads++;
+            }
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    running = false;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_GT(reads.load(), 0u);
+    EXPECT_GT(callbacks.load(), 0u);
+    EXPECT_FALSE(manager.isScanning());
+    EXPECT_TRUE(manager.getCurrentServiceUUID().empty());
+}
+
+TEST_F(ConcurrencyTest, ReadsAfterFlushSeeEveryReportedDevice) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    EXPECT_TRUE(manager.getDiscoveredDevices().empty());
+
+    std::vector<std::thread> writers;
+    for (int writer = 0; writer < 4; ++writer) {
+        writers.emplace_back([writer] {
+            for (int i = 0; i < 100; ++i) {
+                PassBy::PassByBridge::onDeviceDiscovered(identifier(writer, i));
+            }
+        });
+    }
+    for (auto& thread : writers) {
+        thread.join();
+    }
+
+    manager.flushEvents();
+    EXPECT_EQ(manager.getDiscoveredDevices().size(), 400u);
+    EXPECT_EQ(manager.getEncounters().size(), 400u);
+
+    manager.clearDiscoveredDevices();
+    EXPECT_TRUE(manager.getDiscoveredDevices().empty());
+}
+
+TEST_F(ConcurrencyTest, CallbacksMayReadTheManager) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    std::atomic<size_t> reads{0};
+
+    // Reads only load the published snapshot, so they never wait for the dispatch thread
+    manager.setDeviceDiscoveredCallback([&](const PassBy::DeviceInfo&) {
+        reads += manager.getDiscoveredDevices().size() <= 50;
+    });
+
+    PassBy::PassByBridge::onDeviceDiscovered(identifier(0, 1));
+    PassBy::PassByBridge::onDeviceDiscovered(identifier(0, 2));
+    manager.flushEvents();
+    EXPECT_EQ(reads.load(), 2u);
+    EXPECT_EQ(manager.getDiscoveredDevices().size(), 2u);
+
+    // On an executor thread, while the dispatch thread blocks on the executor's full queue
+    PassBy::ExecutorOptions options;
+    options.threads = 1;
+    options.queueCapacity = 2;
+    options.backpressure = PassBy::BackpressurePolicy::Block;
+    manager.setCallbackExecutor(PassBy::CallbackExecutor::threadPool(options));
+    for (int i = 3; i <= 50; ++i) {
+        PassBy::PassByBridge::onDeviceDiscovered(identifier(0, i));
+    }
+    manager.flushEvents();
+    EXPECT_EQ(reads.load(), 50u);
+    EXPECT_EQ(manager.getDiscoveredDevices().size(), 50u);
+}
+
+TEST_F(ConcurrencyTest, SnapshotCatchesUpWithoutAFlush) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    PassBy::PassByBridge::onDeviceDiscovered(identifier(0, 1));
+    manager.flushEvents();
+    PassBy::PassByBridge::onDeviceDiscovered(identifier(0, 2));
+
+    // Republished by the dispatch thread on its own within the snapshot interval
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (manager.getDiscoveredDevices().size() < 2 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_EQ(manager.getDiscoveredDevices().size(), 2u);
+}
+
+TEST_F(ConcurrencyTest, CallbacksMayChangeSettingsWhileTheQueueIsFull) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    std::atomic<bool> first{true};
+    std::atomic<bool> changed{false};
+
+    // Runs on the dispatch thread, so nothing drains the queue until it returns
+    manager.setDeviceDiscoveredCallback([&](const PassBy::DeviceInfo&) {
+        if (!first.exchange(false)) {
+            return;
+        }
+        for (int i = 1; manager.getDroppedEventCount() == 0; ++i) {
+            PassBy::PassByBridge::onDeviceDiscovered(identifier(1, i));
+        }
+        manager.setDutyCycle(PassBy::DutyCycleOptions());
+        manager.setConnectionPolicy(PassBy::ConnectionPolicy());
+        manager.subscribe(PassBy::SubscriptionFilter(), [](const PassBy::DeviceInfo&) {});
+        changed = true;
+    });
+
+    PassBy::PassByBridge::onDeviceDiscovered(identifier(0, 0));
+    manager.flushEvents();
+    EXPECT_TRUE(changed.load());
+}
@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "../src/internal/ConnectionScheduler.h"
+
+namespace {
+
+PassBy::DeviceId handleFor(uint32_t n) {
+    uint8_t bytes[PassBy::DeviceId::kSize] = {};
+    bytes[0] = 0xCD;
+    bytes[12] = static_cast<uint8_t>(n >> 24);
+    bytes[13] = static_cast<uint8_t>(n >> 16);
+    bytes[14] = static_cast<uint8_t>(n >> 8);
+    bytes[15] = static_cast<uint8_t>(n);
+    return PassBy::DeviceId::fromBytes(bytes);
+}
+
+PassBy::ConnectionPolicy testPolicy() {
+    PassBy::ConnectionPolicy policy;
+    policy.maxConcurrentConnections = 2;
+    policy.connectionTimeout = std::chrono::milliseconds(1000);
+    policy.initialBackoff = std::chrono::milliseconds(500);
+    policy.maxBackoff = std::chrono::milliseconds(2000);
+    policy.candidateLifetime = std::chrono::milliseconds(5000);
+    return policy;
+}
+
+bool contains(const std::vector<PassBy::DeviceId>& handles, const PassBy::DeviceId& handle) {
+    return std::find(handles.begin(), handles.end(), handle) != handles.end();
+}
+
+} // namespace
+
+TEST(ConnectionSchedulerTest, CapsConcurrentChains) {
+    PassBy::ConnectionScheduler scheduler;
+    scheduler.configure(testPolicy());
+    for (uint32_t i = 0; i < 10; ++i) {
+        scheduler.onAdvertisement(handleFor(i), -60, 0);
+    }
+
+    scheduler.poll(0);
+    EXPECT_EQ(scheduler.toConnect().size(), 2u);
+    EXPECT_EQ(scheduler.inFlight(), 2u);
+
+    // Full: more advertisements start nothing
+    scheduler.onAdvertisement(handleFor(10), -30, 10);
+    scheduler.poll(10);
+    EXPECT_TRUE(scheduler.toConnect().empty());
+    EXPECT_EQ(scheduler.inFlight(), 2u);
+}
+
+TEST(ConnectionSchedulerTest, PrefersStrongAndRecentPeripherals) {
+    PassBy::ConnectionScheduler scheduler;
+    scheduler.configure(testPolicy());
+    scheduler.onAdvertisement(handleFor(1), -90, 1000);  // Weak
+    scheduler.onAdvertisement(handleFor(2), -50, 0);     // Strong but 1 s old
+    scheduler.onAdvertisement(handleFor(3), -50, 1000);  // Strong and fresh
+    scheduler.onAdvertisement(handleFor(4), -70, 1000);
+
+    scheduler.poll(1000);
+    ASSERT_EQ(scheduler.toConnect().size(), 2u);
+    EXPECT_EQ(scheduler.toConnect()[0], handleFor(3));
+    EXPECT_EQ(scheduler.toConnect()[1], handleFor(2));
+}
+
+TEST(ConnectionSchedulerTest, ResolvedPeripheralFreesSlot) {
+    PassBy::ConnectionScheduler scheduler;
+    scheduler.configure(testPolicy());
+    for (uint32_t i = 0; i < 3; ++i) {
+        scheduler.onAdvertisement(handleFor(i), -60 + static_cast<int>(i), 0);
+    }
+    scheduler.poll(0);
+    ASSERT_EQ(scheduler.toConnect().size(), 2u);
+    PassBy::DeviceId first = scheduler.toConnect()[0];
+    EXPECT_FALSE(scheduler.needsPoll(100));
+
+    EXPECT_TRUE(scheduler.onResolved(first));
+    EXPECT_FALSE(scheduler.onResolved(first));
+    EXPECT_TRUE(scheduler.needsPoll(100));
+    scheduler.poll(100);
+    ASSERT_EQ(scheduler.toConnect().size(), 1u);
+    EXPECT_EQ(scheduler.toConnect()[0], handleFor(0));
+    EXPECT_EQ(scheduler.inFlight(), 2u);
+}
+
+TEST(ConnectionSchedulerTest, FailuresBackOffExponentially) {
+    PassBy::ConnectionScheduler scheduler;
+    auto policy = testPolicy();
+    policy.candidateLifetime = std::chrono::milliseconds(60000);
+    scheduler.configure(policy);
+    PassBy::DeviceId handle = handleFor(1);
+    scheduler.onAdvertisement(handle, -60, 0);
+
+    int64_t now = 0;
+    int64_t expected[] = {500, 1000, 2000, 2000};
+    for (int64_t delay : expected) {
+        scheduler.poll(now);
+        ASSERT_TRUE(contains(scheduler.toConnect(), handle));
+        scheduler.onFailed(handle, now);
+
+        scheduler.poll(now + delay - 1);
+        EXPECT_TRUE(scheduler.toConnect().empty());
+        EXPECT_EQ(scheduler.nextDeadlineMs(), now + delay);
+        now += delay;
+    }
+
+    // Success clears the history
+    scheduler.poll(now);
+    EXPECT_TRUE(scheduler.onResolved(handle));
+    EXPECT_EQ(scheduler.trackedCount(), 0u);
+}
+
+TEST(ConnectionSchedulerTest, StalledChainsTimeOut) {
+    PassBy::ConnectionScheduler scheduler;
+    scheduler.configure(testPolicy());
+    scheduler.onAdvertisement(handleFor(1), -60, 0);
+    scheduler.onAdvertisement(handleFor(2), -60, 0);
+    scheduler.onAdvertisement(handleFor(3), -70, 0);
+    scheduler.poll(0);
+    ASSERT_EQ(scheduler.toConnect().size(), 2u);
+    EXPECT_EQ(scheduler.nextDeadlineMs(), 1000);
+
+    EXPECT_FALSE(scheduler.needsPoll(999));
+    EXPECT_TRUE(scheduler.needsPoll(1000));
+    scheduler.poll(1000);
+    EXPECT_EQ(scheduler.timedOut().size(), 2u);
+    // The timed-out pair backs off, so the third peripheral gets a slot
+    ASSERT_EQ(scheduler.toConnect().size(), 1u);
+    EXPECT_EQ(scheduler.toConnect()[0], handleFor(3));
+
+    // A late failure report for a timed-out chain is ignored
+    scheduler.onFailed(handleFor(1), 1001);
+    EXPECT_EQ(scheduler.inFlight(), 1u);
+}
+
+TEST(ConnectionSchedulerTest, ForgetsPeripheralsOutOfRange) {
+    PassBy::ConnectionScheduler scheduler;
+    auto policy = testPolicy();
+    policy.maxConcurrentConnections = 1;
+    policy.maxTrackedPeripherals = 4;
+    policy.connectionTimeout = std::chrono::milliseconds(10000);
+    scheduler.configure(policy);
+    for (uint32_t i = 0; i < 6; ++i) {
+        scheduler.onAdvertisement(handleFor(i), -60, 0);
+    }
+    EXPECT_EQ(scheduler.trackedCount(), 4u);
+    EXPECT_EQ(scheduler.ignoredCount(), 2u);
+
+    scheduler.poll(0);
+    ASSERT_EQ(scheduler.toConnect().size(), 1u);
+    PassBy::DeviceId connecting = scheduler.toConnect()[0];
+
+    // Everyone else was last heard more than candidateLifetime ago
+    scheduler.poll(5000);
+    EXPECT_EQ(scheduler.trackedCount(), 1u);
+
+    int cancelled = 0;
+    scheduler.reset([&](const PassBy::DeviceId& handle) {
+        EXPECT_EQ(handle, connecting);
+        ++cancelled;
+    });
+    EXPECT_EQ(cancelled, 1);
+    EXPECT_EQ(scheduler.trackedCount(), 0u);
+    EXPECT_EQ(scheduler.inFlight(), 0u);
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+#include <vector>
+#include "PassBy/PassBy.h"
+#include "PassBy/DeviceId.h"
+#include "../src/internal/PassByBridge.h"
+#include "../src/internal/DeviceIdTable.h"
+#include "TestPassByManager.h"
+
+namespace {
+
+PassBy::DeviceId makeId(uint64_t high, uint64_t low) {
+    uint8_t bytes[PassBy::DeviceId::kSize];
+    for (int i = 0; i < 8; ++i) {
+        bytes[i] = static_cast<uint8_t>(high >> (56 - 8 * i));
+        bytes[8 + i] = static_cast<uint8_t>(low >> (56 - 8 * i));
+    }
+    return PassBy::DeviceId::fromBytes(bytes);
+}
+
+} // namespace
+
+TEST(DeviceIdTest, CanonicalRoundTrip) {
+    const std::string text = "E621E1F8-C36C-495A-93FC-0C247A3E6E5F";
+    bool canonical = false;
+    PassBy::DeviceId id = PassBy::DeviceId::fromString(text, &canonical);
+
+    EXPECT_TRUE(canonical);
+    EXPECT_EQ(id.toString(), text);
+    EXPECT_EQ(id.bytes()[0], 0xE6);
+    EXPECT_EQ(id.bytes()[15], 0x5F);
+}
+
+TEST(DeviceIdTest, ParseAcceptsLowercase) {
+    PassBy::DeviceId id;
+    ASSERT_TRUE(PassBy::DeviceId::parse("e621e1f8-c36c-495a-93fc-0c247a3e6e5f", id));
+    EXPECT_EQ(id.toString(), "E621E1F8-C36C-495A-93FC-0C247A3E6E5F");
+
+    EXPECT_FALSE(PassBy::DeviceId::parse("not-a-uuid", id));
+    EXPECT_FALSE(PassBy::DeviceId::parse("E621E1F8XC36C-495A-93FC-0C247A3E6E5F", id));
+}
+
+TEST(DeviceIdTest, NonCanonicalTextIsHashed) {
+    bool canonical = true;
+    PassBy::DeviceId a = PassBy::DeviceId::fromString("device-1", &canonical);
+    EXPECT_FALSE(canonical);
+    EXPECT_FALSE(a.isNull());
+
+    // Stable and distinct; lowercase UUIDs are kept as text too so they round-trip
+    EXPECT_EQ(a, PassBy::DeviceId::fromString("device-1"));
+    EXPECT_NE(a, PassBy::DeviceId::fromString("device-2"));
+    PassBy::DeviceId::fromString("e621e1f8-c36c-495a-93fc-0c247a3e6e5f", &canonical);
+    EXPECT_FALSE(canonical);
+}
+
+TEST(DeviceIdTableTest, SetInsertFindErase) {
+    PassBy::DeviceIdSet set;
+    PassBy::DeviceId a = makeId(1, 2);
+    PassBy::DeviceId b = makeId(3, 4);
+
+    EXPECT_TRUE(set.insert(a).second);
+    EXPECT_FALSE(set.insert(a).second);
+    EXPECT_TRUE(set.insert(b).second);
+    EXPECT_EQ(set.size(), 2u);
+    EXPECT_TRUE(set.contains(a));
+
+    EXPECT_TRUE(set.erase(a));
+    EXPECT_FALSE(set.erase(a));
+    EXPECT_FALSE(set.contains(a));
+    EXPECT_TRUE(set.contains(b));
+    EXPECT_EQ(set.size(), 1u);
+
+    set.clear();
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(set.memoryUsage(), 0u);
+}
+
+TEST(DeviceIdTableTest, MapValuesSurviveGrowth) {
+    PassBy::DeviceIdMap<uint32_t> map;
+    for (uint32_t i = 0; i < 5000; ++i) {
+        *map.insert(makeId(i, i * 7)).first = i;
+    }
+    EXPECT_EQ(map.size(), 5000u);
+    for (uint32_t i = 0; i < 5000; ++i) {
+        const uint32_t* value = map.find(makeId(i, i * 7));
+        ASSERT_NE(value, nullptr);
+        EXPECT_EQ(*value, i);
+    }
+    EXPECT_EQ(map.find(makeId(9999, 1)), nullptr);
+}
+
+TEST(DeviceIdTableTest, MatchesStdSetUnderRandomChurn) {
+    std::mt19937_64 rng(42);
+    PassBy::DeviceIdSet set;
+    std::set<std::pair<uint64_t, uint64_t>> reference;
+
+    // Small key space so inserts and erases collide and leave tombstones behind
+    for (int i = 0; i < 50000; ++i) {
+        uint64_t key = rng() % 2000;
+        PassBy::DeviceId id = makeId(key, ~key);
+        if (rng() % 3 == 0) {
+            EXPECT_EQ(set.erase(id), reference.erase({key, ~key}) == 1);
+        } else {
+            EXPECT_EQ(set.insert(id).second, reference.insert({key, ~key}).second);
+        }
+    }
+    EXPECT_EQ(set.size(), reference.size());
+
+    size_t visited = 0;
+    set.forEach([&](const PassBy::DeviceId&) { ++visited; });
+    EXPECT_EQ(visited, reference.size());
+}
+
+class DeviceRegistryTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        PassBy::TestPassByManager::resetForTesting();
+    }
+
+    void TearDown() override {
+        PassBy::TestPassByManager::resetForTesting();
+    }
+};
+
+TEST_F(DeviceRegistryTest, UUIDAndFreeFormIdentifiersRoundTrip) {
+    auto& manager = PassBy::PassByManager::getInstance();
+
+    std::vector<PassBy::DeviceInfo> received;
+    manager.setDeviceDiscoveredCallback([&](const PassBy::DeviceInfo& device) {
+        received.push_back(device);
+    });
+
+    const std::string uuid = "E621E1F8-C36C-495A-93FC-0C247A3E6E5F";
+    PassBy::PassByBridge::onDeviceDiscovered(uuid);
+    PassBy::PassByBridge::onDeviceDiscovered("invalid-device-UUID");
+    PassBy::PassByBridge::onDeviceDiscovered(uuid);
+    manager.flushEvents();
+
+    ASSERT_EQ(received.size(), 3u);
+    EXPECT_EQ(received[0].uuid, uuid);
+    EXPECT_EQ(received[0].id, PassBy::DeviceId::fromString(uuid));
+    EXPECT_EQ(received[1].uuid, "invalid-device-UUID");
+
+    auto devices = manager.getDiscoveredDevices();
+    std::set<std::string> unique(devices.begin(), devices.end());
+    EXPECT_EQ(devices.size(), 2u);
+    EXPECT_EQ(unique, (std::set<std::string>{uuid, "invalid-device-UUID"}));
+}
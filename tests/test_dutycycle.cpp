@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "../src/internal/DutyCycleController.h"
+
+using Action = PassBy::DutyCycleController::Action;
+
+namespace {
+
+PassBy::DutyCycleOptions testOptions() {
+    PassBy::DutyCycleOptions options;
+    options.enabled = true;
+    options.window = std::chrono::milliseconds(1000);
+    options.maxWindow = std::chrono::milliseconds(3000);
+    options.targetLatency = std::chrono::milliseconds(4000);
+    options.maxLatency = std::chrono::milliseconds(32000);
+    return options;
+}
+
+// Virtual clock: step through time and record each radio transition
+struct Transition {
+    int64_t atMs;
+    Action action;
+};
+
+std::vector<Transition> runFor(PassBy::DutyCycleController& controller, int64_t fromMs, int64_t toMs) {
+    std::vector<Transition> transitions;
+    for (int64_t now = fromMs; now < toMs; now = std::min(controller.nextDeadlineMs(), toMs)) {
+        Action action = controller.poll(now);
+        if (action != Action::None) {
+            transitions.push_back({now, action});
+        }
+    }
+    return transitions;
+}
+
+} // namespace
+
+TEST(DutyCycleControllerTest, QuietNeighbourhoodBacksOff) {
+    PassBy::DutyCycleController controller;
+    controller.configure(testOptions());
+    controller.start(0);
+    EXPECT_TRUE(controller.isRadioOn());
+
+    auto transitions = runFor(controller, 0, 70000);
+    // Windows start 8 s, 16 s and then 32 s apart (capped at maxLatency)
+    std::vector<int64_t> starts;
+    for (const auto& transition : transitions) {
+        if (transition.action == Action::RadioOn) {
+            starts.push_back(transition.atMs);
+        } else {
+            EXPECT_EQ(transition.action, Action::RadioOff);
+        }
+    }
+    ASSERT_EQ(starts.size(), 3u);
+    EXPECT_EQ(starts[0], 8000);
+    EXPECT_EQ(starts[1], 24000);
+    EXPECT_EQ(starts[2], 56000);
+    EXPECT_EQ(transitions[0].atMs, 1000);   // First window closes on time
+    EXPECT_EQ(controller.periodMs(), 32000);
+}
+
+TEST(DutyCycleControllerTest, NewPeersKeepLatencyAtTarget) {
+    PassBy::DutyCycleController controller;
+    controller.configure(testOptions());
+    controller.start(0);
+
+    // Let it back off first
+    runFor(controller, 0, 8001);
+    ASSERT_TRUE(controller.isRadioOn());
+    EXPECT_EQ(controller.periodMs(), 8000);
+
+    // A new peer during the window: next cycle returns to the target latency
+    controller.onNewPeer(8200);
+    runFor(controller, 8000, 9500);
+    EXPECT_FALSE(controller.isRadioOn());
+    EXPECT_EQ(controller.periodMs(), 4000);
+    EXPECT_EQ(controller.nextDeadlineMs(), 12000);
+}
+
+TEST(DutyCycleControllerTest, WindowStretchesWhilePeersArrive) {
+    PassBy::DutyCycleController controller;
+    controller.configure(testOptions());
+    controller.start(0);
+
+    controller.onNewPeer(900);
+    EXPECT_EQ(controller.nextDeadlineMs(), 1900);
+    EXPECT_EQ(controller.poll(1000), Action::None);
+    controller.onNewPeer(1800);
+    controller.onNewPeer(2700);
+    // Capped at maxWindow from the window start
+    EXPECT_EQ(controller.nextDeadlineMs(), 3000);
+    EXPECT_EQ(controller.poll(3000), Action::RadioOff);
+    EXPECT_EQ(controller.nextDeadlineMs(), 4000);
+    EXPECT_EQ(controller.poll(4000), Action::RadioOn);
+}
+
+TEST(DutyCycleControllerTest, NoGapMeansRadioStaysOn) {
+    auto options = testOptions();
+    options.window = std::chrono::milliseconds(2000);
+    options.targetLatency = std::chrono::milliseconds(2000);
+    options.maxLatency = std::chrono::milliseconds(2000);
+    PassBy::DutyCycleController controller;
+    controller.configure(options);
+    controller.start(0);
+
+    EXPECT_TRUE(runFor(controller, 0, 20000).empty());
+    EXPECT_TRUE(controller.isRadioOn());
+    EXPECT_EQ(controller.windowCount(), 10u);
+}
+
+TEST(DutyCycleControllerTest, StoppedControllerIsIdle) {
+    PassBy::DutyCycleController controller;
+    controller.configure(testOptions());
+    EXPECT_EQ(controller.poll(0), Action::None);
+    EXPECT_EQ(controller.nextDeadlineMs(), PassBy::DutyCycleController::kNoDeadline);
+
+    controller.start(0);
+    controller.stop();
+    EXPECT_FALSE(controller.isRadioOn());
+    EXPECT_EQ(controller.poll(5000), Action::None);
+    EXPECT_EQ(controller.nextDeadlineMs(), PassBy::DutyCycleController::kNoDeadline);
+}
@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "PassBy/PassBy.h"
+#include "../src/internal/EncounterAggregator.h"
+#include "TestPassByManager.h"
+#include "TestDeviceId.h"
+
+namespace {
+
+constexpr int64_t kMinuteMs = 60 * 1000;
+
+std::vector<PassBy::DeviceId> topIds(const PassBy::EncounterAggregator& aggregator, PassBy::EncounterRanking ranking,
+                                     size_t k) {
+    std::vector<PassBy::DeviceId> ids;
+    aggregator.top(ranking, k, [&](const PassBy::DeviceId& id, const PassBy::EncounterAggregate&) { ids.push_back(id); });
+    return ids;
+}
+
+} // namespace
+
+TEST(EncounterAggregatorTest, SplitsVisitsOnGaps) {
+    PassBy::EncounterAggregator aggregator(5 * kMinuteMs, 0.5, 0);
+    const PassBy::DeviceId id = PassBy::testDeviceId(1);
+
+    // Two visits of 3 and 1 minutes, ten minutes apart
+    aggregator.record(id, 0, true, -60, "");
+    aggregator.record(id, 2 * kMinuteMs, true, -70, "");
+    aggregator.record(id, 3 * kMinuteMs, false, 0, "");
+    aggregator.record(id, 13 * kMinuteMs, true, -80, "");
+    aggregator.record(id, 14 * kMinuteMs, false, 0, "");
+
+    const PassBy::EncounterAggregate* aggregate = aggregator.find(id);
+    ASSERT_NE(aggregate, nullptr);
+    EXPECT_EQ(aggregate->sightings, 5u);
+    EXPECT_EQ(aggregate->visits, 2u);
+    EXPECT_EQ(aggregate->dwellMs(), 4 * kMinuteMs);
+    EXPECT_EQ(aggregate->firstSeenMs, 0);
+    EXPECT_EQ(aggregate->lastSeenMs, 14 * kMinuteMs);
+    ASSERT_TRUE(aggregate->hasRssi);
+    EXPECT_DOUBLE_EQ(aggregate->rssi, -72.5);   // -60, then halfway to -70, then halfway to -80
+
+    // A clock stepping back neither opens a visit nor moves lastSeen
+    aggregator.record(id, 12 * kMinuteMs, false, 0, "");
+    EXPECT_EQ(aggregate->visits, 2u);
+    EXPECT_EQ(aggregate->lastSeenMs, 14 * kMinuteMs);
+}
+
+TEST(EncounterAggregatorTest, RanksEachOrdering) {
+    PassBy::EncounterAggregator aggregator(kMinuteMs, 0.2, 0);
+    const PassBy::DeviceId frequent = PassBy::testDeviceId(1);
+    const PassBy::DeviceId lingering = PassBy::testDeviceId(2);
+    const PassBy::DeviceId latest = PassBy::testDeviceId(3);
+
+    // frequent: three short visits; lingering: one ten-minute visit; latest: seen once, last
+    for (int visit = 0; visit < 3; ++visit) {
+        aggregator.record(frequent, visit * 10 * kMinuteMs, false, 0, "");
+    }
+    for (int minute = 0; minute <= 10; ++minute) {
+        aggregator.record(lingering, minute * kMinuteMs, false, 0, "");
+    }
+    aggregator.record(latest, 30 * kMinuteMs, false, 0, "");
+
+    using Ranking = PassBy::EncounterRanking;
+    EXPECT_EQ(topIds(aggregator, Ranking::MostFrequent, 1), (std::vector<PassBy::DeviceId>{frequent}));
+    EXPECT_EQ(topIds(aggregator, Ranking::LongestDwell, 1), (std::vector<PassBy::DeviceId>{lingering}));
+    EXPECT_EQ(topIds(aggregator, Ranking::MostRecent, 3),
+              (std::vector<PassBy::DeviceId>{latest, frequent, lingering}));
+    EXPECT_EQ(topIds(aggregator, Ranking::MostFrequent, 10).size(), 3u);
+
+    // Updates move a device within the indexes
+    for (int visit = 0; visit < 3; ++visit) {
+        aggregator.record(latest, (40 + visit * 10) * kMinuteMs, false, 0, "");
+    }
+    EXPECT_EQ(topIds(aggregator, Ranking::MostFrequent, 1), (std::vector<PassBy::DeviceId>{latest}));
+}
+
+TEST(EncounterAggregatorTest, DropsTheLeastRecentBeyondTheLimit) {
+    PassBy::EncounterAggregator aggregator(kMinuteMs, 0.2, 100);
+    for (uint32_t i = 0; i < 1000; ++i) {
+        aggregator.record(PassBy::testDeviceId(i), i * 1000, false, 0, i % 2 ? "alias" : "");
+    }
+    EXPECT_EQ(aggregator.size(), 100u);
+    EXPECT_EQ(aggregator.find(PassBy::testDeviceId(899)), nullptr);
+    EXPECT_NE(aggregator.find(PassBy::testDeviceId(900)), nullptr);
+    for (auto ranking : {PassBy::EncounterRanking::MostFrequent, PassBy::EncounterRanking::LongestDwell,
+                         PassBy::EncounterRanking::MostRecent}) {
+        EXPECT_EQ(topIds(aggregator, ranking, 1000).size(), 100u);
+    }
+
+    aggregator.clear();
+    EXPECT_EQ(aggregator.size(), 0u);
+    EXPECT_TRUE(topIds(aggregator, PassBy::EncounterRanking::MostRecent, 10).empty());
+}
+
+class AggregationTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        PassBy::TestPassByManager::resetForTesting();
+    }
+
+    void TearDown() override {
+        PassBy::TestPassByManager::resetForTesting();
+    }
+};
+
+TEST_F(AggregationTest, ManagerReportsTopEncounters) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    EXPECT_TRUE(manager.getTopEncounters(PassBy::EncounterRanking::MostFrequent, 5).empty());
+
+    PassBy::AggregationOptions options;
+    options.enabled = true;
+    manager.setAggregation(options);
+    for (int i = 0; i < 3; ++i) {
+        manager.onDeviceDiscovered("device-a");
+    }
+    manager.onDeviceDiscovered("device-b");
+    manager.flushEvents();
+
+    auto top = manager.getTopEncounters(PassBy::EncounterRanking::MostFrequent, 5);
+    ASSERT_EQ(top.size(), 2u);
+    EXPECT_EQ(top[0].uuid, "device-a");
+    EXPECT_EQ(top[0].sightings, 3u);
+    EXPECT_EQ(top[0].visits, 1u);
+    EXPECT_FALSE(top[0].hasRssi);
+    EXPECT_EQ(top[1].uuid, "device-b");
+
+    manager.clearDiscoveredDevices();
+    EXPECT_TRUE(manager.getTopEncounters(PassBy::EncounterRanking::MostRecent, 5).empty());
+
+    options.enabled = false;
+    manager.setAggregation(options);
+    manager.onDeviceDiscovered("device-a");
+    manager.flushEvents();
+    EXPECT_TRUE(manager.getTopEncounters(PassBy::EncounterRanking::MostRecent, 5).empty());
+}
@@ -0,0 +1,229 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "PassBy/PassBy.h"
+#include "TestPassByManager.h"
+#include "TestDeviceId.h"
+
+namespace {
+
+using std::chrono::milliseconds;
+using std::chrono::system_clock;
+
+struct Row {
+    std::string uuid;
+    PassBy::DeviceId id;
+    int64_t firstSeenMs;
+    int64_t lastSeenMs;
+    uint32_t hitCount;
+
+    bool operator==(const Row& other) const {
+        return uuid == other.uuid && id == other.id && firstSeenMs == other.firstSeenMs &&
+               lastSeenMs == other.lastSeenMs && hitCount == other.hitCount;
+    }
+};
+
+int64_t toMs(system_clock::time_point time) {
+    return std::chrono::duration_cast<milliseconds>(time.time_since_epoch()).count();
+}
+
+PassBy::EncounterView viewOf(const Row& row) {
+    return PassBy::EncounterView{row.uuid, row.id, system_clock::time_point(milliseconds(row.firstSeenMs)),
+                                 system_clock::time_point(milliseconds(row.lastSeenMs)), row.hitCount};
+}
+
+std::vector<uint8_t> encode(const std::vector<Row>& rows, int64_t baseMs, size_t chunkSize,
+                            std::vector<size_t>* chunks = nullptr) {
+    std::vector<uint8_t> out;
+    PassBy::EncounterExportWriter writer(
+        [&](const uint8_t* data, size_t size) {
+            out.insert(out.end(), data, data + size);
+            if (chunks) {
+                chunks->push_back(size);
+            }
+            return true;
+        },
+        chunkSize);
+    EXPECT_TRUE(writer.begin(rows.size(), baseMs));
+    for (const Row& row : rows) {
+        EXPECT_TRUE(writer.add(viewOf(row)));
+    }
+    EXPECT_TRUE(writer.finish());
+    EXPECT_EQ(writer.bytesWritten(), out.size());
+    return out;
+}
+
+// Decode data fed in pieces of `step` bytes
+std::vector<Row> decode(const std::vector<uint8_t>& data, size_t step, bool* finished = nullptr) {
+    std::vector<Row> rows;
+    PassBy::EncounterExportDecoder decoder;
+    auto collect = [&](const PassBy::EncounterView& view) {
+        rows.push_back(Row{std::string(view.uuid), view.id, toMs(view.firstSeen), toMs(view.lastSeen), view.hitCount});
+    };
+    for (size_t offset = 0; offset < data.size(); offset += step) {
+        EXPECT_TRUE(decoder.feed(data.data() + offset, std::min(step, data.size() - offset), collect));
+    }
+    if (finished) {
+        *finished = decoder.finished();
+    } else {
+        EXPECT_TRUE(decoder.finished());
+    }
+    return rows;
+}
+
+std::vector<Row> sampleRows() {
+    const int64_t base = 1700000000000;
+    std::vector<Row> rows;
+    for (uint32_t i = 0; i < 50; ++i) {
+        PassBy::DeviceId id = PassBy::testDeviceId(i);
+        std::string uuid = i % 5 == 0 ? "alias-" + std::to_string(i) : id.toString();
+        rows.push_back(Row{uuid, id, base + i * 7919, base + i * 7919 + i * 100, i * 3 + 1});
+    }
+    return rows;
+}
+
+} // namespace
+
+TEST(EncounterExportTest, RoundTripsInAnyChunking) {
+    std::vector<Row> rows = sampleRows();
+    std::vector<uint8_t> data = encode(rows, rows.front().firstSeenMs, 64);
+    EXPECT_EQ(decode(data, data.size()), rows);
+    EXPECT_EQ(decode(data, 1), rows);
+    EXPECT_EQ(decode(data, 13), rows);
+}
+
+TEST(EncounterExportTest, IsCompactAndChunked) {
+    const int64_t base = 1700000000000;
+    std::vector<Row> rows;
+    for (uint32_t i = 0; i < 10000; ++i) {
+        // A day of encounters, each seen for up to a few minutes
+        PassBy::DeviceId id = PassBy::testDeviceId(i);
+        rows.push_back(Row{id.toString(), id, base + i * 8640, base + i * 8640 + (i % 300) * 1000, i % 40 + 1});
+    }
+    const size_t chunkSize = 4096;
+    std::vector<size_t> chunks;
+    std::vector<uint8_t> data = encode(rows, base, chunkSize, &chunks);
+
+    // About 22 bytes per encounter against ~37 for the bare UUID text
+    EXPECT_LT(data.size(), rows.size() * 24);
+    for (size_t size : chunks) {
+        EXPECT_LT(size, chunkSize + 64);
+    }
+    EXPECT_EQ(decode(data, chunkSize), rows);
+}
+
+TEST(EncounterExportTest, WriterRejectsUnsortedInput) {
+    std::vector<uint8_t> out;
+    PassBy::EncounterExportWriter writer([&](const uint8_t* data, size_t size) {
+        out.insert(out.end(), data, data + size);
+        return true;
+    });
+    std::vector<Row> rows = sampleRows();
+    ASSERT_TRUE(writer.begin(2, rows[0].firstSeenMs));
+    EXPECT_TRUE(writer.add(viewOf(rows[1])));
+    EXPECT_FALSE(writer.add(viewOf(rows[0])));
+    EXPECT_FALSE(writer.finish());
+}
+
+TEST(EncounterExportTest, DecoderRejectsMalformedInput) {
+    std::vector<Row> rows = sampleRows();
+    std::vector<uint8_t> data = encode(rows, rows.front().firstSeenMs, 1024);
+    auto ignore = [](const PassBy::EncounterView&) {};
+
+    // Truncated: decodes what is complete, never finishes
+    bool finished = true;
+    std::vector<uint8_t> truncated(data.begin(), data.end() - 3);
+    EXPECT_EQ(decode(truncated, 100, &finished).size(), rows.size() - 1);
+    EXPECT_FALSE(finished);
+
+    // Trailing bytes
+    std::vector<uint8_t> trailing = data;
+    trailing.push_back(0);
+    PassBy::EncounterExportDecoder extra;
+    EXPECT_FALSE(extra.feed(trailing.data(), trailing.size(), ignore));
+
+    // Not an export
+    std::vector<uint8_t> garbage = data;
+    garbage[0] = 'X';
+    PassBy::EncounterExportDecoder wrong;
+    EXPECT_FALSE(wrong.feed(garbage.data(), garbage.size(), ignore));
+    EXPECT_TRUE(wrong.failed());
+}
+
+class EncounterExportManagerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        PassBy::TestPassByManager::resetForTesting();
+    }
+
+    void TearDown() override {
+        PassBy::TestPassByManager::resetForTesting();
+    }
+};
+
+TEST_F(EncounterExportManagerTest, ExportsTheRegistry) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    for (uint32_t i = 0; i < 200; ++i) {
+        manager.onDeviceDiscovered(i % 4 == 0 ? "device-" + std::to_string(i) : PassBy::testDeviceId(i).toString());
+    }
+    manager.onDeviceDiscovered("device-0");
+    manager.flushEvents();
+
+    std::vector<uint8_t> data;
+    size_t chunks = 0;
+    ASSERT_TRUE(manager.exportEncounters(
+        [&](const uint8_t* bytes, size_t size) {
+            data.insert(data.end(), bytes, bytes + size);
+            ++chunks;
+            return true;
+        },
+        512));
+    EXPECT_GT(chunks, 1u);
+
+    std::vector<Row> exported = decode(data, 100);
+    std::vector<Row> expected;
+    for (const auto& info : manager.getEncounters()) {
+        expected.push_back(Row{info.uuid, info.id, toMs(info.firstSeen), toMs(info.lastSeen), info.hitCount});
+    }
+    std::sort(expected.begin(), expected.end(), [](const Row& a, const Row& b) { return a.id < b.id; });
+    EXPECT_EQ(exported, expected);
+
+    // A failing sink aborts the export
+    EXPECT_FALSE(manager.exportEncounters([](const uint8_t*, size_t) { return false; }, 512));
+}
+
+TEST_F(EncounterExportManagerTest, ExportsEncountersRemovedMeanwhile) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    // Enough for several batches
+    for (uint32_t i = 0; i < 3000; ++i) {
+        manager.onDeviceDiscovered(PassBy::testDeviceId(i).toString());
+    }
+    manager.flushEvents();
+    std::vector<PassBy::EncounterInfo> before = manager.getEncounters();
+
+    // The sink runs without the device lock, so it may change the registry
+    std::vector<uint8_t> data;
+    ASSERT_TRUE(manager.exportEncounters(
+        [&](const uint8_t* bytes, size_t size) {
+            if (data.empty()) {
+                manager.clearDiscoveredDevices();
+                manager.onDeviceDiscovered(PassBy::testDeviceId(5000).toString());
+                manager.flushEvents();
+            }
+            data.insert(data.end(), bytes, bytes + size);
+            return true;
+        },
+        512));
+    EXPECT_EQ(manager.getEncounters().size(), 1u);
+
+    std::vector<Row> exported = decode(data, 4096);
+    ASSERT_EQ(exported.size(), before.size());
+    std::sort(before.begin(), before.end(),
+              [](const PassBy::EncounterInfo& a, const PassBy::EncounterInfo& b) { return a.id < b.id; });
+    for (size_t i = 0; i < before.size(); ++i) {
+        EXPECT_EQ(exported[i].id, before[i].id);
+        EXPECT_EQ(exported[i].hitCount, before[i].hitCount);
+    }
+}
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "PassBy/EncounterGraph.h"
+#include "../src/internal/Parallel.h"
+#include "TestDeviceId.h"
+
+namespace {
+
+const PassBy::GraphContact* findContact(const std::vector<PassBy::GraphContact>& contacts, uint32_t n) {
+    for (const auto& contact : contacts) {
+        if (contact.id == PassBy::testDeviceId(n)) {
+            return &contact;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+TEST(ParallelTest, SortAndScanMatchSerial) {
+    std::mt19937 rng(7);
+    std::vector<uint32_t> values(200000);
+    for (auto& value : values) {
+        value = rng() % 1000;
+    }
+
+    std::vector<uint32_t> sorted = values;
+    PassBy::parallelSort(sorted.begin(), sorted.end(), 4, std::less<uint32_t>());
+    std::vector<uint32_t> expected = values;
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(sorted, expected);
+
+    std::vector<uint64_t> sums(values.begin(), values.end());
+    uint64_t total = PassBy::parallelExclusiveScan(sums, 4);
+    EXPECT_EQ(total, std::accumulate(values.begin(), values.end(), uint64_t(0)));
+    uint64_t running = 0;
+    for (size_t i = 0; i < values.size(); ++i) {
+        ASSERT_EQ(sums[i], running);
+        running += values[i];
+    }
+}
+
+TEST(EncounterGraphTest, MergesReportsFromBothSides) {
+    PassBy::EncounterGraphBuilder builder(1);
+    // 0 and 1 see each other over overlapping spans, then meet again later
+    builder.add(PassBy::testDeviceId(0), PassBy::testDeviceId(1), 1000, 5000, 3);
+    builder.add(PassBy::testDeviceId(1), PassBy::testDeviceId(0), 4000, 8000, 2);
+    builder.add(PassBy::testDeviceId(0), PassBy::testDeviceId(1), 20000, 21000, 1);
+    builder.add(PassBy::testDeviceId(1), PassBy::testDeviceId(2), 2000, 3000, 1);
+    builder.add(PassBy::testDeviceId(2), PassBy::testDeviceId(2), 2000, 3000, 1);
+    EXPECT_EQ(builder.reportCount(), 4u);
+
+    PassBy::EncounterGraph graph = builder.build();
+    EXPECT_EQ(builder.reportCount(), 0u);
+    EXPECT_EQ(graph.nodeCount(), 3u);
+    EXPECT_EQ(graph.edgeCount(), 2u);
+    EXPECT_EQ(graph.intervalCount(), 3u);
+    EXPECT_TRUE(graph.contains(PassBy::testDeviceId(2)));
+    EXPECT_FALSE(graph.contains(PassBy::testDeviceId(3)));
+
+    auto contacts = graph.contacts(PassBy::testDeviceId(0));
+    ASSERT_EQ(contacts.size(), 1u);
+    EXPECT_EQ(contacts[0].id, PassBy::testDeviceId(1));
+    EXPECT_EQ(contacts[0].encounters, 2u);
+    EXPECT_EQ(contacts[0].overlapMs, 7000 + 1000);
+    EXPECT_EQ(contacts[0].hits, 6u);
+    EXPECT_EQ(graph.contactCount(PassBy::testDeviceId(1)), 2u);
+    EXPECT_TRUE(graph.contacts(PassBy::testDeviceId(3)).empty());
+}
+
+TEST(EncounterGraphTest, WindowsLimitContacts) {
+    PassBy::EncounterGraphBuilder builder(1);
+    builder.add(PassBy::testDeviceId(0), PassBy::testDeviceId(1), 1000, 5000);
+    builder.add(PassBy::testDeviceId(0), PassBy::testDeviceId(2), 10000, 12000);
+    builder.add(PassBy::testDeviceId(0), PassBy::testDeviceId(3), 30000, 30000);
+    PassBy::EncounterGraph graph = builder.build();
+
+    PassBy::TimeWindow early{0, 11000};
+    auto contacts = graph.contacts(PassBy::testDeviceId(0), early);
+    ASSERT_EQ(contacts.size(), 2u);
+    ASSERT_NE(findContact(contacts, 2), nullptr);
+    EXPECT_EQ(findContact(contacts, 2)->overlapMs, 1000);
+    EXPECT_EQ(findContact(contacts, 1)->overlapMs, 4000);
+
+    // Half-open: an encounter starting at toMs is outside, one ending at fromMs inside
+    EXPECT_EQ(graph.contactCount(PassBy::testDeviceId(0), PassBy::TimeWindow{5000, 10000}), 1u);
+    EXPECT_EQ(graph.contactCount(PassBy::testDeviceId(0), PassBy::TimeWindow{12001, 30000}), 0u);
+    EXPECT_EQ(graph.contactCount(PassBy::testDeviceId(0), PassBy::TimeWindow{12001, 30001}), 1u);
+    EXPECT_EQ(graph.contactCount(PassBy::testDeviceId(0)), 3u);
+}
+
+TEST(EncounterGraphTest, NeighbourhoodFollowsActiveEdges) {
+    // Chain 0-1-2-3-4, with 2-3 only met late
+    PassBy::EncounterGraphBuilder builder(1);
+    builder.add(PassBy::testDeviceId(0), PassBy::testDeviceId(1), 100, 200);
+    builder.add(PassBy::testDeviceId(1), PassBy::testDeviceId(2), 100, 200);
+    builder.add(PassBy::testDeviceId(2), PassBy::testDeviceId(3), 5000, 6000);
+    builder.add(PassBy::testDeviceId(3), PassBy::testDeviceId(4), 100, 200);
+    PassBy::EncounterGraph graph = builder.build();
+
+    auto reached = graph.neighbourhood(PassBy::testDeviceId(0), 3);
+    ASSERT_EQ(reached.size(), 3u);
+    EXPECT_EQ(reached[0].id, PassBy::testDeviceId(1));
+    EXPECT_EQ(reached[0].hops, 1u);
+    EXPECT_EQ(reached[2].id, PassBy::testDeviceId(3));
+    EXPECT_EQ(reached[2].hops, 3u);
+    EXPECT_EQ(graph.neighbourhood(PassBy::testDeviceId(0), 10).size(), 4u);
+    EXPECT_TRUE(graph.neighbourhood(PassBy::testDeviceId(0), 0).empty());
+
+    // Without the 2-3 encounter the chain breaks
+    EXPECT_EQ(graph.neighbourhood(PassBy::testDeviceId(0), 10, PassBy::TimeWindow{0, 1000}).size(), 2u);
+    EXPECT_EQ(graph.neighbourhood(PassBy::testDeviceId(2), 10, PassBy::TimeWindow{0, 1000}).size(), 2u);
+}
+
+TEST(EncounterGraphTest, ParallelBuildMatchesSerial) {
+    PassBy::EncounterGraphBuilder serialBuilder(1);
+    PassBy::EncounterGraphBuilder parallelBuilder(4);
+    std::mt19937 rng(11);
+    for (int i = 0; i < 100000; ++i) {
+        uint32_t a = rng() % 5000;
+        uint32_t b = rng() % 5000;
+        int64_t start = static_cast<int64_t>(rng() % 1000000);
+        int64_t end = start + static_cast<int64_t>(rng() % 5000);
+        serialBuilder.add(PassBy::testDeviceId(a), PassBy::testDeviceId(b), start, end, 1);
+        parallelBuilder.add(PassBy::testDeviceId(a), PassBy::testDeviceId(b), start, end, 1);
+    }
+    PassBy::EncounterGraph serial = serialBuilder.build();
+    PassBy::EncounterGraph parallel = parallelBuilder.build();
+    ASSERT_EQ(parallel.nodeCount(), serial.nodeCount());
+    ASSERT_EQ(parallel.edgeCount(), serial.edgeCount());
+    ASSERT_EQ(parallel.intervalCount(), serial.intervalCount());
+    EXPECT_LT(serial.memoryUsage(), 40 * serial.intervalCount() + 80 * serial.nodeCount());
+
+    PassBy::TimeWindow window{200000, 400000};
+    for (uint32_t n = 0; n < 5000; n += 97) {
+        auto expected = serial.contacts(PassBy::testDeviceId(n), window);
+        auto actual = parallel.contacts(PassBy::testDeviceId(n), window);
+        ASSERT_EQ(actual.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            EXPECT_EQ(actual[i].id, expected[i].id);
+            EXPECT_EQ(actual[i].encounters, expected[i].encounters);
+            EXPECT_EQ(actual[i].overlapMs, expected[i].overlapMs);
+            EXPECT_EQ(actual[i].hits, expected[i].hits);
+        }
+        EXPECT_EQ(parallel.neighbourhood(PassBy::testDeviceId(n), 2, window).size(),
+                  serial.neighbourhood(PassBy::testDeviceId(n), 2, window).size());
+    }
+}
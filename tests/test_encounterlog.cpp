@@ -0,0 +1,221 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include "PassBy/PassBy.h"
+#include "../src/internal/PassByBridge.h"
+#include "../src/internal/EncounterLog.h"
+#include "../src/internal/EncounterStore.h"
+#include "TestPassByManager.h"
+#include "TestDeviceId.h"
+
+namespace {
+
+long fileSize(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    return static_cast<long>(file.tellg());
+}
+
+} // namespace
+
+class EncounterLogTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        PassBy::TestPassByManager::resetForTesting();
+        path = ::testing::TempDir() + "passby_encounters_" +
+               ::testing::UnitTest::GetInstance()->current_test_info()->name() + ".log";
+        std::remove(path.c_str());
+    }
+
+    void TearDown() override {
+        PassBy::TestPassByManager::resetForTesting();
+        std::remove(path.c_str());
+    }
+
+    std::string path;
+};
+
+TEST_F(EncounterLogTest, ReloadsLatestStatePerDevice) {
+    {
+        PassBy::EncounterStore store;
+        store.setChangeTracking(true);
+        PassBy::EncounterLog log;
+        ASSERT_TRUE(log.open(path));
+
+        store.record(PassBy::testDeviceId(1), 1000, "");
+        store.record(PassBy::DeviceId::fromString("device-2"), 1500, "device-2");
+        store.drainChanges([&](const PassBy::EncounterRecord& r) { log.append(r, store.aliasOf(r)); });
+        store.record(PassBy::testDeviceId(1), 4000, "");
+        store.drainChanges([&](const PassBy::EncounterRecord& r) { log.append(r, store.aliasOf(r)); });
+        EXPECT_EQ(log.entryCount(), 3u);
+    }
+
+    PassBy::EncounterLog log;
+    ASSERT_TRUE(log.open(path));
+    PassBy::EncounterStore store;
+    EXPECT_EQ(log.load(store, 5000), 3u);
+    EXPECT_EQ(store.size(), 2u);
+
+    const PassBy::EncounterRecord* record = store.find(PassBy::testDeviceId(1), 5000);
+    ASSERT_NE(record, nullptr);
+    EXPECT_EQ(record->firstSeenMs, 1000);
+    EXPECT_EQ(record->lastSeenMs, 4000);
+    EXPECT_EQ(record->hitCount, 2u);
+
+    record = store.find(PassBy::DeviceId::fromString("device-2"), 5000);
+    ASSERT_NE(record, nullptr);
+    EXPECT_EQ(store.identifierString(*record), "device-2");
+}
+
+TEST_F(EncounterLogTest, DiscardsTornTail) {
+    PassBy::EncounterStore source;
+    {
+        PassBy::EncounterLog log;
+        ASSERT_TRUE(log.open(path));
+        log.append(*source.record(PassBy::testDeviceId(1), 1000, ""), "");
+        log.append(*source.record(PassBy::testDeviceId(2), 1000, ""), "");
+        size_t secondEntry = log.usedBytes() - 48;
+
+        // Simulate a crash in the middle of the second append
+        log.close();
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(static_cast<std::streamoff>(secondEntry));
+        file.put('\x5A');
+    }
+
+    PassBy::EncounterLog log;
+    ASSERT_TRUE(log.open(path));
+    EXPECT_EQ(log.entryCount(), 1u);
+
+    // Appends continue after the last intact entry
+    log.append(*source.record(PassBy::testDeviceId(3), 2000, ""), "");
+    log.close();
+    ASSERT_TRUE(log.open(path));
+    PassBy::EncounterStore store;
+    EXPECT_EQ(log.load(store, 2000), 2u);
+    EXPECT_NE(store.find(PassBy::testDeviceId(1), 2000), nullptr);
+    EXPECT_EQ(store.find(PassBy::testDeviceId(2), 2000), nullptr);
+    EXPECT_NE(store.find(PassBy::testDeviceId(3), 2000), nullptr);
+}
+
+TEST_F(EncounterLogTest, RejectsForeignFiles) {
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "not an encounter log, just some text that is long enough";
+    }
+    PassBy::EncounterLog log;
+    EXPECT_FALSE(log.open(path));
+}
+
+TEST_F(EncounterLogTest, RecoversFileWhoseHeaderNeverReachedDisk) {
+    {
+        // What a crash right after creation used to leave behind
+        std::ofstream file(path, std::ios::binary);
+        file << std::string(64 * 1024, '\0');
+    }
+    PassBy::EncounterStore source;
+    PassBy::EncounterLog log;
+    ASSERT_TRUE(log.open(path));
+    EXPECT_EQ(log.entryCount(), 0u);
+    log.append(*source.record(PassBy::testDeviceId(1), 1000, ""), "");
+    log.close();
+
+    ASSERT_TRUE(log.open(path));
+    PassBy::EncounterStore store;
+    EXPECT_EQ(log.load(store, 1000), 1u);
+    EXPECT_NE(store.find(PassBy::testDeviceId(1), 1000), nullptr);
+}
+
+TEST_F(EncounterLogTest, CompactionKeepsOnlyLiveRecords) {
+    PassBy::EncounterStore store;
+    store.setChangeTracking(true);
+    PassBy::EncounterLog log;
+    ASSERT_TRUE(log.open(path));
+
+    for (int round = 0; round < 100; ++round) {
+        for (uint32_t n = 0; n < 100; ++n) {
+            store.record(PassBy::testDeviceId(n), round, "");
+        }
+        store.drainChanges([&](const PassBy::EncounterRecord& r) { log.append(r, store.aliasOf(r)); });
+    }
+    EXPECT_EQ(log.entryCount(), 10000u);
+    EXPECT_TRUE(log.shouldCompact(store.size()));
+    long before = fileSize(path);
+
+    ASSERT_TRUE(log.compact(store, 100));
+    EXPECT_EQ(log.entryCount(), 100u);
+    EXPECT_LT(fileSize(path), before);
+
+    PassBy::EncounterStore reloaded;
+    log.load(reloaded, 100);
+    ASSERT_EQ(reloaded.size(), 100u);
+    EXPECT_EQ(reloaded.find(PassBy::testDeviceId(42), 100)->hitCount, 100u);
+}
+
+TEST_F(EncounterLogTest, BackgroundCompactionKeepsLaterChanges) {
+    PassBy::EncounterStore store;
+    store.setChangeTracking(true);
+    PassBy::EncounterLog log;
+    ASSERT_TRUE(log.open(path));
+    auto persist = [&] {
+        store.drainChanges([&](const PassBy::EncounterRecord& r) { log.append(r, store.aliasOf(r)); });
+    };
+
+    for (int round = 0; round < 50; ++round) {
+        for (uint32_t n = 0; n < 100; ++n) {
+            store.record(PassBy::testDeviceId(n), round, "");
+        }
+        persist();
+    }
+    ASSERT_TRUE(log.startCompaction(store, 50));
+    EXPECT_TRUE(log.isCompacting());
+
+    // Changes made while the rewrite runs land in the old file and are carried over
+    store.record(PassBy::testDeviceId(7), 60, "");
+    store.record(PassBy::DeviceId::fromString("late-device"), 60, "late-device");
+    persist();
+
+    ASSERT_TRUE(log.finishCompaction(store, 60, true));
+    EXPECT_FALSE(log.isCompacting());
+    EXPECT_EQ(log.entryCount(), 102u);
+    log.close();
+
+    ASSERT_TRUE(log.open(path));
+    PassBy::EncounterStore reloaded;
+    log.load(reloaded, 60);
+    ASSERT_EQ(reloaded.size(), 101u);
+    EXPECT_EQ(reloaded.find(PassBy::testDeviceId(7), 60)->hitCount, 51u);
+    EXPECT_EQ(reloaded.find(PassBy::testDeviceId(8), 60)->hitCount, 50u);
+    const PassBy::EncounterRecord* late = reloaded.find(PassBy::DeviceId::fromString("late-device"), 60);
+    ASSERT_NE(late, nullptr);
+    EXPECT_EQ(reloaded.aliasOf(*late), "late-device");
+}
+
+TEST_F(EncounterLogTest, ManagerWarmStartsFromLog) {
+    {
+        auto& manager = PassBy::PassByManager::getInstance();
+        ASSERT_TRUE(manager.openEncounterLog(path));
+        PassBy::PassByBridge::onDeviceDiscovered("12345678-1234-1234-1234-123456789ABC");
+        PassBy::PassByBridge::onDeviceDiscovered("device-1");
+        manager.flushEvents();
+    }
+
+    // A fresh manager starts with the encounters of the previous one
+    PassBy::TestPassByManager::resetForTesting();
+    auto& manager = PassBy::PassByManager::getInstance();
+    EXPECT_TRUE(manager.getDiscoveredDevices().empty());
+    ASSERT_TRUE(manager.openEncounterLog(path));
+
+    auto devices = manager.getDiscoveredDevices();
+    std::sort(devices.begin(), devices.end());
+    ASSERT_EQ(devices.size(), 2u);
+    EXPECT_EQ(devices[0], "12345678-1234-1234-1234-123456789ABC");
+    EXPECT_EQ(devices[1], "device-1");
+
+    // Clearing the devices clears the log too
+    manager.clearDiscoveredDevices();
+    manager.closeEncounterLog();
+    ASSERT_TRUE(manager.openEncounterLog(path));
+    EXPECT_TRUE(manager.getDiscoveredDevices().empty());
+}
@@ -0,0 +1,362 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <string>
+#include <thread>
+#include "PassBy/PassBy.h"
+#include "../src/internal/PassByBridge.h"
+#include "../src/internal/EncounterStore.h"
+#include "TestPassByManager.h"
+#include "TestDeviceId.h"
+
+TEST(EncounterStoreTest, TracksFirstLastSeenAndHits) {
+    PassBy::EncounterStore store;
+    bool isNew = false;
+
+    store.record(PassBy::testDeviceId(1), 1000, "", &isNew);
+    EXPECT_TRUE(isNew);
+    store.record(PassBy::testDeviceId(1), 2500, "", &isNew);
+    EXPECT_FALSE(isNew);
+
+    const PassBy::EncounterRecord* record = store.find(PassBy::testDeviceId(1), 3000);
+    ASSERT_NE(record, nullptr);
+    EXPECT_EQ(record->firstSeenMs, 1000);
+    EXPECT_EQ(record->lastSeenMs, 2500);
+    EXPECT_EQ(record->hitCount, 2u);
+}
+
+TEST(EncounterStoreTest, KeepsAliasText) {
+    PassBy::EncounterStore store;
+    PassBy::DeviceId id = PassBy::DeviceId::fromString("device-1");
+    const PassBy::EncounterRecord* record = store.record(id, 0, "device-1");
+    ASSERT_NE(record, nullptr);
+    EXPECT_EQ(store.identifierString(*record), "device-1");
+}
+
+TEST(EncounterStoreTest, ExpiresAfterTTL) {
+    PassBy::EncounterStore store;
+    store.configure(1000, 0);
+
+    store.record(PassBy::testDeviceId(1), 0, "");
+    EXPECT_NE(store.find(PassBy::testDeviceId(1), 999), nullptr);
+    EXPECT_EQ(store.find(PassBy::testDeviceId(1), 1000), nullptr);
+
+    // Seen again after expiry: a fresh encounter
+    bool isNew = false;
+    const PassBy::EncounterRecord* record = store.record(PassBy::testDeviceId(1), 5000, "", &isNew);
+    EXPECT_TRUE(isNew);
+    EXPECT_EQ(record->firstSeenMs, 5000);
+    EXPECT_EQ(record->hitCount, 1u);
+}
+
+TEST(EncounterStoreTest, IncrementalExpiryRetiresStaleRecords) {
+    PassBy::EncounterStore store;
+    store.configure(1000, 0);
+    for (uint32_t i = 0; i < 100; ++i) {
+        store.record(PassBy::testDeviceId(i), 0, "");
+    }
+    EXPECT_EQ(store.size(), 100u);
+
+    // Each update advances the expiry hand a few slots; old records drain without a full scan
+    for (uint32_t i = 0; i < 100; ++i) {
+        store.record(PassBy::testDeviceId(1000 + i), 2000, "");
+    }
+    EXPECT_EQ(store.size(), 100u);
+    EXPECT_EQ(store.expiredCount(), 100u);
+    EXPECT_EQ(store.find(PassBy::testDeviceId(0), 2000), nullptr);
+}
+
+TEST(EncounterStoreTest, MemoryBudgetIsHonored) {
+    PassBy::EncounterStore store;
+    const size_t budget = 64 * 1024;
+    store.configure(0, budget);
+
+    size_t capacity = store.maxRecords();
+    ASSERT_GT(capacity, 0u);
+    EXPECT_EQ(capacity, PassBy::EncounterStore::recordsForBudget(budget));
+
+    for (uint32_t i = 0; i < capacity * 4; ++i) {
+        store.record(PassBy::testDeviceId(i), i, "");
+    }
+    EXPECT_EQ(store.size(), capacity);
+    EXPECT_EQ(store.evictedCount(), capacity * 3);
+    EXPECT_LE(store.memoryUsage(), budget);
+}
+
+TEST(EncounterStoreTest, MemoryBudgetCoversAliases) {
+    PassBy::EncounterStore store;
+    const size_t budget = 16 * 1024;
+    store.configure(0, budget);
+    const size_t capacity = store.maxRecords();
+    EXPECT_EQ(capacity, PassBy::EncounterStore::recordsForBudget(budget));
+    const size_t usage = store.memoryUsage();
+    for (uint32_t i = 0; i < 10; ++i) {
+        store.record(PassBy::testDeviceId(i), i, "");
+    }
+
+    // Alias text is reserved per slot up front, so non-UUID identifiers never resize the store
+    auto alias = [](uint32_t n) { return "beacon-with-a-rather-long-name-" + std::to_string(n); };
+    for (uint32_t i = 10; i < 1000; ++i) {
+        store.record(PassBy::testDeviceId(i), i, alias(i));
+        ASSERT_EQ(store.memoryUsage(), usage);
+    }
+    EXPECT_LE(usage, budget);
+    EXPECT_EQ(store.maxRecords(), capacity);
+    EXPECT_EQ(store.size(), capacity);
+
+    const PassBy::EncounterRecord* record = store.find(PassBy::testDeviceId(999), 1000);
+    ASSERT_NE(record, nullptr);
+    EXPECT_EQ(store.aliasOf(*record), alias(999));
+    EXPECT_EQ(store.identifierString(*record), alias(999));
+
+    // Aliases follow their records through a budget change
+    store.configure(0, budget * 2);
+    EXPECT_LE(store.memoryUsage(), budget * 2);
+    record = store.find(PassBy::testDeviceId(999), 1000);
+    ASSERT_NE(record, nullptr);
+    EXPECT_EQ(store.aliasOf(*record), alias(999));
+    store.configure(0, 0);
+    record = store.find(PassBy::testDeviceId(999), 1000);
+    ASSERT_NE(record, nullptr);
+    EXPECT_EQ(store.aliasOf(*record), alias(999));
+}
+
+TEST(EncounterStoreTest, ClockEvictionSparesRepeatVisitors) {
+    PassBy::EncounterStore store;
+    store.configure(0, 4096);
+    size_t capacity = store.maxRecords();
+    ASSERT_GT(capacity, 2u);
+
+    for (uint32_t i = 0; i < capacity; ++i) {
+        store.record(PassBy::testDeviceId(i), i, "");
+    }
+    // Device 0 is seen again, so its reference bit protects it from the next eviction
+    store.record(PassBy::testDeviceId(0), capacity, "");
+    store.record(PassBy::testDeviceId(100000), capacity + 1, "");
+
+    EXPECT_NE(store.find(PassBy::testDeviceId(0), capacity + 1), nullptr);
+    EXPECT_EQ(store.find(PassBy::testDeviceId(1), capacity + 1), nullptr);
+    EXPECT_NE(store.find(PassBy::testDeviceId(100000), capacity + 1), nullptr);
+}
+
+TEST(EncounterStoreTest, ShrinkingBudgetKeepsMostRecent) {
+    PassBy::EncounterStore store;
+    for (uint32_t i = 0; i < 1000; ++i) {
+        store.record(PassBy::testDeviceId(i), i, "");
+    }
+    store.configure(0, 4096);
+    size_t capacity = store.maxRecords();
+    EXPECT_EQ(store.size(), capacity);
+    EXPECT_NE(store.find(PassBy::testDeviceId(999), 1000), nullptr);
+    EXPECT_EQ(store.find(PassBy::testDeviceId(0), 1000), nullptr);
+}
+
+TEST(EncounterStoreTest, ChangesSinceVisitsOnlyNewerChanges) {
+    PassBy::EncounterStore store;
+    for (uint32_t i = 0; i < 100; ++i) {
+        store.record(PassBy::testDeviceId(i), i, "");
+    }
+    uint64_t generation = store.generation();
+
+    store.record(PassBy::testDeviceId(7), 200, "");
+    store.record(PassBy::testDeviceId(500), 201, "");
+
+    std::vector<PassBy::DeviceId> changed;
+    bool complete = store.changesSince(generation, 300,
+        [&](const PassBy::EncounterRecord& record) { changed.push_back(record.id); },
+        [](const PassBy::DeviceId&) { FAIL() << "nothing was removed"; });
+    EXPECT_TRUE(complete);
+    ASSERT_EQ(changed.size(), 2u);
+    EXPECT_EQ(changed[0], PassBy::testDeviceId(500));
+    EXPECT_EQ(changed[1], PassBy::testDeviceId(7));
+}
+
+TEST(EncounterStoreTest, ChangesSinceReportsRemovals) {
+    PassBy::EncounterStore store;
+    store.configure(1000, 0);
+    store.record(PassBy::testDeviceId(1), 0, "");
+    uint64_t generation = store.generation();
+
+    // The expiry hand retires device 1 while device 2 is recorded
+    store.record(PassBy::testDeviceId(2), 5000, "");
+
+    std::vector<PassBy::DeviceId> removed;
+    store.changesSince(generation, 5000, [](const PassBy::EncounterRecord&) {},
+                       [&](const PassBy::DeviceId& id) { removed.push_back(id); });
+    ASSERT_EQ(removed.size(), 1u);
+    EXPECT_EQ(removed[0], PassBy::testDeviceId(1));
+}
+
+TEST(EncounterStoreTest, ChangesSinceReportsExpiredRecords) {
+    PassBy::EncounterStore store;
+    store.configure(1000, 0);
+    store.record(PassBy::testDeviceId(1), 0, "");
+    uint64_t generation = store.generation();
+
+    // Nothing else is recorded, so only the sweep can retire device 1
+    store.expireStale(100000);
+
+    std::vector<PassBy::DeviceId> removed;
+    EXPECT_TRUE(store.changesSince(generation, 100000, [](const PassBy::EncounterRecord&) {},
+                                   [&](const PassBy::DeviceId& id) { removed.push_back(id); }));
+    ASSERT_EQ(removed.size(), 1u);
+    EXPECT_EQ(removed[0], PassBy::testDeviceId(1));
+    EXPECT_EQ(store.size(), 0u);
+    EXPECT_EQ(store.expiredCount(), 1u);
+}
+
+TEST(EncounterStoreTest, ChangesSinceFailsAfterClear) {
+    PassBy::EncounterStore store;
+    store.record(PassBy::testDeviceId(1), 0, "");
+    uint64_t generation = store.generation();
+    store.clear();
+    store.record(PassBy::testDeviceId(2), 0, "");
+
+    auto ignoreRecord = [](const PassBy::EncounterRecord&) {};
+    auto ignoreId = [](const PassBy::DeviceId&) {};
+    EXPECT_FALSE(store.changesSince(generation, 0, ignoreRecord, ignoreId));
+    EXPECT_TRUE(store.changesSince(store.generation(), 0, ignoreRecord, ignoreId));
+}
+
+TEST(EncounterStoreTest, RetainedHistoryShowsAnEarlierGeneration) {
+    PassBy::EncounterStore store;
+    store.configure(1000, 0);
+    store.record(PassBy::testDeviceId(1), 0, "alias-1");
+    store.record(PassBy::testDeviceId(2), 500, "");
+    store.retainHistory(true);
+    uint64_t generation = store.generation();
+
+    // Device 1 expires and comes back, device 2 is updated, device 3 is new, then all go
+    store.record(PassBy::testDeviceId(1), 1200, "alias-1");
+    store.record(PassBy::testDeviceId(2), 1300, "");
+    store.record(PassBy::testDeviceId(3), 1300, "");
+    auto visit = [&](int64_t nowMs) {
+        std::vector<std::pair<uint32_t, std::string>> seen;
+        store.forEachAsOf(generation, nowMs, [&](const PassBy::EncounterRecord& record, std::string_view alias) {
+            seen.emplace_back(record.hitCount, std::string(alias));
+        });
+        std::sort(seen.begin(), seen.end());
+        return seen;
+    };
+    using Seen = std::vector<std::pair<uint32_t, std::string>>;
+    EXPECT_EQ(visit(900), (Seen{{1, "alias-1"}, {2, ""}}));
+    store.clear();
+    EXPECT_EQ(visit(900), (Seen{{1, "alias-1"}, {2, ""}}));
+
+    // Only what was live then
+    EXPECT_EQ(visit(1100), (Seen{{2, ""}}));
+
+    // Nothing is kept once the last reader is done
+    store.retainHistory(false);
+    EXPECT_TRUE(visit(900).empty());
+}
+
+class EncounterPolicyTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        PassBy::TestPassByManager::resetForTesting();
+    }
+
+    void TearDown() override {
+        PassBy::TestPassByManager::resetForTesting();
+    }
+};
+
+TEST_F(EncounterPolicyTest, EncountersReportHits) {
+    auto& manager = PassBy::PassByManager::getInstance();
+
+    PassBy::PassByBridge::onDeviceDiscovered("device-1");
+    PassBy::PassByBridge::onDeviceDiscovered("device-1");
+    PassBy::PassByBridge::onDeviceDiscovered("device-2");
+    manager.flushEvents();
+
+    auto encounters = manager.getEncounters();
+    ASSERT_EQ(encounters.size(), 2u);
+    for (const auto& encounter : encounters) {
+        EXPECT_EQ(encounter.hitCount, encounter.uuid == "device-1" ? 2u : 1u);
+        EXPECT_LE(encounter.firstSeen, encounter.lastSeen);
+    }
+}
+
+TEST_F(EncounterPolicyTest, TimeToLiveForgetsDevices) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    PassBy::EncounterPolicy policy;
+    policy.timeToLive = std::chrono::milliseconds(50);
+    manager.setEncounterPolicy(policy);
+
+    PassBy::PassByBridge::onDeviceDiscovered("device-1");
+    manager.flushEvents();
+    EXPECT_EQ(manager.getDiscoveredDevices().size(), 1u);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(80));
+    EXPECT_TRUE(manager.getDiscoveredDevices().empty());
+}
+
+TEST_F(EncounterPolicyTest, MemoryLimitBoundsStore) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    PassBy::EncounterPolicy policy;
+    policy.maxMemoryBytes = 16 * 1024;
+    manager.setEncounterPolicy(policy);
+
+    for (int i = 0; i < 2000; ++i) {
+        PassBy::PassByBridge::onDeviceDiscovered(PassBy::testDeviceId(i).toString());
+        if (i % 500 == 0) {
+            manager.flushEvents();
+        }
+    }
+    manager.flushEvents();
+
+    EXPECT_LE(manager.getEncounterMemoryUsage(), policy.maxMemoryBytes);
+    EXPECT_EQ(manager.getDiscoveredDevices().size(), PassBy::EncounterStore::recordsForBudget(policy.maxMemoryBytes));
+}
+
+TEST_F(EncounterPolicyTest, DeltaReturnsOnlyChanges) {
+    auto& manager = PassBy::PassByManager::getInstance();
+
+    PassBy::PassByBridge::onDeviceDiscovered("device-1");
+    PassBy::PassByBridge::onDeviceDiscovered("device-2");
+    manager.flushEvents();
+
+    auto delta = manager.getDiscoveredSince(0);
+    EXPECT_FALSE(delta.reset);
+    EXPECT_EQ(delta.changed.size(), 2u);
+
+    PassBy::PassByBridge::onDeviceDiscovered("device-2");
+    manager.flushEvents();
+    delta = manager.getDiscoveredSince(delta.generation);
+    ASSERT_EQ(delta.changed.size(), 1u);
+    EXPECT_EQ(delta.changed[0].uuid, "device-2");
+    EXPECT_EQ(delta.changed[0].hitCount, 2u);
+
+    // Nothing new
+    delta = manager.getDiscoveredSince(delta.generation);
+    EXPECT_TRUE(delta.changed.empty());
+    EXPECT_TRUE(delta.removed.empty());
+
+    // After a clear the caller is told to resynchronize
+    uint64_t before = delta.generation;
+    manager.clearDiscoveredDevices();
+    PassBy::PassByBridge::onDeviceDiscovered("device-3");
+    manager.flushEvents();
+    delta = manager.getDiscoveredSince(before);
+    EXPECT_TRUE(delta.reset);
+    ASSERT_EQ(delta.changed.size(), 1u);
+    EXPECT_EQ(delta.changed[0].uuid, "device-3");
+}
+
+TEST_F(EncounterPolicyTest, VisitEncountersSeesEveryDevice) {
+    auto& manager = PassBy::PassByManager::getInstance();
+
+    PassBy::PassByBridge::onDeviceDiscovered("12345678-1234-1234-1234-123456789ABC");
+    PassBy::PassByBridge::onDeviceDiscovered("device-1");
+    manager.flushEvents();
+
+    std::vector<std::string> seen;
+    manager.visitEncounters([&](const PassBy::EncounterView& view) {
+        seen.emplace_back(view.uuid);
+        EXPECT_EQ(view.hitCount, 1u);
+    });
+    std::sort(seen.begin(), seen.end());
+    ASSERT_EQ(seen.size(), 2u);
+    EXPECT_EQ(seen[0], "12345678-1234-1234-1234-123456789ABC");
+    EXPECT_EQ(seen[1], "device-1");
+}
@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "PassBy/EphemeralId.h"
+#include "../src/internal/Sha256.h"
+
+namespace {
+
+constexpr int64_t kIntervalMs = 15 * 60 * 1000;
+
+std::string hex(const uint8_t* bytes, size_t length) {
+    static const char kDigits[] = "0123456789abcdef";
+    std::string out;
+    for (size_t i = 0; i < length; ++i) {
+        out.push_back(kDigits[bytes[i] >> 4]);
+        out.push_back(kDigits[bytes[i] & 0xF]);
+    }
+    return out;
+}
+
+std::string sha256(const std::string& text, size_t split = 0) {
+    PassBy::Sha256 hash;
+    hash.update(text.data(), split);
+    hash.update(text.data() + split, text.size() - split);
+    uint8_t digest[PassBy::Sha256::kDigestSize];
+    hash.finish(digest);
+    return hex(digest, sizeof(digest));
+}
+
+std::string hmac(const std::vector<uint8_t>& key, const std::string& text) {
+    uint8_t digest[PassBy::Sha256::kDigestSize];
+    PassBy::hmacSha256(key.data(), key.size(), text.data(), text.size(), nullptr, 0, digest);
+    return hex(digest, sizeof(digest));
+}
+
+PassBy::ContactSecret secretFor(uint32_t n) {
+    PassBy::ContactSecret secret{};
+    std::memcpy(secret.data(), &n, sizeof(n));
+    secret[31] = 0x5A;
+    return secret;
+}
+
+PassBy::DeviceId contactFor(uint32_t n) {
+    uint8_t bytes[PassBy::DeviceId::kSize] = {0xC0};
+    std::memcpy(bytes + 12, &n, sizeof(n));
+    return PassBy::DeviceId::fromBytes(bytes);
+}
+
+} // namespace
+
+TEST(Sha256Test, MatchesKnownDigests) {
+    EXPECT_EQ(sha256(""), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    EXPECT_EQ(sha256("abc"), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    const std::string twoBlocks = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    EXPECT_EQ(sha256(twoBlocks), "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+    EXPECT_EQ(sha256(twoBlocks, 13), sha256(twoBlocks));
+}
+
+TEST(Sha256Test, HmacMatchesRfc4231) {
+    EXPECT_EQ(hmac(std::vector<uint8_t>(20, 0x0b), "Hi There"),
+              "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7");
+    EXPECT_EQ(hmac({'J', 'e', 'f', 'e'}, "what do ya want for nothing?"),
+              "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843");
+    EXPECT_EQ(hmac(std::vector<uint8_t>(131, 0xaa), "Test Using Larger Than Block-Size Key - Hash Key First"),
+              "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54");
+}
+
+TEST(EphemeralIdTest, RotatesPerInterval) {
+    PassBy::ContactSecret secret = secretFor(1);
+    PassBy::DeviceId first = PassBy::EphemeralId::derive(secret, 100);
+    EXPECT_EQ(PassBy::EphemeralId::derive(secret, 100), first);
+    EXPECT_NE(PassBy::EphemeralId::derive(secret, 101), first);
+    EXPECT_NE(PassBy::EphemeralId::derive(secretFor(2), 100), first);
+
+    // A version 4 UUID
+    EXPECT_EQ(first.bytes()[6] >> 4, 4);
+    EXPECT_EQ(first.bytes()[8] >> 6, 2);
+
+    std::chrono::milliseconds interval(kIntervalMs);
+    EXPECT_EQ(PassBy::EphemeralId::intervalAt(kIntervalMs * 7 + 5, interval), 7);
+    EXPECT_EQ(PassBy::EphemeralId::intervalAt(-1, interval), -1);
+}
+
+TEST(EphemeralIdTableTest, ResolvesEveryIdentifierInTheWindow) {
+    PassBy::EphemeralTableOptions options;
+    options.pastIntervals = 2;
+    options.futureIntervals = 1;
+    PassBy::EphemeralIdTable table(options);
+    for (uint32_t i = 0; i < 10; ++i) {
+        table.addContact(contactFor(i), secretFor(i));
+    }
+
+    const int64_t now = 1000 * kIntervalMs + 123;
+    table.advanceTo(now);
+    EXPECT_EQ(table.firstInterval(), 998);
+    EXPECT_EQ(table.lastInterval(), 1001);
+    EXPECT_EQ(table.size(), 40u);
+
+    PassBy::EphemeralMatch match;
+    ASSERT_TRUE(table.resolve(PassBy::EphemeralId::derive(secretFor(7), 1001), &match));
+    EXPECT_EQ(match.contact, contactFor(7));
+    EXPECT_EQ(match.interval, 1001);
+    EXPECT_FALSE(table.resolve(PassBy::EphemeralId::derive(secretFor(7), 1002), &match));
+    EXPECT_FALSE(table.resolve(PassBy::EphemeralId::derive(secretFor(42), 1000), &match));
+
+    // Rolling forward drops the oldest intervals and derives the new ones
+    table.advanceTo(now + 2 * kIntervalMs);
+    EXPECT_EQ(table.firstInterval(), 1000);
+    EXPECT_EQ(table.size(), 40u);
+    EXPECT_FALSE(table.resolve(PassBy::EphemeralId::derive(secretFor(3), 999), nullptr));
+    EXPECT_TRUE(table.resolve(PassBy::EphemeralId::derive(secretFor(3), 1003), nullptr));
+
+    // Contacts come and go within the window
+    EXPECT_TRUE(table.removeContact(contactFor(3)));
+    EXPECT_FALSE(table.removeContact(contactFor(3)));
+    EXPECT_FALSE(table.resolve(PassBy::EphemeralId::derive(secretFor(3), 1003), nullptr));
+    EXPECT_EQ(table.size(), 36u);
+    table.addContact(contactFor(50), secretFor(50));
+    EXPECT_TRUE(table.resolve(PassBy::EphemeralId::derive(secretFor(50), 1000), &match));
+    EXPECT_EQ(match.contact, contactFor(50));
+    EXPECT_EQ(table.contactCount(), 10u);
+
+    // A replaced secret no longer resolves
+    table.addContact(contactFor(50), secretFor(51));
+    EXPECT_FALSE(table.resolve(PassBy::EphemeralId::derive(secretFor(50), 1000), nullptr));
+    EXPECT_TRUE(table.resolve(PassBy::EphemeralId::derive(secretFor(51), 1000), nullptr));
+    EXPECT_EQ(table.size(), 40u);
+
+    // Jumping far ahead rebuilds
+    table.advanceTo(now + 100 * kIntervalMs);
+    EXPECT_EQ(table.size(), 40u);
+    EXPECT_TRUE(table.resolve(PassBy::EphemeralId::derive(secretFor(0), 1100), nullptr));
+}
+
+TEST(EphemeralIdTableTest, ParallelBuildMatchesSerial) {
+    std::vector<std::pair<PassBy::DeviceId, PassBy::ContactSecret>> contacts;
+    for (uint32_t i = 0; i < 2000; ++i) {
+        contacts.emplace_back(contactFor(i), secretFor(i));
+    }
+    PassBy::EphemeralTableOptions serialOptions;
+    serialOptions.threads = 1;
+    PassBy::EphemeralTableOptions parallelOptions;
+    parallelOptions.threads = 4;
+
+    PassBy::EphemeralIdTable serial(serialOptions);
+    PassBy::EphemeralIdTable parallel(parallelOptions);
+    const int64_t now = 5000 * kIntervalMs;
+    serial.addContacts(contacts);
+    serial.advanceTo(now);
+    parallel.advanceTo(now);
+    parallel.addContacts(contacts);
+    ASSERT_EQ(serial.size(), contacts.size() * 6);
+    ASSERT_EQ(parallel.size(), serial.size());
+
+    for (uint32_t i = 0; i < contacts.size(); i += 7) {
+        for (int64_t interval = serial.firstInterval(); interval <= serial.lastInterval(); ++interval) {
+            PassBy::EphemeralMatch match;
+            ASSERT_TRUE(parallel.resolve(PassBy::EphemeralId::derive(secretFor(i), interval), &match));
+            EXPECT_EQ(match.contact, contactFor(i));
+            EXPECT_EQ(match.interval, interval);
+        }
+    }
+}
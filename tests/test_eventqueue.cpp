@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include "PassBy/PassBy.h"
+#include "../src/internal/PassByBridge.h"
+#include "../src/internal/MPSCRingBuffer.h"
+#include "TestPassByManager.h"
+
+TEST(MPSCRingBufferTest, PushAndConsumeInOrder) {
+    PassBy::MPSCRingBuffer<int> queue(8);
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_TRUE(queue.tryPush([i](int& slot) { slot = i; }));
+    }
+    EXPECT_EQ(queue.sizeApprox(), 5u);
+
+    std::vector<int> received;
+    while (queue.tryConsume([&](int& value) { received.push_back(value); })) {
+    }
+    EXPECT_EQ(received, (std::vector<int>{0, 1, 2, 3, 4}));
+    EXPECT_FALSE(queue.hasPending());
+}
+
+TEST(MPSCRingBufferTest, RejectsWhenFull) {
+    PassBy::MPSCRingBuffer<int> queue(4);
+    ASSERT_EQ(queue.capacity(), 4u);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(queue.tryPush([i](int& slot) { slot = i; }));
+    }
+    EXPECT_FALSE(queue.tryPush([](int& slot) { slot = 99; }));
+
+    // Space frees up once the consumer catches up, including after wrap-around
+    EXPECT_TRUE(queue.tryConsume([](int&) {}));
+    EXPECT_TRUE(queue.tryPush([](int& slot) { slot = 4; }));
+}
+
+TEST(MPSCRingBufferTest, MultipleProducersDeliverEverything) {
+    constexpr int kProducers = 4;
+    constexpr int kPerProducer = 10000;
+    PassBy::MPSCRingBuffer<int> queue(256);
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&queue, p] {
+            for (int i = 0; i < kPerProducer; ++i) {
+                int value = p * kPerProducer + i;
+                while (!queue.tryPush([value](int& slot) { slot = value; })) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    // Per-producer FIFO order must hold
+    std::vector<int> lastSeen(kProducers, -1);
+    int consumed = 0;
+    while (consumed < kProducers * kPerProducer) {
+        bool got = queue.tryConsume([&](int& value) {
+            int producer = value / kPerProducer;
+            EXPECT_GT(value, lastSeen[producer]);
+            lastSeen[producer] = value;
+        });
+        if (got) {
+            ++consumed;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+    EXPECT_FALSE(queue.hasPending());
+}
+
+class DispatchThreadTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        PassBy::TestPassByManager::resetForTesting();
+    }
+
+    void TearDown() override {
+        PassBy::TestPassByManager::resetForTesting();
+    }
+};
+
+TEST_F(DispatchThreadTest, CallbacksRunOnDispatchThread) {
+    auto& manager = PassBy::PassByManager::getInstance();
+
+    std::thread::id callbackThread;
+    manager.setDeviceDiscoveredCallback([&](const PassBy::DeviceInfo&) {
+        callbackThread = std::this_thread::get_id();
+    });
+
+    PassBy::PassByBridge::onDeviceDiscovered("device-1");
+    manager.flushEvents();
+
+    EXPECT_NE(callbackThread, std::thread::id());
+    EXPECT_NE(callbackThread, std::this_thread::get_id());
+}
+
+TEST_F(DispatchThreadTest, ConcurrentProducers) {
+    auto& manager = PassBy::PassByManager::getInstance();
+
+    constexpr int kProducers = 4;
+    constexpr int kDevicesPerProducer = 200;
+    std::atomic<int> callbackCount{0};
+    manager.setDeviceDiscoveredCallback([&](const PassBy::DeviceInfo&) {
+        callbackCount.fetch_add(1);
+    });
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([p] {
+            for (int i = 0; i < kDevicesPerProducer; ++i) {
+                PassBy::PassByBridge::onDeviceDiscovered("device-" + std::to_string(p) + "-" + std::to_string(i));
+            }
+        });
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+    manager.flushEvents();
+
+    int delivered = kProducers * kDevicesPerProducer - static_cast<int>(manager.getDroppedEventCount());
+    EXPECT_EQ(callbackCount.load(), delivered);
+    EXPECT_EQ(manager.getDiscoveredDevices().size(), static_cast<size_t>(delivered));
+}
+
+TEST_F(DispatchThreadTest, OversizedIdentifierIsDropped) {
+    auto& manager = PassBy::PassByManager::getInstance();
+
+    PassBy::PassByBridge::onDeviceDiscovered(std::string(200, 'x'));
+    manager.flushEvents();
+
+    EXPECT_EQ(manager.getDroppedEventCount(), 1u);
+    EXPECT_TRUE(manager.getDiscoveredDevices().empty());
+}
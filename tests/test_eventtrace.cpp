@@ -0,0 +1,218 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "PassBy/PassBy.h"
+#include "../src/internal/EventTrace.h"
+#include "../src/internal/PassByBridge.h"
+#include "../src/internal/PlatformInterface.h"
+#include "../src/internal/TraceReplayer.h"
+#include "TestPassByManager.h"
+#include "TestDeviceId.h"
+
+namespace {
+
+long fileSize(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    return static_cast<long>(file.tellg());
+}
+
+std::vector<std::string> sorted(std::vector<std::string> values) {
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+} // namespace
+
+class EventTraceTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        PassBy::TestPassByManager::resetForTesting();
+        path = ::testing::TempDir() + "passby_trace_" +
+               ::testing::UnitTest::GetInstance()->current_test_info()->name() + ".bin";
+        std::remove(path.c_str());
+    }
+
+    void TearDown() override {
+        PassBy::TestPassByManager::resetForTesting();
+        std::remove(path.c_str());
+    }
+
+    std::string path;
+};
+
+TEST_F(EventTraceTest, RoundTripsEveryEventType) {
+    const uint8_t advertisement[] = {0x02, 0x01, 0x06, 0x03, 0x03, 0xAA, 0xFE};
+    PassBy::EventTraceWriter writer;
+    ASSERT_TRUE(writer.open(path, 1700000000000));
+
+    PassBy::TraceEvent text(PassBy::TraceEventType::DeviceDiscovered);
+    text.text = "device-1";
+    writer.append(text);
+    PassBy::TraceEvent id(PassBy::TraceEventType::DeviceIdDiscovered);
+    id.id = PassBy::testDeviceId(1);
+    writer.append(id);
+    PassBy::TraceEvent service(PassBy::TraceEventType::ServiceDeviceDiscovered);
+    service.text = "device-2";
+    service.service = PassBy::testDeviceId(2);
+    service.rssi = -73;
+    writer.append(service);
+    PassBy::TraceEvent raw(PassBy::TraceEventType::PeripheralAdvertisement);
+    raw.id = PassBy::testDeviceId(3);
+    raw.rssi = -40;
+    raw.data = advertisement;
+    raw.length = sizeof(advertisement);
+    writer.append(raw);
+    PassBy::TraceEvent read(PassBy::TraceEventType::PeripheralIdentifierRead);
+    read.id = PassBy::testDeviceId(3);
+    read.text = "device-3";
+    writer.append(read);
+    PassBy::TraceEvent advertising(PassBy::TraceEventType::AdvertisingStarted);
+    advertising.text = "self";
+    advertising.detail = "busy";
+    writer.append(advertising);
+    PassBy::TraceEvent stage(PassBy::TraceEventType::StageLatency);
+    stage.stage = PassBy::PipelineStage::Connect;
+    stage.value = 12345;
+    writer.append(stage);
+    PassBy::TraceEvent rssiId(PassBy::TraceEventType::RssiDeviceIdDiscovered);
+    rssiId.id = PassBy::testDeviceId(4);
+    rssiId.rssi = -61;
+    writer.append(rssiId);
+    PassBy::TraceEvent serviceId(PassBy::TraceEventType::ServiceDeviceIdDiscovered);
+    serviceId.id = PassBy::testDeviceId(5);
+    serviceId.service = PassBy::testDeviceId(2);
+    serviceId.rssi = -62;
+    writer.append(serviceId);
+    EXPECT_EQ(writer.close(), 9u);
+
+    PassBy::EventTraceReader reader;
+    ASSERT_TRUE(reader.open(path));
+    EXPECT_EQ(reader.startWallMs(), 1700000000000);
+    std::vector<PassBy::TraceEvent> events;
+    PassBy::TraceEvent event;
+    while (reader.next(event)) {
+        if (!events.empty()) {
+            EXPECT_GE(event.timeNs, events.back().timeNs);
+        }
+        events.push_back(event);
+    }
+    EXPECT_FALSE(reader.truncated());
+    ASSERT_EQ(events.size(), 9u);
+
+    EXPECT_EQ(events[0].type, PassBy::TraceEventType::DeviceDiscovered);
+    EXPECT_EQ(events[0].text, "device-1");
+    EXPECT_EQ(events[1].id, PassBy::testDeviceId(1));
+    EXPECT_EQ(events[2].text, "device-2");
+    EXPECT_EQ(events[2].service, PassBy::testDeviceId(2));
+    EXPECT_EQ(events[2].rssi, -73);
+    EXPECT_EQ(events[3].id, PassBy::testDeviceId(3));
+    EXPECT_EQ(events[3].rssi, -40);
+    ASSERT_EQ(events[3].length, sizeof(advertisement));
+    EXPECT_TRUE(std::equal(advertisement, advertisement + sizeof(advertisement), events[3].data));
+    EXPECT_EQ(events[4].text, "device-3");
+    EXPECT_FALSE(events[5].success);
+    EXPECT_EQ(events[5].text, "self");
+    EXPECT_EQ(events[5].detail, "busy");
+    EXPECT_EQ(events[6].stage, PassBy::PipelineStage::Connect);
+    EXPECT_EQ(events[6].value, 12345);
+    EXPECT_EQ(events[7].id, PassBy::testDeviceId(4));
+    EXPECT_EQ(events[7].rssi, -61);
+    EXPECT_EQ(events[8].id, PassBy::testDeviceId(5));
+    EXPECT_EQ(events[8].service, PassBy::testDeviceId(2));
+    EXPECT_EQ(events[8].rssi, -62);
+
+    reader.rewind();
+    ASSERT_TRUE(reader.next(event));
+    EXPECT_EQ(event.text, "device-1");
+}
+
+TEST_F(EventTraceTest, TornRecordEndsTheTrace) {
+    PassBy::EventTraceWriter writer;
+    ASSERT_TRUE(writer.open(path, 0));
+    for (int i = 0; i < 3; ++i) {
+        PassBy::TraceEvent event(PassBy::TraceEventType::DeviceDiscovered);
+        event.text = "device-" + std::to_string(i);
+        writer.append(event);
+    }
+    writer.close();
+    ASSERT_EQ(truncate(path.c_str(), fileSize(path) - 2), 0);
+
+    PassBy::EventTraceReader reader;
+    ASSERT_TRUE(reader.open(path));
+    PassBy::TraceEvent event;
+    int count = 0;
+    while (reader.next(event)) {
+        ++count;
+    }
+    EXPECT_EQ(count, 2);
+    EXPECT_TRUE(reader.truncated());
+}
+
+TEST_F(EventTraceTest, RejectsOtherFiles) {
+    PassBy::EventTraceReader reader;
+    EXPECT_FALSE(reader.open(path));
+    std::ofstream(path) << "not a trace, just some text";
+    EXPECT_FALSE(reader.open(path));
+}
+
+TEST_F(EventTraceTest, ReplayReproducesARecordedSession) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    ASSERT_TRUE(manager.startEventTrace(path));
+    PassBy::PassByBridge::onDeviceDiscovered("bridge-device");
+    manager.onDeviceDiscovered(PassBy::testDeviceId(1));
+    manager.onPeripheralIdentifierRead(PassBy::testDeviceId(9), "read-device");
+    manager.onPeripheralConnectionFailed(PassBy::testDeviceId(8));
+    manager.onAdvertisingStarted("self", true);
+    EXPECT_EQ(manager.stopEventTrace(), 5u);
+    manager.onDeviceDiscovered("after-recording");
+    manager.flushEvents();
+    EXPECT_EQ(manager.stopEventTrace(), 0u);
+
+    PassBy::PassByContext replay(nullptr);
+    std::vector<std::string> advertising;
+    replay.setAdvertisingStartedCallback([&](const PassBy::AdvertisingInfo& info) {
+        advertising.push_back(info.peripheralUUID);
+    });
+    PassBy::EventTraceReader reader;
+    ASSERT_TRUE(reader.open(path));
+    PassBy::ReplayOptions options;
+    options.speed = 0;
+    PassBy::ReplayStats stats = PassBy::TraceReplayer::replay(reader, replay, options);
+    replay.flushEvents();
+
+    EXPECT_EQ(stats.events, 5u);
+    EXPECT_FALSE(stats.truncated);
+    EXPECT_EQ(sorted(replay.getDiscoveredDevices()),
+              sorted({"bridge-device", PassBy::testDeviceId(1).toString(), "read-device"}));
+    EXPECT_EQ(advertising, std::vector<std::string>{"self"});
+}
+
+TEST_F(EventTraceTest, ReplayKeepsTheRecordedPace) {
+    PassBy::PassByContext recorded(nullptr);
+    ASSERT_TRUE(recorded.startEventTrace(path));
+    recorded.onDeviceDiscovered("first");
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    recorded.onDeviceDiscovered("second");
+    recorded.stopEventTrace();
+
+    PassBy::PassByContext replay(nullptr);
+    PassBy::EventTraceReader reader;
+    ASSERT_TRUE(reader.open(path));
+    PassBy::ReplayOptions options;
+    options.speed = 2.0;
+    PassBy::ReplayStats stats = PassBy::TraceReplayer::replay(reader, replay, options);
+    EXPECT_EQ(stats.events, 2u);
+    EXPECT_GE(stats.traceDuration, std::chrono::milliseconds(40));
+    EXPECT_GE(stats.elapsed, stats.traceDuration / 2);
+
+    reader.rewind();
+    options.speed = 0;
+    stats = PassBy::TraceReplayer::replay(reader, replay, options);
+    EXPECT_LT(stats.elapsed, stats.traceDuration);
+}
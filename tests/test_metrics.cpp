@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "PassBy/PassBy.h"
+#include "../src/internal/LatencyHistogram.h"
+#include "TestPassByManager.h"
+
+using PassBy::LatencyHistogram;
+
+TEST(LatencyHistogramTest, BucketsBoundTheirValues) {
+    size_t previous = 0;
+    for (uint64_t value = 0; value < (uint64_t(1) << 20); value = value < 64 ? value + 1 : value + value / 7) {
+        size_t bucket = LatencyHistogram::bucketFor(value);
+        ASSERT_LT(bucket, LatencyHistogram::kBucketCount);
+        ASSERT_GE(bucket, previous);
+        ASSERT_GE(LatencyHistogram::bucketUpperBound(bucket), value);
+        if (bucket > 0) {
+            ASSERT_LT(LatencyHistogram::bucketUpperBound(bucket - 1), value);
+        }
+        // Within 1/16 of the value above the exact range
+        ASSERT_LE(LatencyHistogram::bucketUpperBound(bucket) - value, value / 16);
+        previous = bucket;
+    }
+    EXPECT_EQ(LatencyHistogram::bucketFor(LatencyHistogram::kMaxValue), LatencyHistogram::kBucketCount - 1);
+}
+
+TEST(LatencyHistogramTest, SummarizesPercentiles) {
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.summary().count, 0u);
+
+    for (uint64_t value = 1; value <= 1000; ++value) {
+        histogram.record(value * 100);
+    }
+    PassBy::LatencySummary summary = histogram.summary();
+    EXPECT_EQ(summary.count, 1000u);
+    EXPECT_EQ(summary.min.count(), 100);
+    EXPECT_EQ(summary.max.count(), 100000);
+    EXPECT_EQ(summary.mean.count(), 50050);
+    EXPECT_NEAR(summary.p50.count(), 50000, 50000 / 16);
+    EXPECT_NEAR(summary.p90.count(), 90000, 90000 / 16);
+    EXPECT_NEAR(summary.p99.count(), 99000, 99000 / 16);
+    EXPECT_LE(summary.p99, summary.max);
+
+    histogram.reset();
+    EXPECT_EQ(histogram.summary().count, 0u);
+}
+
+TEST(LatencyHistogramTest, RecordsFromManyThreads) {
+    LatencyHistogram histogram;
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < 4; ++thread) {
+        threads.emplace_back([&histogram, thread] {
+            for (uint64_t i = 0; i < 10000; ++i) {
+                histogram.record(thread * 1000 + i % 1000);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    PassBy::LatencySummary summary = histogram.summary();
+    EXPECT_EQ(summary.count, 40000u);
+    EXPECT_EQ(summary.min.count(), 0);
+    EXPECT_EQ(summary.max.count(), 3999);
+}
+
+class MetricsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        PassBy::TestPassByManager::resetForTesting();
+        if (!PassBy::PassByManager::getInstance().getMetricsSnapshot().enabled) {
+            GTEST_SKIP() << "Built without PASSBY_ENABLE_METRICS";
+        }
+    }
+
+    void TearDown() override {
+        PassBy::TestPassByManager::resetForTesting();
+    }
+};
+
+TEST_F(MetricsTest, TimesDeliveryAndAdvertisements) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    manager.setDeviceDiscoveredCallback([](const PassBy::DeviceInfo&) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    });
+
+    manager.onDeviceDiscovered("device-1");
+    manager.onDeviceDiscovered("device-2");
+    manager.onDeviceDiscovered(std::string(100, 'x'));     // Too long: dropped
+    uint8_t bytes[PassBy::DeviceId::kSize] = {1};
+    manager.onPeripheralDiscovered(PassBy::DeviceId::fromBytes(bytes), -60);
+    manager.flushEvents();
+
+    PassBy::MetricsSnapshot metrics = manager.getMetricsSnapshot();
+    EXPECT_EQ(metrics.discoveries, 2u);
+    EXPECT_EQ(metrics.advertisements, 1u);
+    EXPECT_EQ(metrics.droppedEvents, 1u);
+    EXPECT_EQ(metrics.queueDepth, 0u);
+    EXPECT_GE(metrics.maxQueueDepth, 1u);
+
+    const PassBy::LatencySummary& delivery = metrics[PassBy::PipelineStage::Delivery];
+    EXPECT_EQ(delivery.count, 2u);
+    EXPECT_GE(delivery.min, std::chrono::milliseconds(2));      // Includes the callback
+    EXPECT_LE(delivery.min, delivery.p50);
+    EXPECT_LE(delivery.p50, delivery.max);
+    EXPECT_EQ(metrics[PassBy::PipelineStage::Advertisement].count, 1u);
+    EXPECT_EQ(metrics[PassBy::PipelineStage::Connect].count, 0u);
+}
+
+TEST_F(MetricsTest, RecordsPlatformStages) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    manager.recordStageLatency(PassBy::PipelineStage::Connect, std::chrono::microseconds(1500));
+    manager.recordStageLatency(PassBy::PipelineStage::Connect, std::chrono::microseconds(2500));
+    manager.recordStageLatency(PassBy::PipelineStage::CharacteristicRead, std::chrono::microseconds(700));
+
+    PassBy::MetricsSnapshot metrics = manager.getMetricsSnapshot();
+    const PassBy::LatencySummary& connect = metrics[PassBy::PipelineStage::Connect];
+    EXPECT_EQ(connect.count, 2u);
+    EXPECT_EQ(connect.min.count(), 1500);
+    EXPECT_EQ(connect.max.count(), 2500);
+    EXPECT_EQ(connect.mean.count(), 2000);
+    EXPECT_EQ(metrics[PassBy::PipelineStage::CharacteristicRead].count, 1u);
+    EXPECT_EQ(metrics[PassBy::PipelineStage::ServiceDiscovery].count, 0u);
+}
+
+TEST_F(MetricsTest, CountsFilteredDiscoveries) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    PassBy::SubscriptionFilter filter;
+    filter.identifierPrefixes = {"wanted-"};
+    ASSERT_NE(manager.subscribe(filter, [](const PassBy::DeviceInfo&) {}), 0u);
+
+    manager.onDeviceDiscovered("wanted-1");
+    manager.onDeviceDiscovered("other-1");
+    manager.onDeviceDiscovered("other-2");
+    manager.flushEvents();
+
+    PassBy::MetricsSnapshot metrics = manager.getMetricsSnapshot();
+    EXPECT_EQ(metrics.discoveries, 1u);
+    EXPECT_EQ(metrics.filteredDiscoveries, 2u);
+}
@@ -1,4 +1,6 @@
 #include <gtest/gtest.h>
+#include <thread>
+#include <vector>
 #include "PassBy/PassBy.h"
 #include "../src/internal/PassByBridge.h"
 #include "TestPassByManager.h"
@@ -78,6 +80,7 @@ TEST_F(PassByManagerTest, DeviceDiscoveryViaBridge) {
     // Simulate device discovery via bridge
     PassBy::PassByBridge::onDeviceDiscovered("test-uuid-1");
     PassBy::PassByBridge::onDeviceDiscovered("test-uuid-2");
+    manager.flushEvents();
     
     // Check callback was called
     EXPECT_EQ(discoveredDevices.size(), 2);
@@ -105,6 +108,7 @@ TEST_F(PassByManagerTest, GetDiscoveredDevices) {
     PassBy::PassByBridge::onDeviceDiscovered("device-1");
     PassBy::PassByBridge::onDeviceDiscovered("device-2");
     PassBy::PassByBridge::onDeviceDiscovered("device-1"); // Duplicate should be ignored
+    manager.flushEvents();
     
     devices = manager.getDiscoveredDevices();
     EXPECT_EQ(devices.size(), 2);
@@ -134,6 +138,7 @@ TEST_F(PassByManagerTest, ClearDiscoveredDevices) {
     // Add devices
     PassBy::PassByBridge::onDeviceDiscovered("device-1");
     PassBy::PassByBridge::onDeviceDiscovered("device-2");
+    manager.flushEvents();
     
     auto devices = manager.getDiscoveredDevices();
     EXPECT_EQ(devices.size(), 2);
@@ -215,6 +220,7 @@ TEST_F(PassByManagerTest, AdvertisingStartedSuccess) {
     manager.startScanning();
     // 成功ケースをシミュレート
     manager.onAdvertisingStarted("uuid-success-123", true);
+    manager.flushEvents();
     
     EXPECT_TRUE(callbackCalled);
     EXPECT_TRUE(receivedInfo.success);
@@ -236,6 +242,7 @@ TEST_F(PassByManagerTest, AdvertisingStartedFailure) {
     manager.startScanning();
     // 失敗ケースをシミュレート
     manager.onAdvertisingStarted("", false, "Bluetooth not available");
+    manager.flushEvents();
     
     EXPECT_TRUE(callbackCalled);
     EXPECT_FALSE(receivedInfo.success);
@@ -250,4 +257,51 @@ TEST_F(PassByManagerTest, AdvertisingStartedWithoutCallback) {
     // コールバック未設定でonAdvertisingStartedを呼んでもクラッシュしないことを確認
     EXPECT_NO_THROW(manager.onAdvertisingStarted("uuid-test", true));
     EXPECT_NO_THROW(manager.onAdvertisingStarted("", false, "Error"));
-}
\ No newline at end of file
+}
+
+TEST_F(PassByManagerTest, ContextsAreIndependent) {
+    PassBy::PassByContext first;
+    PassBy::PassByContext second;
+    
+    EXPECT_TRUE(first.startScanning("service-1"));
+    EXPECT_TRUE(second.startScanning("service-2"));
+    EXPECT_EQ(first.getCurrentServiceUUID(), "service-1");
+    EXPECT_EQ(second.getCurrentServiceUUID(), "service-2");
+    
+    first.onDeviceDiscovered("device-a");
+    second.onDeviceDiscovered("device-b");
+    second.onDeviceDiscovered("device-c");
+    first.flushEvents();
+    second.flushEvents();
+    EXPECT_EQ(first.getDiscoveredDevices(), std::vector<std::string>{"device-a"});
+    EXPECT_EQ(second.getDiscoveredDevices().size(), 2u);
+    
+    EXPECT_TRUE(first.stopScanning());
+    EXPECT_TRUE(second.isScanning());
+}
+
+TEST_F(PassByManagerTest, BridgeRoutesToTheDefaultContextOnly) {
+    PassBy::PassByContext context;
+    auto& manager = PassBy::PassByManager::getInstance();
+    EXPECT_EQ(PassBy::PassByBridge::getManager(), &manager);
+    
+    PassBy::PassByBridge::onDeviceDiscovered("bridge-device");
+    manager.flushEvents();
+    context.flushEvents();
+    EXPECT_EQ(manager.getDiscoveredDevices().size(), 1u);
+    EXPECT_TRUE(context.getDiscoveredDevices().empty());
+}
+
+TEST_F(PassByManagerTest, GetInstanceIsSharedAcrossThreads) {
+    std::vector<PassBy::PassByManager*> seen(8, nullptr);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < seen.size(); ++i) {
+        threads.emplace_back([&seen, i] { seen[i] = &PassBy::PassByManager::getInstance(); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (auto* manager : seen) {
+        EXPECT_EQ(manager, &PassBy::PassByManager::getInstance());
+    }
+}
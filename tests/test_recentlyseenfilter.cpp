@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "PassBy/PassBy.h"
+#include "../src/internal/RecentlySeenFilter.h"
+#include "TestPassByManager.h"
+#include "TestDeviceId.h"
+
+namespace {
+
+constexpr int64_t kHourMs = 3600 * 1000;
+
+} // namespace
+
+TEST(RecentlySeenFilterTest, RemembersForTheWindow) {
+    PassBy::RecentlySeenFilter filter(3, kHourMs, 1000, 0.01);
+    int64_t start = 100 * kHourMs;
+
+    EXPECT_FALSE(filter.testAndInsert(PassBy::testDeviceId(1), start));
+    EXPECT_TRUE(filter.testAndInsert(PassBy::testDeviceId(1), start + 1));
+    EXPECT_FALSE(filter.contains(PassBy::testDeviceId(2), start));
+
+    // Still in the window two slices later, gone once its slice is the fourth
+    EXPECT_TRUE(filter.contains(PassBy::testDeviceId(1), start + 2 * kHourMs));
+    filter.insert(PassBy::testDeviceId(3), start + 2 * kHourMs);
+    EXPECT_FALSE(filter.contains(PassBy::testDeviceId(1), start + 3 * kHourMs));
+    EXPECT_TRUE(filter.contains(PassBy::testDeviceId(3), start + 3 * kHourMs));
+
+    // A repeat moves the device into the current slice
+    filter.insert(PassBy::testDeviceId(3), start + 4 * kHourMs);
+    EXPECT_TRUE(filter.contains(PassBy::testDeviceId(3), start + 6 * kHourMs));
+
+    filter.clear();
+    EXPECT_FALSE(filter.contains(PassBy::testDeviceId(3), start + 6 * kHourMs));
+}
+
+TEST(RecentlySeenFilterTest, ClockSteppingBackKeepsTheNewestSlice) {
+    PassBy::RecentlySeenFilter filter(2, kHourMs, 1000, 0.01);
+    int64_t start = 10 * kHourMs;
+    filter.insert(PassBy::testDeviceId(1), start);
+    filter.insert(PassBy::testDeviceId(2), start - 5 * kHourMs);
+    EXPECT_TRUE(filter.contains(PassBy::testDeviceId(1), start));
+    EXPECT_TRUE(filter.contains(PassBy::testDeviceId(2), start));
+}
+
+TEST(RecentlySeenFilterTest, HoldsTheFalsePositiveRateAtCapacity) {
+    const size_t capacity = 20000;
+    const double rate = 0.01;
+    PassBy::RecentlySeenFilter filter(4, kHourMs, capacity, rate);
+
+    // Every slice filled to capacity with distinct devices
+    for (uint32_t slice = 0; slice < 4; ++slice) {
+        for (uint32_t i = 0; i < capacity; ++i) {
+            filter.insert(PassBy::testDeviceId(slice * capacity + i), slice * kHourMs);
+        }
+    }
+    const int64_t now = 3 * kHourMs;
+    for (uint32_t i = 0; i < 4 * capacity; i += 97) {
+        ASSERT_TRUE(filter.contains(PassBy::testDeviceId(i), now));
+    }
+
+    size_t falsePositives = 0;
+    const size_t probes = 200000;
+    for (uint32_t i = 0; i < probes; ++i) {
+        falsePositives += filter.contains(PassBy::testDeviceId(i, 0xF0), now) ? 1 : 0;
+    }
+    EXPECT_LT(static_cast<double>(falsePositives) / probes, rate * 1.5);
+}
+
+TEST(RecentlySeenFilterTest, MemoryDoesNotGrow) {
+    PassBy::RecentlySeenFilter filter(7, 24 * kHourMs, 100000, 0.001);
+    size_t memory = filter.memoryUsage();
+    EXPECT_LT(memory, 2u * 1024 * 1024);
+    for (uint32_t i = 0; i < 1000000; ++i) {
+        filter.insert(PassBy::testDeviceId(i), static_cast<int64_t>(i) * 1000);
+    }
+    EXPECT_EQ(filter.memoryUsage(), memory);
+}
+
+class DuplicateFilterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        PassBy::TestPassByManager::resetForTesting();
+    }
+
+    void TearDown() override {
+        PassBy::TestPassByManager::resetForTesting();
+    }
+};
+
+TEST_F(DuplicateFilterTest, ReportsEachDeviceOncePerHorizon) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    std::vector<std::string> reported;
+    manager.setDeviceDiscoveredCallback([&](const PassBy::DeviceInfo& device) { reported.push_back(device.uuid); });
+    PassBy::DuplicateFilterOptions options;
+    options.enabled = true;
+    options.devicesPerSlice = 1000;
+    manager.setDuplicateFilter(options);
+
+    manager.onDeviceDiscovered("device-a");
+    manager.onDeviceDiscovered("device-b");
+    manager.onDeviceDiscovered("device-a");
+    manager.onDeviceDiscovered("device-a");
+    manager.flushEvents();
+    EXPECT_EQ(reported, (std::vector<std::string>{"device-a", "device-b"}));
+
+    // Repeats still count as sightings
+    for (const auto& encounter : manager.getEncounters()) {
+        EXPECT_EQ(encounter.hitCount, encounter.uuid == "device-a" ? 3u : 1u);
+    }
+    if (manager.getMetricsSnapshot().enabled) {
+        EXPECT_EQ(manager.getMetricsSnapshot().duplicateDiscoveries, 2u);
+    }
+
+    // Clearing forgets the devices, disabling reports every sighting again
+    manager.clearDiscoveredDevices();
+    manager.onDeviceDiscovered("device-a");
+    manager.flushEvents();
+    EXPECT_EQ(reported.size(), 3u);
+    options.enabled = false;
+    manager.setDuplicateFilter(options);
+    manager.onDeviceDiscovered("device-a");
+    manager.flushEvents();
+    EXPECT_EQ(reported.size(), 4u);
+}
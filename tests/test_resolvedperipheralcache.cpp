@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include "../src/internal/ResolvedPeripheralCache.h"
+
+namespace {
+
+PassBy::DeviceId idFor(uint8_t tag, uint32_t n) {
+    uint8_t bytes[PassBy::DeviceId::kSize] = {};
+    bytes[0] = tag;
+    bytes[12] = static_cast<uint8_t>(n >> 24);
+    bytes[13] = static_cast<uint8_t>(n >> 16);
+    bytes[14] = static_cast<uint8_t>(n >> 8);
+    bytes[15] = static_cast<uint8_t>(n);
+    return PassBy::DeviceId::fromBytes(bytes);
+}
+
+PassBy::DeviceId handleFor(uint32_t n) { return idFor(0xCD, n); }
+PassBy::DeviceId peerFor(uint32_t n) { return idFor(0xAB, n); }
+
+} // namespace
+
+TEST(ResolvedPeripheralCacheTest, HitsUntilExpiry) {
+    PassBy::ResolvedPeripheralCache cache;
+    cache.configure(1000, 16);
+    cache.insert(handleFor(1), peerFor(1), true, "", 0);
+
+    const auto* entry = cache.lookup(handleFor(1), 999);
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->id, peerFor(1));
+    EXPECT_TRUE(entry->canonical);
+    EXPECT_EQ(cache.lookup(handleFor(2), 999), nullptr);
+
+    // Expired entries are dropped, so the next advertisement reads the peer again
+    EXPECT_EQ(cache.lookup(handleFor(1), 1000), nullptr);
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_EQ(cache.hitCount(), 1u);
+    EXPECT_EQ(cache.missCount(), 2u);
+}
+
+TEST(ResolvedPeripheralCacheTest, KeepsNonCanonicalText) {
+    PassBy::ResolvedPeripheralCache cache;
+    cache.configure(1000, 16);
+    bool canonical = true;
+    PassBy::DeviceId id = PassBy::DeviceId::fromString("legacy-device", &canonical);
+    ASSERT_FALSE(canonical);
+    cache.insert(handleFor(1), id, false, "legacy-device", 0);
+
+    const auto* entry = cache.lookup(handleFor(1), 10);
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->identifierView(), "legacy-device");
+
+    // A peer that restarted with a new identifier replaces the entry
+    cache.insert(handleFor(1), peerFor(7), true, "", 20);
+    entry = cache.lookup(handleFor(1), 30);
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->id, peerFor(7));
+    EXPECT_TRUE(entry->identifierView().empty());
+    EXPECT_EQ(cache.size(), 1u);
+}
+
+TEST(ResolvedPeripheralCacheTest, SizeBoundEvictsUnusedEntries) {
+    PassBy::ResolvedPeripheralCache cache;
+    cache.configure(60000, 4);
+    for (uint32_t i = 0; i < 4; ++i) {
+        cache.insert(handleFor(i), peerFor(i), true, "", 0);
+    }
+    // Entries 0 and 2 stay in use
+    ASSERT_NE(cache.lookup(handleFor(0), 10), nullptr);
+    ASSERT_NE(cache.lookup(handleFor(2), 10), nullptr);
+
+    cache.insert(handleFor(4), peerFor(4), true, "", 20);
+    cache.insert(handleFor(5), peerFor(5), true, "", 20);
+    EXPECT_EQ(cache.size(), 4u);
+    EXPECT_NE(cache.lookup(handleFor(0), 30), nullptr);
+    EXPECT_NE(cache.lookup(handleFor(2), 30), nullptr);
+    EXPECT_EQ(cache.lookup(handleFor(1), 30), nullptr);
+    EXPECT_EQ(cache.lookup(handleFor(3), 30), nullptr);
+    EXPECT_NE(cache.lookup(handleFor(5), 30), nullptr);
+}
+
+TEST(ResolvedPeripheralCacheTest, ZeroLifetimeDisables) {
+    PassBy::ResolvedPeripheralCache cache;
+    cache.configure(1000, 16);
+    cache.insert(handleFor(1), peerFor(1), true, "", 0);
+
+    cache.configure(0, 16);
+    EXPECT_FALSE(cache.enabled());
+    EXPECT_EQ(cache.lookup(handleFor(1), 10), nullptr);
+    cache.insert(handleFor(2), peerFor(2), true, "", 10);
+    EXPECT_EQ(cache.size(), 0u);
+}
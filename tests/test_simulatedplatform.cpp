@@ -0,0 +1,414 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "PassBy/PassBy.h"
+#include "../src/platform/sim/SimulatedPlatform.h"
+#include "TestPassByManager.h"
+
+namespace {
+
+const std::string kServiceUUID = "12345678-1234-1234-1234-123456789ABC";
+
+// Remembers the filter of every startBLE call
+class RecordingPlatform : public PassBy::SimulatedPlatform {
+public:
+    using SimulatedPlatform::SimulatedPlatform;
+
+    bool startBLE(const std::string& serviceUUID) override {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            filters.push_back(serviceUUID);
+        }
+        return SimulatedPlatform::startBLE(serviceUUID);
+    }
+
+    std::vector<std::string> startedFilters() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return filters;
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<std::string> filters;
+};
+
+PassBy::DutyCycleOptions shortWindows() {
+    PassBy::DutyCycleOptions options;
+    options.enabled = true;
+    options.window = std::chrono::milliseconds(20);
+    options.maxWindow = std::chrono::milliseconds(20);
+    options.targetLatency = std::chrono::milliseconds(40);
+    options.maxLatency = std::chrono::milliseconds(40);
+    return options;
+}
+
+} // namespace
+
+class SimulatedPlatformTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        PassBy::TestPassByManager::resetForTesting();
+    }
+
+    void TearDown() override {
+        PassBy::TestPassByManager::resetForTesting();
+        PassBy::SimulatedPlatform::install(nullptr);
+    }
+
+    PassBy::PassByManager& managerOn(std::shared_ptr<PassBy::VirtualRadio> radio) {
+        PassBy::SimulatedPlatform::install(radio);
+        PassBy::TestPassByManager::resetForTesting();
+        return PassBy::PassByManager::getInstance();
+    }
+
+    // Step the radio, draining the manager's queue between steps
+    static void run(PassBy::VirtualRadio& radio, PassBy::PassByManager& manager, int64_t durationMs) {
+        for (int64_t elapsed = 0; elapsed < durationMs; elapsed += 100) {
+            radio.advance(100);
+            manager.flushEvents();
+        }
+    }
+};
+
+TEST_F(SimulatedPlatformTest, CrowdIsDiscoveredFromWorkerThreads) {
+    auto radio = std::make_shared<PassBy::VirtualRadio>(7, 4);
+    radio->addCrowd(1000, 0, 5000, 100, kServiceUUID);
+    PassBy::RadioConditions conditions;
+    conditions.packetLoss = 0.3;
+    radio->setConditions(conditions);
+
+    auto& manager = managerOn(radio);
+    ASSERT_TRUE(manager.startScanning());
+    run(*radio, manager, 2000);
+
+    EXPECT_EQ(manager.getDiscoveredDevices().size(), 1000u);
+    EXPECT_EQ(manager.getDroppedEventCount(), 0u);
+    auto stats = radio->stats();
+    EXPECT_GT(stats.advertisementsLost, 0u);
+    EXPECT_EQ(stats.identifiersReported, stats.connectionAttempts);
+}
+
+TEST_F(SimulatedPlatformTest, ScenarioIsDeterministicAcrossThreadCounts) {
+    auto runScenario = [](size_t threads) {
+        PassBy::VirtualRadio radio(42, threads);
+        radio.addCrowd(500, 0, 3000, 250, kServiceUUID);
+        radio.addCrowd(500, 1000, 4000, 100, kServiceUUID);
+        PassBy::RadioConditions conditions;
+        conditions.packetLoss = 0.2;
+        conditions.connectionFailureRate = 0.1;
+        conditions.connectDurationMs = 300;
+        radio.setConditions(conditions);
+        radio.setScanning(true);
+        radio.runUntil(5000);
+        return radio.stats();
+    };
+
+    PassBy::RadioStats single = runScenario(1);
+    PassBy::RadioStats parallel = runScenario(8);
+    EXPECT_EQ(single.advertisements, parallel.advertisements);
+    EXPECT_EQ(single.advertisementsLost, parallel.advertisementsLost);
+    EXPECT_EQ(single.connectionAttempts, parallel.connectionAttempts);
+    EXPECT_EQ(single.connectionFailures, parallel.connectionFailures);
+    EXPECT_EQ(single.identifiersReported, parallel.identifiersReported);
+}
+
+TEST_F(SimulatedPlatformTest, DepartedPeersGoQuiet) {
+    PassBy::VirtualRadio radio(3, 2);
+    radio.addCrowd(100, 0, 1000, 100, kServiceUUID);
+    radio.setScanning(true);
+
+    radio.runUntil(1000);
+    uint64_t reported = radio.stats().identifiersReported;
+    EXPECT_GT(reported, 0u);
+
+    radio.runUntil(3000);
+    EXPECT_EQ(radio.stats().identifiersReported, reported);
+}
+
+TEST_F(SimulatedPlatformTest, FailedConnectionsReportNothing) {
+    auto radio = std::make_shared<PassBy::VirtualRadio>(5, 2);
+    radio->addCrowd(50, 0, 10000, 100, kServiceUUID);
+    PassBy::RadioConditions conditions;
+    conditions.connectionFailureRate = 1.0;
+    radio->setConditions(conditions);
+
+    auto& manager = managerOn(radio);
+    manager.startScanning();
+    run(*radio, manager, 1000);
+
+    EXPECT_TRUE(manager.getDiscoveredDevices().empty());
+    EXPECT_GT(radio->stats().connectionFailures, 0u);
+}
+
+TEST_F(SimulatedPlatformTest, ServiceFilterAndScanState) {
+    auto radio = std::make_shared<PassBy::VirtualRadio>(9, 1);
+    radio->addCrowd(10, 0, 10000, 100, kServiceUUID);
+    radio->addCrowd(10, 0, 10000, 100, "");     // Non-PassBy advertisers
+    radio->addCrowd(10, 0, 10000, 100, "0000FEAA-0000-1000-8000-00805F9B34FB");
+
+    auto& manager = managerOn(radio);
+
+    // Not scanning yet: nothing is heard
+    run(*radio, manager, 500);
+    EXPECT_EQ(radio->stats().advertisements, 0u);
+
+    manager.startScanning(kServiceUUID);
+    run(*radio, manager, 1000);
+    EXPECT_EQ(manager.getDiscoveredDevices().size(), 10u);
+
+    manager.stopScanning();
+    manager.clearDiscoveredDevices();
+    manager.startScanning();
+    run(*radio, manager, 1000);
+    EXPECT_EQ(manager.getDiscoveredDevices().size(), 20u);
+}
+
+TEST_F(SimulatedPlatformTest, UnattachedPlatformDropsReports) {
+    auto radio = std::make_shared<PassBy::VirtualRadio>(3, 2);
+    radio->addCrowd(10, 0, 10000, 100, kServiceUUID);
+    radio->addCrowd(10, 0, 10000, 100, "");
+    PassBy::RadioConditions conditions;
+    conditions.connectionFailureRate = 0.5;
+    conditions.connectDurationMs = 50;
+    radio->setConditions(conditions);
+
+    // No manager attached: every handler must drop what the radio reports
+    PassBy::SimulatedPlatform platform(radio);
+    ASSERT_TRUE(platform.startBLE(""));
+    radio->advance(500);
+    EXPECT_GT(radio->stats().identifiersReported, 0u);
+
+    radio->setConnectionMode(PassBy::ConnectionMode::Scheduled);
+    for (size_t i = 0; i < radio->peerCount(); ++i) {
+        platform.connectPeripheral(PassBy::VirtualRadio::peripheralHandle(i));
+    }
+    radio->advance(500);
+    EXPECT_GT(radio->stats().connectionFailures, 0u);
+    EXPECT_TRUE(platform.stopBLE());
+}
+
+TEST_F(SimulatedPlatformTest, ScheduledConnectionsRespectPolicy) {
+    auto radio = std::make_shared<PassBy::VirtualRadio>(11, 4);
+    radio->addCrowd(30, 0, 60000, 100, kServiceUUID);
+    radio->addCrowd(10, 0, 60000, 100, "");     // Never connected to
+    PassBy::RadioConditions conditions;
+    conditions.connectionFailureRate = 0.2;
+    conditions.connectDurationMs = 300;
+    radio->setConditions(conditions);
+    radio->setConnectionMode(PassBy::ConnectionMode::Scheduled);
+
+    auto& manager = managerOn(radio);
+    PassBy::ConnectionPolicy policy;
+    policy.maxConcurrentConnections = 3;
+    // Policy times are wall clock; keep backoff short so the virtual run is not held up
+    policy.initialBackoff = std::chrono::milliseconds(1);
+    policy.maxBackoff = std::chrono::milliseconds(1);
+    manager.setConnectionPolicy(policy);
+    ASSERT_TRUE(manager.startScanning());
+    for (int64_t elapsed = 0; elapsed < 60000 && manager.getDiscoveredDevices().size() < 30; elapsed += 1000) {
+        run(*radio, manager, 1000);
+    }
+
+    EXPECT_EQ(manager.getDiscoveredDevices().size(), 30u);
+    auto stats = radio->stats();
+    EXPECT_GT(stats.maxConcurrentConnections, 0u);
+    EXPECT_LE(stats.maxConcurrentConnections, 3u);
+    EXPECT_GT(stats.connectionFailures, 0u);
+    // Far fewer chains than advertisements, unlike Autonomous mode
+    EXPECT_LT(stats.connectionAttempts, stats.advertisements / 10);
+    // Read once each; later advertisements are answered from the resolved cache
+    EXPECT_EQ(stats.identifiersReported, 30u);
+
+    manager.stopScanning();
+}
+
+TEST_F(SimulatedPlatformTest, ResolvedPeripheralsAreNotReadAgain) {
+    auto radio = std::make_shared<PassBy::VirtualRadio>(13, 2);
+    radio->addCrowd(20, 0, 60000, 100, kServiceUUID);
+    PassBy::RadioConditions conditions;
+    conditions.connectDurationMs = 200;
+    radio->setConditions(conditions);
+    radio->setConnectionMode(PassBy::ConnectionMode::Scheduled);
+
+    auto& manager = managerOn(radio);
+    PassBy::ConnectionPolicy policy;
+    policy.maxConcurrentConnections = 4;
+    manager.setConnectionPolicy(policy);
+    ASSERT_TRUE(manager.startScanning());
+    run(*radio, manager, 5000);
+    ASSERT_EQ(manager.getDiscoveredDevices().size(), 20u);
+    uint64_t attempts = radio->stats().connectionAttempts;
+    EXPECT_EQ(attempts, 20u);
+
+    // Still reported (hit counts keep growing) without a single new connection
+    auto totalHits = [&manager] {
+        uint64_t hits = 0;
+        for (const auto& encounter : manager.getDiscoveredSince(0).changed) {
+            hits += encounter.hitCount;
+        }
+        return hits;
+    };
+    uint64_t hitsBefore = totalHits();
+    run(*radio, manager, 3000);
+    uint64_t hitsAfter = totalHits();
+    EXPECT_GT(hitsAfter, hitsBefore + 20 * 20);
+    EXPECT_EQ(radio->stats().connectionAttempts, attempts);
+
+    // With the cache off every advertisement is a candidate again
+    policy.resolvedLifetime = std::chrono::milliseconds(0);
+    manager.setConnectionPolicy(policy);
+    run(*radio, manager, 2000);
+    EXPECT_GT(radio->stats().connectionAttempts, attempts);
+
+    manager.stopScanning();
+}
+
+TEST_F(SimulatedPlatformTest, AdvertisedIdentifiersSkipConnections) {
+    auto radio = std::make_shared<PassBy::VirtualRadio>(17, 2);
+    radio->addCrowd(40, 0, 60000, 100, kServiceUUID, true);
+    radio->addCrowd(10, 0, 60000, 100, kServiceUUID);     // Older peers, GATT only
+    radio->setConnectionMode(PassBy::ConnectionMode::Scheduled);
+
+    auto& manager = managerOn(radio);
+    ASSERT_TRUE(manager.startScanning());
+    run(*radio, manager, 200);
+    // One advertising interval is enough for the new peers
+    EXPECT_GE(manager.getDiscoveredDevices().size(), 40u);
+
+    run(*radio, manager, 5000);
+    EXPECT_EQ(manager.getDiscoveredDevices().size(), 50u);
+    EXPECT_EQ(radio->stats().identifiersReported, 10u);
+
+    manager.stopScanning();
+}
+
+TEST_F(SimulatedPlatformTest, DutyCycledSessionStopsCleanly) {
+    auto radio = std::make_shared<PassBy::VirtualRadio>(19, 1);
+    auto& manager = managerOn(radio);
+    manager.setDutyCycle(shortWindows());
+
+    for (int round = 0; round < 20; ++round) {
+        ASSERT_TRUE(manager.startScanning(kServiceUUID));
+        EXPECT_TRUE(radio->isScanning());
+        std::this_thread::sleep_for(std::chrono::milliseconds(round % 4 * 10));
+        // Whether the window is open or not, the session ends with the radio off
+        ASSERT_TRUE(manager.stopScanning());
+        EXPECT_FALSE(radio->isScanning());
+        EXPECT_FALSE(manager.isScanning());
+    }
+}
+
+TEST_F(SimulatedPlatformTest, DutyCycleRestartsWithLongFilters) {
+    // Longer than an identifier fits in a queue slot
+    const std::string filter(100, 'F');
+    auto radio = std::make_shared<PassBy::VirtualRadio>(37, 1);
+    auto platform = std::make_unique<RecordingPlatform>(radio);
+    RecordingPlatform* recorder = platform.get();
+    PassBy::PassByContext context(std::move(platform));
+    context.setDutyCycle(shortWindows());
+
+    ASSERT_TRUE(context.startScanning(filter));
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (recorder->startedFilters().size() < 3 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    ASSERT_TRUE(context.stopScanning());
+
+    auto filters = recorder->startedFilters();
+    ASSERT_GE(filters.size(), 3u);
+    for (const auto& started : filters) {
+        EXPECT_EQ(started, filter);
+    }
+}
+
+TEST_F(SimulatedPlatformTest, DutyCycleReportsAdvertisingOnce) {
+    auto radio = std::make_shared<PassBy::VirtualRadio>(41, 1);
+    auto platform = std::make_unique<RecordingPlatform>(radio);
+    RecordingPlatform* recorder = platform.get();
+    PassBy::PassByContext context(std::move(platform));
+    std::atomic<int> reports{0};
+    context.setAdvertisingStartedCallback([&](const PassBy::AdvertisingInfo&) { ++reports; });
+    context.setDutyCycle(shortWindows());
+
+    ASSERT_TRUE(context.startScanning());
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (recorder->startedFilters().size() < 3 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    ASSERT_TRUE(context.stopScanning());
+    ASSERT_GE(recorder->startedFilters().size(), 3u);
+    EXPECT_EQ(reports.load(), 1);
+
+    // The next session reports again
+    ASSERT_TRUE(context.startScanning());
+    context.flushEvents();
+    EXPECT_EQ(reports.load(), 2);
+    ASSERT_TRUE(context.stopScanning());
+}
+
+TEST_F(SimulatedPlatformTest, ContextsRunIndependentSessions) {
+    auto crowded = std::make_shared<PassBy::VirtualRadio>(23, 2);
+    crowded->addCrowd(30, 0, 60000, 100, kServiceUUID);
+    auto quiet = std::make_shared<PassBy::VirtualRadio>(29, 1);
+    quiet->addCrowd(5, 0, 60000, 100, kServiceUUID);
+
+    PassBy::PassByContext first(std::make_unique<PassBy::SimulatedPlatform>(crowded));
+    PassBy::PassByContext second(std::make_unique<PassBy::SimulatedPlatform>(quiet));
+    ASSERT_TRUE(first.startScanning(kServiceUUID));
+    ASSERT_TRUE(second.startScanning(kServiceUUID));
+
+    std::thread other([&] { run(*quiet, second, 1000); });
+    run(*crowded, first, 1000);
+    other.join();
+
+    EXPECT_EQ(first.getDiscoveredDevices().size(), 30u);
+    EXPECT_EQ(second.getDiscoveredDevices().size(), 5u);
+
+    first.stopScanning();
+    EXPECT_FALSE(crowded->isScanning());
+    EXPECT_TRUE(quiet->isScanning());
+}
+
+TEST_F(SimulatedPlatformTest, SubscriptionsShareOneScan) {
+    const std::string serviceB = "0000BBBB-0000-1000-8000-00805F9B34FB";
+    const std::string serviceC = "0000CCCC-0000-1000-8000-00805F9B34FB";
+    auto radio = std::make_shared<PassBy::VirtualRadio>(31, 2);
+    radio->addCrowd(10, 0, 60000, 100, kServiceUUID);
+    radio->addCrowd(5, 0, 60000, 100, serviceB);
+    radio->addCrowd(7, 0, 60000, 100, serviceC);
+    auto& manager = managerOn(radio);
+
+    std::mutex mutex;
+    std::set<std::string> seenA;
+    std::set<std::string> seenB;
+    PassBy::SubscriptionFilter filterA;
+    filterA.serviceUUIDs = {kServiceUUID};
+    PassBy::SubscriptionFilter filterB;
+    filterB.serviceUUIDs = {serviceB};
+    PassBy::SubscriptionId a = manager.subscribe(filterA, [&](const PassBy::DeviceInfo& device) {
+        std::lock_guard<std::mutex> lock(mutex);
+        seenA.insert(device.uuid);
+    });
+    PassBy::SubscriptionId b = manager.subscribe(filterB, [&](const PassBy::DeviceInfo& device) {
+        std::lock_guard<std::mutex> lock(mutex);
+        seenB.insert(device.uuid);
+    });
+    ASSERT_NE(a, 0u);
+    ASSERT_NE(b, 0u);
+    EXPECT_TRUE(radio->isScanning());
+
+    run(*radio, manager, 1000);
+    EXPECT_EQ(seenA.size(), 10u);
+    EXPECT_EQ(seenB.size(), 5u);
+    EXPECT_EQ(manager.getDiscoveredDevices().size(), 15u);
+
+    EXPECT_TRUE(manager.unsubscribe(a));
+    EXPECT_TRUE(radio->isScanning());
+    EXPECT_TRUE(manager.unsubscribe(b));
+    EXPECT_FALSE(radio->isScanning());
+}
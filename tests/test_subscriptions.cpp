@@ -0,0 +1,238 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "PassBy/PassBy.h"
+#include "../src/internal/SubscriptionMatcher.h"
+#include "TestPassByManager.h"
+
+using Filter = PassBy::SubscriptionMatcher::Filter;
+
+namespace {
+
+// 16-bit service UUID on the Bluetooth base UUID
+PassBy::DeviceId shortService(uint16_t id) {
+    uint8_t bytes[PassBy::DeviceId::kSize] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00,
+                                              0x80, 0x00, 0x00, 0x80, 0x5f, 0x9b, 0x34, 0xfb};
+    bytes[2] = static_cast<uint8_t>(id >> 8);
+    bytes[3] = static_cast<uint8_t>(id);
+    return PassBy::DeviceId::fromBytes(bytes);
+}
+
+const PassBy::DeviceId kServiceA = shortService(0xAAAA);
+const PassBy::DeviceId kServiceB = shortService(0xBBBB);
+const PassBy::DeviceId kServiceC = shortService(0xCCCC);
+constexpr int kUnknownRssi = PassBy::SubscriptionMatcher::kUnknownRssi;
+
+Filter serviceFilter(const PassBy::DeviceId& service) {
+    Filter filter;
+    filter.services.push_back(service);
+    return filter;
+}
+
+std::vector<size_t> matches(const PassBy::SubscriptionMatcher& matcher, const PassBy::DeviceId* service, int rssi,
+                            std::string_view identifier) {
+    std::vector<size_t> indices;
+    matcher.match(service, rssi, identifier, [&](size_t index) { indices.push_back(index); });
+    std::sort(indices.begin(), indices.end());
+    return indices;
+}
+
+} // namespace
+
+TEST(SubscriptionMatcherTest, MatchesByService) {
+    std::vector<Filter> filters;
+    filters.push_back(serviceFilter(kServiceA));
+    filters.push_back(serviceFilter(kServiceB));
+    Filter both;
+    both.services = {kServiceA, kServiceB};
+    filters.push_back(both);
+    filters.push_back(Filter());    // Everything
+    PassBy::SubscriptionMatcher matcher(std::move(filters), false);
+
+    EXPECT_EQ(matches(matcher, &kServiceA, -50, "device"), (std::vector<size_t>{0, 2, 3}));
+    EXPECT_EQ(matches(matcher, &kServiceB, -50, "device"), (std::vector<size_t>{1, 2, 3}));
+    EXPECT_EQ(matches(matcher, &kServiceC, -50, "device"), (std::vector<size_t>{3}));
+}
+
+TEST(SubscriptionMatcherTest, UnknownServiceDependsOnTheScan) {
+    std::vector<Filter> filters;
+    filters.push_back(serviceFilter(kServiceA));
+    filters.push_back(Filter());
+    PassBy::SubscriptionMatcher unfiltered(std::move(filters), false);
+    EXPECT_EQ(matches(unfiltered, nullptr, -50, "device"), (std::vector<size_t>{1}));
+
+    // A filtered scan only reports devices with a subscribed service
+    filters.clear();
+    filters.push_back(serviceFilter(kServiceA));
+    filters.push_back(Filter());
+    PassBy::SubscriptionMatcher filtered(std::move(filters), true);
+    EXPECT_EQ(matches(filtered, nullptr, -50, "device"), (std::vector<size_t>{0, 1}));
+}
+
+TEST(SubscriptionMatcherTest, MatchesByPrefixOnce) {
+    std::vector<Filter> filters;
+    Filter prefixes;
+    prefixes.prefixes = {"ab", "abc", "x"};
+    filters.push_back(prefixes);
+    Filter serviceAndPrefix = serviceFilter(kServiceA);
+    serviceAndPrefix.prefixes = {"abc"};
+    filters.push_back(serviceAndPrefix);
+    PassBy::SubscriptionMatcher matcher(std::move(filters), false);
+
+    EXPECT_EQ(matches(matcher, &kServiceA, -50, "abcdef"), (std::vector<size_t>{0, 1}));
+    EXPECT_EQ(matches(matcher, &kServiceB, -50, "abcdef"), (std::vector<size_t>{0}));
+    EXPECT_EQ(matches(matcher, &kServiceA, -50, "abd"), (std::vector<size_t>{0}));
+    EXPECT_EQ(matches(matcher, &kServiceA, -50, "a"), (std::vector<size_t>{}));
+    EXPECT_EQ(matches(matcher, nullptr, -50, "xyz"), (std::vector<size_t>{0}));
+}
+
+TEST(SubscriptionMatcherTest, AppliesRssiThresholds) {
+    std::vector<Filter> filters;
+    Filter near;
+    near.minRssi = -60;
+    filters.push_back(near);
+    filters.push_back(Filter());
+    PassBy::SubscriptionMatcher matcher(std::move(filters), false);
+
+    EXPECT_EQ(matches(matcher, nullptr, -55, "device"), (std::vector<size_t>{0, 1}));
+    EXPECT_EQ(matches(matcher, nullptr, -60, "device"), (std::vector<size_t>{0, 1}));
+    EXPECT_EQ(matches(matcher, nullptr, -61, "device"), (std::vector<size_t>{1}));
+    EXPECT_EQ(matches(matcher, nullptr, kUnknownRssi, "device"), (std::vector<size_t>{1}));
+}
+
+TEST(SubscriptionMatcherTest, ScalesToManySubscriptions) {
+    // One subscription per service; each event must only reach its own
+    std::vector<Filter> filters;
+    std::vector<PassBy::DeviceId> services;
+    for (int i = 0; i < 2000; ++i) {
+        services.push_back(PassBy::DeviceId::fromString("service-" + std::to_string(i)));
+        filters.push_back(serviceFilter(services.back()));
+    }
+    PassBy::SubscriptionMatcher matcher(std::move(filters), false);
+    for (size_t i = 0; i < services.size(); i += 97) {
+        EXPECT_EQ(matches(matcher, &services[i], -50, "device"), (std::vector<size_t>{i}));
+    }
+}
+
+class SubscriptionTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        PassBy::TestPassByManager::resetForTesting();
+    }
+
+    void TearDown() override {
+        PassBy::TestPassByManager::resetForTesting();
+    }
+
+    // Identifiers received by each collector
+    std::vector<std::string> received[3];
+    std::mutex receivedMutex;
+
+    PassBy::DeviceDiscoveredCallback collector(size_t slot) {
+        return [this, slot](const PassBy::DeviceInfo& device) {
+            std::lock_guard<std::mutex> lock(receivedMutex);
+            received[slot].push_back(device.uuid);
+        };
+    }
+};
+
+TEST_F(SubscriptionTest, FansOutToMatchingSubscribers) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    PassBy::SubscriptionFilter filterA;
+    filterA.serviceUUIDs = {kServiceA.toString()};
+    PassBy::SubscriptionFilter filterB;
+    filterB.serviceUUIDs = {kServiceB.toString()};
+    filterB.identifierPrefixes = {"team-"};
+
+    PassBy::SubscriptionId a = manager.subscribe(filterA, collector(0));
+    PassBy::SubscriptionId b = manager.subscribe(filterB, collector(1));
+    ASSERT_NE(a, 0u);
+    ASSERT_NE(b, 0u);
+    EXPECT_NE(a, b);
+    EXPECT_FALSE(manager.isScanning());
+
+    manager.onDeviceDiscovered("device-1", kServiceA, -50);
+    manager.onDeviceDiscovered("team-2", kServiceB, -50);
+    manager.onDeviceDiscovered("device-3", kServiceB, -50);    // No prefix match
+    manager.onDeviceDiscovered("device-4", kServiceC, -50);    // Nobody's service
+    manager.flushEvents();
+
+    EXPECT_EQ(received[0], std::vector<std::string>{"device-1"});
+    EXPECT_EQ(received[1], std::vector<std::string>{"team-2"});
+    auto devices = manager.getDiscoveredDevices();
+    std::sort(devices.begin(), devices.end());
+    EXPECT_EQ(devices, (std::vector<std::string>{"device-1", "team-2"}));
+
+    // Gone subscribers get nothing more
+    EXPECT_TRUE(manager.unsubscribe(a));
+    EXPECT_FALSE(manager.unsubscribe(a));
+    manager.onDeviceDiscovered("device-5", kServiceA, -50);
+    manager.flushEvents();
+    EXPECT_EQ(received[0].size(), 1u);
+    EXPECT_TRUE(manager.unsubscribe(b));
+}
+
+TEST_F(SubscriptionTest, SessionKeepsItsDiscoveries) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    std::vector<std::string> legacy;
+    manager.setDeviceDiscoveredCallback([&](const PassBy::DeviceInfo& device) { legacy.push_back(device.uuid); });
+    ASSERT_TRUE(manager.startScanning(kServiceA.toString()));
+
+    PassBy::SubscriptionFilter filter;
+    filter.serviceUUIDs = {kServiceB.toString()};
+    filter.minRssi = -70;
+    ASSERT_NE(manager.subscribe(filter, collector(0)), 0u);
+    // The session and subscriptions do not exclude each other
+    EXPECT_FALSE(manager.startScanning());
+
+    manager.onDeviceDiscovered("session-device", kServiceA, -90);
+    manager.onDeviceDiscovered("near-device", kServiceB, -60);
+    manager.onDeviceDiscovered("far-device", kServiceB, -80);
+    manager.flushEvents();
+
+    EXPECT_EQ(received[0], std::vector<std::string>{"near-device"});
+    EXPECT_EQ(legacy, (std::vector<std::string>{"session-device", "near-device"}));
+
+    // The subscription outlives the session
+    EXPECT_TRUE(manager.stopScanning());
+    manager.onDeviceDiscovered("session-device-2", kServiceA, -50);
+    manager.onDeviceDiscovered("near-device-2", kServiceB, -50);
+    manager.flushEvents();
+    EXPECT_EQ(received[0].size(), 2u);
+    EXPECT_EQ(legacy.size(), 3u);
+}
+
+TEST_F(SubscriptionTest, BinaryIdsCarryRssi) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    PassBy::SubscriptionFilter nearby;
+    nearby.minRssi = -70;
+    PassBy::SubscriptionFilter nearService;
+    nearService.serviceUUIDs = {kServiceB.toString()};
+    nearService.minRssi = -70;
+    ASSERT_NE(manager.subscribe(nearby, collector(0)), 0u);
+    ASSERT_NE(manager.subscribe(nearService, collector(1)), 0u);
+
+    PassBy::DeviceId nearId = shortService(0x0001);
+    PassBy::DeviceId farId = shortService(0x0002);
+    PassBy::DeviceId nearServiceId = shortService(0x0003);
+    manager.onDeviceDiscovered(nearId, -60);
+    manager.onDeviceDiscovered(farId, -90);                    // Too weak for either
+    manager.onDeviceDiscovered(nearServiceId, kServiceB, -60);
+    manager.flushEvents();
+
+    std::sort(received[0].begin(), received[0].end());
+    std::vector<std::string> expected = {nearId.toString(), nearServiceId.toString()};
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(received[0], expected);
+    EXPECT_EQ(received[1], std::vector<std::string>{nearServiceId.toString()});
+}
+
+TEST_F(SubscriptionTest, RejectsInvalidServices) {
+    auto& manager = PassBy::PassByManager::getInstance();
+    PassBy::SubscriptionFilter filter;
+    filter.serviceUUIDs = {"not-a-uuid"};
+    EXPECT_EQ(manager.subscribe(filter, collector(0)), 0u);
+    EXPECT_FALSE(manager.unsubscribe(0));
+}